@@ -148,3 +148,8 @@
 #define BOARD_RUMBA32_AUS3D   4203    // RUMBA32 STM32F446VET6 based controller from Aus3D
 #define BOARD_RUMBA32_MKS     4204    // RUMBA32 STM32F446VET6 based controller from MKS
 #define BOARD_STEVAL_3DP001V1 4206    // STEVAL-3DP001V1 3D PRINTER BOARD
+
+/**
+ * Host native build - Linux
+ */
+#define BOARD_NATIVE_SIM      9000    // Simulated RAMPS for the host native build (ARDUINO_ARCH_NATIVE)
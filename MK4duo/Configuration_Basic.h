@@ -160,6 +160,17 @@
 // Uncomment to include more info in ok command
 //#define ADVANCED_OK
 
+/**
+ * Credit flow control for hosts that stream lines.
+ * After M1005 S1 the port gets no "ok" for each line. MK4duo grants credits
+ * instead, "ok N<last line> C<credits> P<planner free>": the host may send
+ * the lines up to N + C without waiting, one grant covers many lines.
+ * The lines must have line number and checksum, a bad line is answered
+ * with "Resend:" and the lines after it are dropped until it comes again.
+ * See scripts/creditsim.py for a host side simulation.
+ */
+//#define CREDIT_FLOW_CONTROL
+
 /**
  * Enable an emergency-command parser to intercept certain commands as they
  * enter the serial receive buffer, so they cannot be blocked.
@@ -167,11 +178,31 @@
  */
 //#define EMERGENCY_PARSER
 
+/**
+ * Binary command frames on serial, switched on by the host with M1004 S1.
+ * Moves are sent as int32 values with a CRC16 and acknowledged in windows,
+ * with no "ok" for each line. See src/feature/binary_protocol/binary_protocol.h
+ * and scripts/binproto.py for the host side.
+ * BINARY_PROTOCOL_WINDOW: bytes of frames the host may send before the
+ * acknowledge, no more than RX_BUFFER_SIZE - 1
+ */
+//#define BINARY_PROTOCOL
+#define BINARY_PROTOCOL_WINDOW 96
+
 /**
  * Spend 28 bytes of SRAM to optimize the GCode parser
  */
 //#define FASTER_GCODE_PARSER
 
+/**
+ * Parse each command once, when it is added to the command buffer, into a
+ * record with the parameters seen and the X Y Z E F values already converted.
+ * The command is not parsed again when it runs, right before it is planned.
+ * Spend about 64 bytes of SRAM for each BUFSIZE line.
+ * Requires FASTER_GCODE_PARSER
+ */
+//#define GCODE_PREPARSE
+
 /**
  * Spend more bytes of SRAM to optimize the GCode execute
  */
@@ -198,6 +198,19 @@
 #define SOFT_PWM_SPEED 0
 /***********************************************************************/
 
+/***********************************************************************
+ ************************ SOFT PWM Port writes *************************
+ ***********************************************************************
+ *                                                                     *
+ * The port and mask of each soft PWM heater and fan pin are made when *
+ * the pin is set, at start and by M306 P or M106 U, not looked up in  *
+ * every tick. The levels of a tick are gathered by port and written   *
+ * with one register write for each port.                              *
+ *                                                                     *
+ ***********************************************************************/
+//#define SOFT_PWM_PORT_WRITE
+/***********************************************************************/
+
 
 //===========================================================================
 //=============================== FAN FEATURES ==============================
@@ -1407,6 +1420,25 @@
 #define SD_FINISHED_STEPPERRELEASE true   // if sd support and the file is finished: disable steppers?
 #define SD_FINISHED_RELEASECOMMAND "M84"  // Use "M84XYE" to keep Z enabled so your bed stays in place
 
+// Read the file being printed in whole blocks, two buffers of SD_READ_AHEAD_SIZE bytes.
+// The next block is read in idle() while the lines are taken from the other one.
+//#define SD_READ_AHEAD
+#define SD_READ_AHEAD_SIZE 512            // Bytes of each buffer, a multiple of the 512 bytes block
+
+// Gather the lines of a M28 upload in whole blocks, two buffers of SD_WRITE_BEHIND_SIZE bytes.
+// A full block is written in idle(), the rest on M29. M29 reports the upload rate.
+//#define SD_WRITE_BEHIND
+#define SD_WRITE_BEHIND_SIZE 512          // Bytes of each buffer, a multiple of the 512 bytes block
+
+// "M28 B<bytes> <file>" takes the bytes of the file after it answers "upload:ready", no lines,
+// no checksums, no "ok" for each one. Meant for native USB ports. Requires SD_WRITE_BEHIND.
+//#define SD_UPLOAD_RAW
+#define SD_UPLOAD_RAW_TIMEOUT 5000        // (ms) Upload stops if no byte comes for this time
+
+// Print compiled jobs, files made by scripts/gcodejob.py out of a G-code file.
+// The moves come parsed, with the values already floats. Requires GCODE_PREPARSE.
+//#define SD_BINARY_JOB
+
 //#define MENU_ADDAUTOSTART
 
 // Enable this option to scroll long filenames in the SD card menu
@@ -1448,11 +1480,23 @@
 #define SDSORT_CACHE_VFATS 2      // Maximum number of 13-byte VFAT entries to use for sorting.
                                   // Note: Only affects SCROLL_LONG_FILENAMES with SDSORT_CACHE_NAMES but not SDSORT_DYNAMIC_RAM.
 
+// Keep the sorted list of each directory in a file on the card (MK4INDEX.DAT), the LCD
+// menu reads its entries from there. It is made again from the old one when the directory
+// changes. Without it, or on a write protected card, the sort above is used.
+//#define SD_DIR_INDEX
+#define SD_DIR_INDEX_LIMIT 1024   // Maximum number of entries. Costs 8 bytes of heap each while the index is made, 128 at most on AVR.
+
 // This function enable the firmware write restart file for restart print when power loss
 //#define SD_RESTART_FILE               // Uncomment to enable
 #define SD_RESTART_FILE_SAVE_TIME    1  // Seconds between update
 #define SD_RESTART_FILE_PURGE_LEN   20  // Purge when restart
 #define SD_RESTART_FILE_RETRACT_LEN  1  // Retract when restart
+
+// Save the restart data as a journal of records in a file of SD_RESTART_JOURNAL_BLOCKS blocks
+// made once for the job, each save one block write with only what changed since the save
+// before, in place of rewriting the whole restart file. Keeps a block and a copy of the data in RAM.
+//#define SD_RESTART_JOURNAL
+#define SD_RESTART_JOURNAL_BLOCKS    8  // Blocks of 512 bytes, up to one cluster to be sure to find them
 /*****************************************************************************************/
 
 
@@ -1702,6 +1746,53 @@
 /**************************************************************************/
 
 
+/**************************************************************************
+ ************************ Planner Fixed Point *****************************
+ **************************************************************************
+ *                                                                        *
+ * Run the lookahead (reverse and forward pass) and the trapezoid         *
+ * generator on scaled integers instead of float. An AVR does float       *
+ * math in software, so this lets it plan more short segments per second  *
+ * (deltas, arcs, curved prints). The float values of a block are still   *
+ * worked out once when it is queued.                                     *
+ *                                                                        *
+ * Speeds up to 4096 mm/s. Step counts may differ by a step from the      *
+ * float planner at the phase boundaries.                                 *
+ *                                                                        *
+ **************************************************************************/
+//#define PLANNER_FIXED_POINT
+/**************************************************************************/
+
+
+/**************************************************************************
+ *********************** Planner Segment Merge ****************************
+ **************************************************************************
+ *                                                                        *
+ * Join a new segment to the last queued block when they go the same way  *
+ * at the same feedrate and extrusion, and the stepper did not start the  *
+ * block yet. Slicers cut curved perimeters in many tiny segments: fewer, *
+ * longer blocks let the 16 block lookahead see further ahead and keep    *
+ * SLOWDOWN from kicking in. M1003 reports how many segments were joined. *
+ *                                                                        *
+ * Not for delta or scara, hysteresis, XY frequency limit or the filament *
+ * width sensor.                                                          *
+ *                                                                        *
+ **************************************************************************/
+//#define PLANNER_SEGMENT_MERGE
+
+// (mm) Max distance of a dropped corner from the joined block
+#define SEGMENT_MERGE_DEVIATION   0.01
+// (degrees) Max angle between a segment and the first one of the block
+#define SEGMENT_MERGE_ANGLE       5
+// (mm) Max length of a joined block
+#define SEGMENT_MERGE_MAX_LENGTH  10
+// Max segments joined in one block
+#define SEGMENT_MERGE_MAX_SEGMENTS  8
+// Max relative difference of feedrate and extrusion per mm
+#define SEGMENT_MERGE_TOLERANCE   0.02
+/**************************************************************************/
+
+
 /****************************************************************************
  ************************** Bézier Jerk Control *****************************
  ****************************************************************************
@@ -1716,6 +1807,64 @@
 /****************************************************************************/
 
 
+/****************************************************************************
+ ************************** S-Curve Jerk Control ****************************
+ ****************************************************************************
+ *                                                                          *
+ * Jerk limited (7 phase) acceleration worked out by the planner: every     *
+ * speed change is split in jerk up, constant acceleration and jerk down.   *
+ * The stepper ISR only picks the phase and does two multiplies, so it is   *
+ * cheaper than BEZIER_JERK_CONTROL at high step rates. Only 32 bit boards. *
+ *                                                                          *
+ * A speed change keeps the time and distance of the trapezoid, so the      *
+ * peak acceleration goes above the set one (2x at most). The jerk is       *
+ * honored when the speed change is at least 4 * acceleration^2 / jerk,     *
+ * shorter speed changes use the jerk their time allows.                    *
+ *                                                                          *
+ * Can't be used together with BEZIER_JERK_CONTROL.                         *
+ *                                                                          *
+ ****************************************************************************/
+//#define S_CURVE_JERK_CONTROL
+
+// Jerk in mm/s^3
+#define S_CURVE_JERK 500000
+/****************************************************************************/
+
+
+/***********************************************************************
+ **************************** Input Shaping ****************************
+ ***********************************************************************
+ *                                                                     *
+ * Input shaping removes the ringing of the X and Y axes. Every step   *
+ * is sent as 2 or 3 smaller impulses spread over about one ringing    *
+ * period, so the impulses cancel the vibration they excite.           *
+ * Measure the ringing frequency with a ringing test print and set it  *
+ * with M593 X/Y T[shaper] F[frequency] D[damping], saved by M500.     *
+ *                                                                     *
+ * Shapers:                                                            *
+ *   0 = None                                                          *
+ *   1 = ZV   2 impulses, shortest delay, needs an exact frequency     *
+ *   2 = ZVD  3 impulses, more robust, twice the delay of ZV           *
+ *   3 = MZV  3 impulses, good compromise between ZV and ZVD           *
+ *   4 = EI   3 impulses, most robust to a wrong frequency             *
+ *                                                                     *
+ * On CORE machines the shapers act on the A and B motors, use the     *
+ * same values for X and Y.                                            *
+ * Homing and probing moves are never shaped.                          *
+ *                                                                     *
+ * The buffer keeps the step events of the delayed impulses, for each  *
+ * axis. It needs about (steps per second / frequency) events; when    *
+ * it is full the oldest events are output early (see M593).           *
+ *                                                                     *
+ ***********************************************************************/
+//#define INPUT_SHAPING
+#define INPUT_SHAPING_TYPE        { 3, 3 }        // Shaper for X and Y
+#define INPUT_SHAPING_FREQUENCY   { 40.0, 40.0 }  // Ringing frequency in Hz for X and Y
+#define INPUT_SHAPING_DAMPING     { 0.1, 0.1 }    // Damping ratio for X and Y
+#define INPUT_SHAPING_BUFFER_SIZE 512             // Step events per axis
+/***********************************************************************/
+
+
 /***************************************************************************************
  ******************************** Minimum stepper pulse ********************************
  ***************************************************************************************
@@ -1912,6 +2061,11 @@
 #define M100_FREE_MEMORY_DUMPER
 // Comment out to remove Corrupt sub-command
 #define M100_FREE_MEMORY_CORRUPTOR
+
+// Uncomment to profile the stepper ISR phases for debug purpose.
+// Cycles are counted with the DWT on ARM and with the stepper timer on AVR.
+// Use M1002 to report the data, M1002 R to report and reset.
+//#define STEPPER_ISR_PROFILER
 /****************************************************************************************/
 
 
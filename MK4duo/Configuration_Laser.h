@@ -62,9 +62,15 @@
 // Raster mode enables the laser to etch bitmap data at high speeds. Increases command buffer size substantially.
 //#define LASER_RASTER
 #define LASER_MAX_RASTER_LINE 68      // Maximum number of base64 encoded pixels per raster gcode command
+#define LASER_RASTER_POOL_SIZE 256    // Bytes shared by the raster lines queued in the planner, at least LASER_MAX_RASTER_LINE
 #define LASER_RASTER_ASPECT_RATIO 1   // pixels aren't square on most displays, 1.33 == 4:3 aspect ratio. 
 #define LASER_RASTER_MM_PER_PULSE 0.2 // Can be overridden by providing an R value in M649 command : M649 S17 B2 D0 R0.1 F4000
 
+// Binary raster lines: M652 P<pixels> C<crc16> is followed by the raw pixel bytes instead of base64 text.
+// See scripts/raster_stream.py for the host side.
+//#define LASER_RASTER_STREAM
+#define LASER_RASTER_STREAM_TIMEOUT 1000 // Milliseconds to wait for the next pixel byte
+
 //#define LASER_RASTER_MANUAL_Y_FEED // Do not perform any X or Y movements on a G7 $ direction change. Manual Moves must be made between each line.
 
 // Uncomment the following if the laser cutter is equipped with a peripheral relay board
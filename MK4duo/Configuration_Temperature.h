@@ -36,6 +36,7 @@
  * - PID Settings - BED
  * - PID Settings - CHAMBER
  * - PID Settings - COOLER
+ * - Power budget
  * - Inverted PINS
  * - Thermal runaway protection
  * - Prevent cold extrusion
@@ -106,6 +107,25 @@
 #define T9_R25    100000.0  // Resistance in Ohms @ 25°C
 #define T9_BETA     4036.0  // Beta Value (K)
 
+// Read the thermistors 1-9 from an ADC to temperature table instead of the
+// LOG math of Steinhart-Hart on every reading. The table is made again from
+// the formula at start, at EEPROM load and at every M305.
+// Each point takes 4 bytes of RAM for each thermistor.
+//#define THERMISTOR_TABLE
+#define THERMISTOR_TABLE_POINTS   64  // Points of each table (8 - 128), 64 is within 0.5 degC, 32 within 2 degC
+#define THERMISTOR_TABLE_MAXTEMP 500  // (degC) Top of the table, hotter readings use the formula
+
+// Sample the ADC channels of the sensors without stop by DMA (PDC on DUE,
+// DMA2 on STM32F4) in place of one read for each channel every Tick.
+// Each reading is made of ADC_DMA_SAMPLES samples, oversampled and decimated
+// to ADC_OVERSAMPLE_BITS bits more than the ADC, AD_RANGE grows with them.
+// The Tick only adds up the samples of the buffers the DMA has filled.
+// Use M1006 to report the sample rate and the noise of each sensor.
+// The scan takes the ADC, the analog reads of M43 can't be used with it.
+//#define ADC_DMA
+#define ADC_OVERSAMPLE_BITS   2   // Extra bits of the readings (0 - 2)
+#define ADC_DMA_SAMPLES      64   // Samples of each reading (4^ADC_OVERSAMPLE_BITS - 256, a power of 2)
+
 // Enable this for support DHT sensor for temperature e Humidity DHT11, DHT21 or DHT22.
 //#define DHT_SENSOR
 // Set Type DHT 11 for DHT11, 12 for DHT12, 21 for DHT21, 22 for DHT22
@@ -336,6 +356,36 @@
 /***********************************************************************/
 
 
+/***********************************************************************
+ **************************** Power budget *****************************
+ ***********************************************************************
+ *                                                                     *
+ * For a power supply that can't feed all the heaters at full power.   *
+ * Every 100ms the duty asked by PID or bang-bang of all the heaters   *
+ * is cut to stay within POWER_BUDGET_WATTS:                           *
+ *  - first the heaters at their target, to hold the temperature       *
+ *  - then the heaters still heating, the slowest to reach its target  *
+ *    first, so bed, chamber and hotends all heat at the same time     *
+ * The budget is on the mean power, not the current at each moment.   *
+ * The soft PWM windows of the heaters are put one after the other,    *
+ * so they overlap as little as the duties allow; they still overlap   *
+ * when the duties add up to more than 100% (not with SOFTWARE_PDM).   *
+ * At the end of M109, M190 and M191 the time to temperature is shown. *
+ *                                                                     *
+ * M306 W<watts> sets the watts of a heater, 0 leaves it out.          *
+ * M1007 S<watts> sets the budget, 0 for none. M1007 reports the       *
+ * duty asked and given and the seconds to the target of each heater.  *
+ *                                                                     *
+ ***********************************************************************/
+//#define POWER_BUDGET
+#define POWER_BUDGET_WATTS  240                             // Watts the heaters may draw all together
+#define HOTEND_WATTS        { 40, 40, 40, 40, 40, 40 }      // Watts of each hotend at full duty
+#define BED_WATTS           220                             // Watts of each bed at full duty
+#define CHAMBER_WATTS       300                             // Watts of each chamber at full duty
+#define COOLER_WATTS        60                              // Watts of each cooler at full duty
+/***********************************************************************/
+
+
 /********************************************************************************
  **************************** Inverted PINS *************************************
  ********************************************************************************
@@ -106,6 +106,9 @@
 #include "src/lib/enum.h"
 #include "src/lib/restorer.h"
 #include "src/lib/circular_queue.h"
+#include "src/lib/decimal.h"
+#include "src/lib/read_ahead.h"
+#include "src/lib/write_behind.h"
 #include "src/lib/driver_types.h"
 #include "src/lib/duration_t.h"
 #include "src/lib/matrix.h"
@@ -119,6 +122,7 @@
 #include "src/core/hostaction/hostaction.h"
 #include "src/core/utility/utility.h"
 #include "src/core/watch/watch.h"
+#include "src/core/softpwm/softpwm.h"
 #include "src/core/mechanics/mechanics.h"
 #include "src/core/toolmanager/toolmanager.h"
 #include "src/core/nozzle/nozzle.h"
@@ -156,6 +160,7 @@
 #include "src/feature/bezier/bezier.h"
 #include "src/feature/digipot/digipot.h"
 #include "src/feature/emergency_parser/emergency_parser.h"
+#include "src/feature/binary_protocol/binary_protocol.h"
 #include "src/feature/probe/probe.h"
 #include "src/feature/bedlevel/bedlevel.h"
 #include "src/feature/babystep/babystep.h"
@@ -179,3 +184,5 @@
 #include "src/feature/rgbled/led_events.h"
 #include "src/feature/caselight/caselight.h"
 #include "src/feature/restart/restart.h"
+#include "src/feature/isrprofiler/isrprofiler.h"
+#include "src/feature/inputshaper/inputshaper.h"
@@ -47,11 +47,37 @@ char Commands::injected_cmd[64] = { 0 };
 
 long Commands::gcode_last_N = 0;
 
+#if ENABLED(LASER_RASTER_STREAM)
+  int8_t Commands::raster_stream_port = -1;
+#endif
+
+#if ENABLED(SD_UPLOAD_RAW)
+  int8_t Commands::upload_port = -1;
+#endif
+
+#if ENABLED(CREDIT_FLOW_CONTROL)
+  int8_t Commands::credit_port = -1;
+#endif
+
 /** Private Parameters */
 long Commands::gcode_N = 0;
 
+#if ENABLED(CREDIT_FLOW_CONTROL)
+  long Commands::credit_edge    = 0;
+  bool Commands::credit_resend  = false;
+#endif
+
 int Commands::serial_count[NUM_SERIAL] = { 0 };
 
+#if HAS_SD_SUPPORT
+  int     Commands::sd_count        = 0;
+  uint8_t Commands::sd_input_state  = PS_NORMAL;
+#endif
+
+#if ENABLED(GCODE_PREPARSE)
+  bool Commands::preparse_hold = false;
+#endif
+
 /** Public Function */
 void Commands::flush_and_request_resend() {
   SERIAL_FLUSH();
@@ -84,7 +110,7 @@ void Commands::advance_queue() {
   #if HAS_SD_SUPPORT
 
     if (card.isSaving()) {
-      gcode_t command = buffer_ring.peek();
+      gcode_t &command = buffer_ring.peek_ref();
       if (is_M29(command.gcode)) {
         // M29 closes the file
         card.finishWrite();
@@ -115,12 +141,18 @@ void Commands::advance_queue() {
   #endif // !HAS_SD_SUPPORT
 
   // The buffer_ring may be reset by a command handler or by code invoked by idle() within a handler
-  buffer_ring.dequeue();
+  buffer_ring.release();
 
 }
 
 void Commands::clear_queue() {
   buffer_ring.clear();
+  #if ENABLED(LASER_RASTER_STREAM)
+    raster_stream_port = -1;
+  #endif
+  #if ENABLED(SD_UPLOAD_RAW)
+    upload_port = -1;
+  #endif
 }
 
 void Commands::enqueue_one_now(const char * cmd) {
@@ -292,18 +324,58 @@ Heater* Commands::get_target_heater() {
 
 }
 
+#if ENABLED(CREDIT_FLOW_CONTROL)
+
+  void Commands::set_credit_port(const int8_t port) {
+    credit_port = port;
+    credit_resend = false;
+    report_credit(true);
+  }
+
+  void Commands::report_credit(const bool force/*=false*/) {
+
+    if (credit_port < 0) return;
+
+    const uint8_t free = BUFSIZE - buffer_ring.count();
+    const long edge = gcode_last_N + free;
+
+    if (!force) {
+      if (edge <= credit_edge) return;
+      // Grant more at once while the host has lines to send and the planner is busy
+      if (gcode_last_N < credit_edge && edge - credit_edge < (BUFSIZE + 1) / 2
+        && planner.moves_free() < (BLOCK_BUFFER_SIZE) / 2
+      ) return;
+    }
+
+    credit_edge = edge;
+
+    SERIAL_PORT(credit_port);
+    SERIAL_STR(OK);
+    SERIAL_MV(" N", gcode_last_N);
+    SERIAL_MV(" C", int(free));
+    SERIAL_MV(" P", int(planner.moves_free()));
+    SERIAL_EOL();
+    SERIAL_PORT(-1);
+  }
+
+#endif
+
 /** Private Function */
 void Commands::ok_to_send() {
 
-  gcode_t tmp = buffer_ring.peek();
+  const gcode_t &tmp = buffer_ring.peek_ref();
 
   if (tmp.s_port < 0 || !tmp.send_ok) return;
 
+  #if ENABLED(CREDIT_FLOW_CONTROL)
+    if (tmp.s_port == credit_port) return;  // Credits are granted by get_serial
+  #endif
+
   SERIAL_PORT(tmp.s_port);
   SERIAL_STR(OK);
 
   #if ENABLED(ADVANCED_OK)
-    char* p = tmp.gcode;
+    const char* p = tmp.gcode;
     if (*p == 'N') {
       SERIAL_CHR(' ');
       SERIAL_CHR(*p++);
@@ -340,6 +412,16 @@ void Commands::get_serial() {
     }
   #endif
 
+  #if ENABLED(LASER_RASTER_STREAM)
+    // The pixels of a M652 are still waiting in the serial buffer
+    if (raster_stream_port >= 0) return;
+  #endif
+
+  #if ENABLED(SD_UPLOAD_RAW)
+    // The bytes of a M28 B<bytes> upload are still waiting in the serial buffer
+    if (upload_port >= 0) return;
+  #endif
+
   /**
    * Loop while serial characters are incoming and the buffer_ring is not full
    */
@@ -354,6 +436,19 @@ void Commands::get_serial() {
 
       const char serial_char = c;
 
+      #if ENABLED(BINARY_PROTOCOL)
+        // Frames in place of text lines, each one a line with no "ok"
+        if (binary_protocol.port == i) {
+          if (binary_protocol.receive(c, serial_line_buffer[i], serial_count[i])) {
+            #if NO_TIMEOUTS > 0
+              last_command_timer.start();
+            #endif
+            enqueue(serial_line_buffer[i], false, i);
+          }
+          continue;
+        }
+      #endif
+
       if (serial_char == '\n' || serial_char == '\r') {
 
         // Skip empty lines and comments
@@ -376,6 +471,10 @@ void Commands::get_serial() {
           gcode_N = strtol(npos + 1, nullptr, 10);
 
           if (gcode_N != gcode_last_N + 1 && !M110) {
+            #if ENABLED(CREDIT_FLOW_CONTROL)
+              // The lines sent after a bad one are dropped with no error
+              if (credit_resend && i == credit_port) continue;
+            #endif
             gcode_line_error(PSTR(STR_ERR_LINE_NO), i);
             return;
           }
@@ -395,6 +494,10 @@ void Commands::get_serial() {
           }
 
           gcode_last_N = gcode_N;
+
+          #if ENABLED(CREDIT_FLOW_CONTROL)
+            credit_resend = false;
+          #endif
         }
         #if HAS_SD_SUPPORT
           // Pronterface "M29" and "M29 " has no line number
@@ -443,14 +546,46 @@ void Commands::get_serial() {
           last_command_timer.start();
         #endif
 
+        #if ENABLED(SD_UPLOAD_RAW)
+          // The file bytes follow M28 B<bytes>, no M29 to wait for
+          const bool upload = is_M28_raw(command);
+          if (upload) upload_port = i;
+        #endif
+
         // Add the command to the buffer_ring
         enqueue(serial_line_buffer[i], true, i);
+
+        #if ENABLED(BINARY_PROTOCOL)
+          // Frames follow M1004 S1 right away
+          binary_protocol.check_line(i, command);
+        #endif
+
+        #if ENABLED(LASER_RASTER_STREAM)
+          // Binary pixels follow M652, leave them to the command
+          if (match_command(command, 'M', 652)) {
+            raster_stream_port = i;
+            return;
+          }
+        #endif
+
+        #if ENABLED(SD_UPLOAD_RAW)
+          // Leave the file bytes to the command
+          if (upload) return;
+        #endif
       }
       else
         process_stream_char(serial_char, serial_input_state[i], serial_line_buffer[i], serial_count[i]);
 
     } // for NUM_SERIAL
   }
+
+  #if ENABLED(BINARY_PROTOCOL)
+    binary_protocol.acknowledge();
+  #endif
+
+  #if ENABLED(CREDIT_FLOW_CONTROL)
+    report_credit();
+  #endif
 }
 
 #if HAS_SD_SUPPORT
@@ -463,8 +598,7 @@ void Commands::get_serial() {
    */
   void Commands::get_sdcard() {
 
-    static char     sd_line_buffer[MAX_CMD_SIZE];
-    static uint8_t  sd_input_state = PS_NORMAL;
+    static char sd_line_buffer[MAX_CMD_SIZE];
 
     if (!IS_SD_PRINTING()) return;
 
@@ -475,7 +609,51 @@ void Commands::get_serial() {
       }
     #endif
 
-    int sd_count = 0;
+    #if ENABLED(SD_BINARY_JOB)
+      if (card.binary_job) {
+        get_sdcard_job();
+        printer.progress = card.percentDone();
+        return;
+      }
+    #endif
+
+    #if ENABLED(SD_READ_AHEAD)
+
+      // Whole lines out of the read ahead buffers, no SD access for each byte
+      while (!buffer_ring.isFull()) {
+
+        const char *p;
+        bool is_eol;
+        uint16_t n = card.get_line(p, is_eol);
+
+        if (!n) {
+          if (!card.eof()) {
+            if (card.read_error()) SERIAL_LM(ER, STR_SD_ERR_READ);
+            break;
+          }
+          // End of file with no newline
+          if (!process_line_done(sd_input_state, sd_line_buffer, sd_count))
+            enqueue(sd_line_buffer, false, -2);
+          card.fileHasFinished();
+          break;
+        }
+
+        printer.max_inactivity_timer.start();
+
+        if (is_eol) n--;
+        while (n--) process_stream_char(*p++, sd_input_state, sd_line_buffer, sd_count);
+
+        if (is_eol && !process_line_done(sd_input_state, sd_line_buffer, sd_count)) {
+          enqueue(sd_line_buffer, false, -2);   // Port -2 for SD non answer and no send ok.
+          #if HAS_SD_RESTART
+            restart.cmd_sdpos = card.getIndex();
+          #endif
+        }
+
+      }
+
+    #else
+
     bool card_eof = card.eof();
 
     while (!buffer_ring.isFull() && !card_eof) {
@@ -509,15 +687,106 @@ void Commands::get_serial() {
 
     }
 
+    #endif // SD_READ_AHEAD
+
     printer.progress = card.percentDone();
 
   }
 
 #endif // HAS_SD_SUPPORT
 
+#if ENABLED(SD_BINARY_JOB)
+
+  void Commands::get_sdcard_job() {
+
+    static const char job_letters[PREPARSE_VALUES] = { 'X', 'Y', 'Z', 'E', 'F' };
+
+    // Nothing more to read once the job is being aborted
+    if (card.isAbortSDprinting()) return;
+
+    if (card.getIndex() < SD_JOB_HEADER_SIZE) card.setIndex(SD_JOB_HEADER_SIZE);
+
+    while (!buffer_ring.isFull()) {
+
+      if (card.eof()) {
+        card.fileHasFinished();
+        break;
+      }
+
+      const uint32_t start = card.getIndex();
+      char line[MAX_CMD_SIZE];
+      uint8_t tag;
+      bool done = card.get_bytes(&tag, 1);
+
+      if (done && TEST(tag, 7)) {
+        // A move, parsed and converted by the host
+        float value[PREPARSE_VALUES];
+        const uint8_t valuebits = tag & SD_JOB_VALUES;
+        uint8_t count = 0;
+        LOOP_L_N(v, PREPARSE_VALUES) if (TEST(valuebits, v)) count++;
+        done = card.get_bytes(value, count * sizeof(float));
+        if (done) {
+          gcode_record_t rec;
+          rec.parsed          = true;
+          rec.command_letter  = 'G';
+          rec.codenum         = (tag & SD_JOB_G1) ? 1 : 0;
+          #if USE_GCODE_SUBCODES
+            rec.subcode       = 0;
+          #endif
+          rec.command_offset  = 0;
+          rec.string_offset   = 0xFF;
+          rec.valuebits       = valuebits;
+          rec.codebits        = 0;
+          ZERO(rec.param);
+          count = 0;
+          LOOP_L_N(v, PREPARSE_VALUES) {
+            if (TEST(valuebits, v)) {
+              SBI32(rec.codebits, LETTER_BIT(job_letters[v]));
+              rec.value[v] = value[count++];
+            }
+          }
+          strcpy_P(line, rec.codenum ? PSTR("G1") : PSTR("G0"));
+          enqueue_parsed(line, rec);
+        }
+      }
+      else if (done) {
+        // Any other command, a line to parse as it is
+        done = tag && tag < MAX_CMD_SIZE && card.get_bytes(line, tag);
+        if (done) {
+          line[tag] = '\0';
+          enqueue(line, false, -2);
+        }
+      }
+
+      if (!done) {
+        if (card.eof()) {
+          // The file ends inside a record, the job is not whole
+          SERIAL_LM(ER, "Job file cut off");
+          card.setAbortSDprinting(true);
+          break;
+        }
+        // Read again from the start of the record
+        SERIAL_LM(ER, STR_SD_ERR_READ);
+        card.setIndex(start);
+        break;
+      }
+
+      printer.max_inactivity_timer.start();
+
+      #if HAS_SD_RESTART
+        restart.cmd_sdpos = card.getIndex();
+      #endif
+
+    }
+
+  }
+
+#endif // SD_BINARY_JOB
+
 void Commands::process_next() {
 
-  gcode_t cmd = buffer_ring.peek();
+  // Parsed in place, the command stays in the buffer_ring until advance_queue() releases it
+  gcode_t &cmd = buffer_ring.peek_ref();
 
   if (printer.debugEcho()) {
     SERIAL_PORT(cmd.s_port);
@@ -527,15 +796,24 @@ void Commands::process_next() {
   printer.reset_move_timer(); // Keep steppers powered
 
   // Parse the next command in the buffer_ring
-  parser.parse(cmd.gcode);
+  #if ENABLED(STEPPER_ISR_PROFILER)
+    const isr_free_t start = isrprofiler.start_free();
+  #endif
+  #if ENABLED(GCODE_PREPARSE)
+    parser.load(cmd.gcode, cmd.record);
+  #else
+    parser.parse(cmd.gcode);
+  #endif
+  #if ENABLED(STEPPER_ISR_PROFILER)
+    isrprofiler.stop_free(ISR_PHASE_PARSE, start);
+  #endif
   process_parsed();
 
 }
 
 void Commands::unknown_warning() {
   #if NUM_SERIAL > 1
-    gcode_t tmp = buffer_ring.peek();
-    SERIAL_PORT(tmp.s_port);
+    SERIAL_PORT(buffer_ring.peek_ref().s_port);
   #endif
   SERIAL_SMT(ECHO, STR_UNKNOWN_COMMAND, parser.command_ptr);
   SERIAL_CHR('"');
@@ -544,6 +822,9 @@ void Commands::unknown_warning() {
 }
 
 void Commands::gcode_line_error(PGM_P const err, const int8_t port) {
+  #if ENABLED(CREDIT_FLOW_CONTROL)
+    if (port == credit_port) credit_resend = true;
+  #endif
   SERIAL_PORT(port);
   SERIAL_STR(ER);
   SERIAL_STR(err);
@@ -554,6 +835,18 @@ void Commands::gcode_line_error(PGM_P const err, const int8_t port) {
   SERIAL_PORT(-1);
 }
 
+const char* Commands::match_command(const char * line, const char letter, const uint16_t code) {
+  while (*line == ' ') line++;
+  if (*line == 'N') {
+    do line++; while (NUMERIC(*line));
+    while (*line == ' ') line++;
+  }
+  if (*line++ != letter || !NUMERIC(*line)) return nullptr;
+  uint32_t n = 0;
+  while (NUMERIC(*line) && n <= 0xFFFF) n = n * 10 + (*line++ - '0');
+  return (n == code && !NUMERIC(*line) && *line != '.') ? line : nullptr;
+}
+
 bool Commands::enqueue_one(const char * cmd) {
 
   if (*cmd == 0 || *cmd == '\n' || *cmd == '\r')
@@ -570,18 +863,58 @@ bool Commands::enqueue_one(const char * cmd) {
 }
 
 bool Commands::enqueue(const char * cmd, bool say_ok/*=false*/, int8_t port/*=-2*/) {
-  if (*cmd == ';' || buffer_ring.isFull()) return false;
-  gcode_t temp_cmd;
-  strcpy(temp_cmd.gcode, cmd);
-  temp_cmd.s_port = port;
-  temp_cmd.send_ok = say_ok;
+  if (*cmd == ';') return false;
+  gcode_t * const slot = buffer_ring.reserve();
+  if (!slot) return false;
+  strcpy(slot->gcode, cmd);
+  slot->s_port = port;
+  slot->send_ok = say_ok;
+  #if ENABLED(GCODE_PREPARSE)
+    // Parse the line now, out of the way of the moves that run before it
+    if (preparse_hold) {
+      slot->record.parsed = false;
+      if (is_M29(slot->gcode)) preparse_hold = false;
+    }
+    else {
+      #if ENABLED(STEPPER_ISR_PROFILER)
+        const isr_free_t start = isrprofiler.start_free();
+      #endif
+      parser.preparse(slot->gcode, slot->record);
+      #if ENABLED(STEPPER_ISR_PROFILER)
+        isrprofiler.stop_free(ISR_PHASE_PREPARSE, start);
+      #endif
+      preparse_hold = slot->record.command_letter == 'M' && slot->record.codenum == 28
+        #if ENABLED(SD_UPLOAD_RAW)
+          && upload_port < 0
+        #endif
+      ;
+    }
+  #endif
   #if HAS_SD_RESTART
     restart.set_sdpos();
   #endif
-  buffer_ring.enqueue(temp_cmd);
+  buffer_ring.commit();
   return true;
 }
 
+#if ENABLED(SD_BINARY_JOB)
+
+  bool Commands::enqueue_parsed(const char * cmd, const gcode_record_t &rec) {
+    gcode_t * const slot = buffer_ring.reserve();
+    if (!slot) return false;
+    strcpy(slot->gcode, cmd);
+    slot->s_port = -2;
+    slot->send_ok = false;
+    slot->record = rec;
+    #if HAS_SD_RESTART
+      restart.set_sdpos();
+    #endif
+    buffer_ring.commit();
+    return true;
+  }
+
+#endif
+
 /**
  * Process the next "immediate" command from PROGMEM.
  * Return 'true' if any commands were processed.
@@ -4028,6 +4361,24 @@ void Commands::process_parsed(const bool say_ok/*=true*/) {
         #if ENABLED(CODE_M1001)
           case 1001: gcode_M1001(); break;
         #endif
+        #if ENABLED(CODE_M1002)
+          case 1002: gcode_M1002(); break;
+        #endif
+        #if ENABLED(CODE_M1003)
+          case 1003: gcode_M1003(); break;
+        #endif
+        #if ENABLED(CODE_M1004)
+          case 1004: gcode_M1004(); break;
+        #endif
+        #if ENABLED(CODE_M1005)
+          case 1005: gcode_M1005(); break;
+        #endif
+        #if ENABLED(CODE_M1006)
+          case 1006: gcode_M1006(); break;
+        #endif
+        #if ENABLED(CODE_M1007)
+          case 1007: gcode_M1007(); break;
+        #endif
         #if ENABLED(CODE_M9999)
           case 9999: gcode_M9999(); break;
         #endif
@@ -41,6 +41,9 @@ struct gcode_t {
   int8_t  s_port  = -1;         // Serial port for print information:
                                 //    -1 for all port
                                 //    -2 for SD or null port
+  #if ENABLED(GCODE_PREPARSE)
+    gcode_record_t record;        // The line parsed at enqueue time
+  #endif
 };
 
 class Commands {
@@ -80,12 +83,50 @@ class Commands {
      */
     static long gcode_last_N;
 
+    #if ENABLED(LASER_RASTER_STREAM)
+      /**
+       * Serial port holding the binary pixels of a M652 raster line.
+       * No more lines are read until the command has taken them. (-1 == none)
+       */
+      static int8_t raster_stream_port;
+    #endif
+
+    #if ENABLED(SD_UPLOAD_RAW)
+      /**
+       * Serial port holding the bytes of a M28 B<bytes> upload.
+       * No more lines are read until the command has taken them. (-1 == none)
+       */
+      static int8_t upload_port;
+    #endif
+
+    #if ENABLED(CREDIT_FLOW_CONTROL)
+      /**
+       * Serial port with credit flow control (M1005), its lines get
+       * credits in place of an "ok" for each one. (-1 == none)
+       */
+      static int8_t credit_port;
+    #endif
+
   private: /** Private Parameters */
 
     static long gcode_N;
 
+    #if ENABLED(CREDIT_FLOW_CONTROL)
+      static long credit_edge;    // Last line the host may send with the credits granted
+      static bool credit_resend;  // Lines out of order are dropped until the resend line
+    #endif
+
     static int serial_count[NUM_SERIAL];
 
+    #if HAS_SD_SUPPORT
+      static int      sd_count;       // A line may end in the next read
+      static uint8_t  sd_input_state;
+    #endif
+
+    #if ENABLED(GCODE_PREPARSE)
+      static bool preparse_hold;  // Lines from M28 to M29 go to SD as they came
+    #endif
+
   public: /** Public Function */
 
     /**
@@ -112,6 +153,16 @@ class Commands {
      */
     static void clear_queue();
 
+    #if HAS_SD_SUPPORT
+      /**
+       * Drop the part of a line read from SD, when a file is opened or closed
+       */
+      static inline void reset_sd_line() {
+        sd_count = 0;
+        sd_input_state = PS_NORMAL;
+      }
+    #endif
+
     /**
      * Enqueue one or many commands to run from program memory.
      * Aborts the current queue, if any.
@@ -180,6 +231,31 @@ class Commands {
      */
     static Heater* get_target_heater();
 
+    /**
+     * The parameters of a line if its command is letter and code, as the
+     * parser reads it (a line number first is skipped), else nullptr.
+     * M652 matches "N5 M652 S1", not "M6520" nor "M117 M652".
+     */
+    static const char* match_command(const char * line, const char letter, const uint16_t code);
+
+    #if ENABLED(CREDIT_FLOW_CONTROL)
+
+      /**
+       * Switch a port to credit flow control, -1 for none.
+       * The port gets its first credits at once.
+       */
+      static void set_credit_port(const int8_t port);
+
+      /**
+       * Send "ok N<last line> C<free buffer_ring slots> P<planner space remaining>"
+       * when the host may send more lines than last granted. The credits are
+       * held back to grant more at once while the host still has lines to
+       * send and the planner is at least half full.
+       */
+      static void report_credit(const bool force=false);
+
+    #endif
+
   private: /** Private Function */
 
     /**
@@ -209,6 +285,14 @@ class Commands {
       static void get_sdcard();
     #endif
 
+    /**
+     * Get the records of a compiled job (SD_BINARY_JOB) from the SD Card
+     * until the command buffer is full or the end of the file is reached.
+     */
+    #if ENABLED(SD_BINARY_JOB)
+      static void get_sdcard_job();
+    #endif
+
     /**
      * Process a single command and dispatch it to its handler
      * This is called from the main loop()
@@ -232,6 +316,14 @@ class Commands {
      */
     static bool enqueue(const char * cmd, bool say_ok=false, int8_t port=-2);
 
+    #if ENABLED(SD_BINARY_JOB)
+      /**
+       * Copy a command already parsed, with its record, into the main
+       * command buffer. Return false for a full buffer.
+       */
+      static bool enqueue_parsed(const char * cmd, const gcode_record_t &rec);
+    #endif
+
     /**
      * Process the next "immediate" command (PROGMEM)
      */
@@ -254,6 +346,16 @@ class Commands {
       return strstr_P(cmd, PSTR("M29"));
     }
 
+    #if ENABLED(SD_UPLOAD_RAW)
+      /**
+       * Search M28 B<bytes>, the bytes of the file follow the line
+       */
+      FORCE_INLINE static bool is_M28_raw(const char * const cmd) {
+        const char * const m = strstr_P(cmd, PSTR("M28 B"));
+        return m && NUMERIC(m[5]);
+      }
+    #endif
+
     FORCE_INLINE static void process_stream_char(const char c, uint8_t &sis, char (&buff)[MAX_CMD_SIZE], int &ind) {
 
       if (ind >= MAX_CMD_SIZE - 1)
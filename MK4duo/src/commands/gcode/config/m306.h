@@ -50,6 +50,7 @@
  *    R[bool]   Thermal Protection
  *    P[int]    Heater Pin
  *    Q[bool]   PWM Hardware
+ *    W[int]    Watts at full duty, for the power budget
  *
  */
 inline void gcode_M306() {
@@ -60,7 +61,7 @@ inline void gcode_M306() {
 
   #if DISABLED(DISABLE_M503)
     // No arguments? Show M306 report.
-    if (!parser.seen("ABCFLO") && !parser.seen("UIRPQ")) {
+    if (!parser.seen("ABCFLO") && !parser.seen("UIRPQW")) {
       act->print_M306();
       return;
     }
@@ -75,6 +76,10 @@ inline void gcode_M306() {
 
   NOMORE(act->data.pid.drive.max, act->data.pid.Max);
 
+  #if ENABLED(POWER_BUDGET)
+    act->data.watts       = parser.ushortval('W', act->data.watts);
+  #endif
+
   if (parser.seen('U'))
     act->setUsePid(parser.value_bool());
   if (parser.seen('I'))
@@ -88,6 +93,7 @@ inline void gcode_M306() {
     // Put off the heaters
     act->set_target_temp(0);
     act->data.pin = HAL::digital_value_pin();
+    act->update_output_pin();
   }
 
 }
@@ -0,0 +1,48 @@
+/**
+ * MK4duo Firmware for 3D Printer, Laser and CNC
+ *
+ * Based on Marlin, Sprinter and grbl
+ * Copyright (c) 2011 Camiel Gubbels / Erik van der Zalm
+ * Copyright (c) 2020 Alberto Cotronei @MagoKimbra
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+/**
+ * mcode
+ *
+ * Copyright (c) 2020 Alberto Cotronei @MagoKimbra
+ */
+
+#if ENABLED(STEPPER_ISR_PROFILER)
+
+#define CODE_M1002
+
+/**
+ * M1002: Stepper ISR profiler
+ *
+ *  Report cycles spent in each stepper ISR phase, in the Tick ISR and its
+ *  deferred half, in the planner recalculate and in the command parse
+ *  (min/avg/max and log2 histogram), how many times the ISR ran out of
+ *  loops and how many times the deferred half of the Tick ran late.
+ *
+ *  R - Reset the collected data after reporting
+ */
+inline void gcode_M1002() {
+  isrprofiler.print();
+  if (parser.seen('R')) isrprofiler.reset();
+}
+
+#endif // STEPPER_ISR_PROFILER
@@ -0,0 +1,50 @@
+/**
+ * MK4duo Firmware for 3D Printer, Laser and CNC
+ *
+ * Based on Marlin, Sprinter and grbl
+ * Copyright (c) 2011 Camiel Gubbels / Erik van der Zalm
+ * Copyright (c) 2020 Alberto Cotronei @MagoKimbra
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+/**
+ * mcode
+ *
+ * Copyright (c) 2020 Alberto Cotronei @MagoKimbra
+ */
+
+#if ENABLED(PLANNER_SEGMENT_MERGE)
+
+#define CODE_M1003
+
+/**
+ * M1003: Planner segment merge statistics
+ *
+ *  Report the segments queued, how many of them were joined
+ *  to the previous block and the most joined in one block.
+ *
+ *  R - Reset the statistics after reporting
+ */
+inline void gcode_M1003() {
+  const merge_stats_t &stats = planner.merge_stats;
+  SERIAL_MV("Segments:", stats.segments);
+  SERIAL_MV(" joined:", stats.merged);
+  SERIAL_MV(" blocks:", stats.segments - stats.merged);
+  SERIAL_EMV(" max joined:", int(stats.max_count));
+  if (parser.seen('R')) memset(&planner.merge_stats, 0, sizeof(merge_stats_t));
+}
+
+#endif // PLANNER_SEGMENT_MERGE
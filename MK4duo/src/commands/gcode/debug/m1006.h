@@ -0,0 +1,88 @@
+/**
+ * MK4duo Firmware for 3D Printer, Laser and CNC
+ *
+ * Based on Marlin, Sprinter and grbl
+ * Copyright (c) 2011 Camiel Gubbels / Erik van der Zalm
+ * Copyright (c) 2020 Alberto Cotronei @MagoKimbra
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+/**
+ * mcode
+ *
+ * Copyright (c) 2020 Alberto Cotronei @MagoKimbra
+ */
+
+#if ENABLED(ADC_DMA)
+
+#define CODE_M1006
+
+/**
+ * M1006: ADC DMA sampling statistics
+ *
+ *  Report the samples a second taken by the DMA scan, the buffers lost,
+ *  and for each sensor its ADC channel, last reading, readings a second
+ *  and the noise of the samples of its last reading (standard deviation
+ *  and highest less lowest, in LSB of the ADC).
+ *
+ *  R - Reset the collected data after reporting
+ */
+inline void gcode_M1006() {
+
+  static millis_l stats_ms = 0;
+
+  const float seconds = (millis() - stats_ms) * 0.001f,
+              per_second = seconds > 0.0f ? 1.0f / seconds : 0.0f;
+
+  SERIAL_MV("ADC samples/s:", HAL::adc_decimator.samples * per_second, 0);
+  SERIAL_MV(" overruns:", HAL::adc_decimator.overruns);
+  SERIAL_MV(" bits:", ANALOG_INPUT_BITS + ADC_OVERSAMPLE_BITS);
+  SERIAL_EMV(" samples/reading:", ADC_DMA_SAMPLES);
+
+  auto report = [&](PGM_P const name, const uint8_t h, const pin_t pin) {
+    const uint8_t ch = HAL::adc_dma_channel(pin);
+    uint16_t value = 0;
+    if (!HAL::adc_decimator.read(ch, value)) return;
+    SERIAL_STR(name);
+    SERIAL_VAL(int(h));
+    SERIAL_MV(" ch:", int(ch));
+    SERIAL_MV(" raw:", value);
+    SERIAL_MV(" readings/s:", HAL::adc_decimator.readings(ch) * per_second, 1);
+    SERIAL_MV(" sigma:", HAL::adc_decimator.sigma(ch), 2);
+    SERIAL_EMV(" pp:", HAL::adc_decimator.peak(ch));
+  };
+
+  #if HAS_HOTENDS
+    LOOP_HOTEND() report(PSTR("Hotend"), h, hotends[h]->data.sensor.pin);
+  #endif
+  #if HAS_BEDS
+    LOOP_BED() report(PSTR("Bed"), h, beds[h]->data.sensor.pin);
+  #endif
+  #if HAS_CHAMBERS
+    LOOP_CHAMBER() report(PSTR("Chamber"), h, chambers[h]->data.sensor.pin);
+  #endif
+  #if HAS_COOLERS
+    LOOP_COOLER() report(PSTR("Cooler"), h, coolers[h]->data.sensor.pin);
+  #endif
+
+  if (parser.seen('R')) {
+    HAL::adc_decimator.clear_stats();
+    stats_ms = millis();
+  }
+
+}
+
+#endif // ADC_DMA
@@ -120,7 +120,7 @@ inline int32_t count_test_bytes(const char * const start_free_memory) {
    */
   inline void dump_free_memory(char *start_free_memory, char *end_free_memory) {
 
-    gcode_t tmp = commands.buffer_ring.peek();
+    const gcode_t &tmp = commands.buffer_ring.peek_ref();
 
     //
     // Start and end the dump on a nice 16 byte boundary
@@ -0,0 +1,65 @@
+/**
+ * MK4duo Firmware for 3D Printer, Laser and CNC
+ *
+ * Based on Marlin, Sprinter and grbl
+ * Copyright (c) 2011 Camiel Gubbels / Erik van der Zalm
+ * Copyright (c) 2020 Alberto Cotronei @MagoKimbra
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+/**
+ * mcode
+ *
+ * Copyright (c) 2020 Alberto Cotronei @MagoKimbra
+ */
+
+#if ENABLED(INPUT_SHAPING)
+
+#define CODE_M593
+
+/**
+ * M593: Set Input Shaping
+ *  X           Set the X axis (A on CORE machines)
+ *  Y           Set the Y axis (B on CORE machines)
+ *              Without X and Y both axes are set
+ *  T[int]      Shaper: 0 None, 1 ZV, 2 ZVD, 3 MZV, 4 EI
+ *  F[float]    Ringing frequency in Hz (0 to disable)
+ *  D[float]    Damping ratio (0.0 to 0.99)
+ *
+ *  Without T, F and D print the current settings.
+ */
+inline void gcode_M593() {
+
+  if (!parser.seen("TFD")) {
+    inputshaper.print_M593();
+    SERIAL_EMV("  Early echoes (buffer full):", inputshaper.overflows);
+    return;
+  }
+
+  const bool seen_x = parser.seen('X'), seen_y = parser.seen('Y');
+
+  LOOP_L_N(a, INPUT_SHAPING_AXES) {
+    if ((seen_x || seen_y) && !(a == X_AXIS ? seen_x : seen_y)) continue;
+    if (parser.seenval('T')) inputshaper.data.type[a] = MIN(parser.value_byte(), SHAPER_COUNT - 1);
+    if (parser.seenval('F')) inputshaper.data.frequency[a] = MAX(0.0f, parser.value_float());
+    if (parser.seenval('D')) inputshaper.data.damping[a] = constrain(parser.value_float(), 0.0f, 0.99f);
+  }
+
+  inputshaper.refresh();
+
+}
+
+#endif // ENABLED(INPUT_SHAPING)
@@ -101,6 +101,9 @@
 #include "debug/m43.h"
 #include "debug/m44_pre_table.h"          // Debug Code Info
 #include "debug/m1000.h"                  // Debug GCODE Parser
+#include "debug/m1002.h"                  // Stepper ISR profiler
+#include "debug/m1003.h"                  // Planner segment merge statistics
+#include "debug/m1006.h"                  // ADC DMA sampling statistics
 
 // Delta Commands
 #include "delta/g33_type1.h"              // Autocalibration 7 point
@@ -117,6 +120,7 @@
 #include "feature/g60.h"
 #include "feature/g61.h"
 #include "feature/m99.h"                  // Hysteresis feature
+#include "feature/m593.h"                 // Input shaping
 #include "feature/m100.h"                 // Free Memory Watcher
 #include "feature/m125.h"
 #include "feature/m126_m129.h"            // Solenoid feature
@@ -153,6 +157,8 @@
 #include "host/m532_m73.h"                // Update current print state progress
 #include "host/m876.h"                    // Host Prompt Response
 #include "host/m890.h"                    // Run User Gcode
+#include "host/m1004.h"                   // Binary command frames
+#include "host/m1005.h"                   // Credit flow control
 
 // LCD Commands
 #include "lcd/m0_m1.h"
@@ -184,6 +190,7 @@
 #include "multimode/m6.h"
 #include "multimode/m450_m453.h"
 #include "multimode/m649.h"               // Set laser options
+#include "multimode/m652.h"               // Binary raster line
 
 // Muve3D Commands
 #include "muve3d/m650_m655.h"             // Muve3D control
@@ -257,6 +264,7 @@
 #include "temperature/m191.h"
 #include "temperature/m192.h"
 #include "temperature/m303.h"             // PID autotune
+#include "temperature/m1007.h"            // Power budget of the heaters
 
 // Tools Commands
 #include "tools/tcode.h"
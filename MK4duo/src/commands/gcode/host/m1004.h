@@ -0,0 +1,49 @@
+/**
+ * MK4duo Firmware for 3D Printer, Laser and CNC
+ *
+ * Based on Marlin, Sprinter and grbl
+ * Copyright (c) 2011 Camiel Gubbels / Erik van der Zalm
+ * Copyright (c) 2020 Alberto Cotronei @MagoKimbra
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+/**
+ * mcode
+ *
+ * Copyright (c) 2020 Alberto Cotronei @MagoKimbra
+ */
+
+#if ENABLED(BINARY_PROTOCOL)
+
+#define CODE_M1004
+
+/**
+ * M1004: Binary command frames
+ *
+ *  S1 - The port takes binary frames from the next byte, see binary_protocol.h
+ *  S0 - The port is back to text lines
+ *
+ *  The port is switched as soon as the line is read, here the host
+ *  only gets the size of the window it may send.
+ */
+inline void gcode_M1004() {
+  if (binary_protocol.port >= 0)
+    SERIAL_EMV("binary:ready window:", int(BINARY_PROTOCOL_WINDOW));
+  else
+    SERIAL_EM("binary:off");
+}
+
+#endif // BINARY_PROTOCOL
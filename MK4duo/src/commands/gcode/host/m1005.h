@@ -0,0 +1,47 @@
+/**
+ * MK4duo Firmware for 3D Printer, Laser and CNC
+ *
+ * Based on Marlin, Sprinter and grbl
+ * Copyright (c) 2011 Camiel Gubbels / Erik van der Zalm
+ * Copyright (c) 2020 Alberto Cotronei @MagoKimbra
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+/**
+ * mcode
+ *
+ * Copyright (c) 2020 Alberto Cotronei @MagoKimbra
+ */
+
+#if ENABLED(CREDIT_FLOW_CONTROL)
+
+#define CODE_M1005
+
+/**
+ * M1005: Credit flow control
+ *
+ *  S1 - The port gets credits in place of an "ok" for each line
+ *  S0 - Back to an "ok" for each line
+ *
+ *  The answer to M1005 S1 is the first grant, "ok N<last line> C<credits> P<planner free>".
+ *  Set the line number with M110 before, the lines after it are read ahead.
+ */
+inline void gcode_M1005() {
+  if (parser.seenval('S'))
+    commands.set_credit_port(parser.value_bool() ? commands.buffer_ring.peek_ref().s_port : -1);
+}
+
+#endif // CREDIT_FLOW_CONTROL
@@ -32,5 +32,10 @@
  * M110: Set Current Line Number
  */
 inline void gcode_M110() {
+  #if ENABLED(CREDIT_FLOW_CONTROL)
+    // A numbered line set it when read, the lines after it are already in
+    const gcode_t &cmd = commands.buffer_ring.peek_ref();
+    if (commands.credit_port >= 0 && cmd.s_port == commands.credit_port && cmd.gcode[0] == 'N') return;
+  #endif
   if (parser.seenval('N')) commands.gcode_last_N = parser.value_long();
 }
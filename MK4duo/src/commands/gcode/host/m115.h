@@ -98,9 +98,18 @@ inline void gcode_M115() {
   // EMERGENCY_PARSER (M108, M112, M410, M876)
   SERIAL_CAP("EMERGENCY_PARSER", HAS_EMERGENCY_PARSER);
 
+  // BINARY_PROTOCOL (M1004)
+  SERIAL_CAP("BINARY_PROTOCOL", HAS_BINARY_PROTOCOL);
+
+  // CREDIT_FLOW_CONTROL (M1005)
+  SERIAL_CAP("CREDIT_FLOW_CONTROL", HAS_CREDIT_FLOW_CONTROL);
+
   // SDCARD (M20, M23, M24, etc.)
   SERIAL_CAP("SDCARD", HAS_SD_SUPPORT);
 
+  // SD_UPLOAD_RAW (M28 B<bytes>)
+  SERIAL_CAP("SD_UPLOAD_RAW", HAS_SD_UPLOAD_RAW);
+
   // AUTOREPORT_SD_STATUS (M27 extension)
   SERIAL_CAP("AUTOREPORT_SD_STATUS", HAS_SD_SUPPORT);
 
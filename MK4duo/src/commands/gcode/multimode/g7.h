@@ -30,9 +30,11 @@
 
   #define CODE_G7
 
-  inline void gcode_G7() {
-
-    if (parser.seenval('L')) laser.raster_raw_length = parser.value_int();
+  /**
+   * Raster direction from '$' (next row along Y) or '@' (next row by direction).
+   * Shared with the binary raster line M652.
+   */
+  inline void raster_set_direction() {
 
     if (parser.seenval('$')) {
       laser.raster_direction = parser.value_int();
@@ -60,7 +62,12 @@
       #endif
     }
 
-    if (parser.seen('D')) laser.raster_num_pixels = base64_decode(laser.raster_data, parser.string_arg + 1, laser.raster_raw_length);
+  }
+
+  /**
+   * Queue the raster move for the laser.raster_num_pixels pixels in laser.raster_data
+   */
+  inline void raster_move() {
 
     switch (laser.raster_direction) {
       case 0: // Negative X
@@ -102,4 +109,15 @@
     mechanics.prepare_move_to_destination();
   }
 
+  inline void gcode_G7() {
+
+    if (parser.seenval('L')) laser.raster_raw_length = parser.value_int();
+
+    raster_set_direction();
+
+    if (parser.seen('D')) laser.raster_num_pixels = base64_decode(laser.raster_data, parser.string_arg + 1, laser.raster_raw_length);
+
+    raster_move();
+  }
+
 #endif
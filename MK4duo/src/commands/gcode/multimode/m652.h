@@ -0,0 +1,98 @@
+/**
+ * MK4duo Firmware for 3D Printer, Laser and CNC
+ *
+ * Based on Marlin, Sprinter and grbl
+ * Copyright (c) 2011 Camiel Gubbels / Erik van der Zalm
+ * Copyright (c) 2020 Alberto Cotronei @MagoKimbra
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+/**
+ * mcode
+ *
+ * Copyright (c) 2020 Alberto Cotronei @MagoKimbra
+ */
+
+#if ENABLED(LASER) && ENABLED(LASER_RASTER) && ENABLED(LASER_RASTER_STREAM)
+
+#define CODE_M652
+
+/**
+ * M652: Binary raster line
+ *
+ *  P<pixels>         Number of raw pixel bytes following the command
+ *  C<crc>            CRC16 (CCITT, 0x1021, start 0) of the pixel bytes
+ *  $<dir> / @<dir>   Raster direction, as for G7
+ *
+ * The serial port stops reading lines after M652, so the host may append the
+ * pixels straight away, or wait for "raster:ready" (no data in the RX buffer
+ * is lost while the command waits in the queue). The pixels are read into the
+ * raster buffer without any base64 step; a timeout or a wrong CRC is answered
+ * with an error and the line is not engraved.
+ */
+inline void gcode_M652() {
+
+  const int8_t port = commands.buffer_ring.peek_ref().s_port;
+
+  if (port < 0) {
+    SERIAL_LM(ER, "M652 needs a serial port");
+    return;
+  }
+
+  const uint16_t pixels = parser.ushortval('P');
+
+  SERIAL_PORT(port);
+  SERIAL_EMV("raster:ready ", pixels);
+
+  uint16_t  count = 0,
+            crc   = 0;
+  short_timer_t stream_timer(millis());
+
+  while (count < pixels) {
+    const int c = Com::serialRead(port);
+    if (c < 0) {
+      if (stream_timer.expired(LASER_RASTER_STREAM_TIMEOUT)) break;
+      printer.idle();
+      continue;
+    }
+    const uint8_t pixel = c;
+    crc16(&crc, &pixel, 1);
+    if (count < LASER_MAX_RASTER_LINE) laser.raster_data[count] = pixel;
+    count++;
+    stream_timer.start();
+  }
+
+  // Resume reading the G-code lines
+  commands.raster_stream_port = -1;
+
+  if (count < pixels) {
+    while (Com::serialRead(port) != -1);
+    SERIAL_LMV(ER, "Raster stream timeout, pixels:", count);
+  }
+  else if (pixels > LASER_MAX_RASTER_LINE)
+    SERIAL_LMV(ER, "Raster line too long, max:", LASER_MAX_RASTER_LINE);
+  else if (parser.seenval('C') && parser.value_ushort() != crc)
+    SERIAL_LMV(ER, "Raster CRC mismatch:", crc);
+  else {
+    laser.raster_num_pixels = pixels;
+    raster_set_direction();
+    raster_move();
+  }
+
+  SERIAL_PORT(-1);
+}
+
+#endif // ENABLED(LASER) && ENABLED(LASER_RASTER) && ENABLED(LASER_RASTER_STREAM)
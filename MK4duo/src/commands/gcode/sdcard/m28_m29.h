@@ -31,10 +31,92 @@
 #define CODE_M28
 #define CODE_M29
 
+#if ENABLED(SD_UPLOAD_RAW)
+
+  /**
+   * M28 B<bytes> <file>: Raw upload
+   *
+   * The serial port stops reading lines after the command, the host sends
+   * the bytes of the file after "upload:ready", when the emergency parser no
+   * longer reads them. They go to the file as they come, with no line parsing.
+   * At the end the saved message, the upload rate and "upload:crc <crc>", the
+   * CRC16 (CCITT, 0x1021, start 0) of the bytes, for the host to check.
+   * No M29 is needed. If the file can't be opened there is no "upload:ready",
+   * the port reads lines again.
+   */
+  inline void gcode_M28_raw() {
+
+    const int8_t port = commands.buffer_ring.peek_ref().s_port;
+
+    char *name;
+    const uint32_t bytes = strtoul(parser.string_arg + 1, &name, 10);
+    while (*name == ' ') name++;
+
+    if (port < 0) {
+      SERIAL_LM(ER, "M28 B needs a serial port");
+      commands.upload_port = -1;
+      return;
+    }
+
+    // Also stops the emergency parser until the file is closed
+    card.startWrite(name, false);
+    if (!card.isSaving()) {
+      commands.upload_port = -1;
+      return;
+    }
+
+    SERIAL_PORT(port);
+    SERIAL_EMV("upload:ready ", bytes);
+
+    uint8_t   chunk[64];
+    uint32_t  count = 0;
+    uint16_t  crc   = 0;
+    short_timer_t upload_timer(millis());
+
+    while (count < bytes) {
+      uint8_t n = 0;
+      int c;
+      while (n < sizeof(chunk) && count + n < bytes && (c = Com::serialRead(port)) >= 0) chunk[n++] = c;
+      if (!n) {
+        if (upload_timer.expired(SD_UPLOAD_RAW_TIMEOUT)) break;
+        printer.idle();
+        continue;
+      }
+      crc16(&crc, chunk, n);
+      card.write_behind.write(card.gcode_file, chunk, n);
+      count += n;
+      upload_timer.start();
+    }
+
+    // Resume reading the G-code lines
+    commands.upload_port = -1;
+
+    if (count < bytes) {
+      while (Com::serialRead(port) != -1);
+      SERIAL_LMV(ER, "Upload timeout, bytes:", count);
+    }
+
+    card.finishWrite();
+    SERIAL_EMV("upload:crc ", crc);
+    SERIAL_PORT(-1);
+  }
+
+#endif
+
 /**
  * M28: Start SD Write
+ *
+ *  B<bytes>  Raw upload of the bytes after the line (Requires SD_UPLOAD_RAW)
  */
-inline void gcode_M28() { card.startWrite(parser.string_arg, false); }
+inline void gcode_M28() {
+  #if ENABLED(SD_UPLOAD_RAW)
+    if (parser.string_arg && parser.string_arg[0] == 'B' && NUMERIC(parser.string_arg[1])) {
+      gcode_M28_raw();
+      return;
+    }
+  #endif
+  card.startWrite(parser.string_arg, false);
+}
 
 /**
  * M29: Stop SD Write
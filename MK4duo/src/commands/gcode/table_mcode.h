@@ -3043,6 +3043,24 @@ constexpr MCode_command_t MCode_Table [] = {
   #if ENABLED(CODE_M1000)
 		{ 1001, gcode_M1001 },
 	#endif
+	#if ENABLED(CODE_M1002)
+		{ 1002, gcode_M1002 },
+	#endif
+	#if ENABLED(CODE_M1003)
+		{ 1003, gcode_M1003 },
+	#endif
+	#if ENABLED(CODE_M1004)
+		{ 1004, gcode_M1004 },
+	#endif
+	#if ENABLED(CODE_M1005)
+		{ 1005, gcode_M1005 },
+	#endif
+	#if ENABLED(CODE_M1006)
+		{ 1006, gcode_M1006 },
+	#endif
+	#if ENABLED(CODE_M1007)
+		{ 1007, gcode_M1007 },
+	#endif
   #if ENABLED(CODE_M9999)
 		{ 9999, gcode_M9999 }
 	#endif
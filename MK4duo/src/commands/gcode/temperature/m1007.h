@@ -0,0 +1,54 @@
+/**
+ * MK4duo Firmware for 3D Printer, Laser and CNC
+ *
+ * Based on Marlin, Sprinter and grbl
+ * Copyright (c) 2011 Camiel Gubbels / Erik van der Zalm
+ * Copyright (c) 2020 Alberto Cotronei @MagoKimbra
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+/**
+ * mcode
+ *
+ * Copyright (c) 2020 Alberto Cotronei @MagoKimbra
+ */
+
+#if ENABLED(POWER_BUDGET)
+
+#define CODE_M1007
+
+/**
+ * M1007: Power budget of the heaters
+ *
+ *  S<watts> - Set the watts all the heaters may draw together, 0 for no budget
+ *  R        - Reset the count of the spins a heater got less than it asked
+ *
+ *  Report the budget, the watts asked and given in the last 100ms and,
+ *  for each heater, its watts, the duty asked and given, the degC a
+ *  second it heats at full duty, the seconds to its target at full duty
+ *  and its time to temperature in the last M109, M190 or M191.
+ */
+inline void gcode_M1007() {
+
+  if (parser.seenval('S')) powerbudget.data.limit = parser.value_ushort();
+
+  powerbudget.report();
+
+  if (parser.seen('R')) powerbudget.limited = 0;
+
+}
+
+#endif // POWER_BUDGET
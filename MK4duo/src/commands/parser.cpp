@@ -58,6 +58,11 @@ uint16_t GCodeParser::codenum;
   char *GCodeParser::command_args; // start of parameters
 #endif
 
+#if ENABLED(GCODE_PREPARSE)
+  const gcode_record_t *GCodeParser::record;    // record of the loaded command
+  const float *GCodeParser::value_pre;          // converted value, set by seen
+#endif
+
 // Create a global instance of the GCodeParser singleton
 GCodeParser parser;
 
@@ -78,6 +83,10 @@ void GCodeParser::reset() {
     codebits = 0;                     // No codes yet
     //ZERO(param);                    // No parameters (should be safe to comment out this line)
   #endif
+  #if ENABLED(GCODE_PREPARSE)
+    record = nullptr;                 // No record, values from the line
+    value_pre = nullptr;
+  #endif
 }
 
 // Pass the address after the first quote (if any)
@@ -278,6 +287,84 @@ void GCodeParser::parse(char *p) {
   }
 }
 
+#if ENABLED(GCODE_PREPARSE)
+
+  /**
+   * Parse a line when it is added to the command buffer_ring.
+   * It may come in from idle() while a command runs, so the state of
+   * the loaded command is kept aside and put back at the end.
+   */
+  void GCodeParser::preparse(char * const line, gcode_record_t &rec) {
+
+    char * const  old_command_ptr = command_ptr,
+         * const  old_string_arg  = string_arg,
+         * const  old_value_ptr   = value_ptr;
+    const char    old_letter      = command_letter;
+    const uint16_t old_codenum    = codenum;
+    #if USE_GCODE_SUBCODES
+      const uint8_t old_subcode   = subcode;
+    #endif
+    const uint32_t old_codebits   = codebits;
+    uint8_t old_param[COUNT(param)];
+    memcpy(old_param, param, sizeof(param));
+    const gcode_record_t * const old_record = record;
+    const float * const old_value_pre = value_pre;
+
+    parse(line);
+
+    rec.parsed          = true;
+    rec.command_letter  = command_letter;
+    rec.codenum         = codenum;
+    #if USE_GCODE_SUBCODES
+      rec.subcode       = subcode;
+    #endif
+    rec.command_offset  = command_ptr - line;
+    rec.string_offset   = string_arg ? string_arg - line : 0xFF;
+    rec.codebits        = codebits;
+    memcpy(rec.param, param, sizeof(param));
+
+    // Convert the values of the move letters, value_float() gives them back
+    static const char value_letters[PREPARSE_VALUES] = { 'X', 'Y', 'Z', 'E', 'F' };
+    rec.valuebits = 0;
+    LOOP_L_N(v, PREPARSE_VALUES) {
+      if (seenval(value_letters[v])) {
+        rec.value[v] = value_float();
+        SBI(rec.valuebits, v);
+      }
+    }
+
+    command_ptr     = old_command_ptr;
+    string_arg      = old_string_arg;
+    value_ptr       = old_value_ptr;
+    command_letter  = old_letter;
+    codenum         = old_codenum;
+    #if USE_GCODE_SUBCODES
+      subcode       = old_subcode;
+    #endif
+    codebits        = old_codebits;
+    memcpy(param, old_param, sizeof(param));
+    record          = old_record;
+    value_pre       = old_value_pre;
+  }
+
+  void GCodeParser::load(char * const line, const gcode_record_t &rec) {
+    if (!rec.parsed) return parse(line);
+
+    command_ptr     = line + rec.command_offset;
+    string_arg      = rec.string_offset == 0xFF ? nullptr : line + rec.string_offset;
+    command_letter  = rec.command_letter;
+    codenum         = rec.codenum;
+    #if USE_GCODE_SUBCODES
+      subcode       = rec.subcode;
+    #endif
+    codebits        = rec.codebits;
+    memcpy(param, rec.param, sizeof(param));
+    record          = &rec;
+    value_pre       = nullptr;
+  }
+
+#endif // GCODE_PREPARSE
+
 #if ENABLED(INCH_MODE_SUPPORT)
 
   float GCodeParser::axis_unit_factor(const AxisEnum axis) {
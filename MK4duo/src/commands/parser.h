@@ -29,6 +29,35 @@
 
 //#define DEBUG_GCODE_PARSER
 
+#if ENABLED(GCODE_PREPARSE)
+
+  // Letters with the value converted to float at enqueue time
+  #define PREPARSE_VALUES 5   // X Y Z E F
+
+  /**
+   * Command record
+   *  A line parsed once when it is added to the command buffer_ring:
+   *  the parser state, as offsets into the line, and the float values
+   *  of the move letters.
+   */
+  struct gcode_record_t {
+    bool      parsed;                   // False to parse the line when it runs
+    char      command_letter;           // G, M, or T
+    uint16_t  codenum;                  // 123
+    #if USE_GCODE_SUBCODES
+      uint8_t subcode;                  // .1
+    #endif
+    uint8_t   command_offset,           // Command start in the line
+              string_offset,            // string_arg in the line, 0xFF for none
+              valuebits;                // Values converted, 1 bit for each of X Y Z E F
+    uint32_t  codebits;                 // Parameters seen
+    uint8_t   param[26];                // For A-Z, offsets into the command
+    float     value[PREPARSE_VALUES];   // Converted values
+  };
+
+#endif
+
+
 /**
  * Parser Gcode
  *
@@ -77,6 +106,11 @@ class GCodeParser {
       static char *command_args;  // Args start here, for slow scan
     #endif
 
+    #if ENABLED(GCODE_PREPARSE)
+      static const gcode_record_t *record;  // Record of the loaded command, nullptr if parsed
+      static const float *value_pre;        // Set by seen, converted value or nullptr
+    #endif
+
   public: /** Public Function */
 
     #if ENABLED(DEBUG_GCODE_PARSER)
@@ -127,6 +161,14 @@ class GCodeParser {
         if (b) {
           char * const ptr = command_ptr + param[ind];
           value_ptr = param[ind] && valid_float(ptr) ? ptr : nullptr;
+          #if ENABLED(GCODE_PREPARSE)
+            if (record) {
+              const int8_t v = value_index(c);
+              value_pre = v >= 0 && TEST(record->valuebits, v) ? &record->value[v] : nullptr;
+              // A move of a compiled SD job has the value in the record alone
+              if (value_pre && !value_ptr) value_ptr = command_ptr;
+            }
+          #endif
         }
         return b;
       }
@@ -206,6 +248,28 @@ class GCodeParser {
     // This uses 54 bytes of SRAM to speed up seen/value
     static void parse(char * p);
 
+    #if ENABLED(GCODE_PREPARSE)
+
+      // Parse a line into its record, the loaded command is left as it is
+      static void preparse(char * const line, gcode_record_t &rec);
+
+      // Populate all fields from the record of a line, parse it if it has none
+      static void load(char * const line, const gcode_record_t &rec);
+
+      // Index of a letter in gcode_record_t::value, -1 if not converted
+      FORCE_INLINE static int8_t value_index(const char c) {
+        switch (c) {
+          case 'X': return 0;
+          case 'Y': return 1;
+          case 'Z': return 2;
+          case 'E': return 3;
+          case 'F': return 4;
+          default:  return -1;
+        }
+      }
+
+    #endif
+
     // Code value pointer was set
     FORCE_INLINE static bool has_value() { return value_ptr != nullptr; }
 
@@ -215,29 +279,20 @@ class GCodeParser {
     // The value as a string
     static inline char* value_string() { return value_ptr; }
 
-    // Float removes 'E' to prevent scientific notation interpretation
+    // Float, a following 'E' is a parameter and not an exponent
     static inline float value_float() {
-      if (value_ptr) {
-        char *e = value_ptr;
-        for (;;) {
-          const char c = *e;
-          if (c == '\0' || c == ' ') break;
-          if (c == 'E' || c == 'e') {
-            *e = '\0';
-            const float ret = strtof(value_ptr, nullptr);
-            *e = c;
-            return ret;
-          }
-          ++e;
-        }
-        return strtof(value_ptr, nullptr);
-      }
-      return 0;
+      #if ENABLED(GCODE_PREPARSE)
+        if (value_pre) return *value_pre;
+      #endif
+      return value_ptr ? Decimal::to_float(value_ptr) : 0;
     }
 
     // Code value as a long or ulong
-    static inline int32_t   value_long()  { return value_ptr ? strtol(value_ptr, nullptr, 10) : 0L; }
-    static inline uint32_t  value_ulong() { return value_ptr ? strtoul(value_ptr, nullptr, 10) : 0UL; }
+    static inline int32_t   value_long()  { return value_ptr ? Decimal::to_long(value_ptr) : 0L; }
+    static inline uint32_t  value_ulong() { return value_ptr ? Decimal::to_ulong(value_ptr) : 0UL; }
+
+    // Code value in fixed point, times 10^decimals
+    static inline int32_t   value_fixed(const uint8_t decimals) { return value_ptr ? Decimal::to_fixed(value_ptr, decimals) : 0L; }
 
     // Code value for use as time
     static inline millis_l  value_millis()              { return value_ulong(); }
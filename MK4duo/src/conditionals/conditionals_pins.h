@@ -23,6 +23,13 @@
 
 #define AS_QUOTED_STRING(S) #S
 #define INCLUDE_BY_MB(M)    AS_QUOTED_STRING(../boards/M.h)
+
+// The host native build always runs on the simulated board
+#if ENABLED(ARDUINO_ARCH_NATIVE)
+  #undef MOTHERBOARD
+  #define MOTHERBOARD BOARD_NATIVE_SIM
+#endif
+
 #include INCLUDE_BY_MB(MOTHERBOARD)
 
 #if DISABLED(BOARD_NAME)
@@ -51,6 +51,21 @@
 #else
   #define HAS_EMERGENCY_PARSER  false
 #endif
+#if ENABLED(BINARY_PROTOCOL)
+  #define HAS_BINARY_PROTOCOL   true
+#else
+  #define HAS_BINARY_PROTOCOL   false
+#endif
+#if ENABLED(CREDIT_FLOW_CONTROL)
+  #define HAS_CREDIT_FLOW_CONTROL true
+#else
+  #define HAS_CREDIT_FLOW_CONTROL false
+#endif
+#if ENABLED(SD_UPLOAD_RAW)
+  #define HAS_SD_UPLOAD_RAW     true
+#else
+  #define HAS_SD_UPLOAD_RAW     false
+#endif
 #if ENABLED(SERIAL_STATS_DROPPED_RX)
   #define HAS_STATS_DROPPED_RX  true
 #else
@@ -576,6 +591,7 @@
 #define HAS_TEMP_COOLER     (TEMP_SENSOR_COOLER != 0)
 #define HAS_MCU_TEMPERATURE (ENABLED(HAVE_MCU_TEMPERATURE))
 #define HAS_VREF_MONITOR    (ENABLED(HAVE_VREF_MONITOR))
+#define HAS_THERMISTOR_TABLE (ENABLED(THERMISTOR_TABLE) && !HAS_VREF_MONITOR)
 
 // Thermocouples
 #define HAS_MAX6675_SS      (PIN_EXISTS(MAX6675_SS))
@@ -266,6 +266,20 @@ typedef struct EepromDataStruct {
     hysteresis_data_t hysteresis_data;
   #endif
 
+  //
+  // Input Shaping
+  //
+  #if ENABLED(INPUT_SHAPING)
+    input_shaper_data_t input_shaper_data;
+  #endif
+
+  //
+  // Power budget
+  //
+  #if ENABLED(POWER_BUDGET)
+    power_budget_data_t power_budget_data;
+  #endif
+
   //
   // Trinamic
   //
@@ -335,6 +349,10 @@ void EEPROM::post_process() {
     fwretract.refresh_autoretract();
   #endif
 
+  #if ENABLED(INPUT_SHAPING)
+    inputshaper.refresh();
+  #endif
+
   #if HAS_LINEAR_E_JERK
     mechanics.recalculate_max_e_jerk();
   #endif
@@ -660,6 +678,20 @@ void EEPROM::post_process() {
       EEPROM_WRITE(hysteresis.data);
     #endif
 
+    //
+    // Input Shaping
+    //
+    #if ENABLED(INPUT_SHAPING)
+      EEPROM_WRITE(inputshaper.data);
+    #endif
+
+    //
+    // Power budget
+    //
+    #if ENABLED(POWER_BUDGET)
+      EEPROM_WRITE(powerbudget.data);
+    #endif
+
     //
     // Save Trinamic Driver Configuration, and placeholder values
     //
@@ -1065,6 +1097,20 @@ void EEPROM::post_process() {
         EEPROM_READ(hysteresis.data);
       #endif
 
+      //
+      // Input Shaping
+      //
+      #if ENABLED(INPUT_SHAPING)
+        EEPROM_READ(inputshaper.data);
+      #endif
+
+      //
+      // Power budget
+      //
+      #if ENABLED(POWER_BUDGET)
+        EEPROM_READ(powerbudget.data);
+      #endif
+
       if (!flag.validating) stepper.reset_drivers();
 
       //
@@ -1422,6 +1468,10 @@ void EEPROM::reset() {
     hysteresis.factory_parameters();
   #endif
 
+  #if ENABLED(INPUT_SHAPING)
+    inputshaper.factory_parameters();
+  #endif
+
   post_process();
 
   SERIAL_LM(ECHO, "Factory Settings Loaded");
@@ -1771,6 +1821,20 @@ void EEPROM::reset() {
       hysteresis.print_M99();
     #endif
 
+    /**
+     * Input Shaping
+     */
+    #if ENABLED(INPUT_SHAPING)
+      inputshaper.print_M593();
+    #endif
+
+    /**
+     * Power budget
+     */
+    #if ENABLED(POWER_BUDGET)
+      powerbudget.print_M1007();
+    #endif
+
     /**
      * Advanced Pause filament load & unload lengths
      */
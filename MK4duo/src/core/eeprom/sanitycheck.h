@@ -37,6 +37,10 @@
     #error "DEPENDENCY ERROR: EEPROM_FLASH is not implemented for AVR processor."
   #endif
 
+#elif ENABLED(ARDUINO_ARCH_NATIVE)
+
+  // The host native build always saves the EEPROM to a file
+
 #else
 
   #if ENABLED(EEPROM_SETTINGS) && DISABLED(EEPROM_I2C) && DISABLED(EEPROM_SPI) && DISABLED(EEPROM_SD) && DISABLED(EEPROM_FLASH)
@@ -47,12 +47,29 @@ void Fan::init() {
     data.tacho.init(data.ID);
   #endif
 
+  update_output_pin();
+
   if (printer.isRunning()) return; // All running not reinitialize
 
   if (data.pin > 0) HAL::pinMode(data.pin, isHWinvert() ? OUTPUT_HIGH : OUTPUT_LOW);
 
 }
 
+/**
+ * Port and mask of the output pin for the soft PWM,
+ * at start, at EEPROM load and at every change by M106
+ */
+void Fan::update_output_pin() {
+  #if ENABLED(SOFT_PWM_PORT_WRITE)
+    const bool hardware = data.pin > NoPin && USEABLE_HARDWARE_PWM(data.pin);
+    // The Tick ISR reads both, the hardware flag and the soft PWM pin
+    CRITICAL_SECTION_START();
+    pwm_hardware = hardware;
+    softpwm.set_pin(pwm_soft_pin, data.pin);
+    CRITICAL_SECTION_END();
+  #endif
+}
+
 void Fan::set_speed(const uint8_t new_speed) {
   #if ENABLED(FAN_KICKSTART_TIME)
     if (kickstart == 0 && new_speed > speed) {
@@ -81,20 +98,20 @@ void Fan::set_output_pwm() {
   const uint8_t new_speed = isHWinvert() ? 255 - actual_speed() : actual_speed();
 
   if (data.pin > NoPin) {
-    if (USEABLE_HARDWARE_PWM(data.pin))
+    if (use_hardware_pwm())
       HAL::analogWrite(data.pin, new_speed, fanManager.data.frequency);
     else {
       #if ENABLED(SOFTWARE_PDM)
         const uint8_t carry = pwm_soft_pos + new_speed;
-        HAL::digitalWrite(data.pin, (carry < pwm_soft_pos));
+        write_soft_pwm(carry < pwm_soft_pos);
         pwm_soft_pos = carry;
       #else // SOFTWARE PWM
         // Turn HIGH Software PWM
         if (fanManager.pwm_soft_count == 0 && ((pwm_soft_pos = (new_speed & SOFT_PWM_MASK)) > 0))
-            HAL::digitalWrite(data.pin, HIGH);
+            write_soft_pwm(HIGH);
         // Turn LOW Software PWM
         if (pwm_soft_pos == fanManager.pwm_soft_count && pwm_soft_pos != SOFT_PWM_MASK)
-          HAL::digitalWrite(data.pin, LOW);
+          write_soft_pwm(LOW);
       #endif
     }
   }
@@ -79,9 +79,15 @@ class Fan {
 
     uint8_t     pwm_soft_pos;
 
+    #if ENABLED(SOFT_PWM_PORT_WRITE)
+      softpwm_pin_t pwm_soft_pin;
+      bool          pwm_hardware;
+    #endif
+
   public: /** Public Function */
 
     void init();
+    void update_output_pin();
     void set_speed(const uint8_t new_speed);
     void set_auto_monitor(const int8_t h);
     void set_output_pwm();
@@ -108,6 +114,24 @@ class Fan {
     }
     FORCE_INLINE bool isIdle() { return data.flag.Idle; }
 
+  private: /** Private Function */
+
+    FORCE_INLINE bool use_hardware_pwm() {
+      #if ENABLED(SOFT_PWM_PORT_WRITE)
+        return pwm_hardware;
+      #else
+        return USEABLE_HARDWARE_PWM(data.pin);
+      #endif
+    }
+
+    FORCE_INLINE void write_soft_pwm(const bool level) {
+      #if ENABLED(SOFT_PWM_PORT_WRITE)
+        softpwm.write(pwm_soft_pin, level);
+      #else
+        HAL::digitalWrite(data.pin, level);
+      #endif
+    }
+
 };
 
 #if HAS_FAN
@@ -343,6 +343,39 @@
   );
 #endif
 
+/**
+ * S-Curve Jerk Control
+ */
+#if ENABLED(S_CURVE_JERK_CONTROL)
+  #if ENABLED(BEZIER_JERK_CONTROL)
+    #error "DEPENDENCY ERROR: S_CURVE_JERK_CONTROL and BEZIER_JERK_CONTROL can't be used together."
+  #elif ENABLED(__AVR__)
+    #error "DEPENDENCY ERROR: S_CURVE_JERK_CONTROL needs a 32 bit processor, use BEZIER_JERK_CONTROL on AVR."
+  #elif DISABLED(S_CURVE_JERK)
+    #error "DEPENDENCY ERROR: Missing setting S_CURVE_JERK."
+  #endif
+  static_assert(S_CURVE_JERK > 0, "DEPENDENCY ERROR: S_CURVE_JERK must be greater than 0.");
+#endif
+
+/**
+ * Planner Segment Merge
+ */
+#if ENABLED(PLANNER_SEGMENT_MERGE)
+  #if IS_KINEMATIC
+    #error "DEPENDENCY ERROR: PLANNER_SEGMENT_MERGE can't be used with DELTA or SCARA."
+  #elif ENABLED(HYSTERESIS_FEATURE)
+    #error "DEPENDENCY ERROR: PLANNER_SEGMENT_MERGE can't be used with HYSTERESIS_FEATURE."
+  #elif ENABLED(XY_FREQUENCY_LIMIT)
+    #error "DEPENDENCY ERROR: PLANNER_SEGMENT_MERGE can't be used with XY_FREQUENCY_LIMIT."
+  #elif ENABLED(FILAMENT_WIDTH_SENSOR)
+    #error "DEPENDENCY ERROR: PLANNER_SEGMENT_MERGE can't be used with FILAMENT_WIDTH_SENSOR."
+  #elif DISABLED(SEGMENT_MERGE_DEVIATION) || DISABLED(SEGMENT_MERGE_ANGLE) || DISABLED(SEGMENT_MERGE_MAX_LENGTH) || DISABLED(SEGMENT_MERGE_MAX_SEGMENTS) || DISABLED(SEGMENT_MERGE_TOLERANCE)
+    #error "DEPENDENCY ERROR: Missing setting SEGMENT_MERGE_DEVIATION, SEGMENT_MERGE_ANGLE, SEGMENT_MERGE_MAX_LENGTH, SEGMENT_MERGE_MAX_SEGMENTS or SEGMENT_MERGE_TOLERANCE."
+  #endif
+  static_assert(WITHIN(SEGMENT_MERGE_ANGLE, 0, 45), "DEPENDENCY ERROR: SEGMENT_MERGE_ANGLE must be a value from 0 to 45.");
+  static_assert(WITHIN(SEGMENT_MERGE_MAX_SEGMENTS, 2, 32), "DEPENDENCY ERROR: SEGMENT_MERGE_MAX_SEGMENTS must be a value from 2 to 32.");
+#endif
+
 // Z late enable
 #if MECH(COREXZ) && ENABLED(Z_LATE_ENABLE)
   #error "DEPENDENCY ERROR: Z_LATE_ENABLE can't be used with COREXZ."
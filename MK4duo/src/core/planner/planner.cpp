@@ -68,12 +68,20 @@
 // less movements. The delay is measured in milliseconds, and must be less than 250ms
 #define BLOCK_DELAY_FOR_1ST_MOVE 100
 
+// Speed^2 at the end of the last block
+#if ENABLED(PLANNER_FIXED_POINT)
+  constexpr speed_sqr_t min_planner_speed_sqr = speed_sqr_t(sq(MINIMUM_PLANNER_SPEED) * (SPEED_SQR_SCALE) + 0.5f);
+#else
+  constexpr speed_sqr_t min_planner_speed_sqr = sq(MINIMUM_PLANNER_SPEED);
+#endif
+
 Planner planner;
 
 /** Public Parameters */
 plan_flag_t       Planner::flag;
 
 block_t           Planner::block_buffer[BLOCK_BUFFER_SIZE];
+block_info_t      Planner::block_info[BLOCK_BUFFER_SIZE];
 
 volatile uint8_t  Planner::block_buffer_head        = 0,
                   Planner::block_buffer_nonbusy     = 0,
@@ -103,8 +111,21 @@ xyze_float_t  Planner::previous_speed = { 0.0, 0.0, 0.0, 0.0 };
 
 float Planner::previous_nominal_speed_sqr = 0.0;
 
+#if HAS_JUNCTION_DEVIATION
+  xyze_float_t Planner::previous_unit_vec{0.0f};
+#endif
+
+#if HAS_CLASSIC_JERK
+  float Planner::previous_safe_speed = 0.0;
+#endif
+
 uint32_t Planner::cutoff_long = 0;
 
+#if ENABLED(PLANNER_SEGMENT_MERGE)
+  segment_merge_t Planner::last_segment;
+  merge_stats_t   Planner::merge_stats;
+#endif
+
 #if ENABLED(DISABLE_INACTIVE_EXTRUDER)
   uint8_t Planner::g_uc_extruder_last_move[MAX_EXTRUDER] = { 0 };
 #endif
@@ -124,6 +145,9 @@ void Planner::init() {
   #endif
   previous_speed.reset();
   previous_nominal_speed_sqr = 0.0f;
+  #if ENABLED(PLANNER_SEGMENT_MERGE)
+    last_segment.valid = false;
+  #endif
   #if ABL_PLANAR
     bedlevel.matrix.set_to_identity();
   #endif
@@ -666,7 +690,7 @@ void Planner::init() {
     for (uint8_t b = block_buffer_tail; b != block_buffer_head; b = next_block_index(b)) {
       block_t* block = &block_buffer[b];
       if (block->steps.x || block->steps.y || block->steps.z) {
-        float se = (float)block->steps.e / block->step_event_count * SQRT(block->nominal_speed_sqr); // mm/sec;
+        float se = (float)block->steps.e / block->step_event_count * SQRT(block_info[b].nominal_speed_sqr); // mm/sec;
         NOLESS(high, se);
       }
     }
@@ -701,12 +725,11 @@ void Planner::check_axes_activity() {
     block_t* block;
 
     #if ENABLED(BARICUDA)
-      block = &block_buffer[block_buffer_tail];
       #if HAS_HEATER_HE1
-        tail_valve_pressure = block->valve_pressure;
+        tail_valve_pressure = block_info[block_buffer_tail].valve_pressure;
       #endif
       #if HAS_HEATER_HE2
-        tail_e_to_p_pressure = block->e_to_p_pressure;
+        tail_e_to_p_pressure = block_info[block_buffer_tail].e_to_p_pressure;
       #endif
     #endif
 
@@ -809,6 +832,11 @@ void Planner::quick_stop() {
   // Drop all queue entries
   block_buffer_nonbusy = block_buffer_planned = block_buffer_head = block_buffer_tail;
 
+  #if ENABLED(LASER) && ENABLED(LASER_RASTER)
+    // And the raster lines they were holding
+    rasterpool.clear();
+  #endif
+
   // And restart the block delay for the first movement - As the queue was
   // forced to empty, there is no risk the ISR could touch this variable.
   delay_before_delivering = BLOCK_DELAY_FOR_1ST_MOVE;
@@ -875,7 +903,11 @@ float Planner::get_axis_position_mm(const AxisEnum axis) {
 }
 
 void Planner::synchronize() {
-  while (has_blocks_queued() || flag.clean_buffer) {
+  while (has_blocks_queued() || flag.clean_buffer
+    #if ENABLED(INPUT_SHAPING)
+      || inputshaper.busy()
+    #endif
+  ) {
     printer.idle();
     PRINTER_KEEPALIVE(InProcess);
   }
@@ -945,7 +977,13 @@ bool Planner::buffer_steps(const xyze_long_t &target
   block_buffer_head = next_buffer_head;
 
   // Recalculate and optimize trapezoidal speed profiles
-  recalculate();
+  #if ENABLED(STEPPER_ISR_PROFILER)
+    const isr_free_t start = isrprofiler.start_free();
+    recalculate();
+    isrprofiler.stop_free(ISR_PHASE_PLANNER, start);
+  #else
+    recalculate();
+  #endif
 
   // Movement successfully queued!
   return true;
@@ -973,6 +1011,8 @@ bool Planner::fill_block(block_t * const block, bool split_move,
   , feedrate_t fr_mm_s, const uint8_t extruder, const float &millimeters/*=0.0*/
 ) {
 
+  block_info_t * const info = get_block_info(block);
+
   const int32_t dx = target.x - position.x,
                 dy = target.y - position.y,
                 dz = target.z - position.z;
@@ -1121,13 +1161,13 @@ bool Planner::fill_block(block_t * const block, bool split_move,
   steps_dist_mm.e = esteps_float * extruders[extruder]->steps_to_mm;
 
   if (block->steps.x < MIN_STEPS_PER_SEGMENT && block->steps.y < MIN_STEPS_PER_SEGMENT && block->steps.z < MIN_STEPS_PER_SEGMENT) {
-    block->millimeters = ABS(steps_dist_mm.e);
+    info->millimeters = ABS(steps_dist_mm.e);
   }
   else {
     if (millimeters)
-      block->millimeters = millimeters;
+      info->millimeters = millimeters;
     else
-      block->millimeters = SQRT(
+      info->millimeters = SQRT(
         #if CORE_IS_XY
           sq(steps_dist_mm.head.x) + sq(steps_dist_mm.head.y) + sq(steps_dist_mm.z)
         #elif CORE_IS_XZ
@@ -1153,12 +1193,12 @@ bool Planner::fill_block(block_t * const block, bool split_move,
 
   // For a mixing extruder, get a magnified step_event_count for each
   #if ENABLED(COLOR_MIXING_EXTRUDER)
-    mixer.populate_block(block->b_color);
+    mixer.populate_block(info->b_color);
   #endif
 
   #if ENABLED(BARICUDA)
-    block->valve_pressure   = printer.baricuda_valve_pressure;
-    block->e_to_p_pressure  = printer.baricuda_e_to_p_pressure;
+    info->valve_pressure   = printer.baricuda_valve_pressure;
+    info->e_to_p_pressure  = printer.baricuda_e_to_p_pressure;
   #endif
 
   #if EXTRUDERS > 1
@@ -1301,9 +1341,12 @@ bool Planner::fill_block(block_t * const block, bool split_move,
     // Calculate steps between laser firings (steps_l) and consider that when determining largest
     // interval between steps for X, Y, Z, E, L to feed to the motion control code.
     if (laser.mode == RASTER || laser.mode == PULSED) {
-      block->steps_l = ABS(block->millimeters * laser.ppm);
+      block->steps_l = ABS(info->millimeters * laser.ppm);
       #if ENABLED(LASER_RASTER)
-        for (uint8_t i = 0; i < LASER_MAX_RASTER_LINE; i++) {
+        info->raster_length = laser.mode == RASTER ? laser.raster_num_pixels : 0;
+        if (info->raster_length) info->raster_index = rasterpool.reserve(info->raster_length);
+        uint8_t * const raster_data = &rasterpool.data[info->raster_index];
+        for (raster_index_t i = 0; i < info->raster_length; i++) {
           // Scale the image intensity based on the raster power.
           // 100% power on a pixel basis is 255, convert back to 255 = 100.
           #if ENABLED(LASER_REMAP_INTENSITY)
@@ -1319,21 +1362,33 @@ bool Planner::fill_block(block_t * const block, bool split_move,
             if (NewValue <= LASER_REMAP_INTENSITY) NewValue = 0;
           #endif
 
-          block->laser_raster_data[i] = NewValue;
+          raster_data[i] = NewValue;
         }
       #endif
     }
-    else
+    else {
       block->steps_l = 0;
+      #if ENABLED(LASER_RASTER)
+        info->raster_length = 0;
+      #endif
+    }
 
     block->step_event_count = MAX(block->step_event_count, block->steps_l);
 
-    if (laser.diagnostics && block->laser_status == LASER_ON)
+    if (laser.diagnostics && block->laser_status == LASER_ON) {
       SERIAL_LM(ECHO, "Laser firing enabled");
+      #if ENABLED(LASER_RASTER)
+        if (info->raster_length) {
+          SERIAL_SMV(ECHO, "Raster line bytes:", info->raster_length);
+          SERIAL_MV(" pool used:", rasterpool.used());
+          SERIAL_EMV("/", LASER_RASTER_POOL_SIZE);
+        }
+      #endif
+    }
 
   #endif // LASER
 
-  const float inverse_millimeters = 1.0f / block->millimeters;  // Inverse millimeters to remove multiple divides
+  const float inverse_millimeters = 1.0f / info->millimeters;  // Inverse millimeters to remove multiple divides
 
   // Calculate inverse time for this move. No divide by zero due to previous checks.
   // Example: At 120mm/s a 60mm move takes 0.5s. So this will give 2.0.
@@ -1367,13 +1422,13 @@ bool Planner::fill_block(block_t * const block, bool split_move,
     if (isr_enabled) DISABLE_STEPPER_INTERRUPT();
 
     block_buffer_runtime_us += segment_time_us;
-    block->segment_time_us = segment_time_us;
+    info->segment_time_us = segment_time_us;
 
     // Reenable Stepper ISR
     if (isr_enabled) ENABLE_STEPPER_INTERRUPT();
   #endif
 
-  block->nominal_speed_sqr  = sq(block->millimeters * inverse_secs);        //   (mm/sec)^2 Always > 0
+  info->nominal_speed_sqr  = sq(info->millimeters * inverse_secs);        //   (mm/sec)^2 Always > 0
   block->nominal_rate       = CEIL(block->step_event_count * inverse_secs); // (step/sec)   Always > 0
 
   #if ENABLED(FILAMENT_WIDTH_SENSOR)
@@ -1456,7 +1511,7 @@ bool Planner::fill_block(block_t * const block, bool split_move,
   if (speed_factor < 1.0f) {
     current_speed *= speed_factor;
     block->nominal_rate *= speed_factor;
-    block->nominal_speed_sqr = block->nominal_speed_sqr * sq(speed_factor);
+    info->nominal_speed_sqr = info->nominal_speed_sqr * sq(speed_factor);
   }
 
   // Compute and limit the acceleration rate for the trapezoid generator.
@@ -1491,9 +1546,9 @@ bool Planner::fill_block(block_t * const block, bool split_move,
                               && de > 0;
 
       if (block->use_advance_lead) {
-        block->e_D_ratio = (target_float.e - position_float.e) /
+        info->e_D_ratio = (target_float.e - position_float.e) /
           #if IS_KINEMATIC
-            block->millimeters
+            info->millimeters
           #else
             SQRT(sq(target_float.x - position_float.x)
                + sq(target_float.y - position_float.y)
@@ -1503,10 +1558,10 @@ bool Planner::fill_block(block_t * const block, bool split_move,
 
         // Check for unusual high e_D ratio to detect if a retract move was combined with the last print move due to min. steps per segment. Never execute this with advance!
         // This assumes no one will use a retract length of 0mm < retr_length < ~0.2mm and no one will print 100mm wide lines using 3mm filament or 35mm wide lines using 1.75mm filament.
-        if (block->e_D_ratio > 3.0f)
+        if (info->e_D_ratio > 3.0f)
           block->use_advance_lead = false;
         else {
-          const uint32_t max_accel_steps_per_s2 = extruders[extruder]->data.max_jerk / (extruders[extruder]->data.advance_K * block->e_D_ratio) * steps_per_mm;
+          const uint32_t max_accel_steps_per_s2 = extruders[extruder]->data.max_jerk / (extruders[extruder]->data.advance_K * info->e_D_ratio) * steps_per_mm;
           if (printer.debugFeature() && accel > max_accel_steps_per_s2) DEBUG_EM("Acceleration limited.");
           NOMORE(accel, max_accel_steps_per_s2);
         }
@@ -1539,16 +1594,16 @@ bool Planner::fill_block(block_t * const block, bool split_move,
       }
     }
   }
-  block->acceleration_steps_per_s2 = accel;
-  block->acceleration = accel / steps_per_mm;
-  #if DISABLED(BEZIER_JERK_CONTROL)
+  info->acceleration_steps_per_s2 = accel;
+  info->acceleration = accel / steps_per_mm;
+  #if DISABLED(BEZIER_JERK_CONTROL) && DISABLED(S_CURVE_JERK_CONTROL)
     block->acceleration_rate = (uint32_t)(accel * (4096.0f * 4096.0f / (STEPPER_TIMER_RATE)));
   #endif
   #if ENABLED(LIN_ADVANCE)
     if (block->use_advance_lead) {
-      block->advance_speed = (STEPPER_TIMER_RATE) / (extruders[extruder]->data.advance_K * block->e_D_ratio * block->acceleration * extruders[extruder]->data.axis_steps_per_mm);
+      block->advance_speed = (STEPPER_TIMER_RATE) / (extruders[extruder]->data.advance_K * info->e_D_ratio * info->acceleration * extruders[extruder]->data.axis_steps_per_mm);
       if (printer.debugFeature()) {
-        if (extruders[extruder]->data.advance_K * block->e_D_ratio * block->acceleration * 2 < SQRT(block->nominal_speed_sqr) * block->e_D_ratio)
+        if (extruders[extruder]->data.advance_K * info->e_D_ratio * info->acceleration * 2 < SQRT(info->nominal_speed_sqr) * info->e_D_ratio)
           DEBUG_EM("More than 2 steps per eISR loop executed.");
         if (block->advance_speed < 200)
           DEBUG_EM("eISR running at > 10kHz.");
@@ -1560,9 +1615,6 @@ bool Planner::fill_block(block_t * const block, bool split_move,
 
   #if HAS_JUNCTION_DEVIATION
 
-    // Unit vector of previous path line segment
-    static xyze_float_t previous_unit_vec;
-
     #if HAS_DIST_MM_ARG
       xyze_float_t unit_vec = cart_dist_mm;
     #else
@@ -1603,13 +1655,13 @@ bool Planner::fill_block(block_t * const block, bool split_move,
         xyze_float_t junction_unit_vec = unit_vec - previous_unit_vec;
         normalize_junction_vector(junction_unit_vec);
 
-        const float junction_acceleration = limit_value_by_axis_maximum(block->acceleration, junction_unit_vec),
+        const float junction_acceleration = limit_value_by_axis_maximum(info->acceleration, junction_unit_vec),
                     sin_theta_d2 = SQRT(0.5f * (1.0f - junction_cos_theta)); // Trig half angle identity. Always positive.
 
         vmax_junction_sqr = (mechanics.data.junction_deviation_mm * junction_acceleration * sin_theta_d2) / (1.0f - sin_theta_d2);
 
         // For small moves with >135° junction (octagon) find speed for approximate arc
-        if (block->millimeters < 1 && junction_cos_theta < -0.7071067812f) {
+        if (info->millimeters < 1 && junction_cos_theta < -0.7071067812f) {
 
           const float neg = junction_cos_theta < 0 ? -1 : 1,
                       t   = neg * junction_cos_theta;
@@ -1657,13 +1709,13 @@ bool Planner::fill_block(block_t * const block, bool split_move,
           #endif
 
           // NOTE: MinMax acos approximation and thereby also junction_theta top out at pi-0.033, which avoids division by 0
-          const float limit_sqr = block->millimeters / (RADIANS(180) - junction_theta) * junction_acceleration;
+          const float limit_sqr = info->millimeters / (RADIANS(180) - junction_theta) * junction_acceleration;
           NOMORE(vmax_junction_sqr, limit_sqr);
         }
       }
 
       // Get the lowest speed
-      vmax_junction_sqr = MIN(vmax_junction_sqr, block->nominal_speed_sqr, previous_nominal_speed_sqr);
+      vmax_junction_sqr = MIN(vmax_junction_sqr, info->nominal_speed_sqr, previous_nominal_speed_sqr);
     }
     else // Init entry speed to zero. Assume it starts from rest. Planner will correct this later.
       vmax_junction_sqr = 0;
@@ -1674,10 +1726,7 @@ bool Planner::fill_block(block_t * const block, bool split_move,
 
   #if HAS_CLASSIC_JERK
 
-    const float nominal_speed = SQRT(block->nominal_speed_sqr);
-
-    // Exit speed limited by a jerk to full halt of a previous last segment
-    static float previous_safe_speed;
+    const float nominal_speed = SQRT(info->nominal_speed_sqr);
 
     // Start with a safe speed (from which the machine may halt to stop immediately).
     float safe_speed = nominal_speed;
@@ -1769,14 +1818,30 @@ bool Planner::fill_block(block_t * const block, bool split_move,
   #endif // Classic Jerk Limiting
 
   // Max entry speed of this block equals the max exit speed of the previous block.
-  block->max_entry_speed_sqr = vmax_junction_sqr;
+  #if ENABLED(PLANNER_FIXED_POINT)
+    set_fixed_parameters(block, info);
+    info->max_entry_speed_sqr = to_speed_sqr(vmax_junction_sqr);
+  #else
+    info->max_entry_speed_sqr = vmax_junction_sqr;
+  #endif
+
+  #if ENABLED(PLANNER_SEGMENT_MERGE)
+    // A block filled again with one more segment keeps the entry speed it was
+    // planned with, as the block before it may not be able to slow down more
+    NOLESS(info->max_entry_speed_sqr, last_segment.entry_speed_sqr);
+    last_segment.entry_speed_sqr = 0;
+  #endif
 
   // Initialize block entry speed. Compute based on deceleration to user-defined MINIMUM_PLANNER_SPEED.
-  const float v_allowable_sqr = max_allowable_speed_sqr(-block->acceleration, sq(MINIMUM_PLANNER_SPEED), block->millimeters);
+  const float v_allowable_sqr = max_allowable_speed_sqr(-info->acceleration, sq(MINIMUM_PLANNER_SPEED), info->millimeters);
 
   // If we are trying to add a split block, start with the
   // max. allowed speed to avoid an interrupted first move.
-  block->entry_speed_sqr = !split_move ? sq(float(MINIMUM_PLANNER_SPEED)) : MIN(vmax_junction_sqr, v_allowable_sqr);
+  #if ENABLED(PLANNER_FIXED_POINT)
+    info->entry_speed_sqr = !split_move ? min_planner_speed_sqr : to_speed_sqr(MIN(vmax_junction_sqr, v_allowable_sqr));
+  #else
+    info->entry_speed_sqr = !split_move ? sq(float(MINIMUM_PLANNER_SPEED)) : MIN(vmax_junction_sqr, v_allowable_sqr);
+  #endif
 
   // Initialize planner efficiency flags
   // Set flag if block will always reach maximum junction speed regardless of entry/exit speeds.
@@ -1786,11 +1851,11 @@ bool Planner::fill_block(block_t * const block, bool split_move,
   // block nominal speed limits both the current and next maximum junction speeds. Hence, in both
   // the reverse and forward planners, the corresponding block junction speed will always be at the
   // the maximum junction speed and may always be ignored for any speed reduction checks.
-  block->flag |= block->nominal_speed_sqr <= v_allowable_sqr ? BLOCK_FLAG_RECALCULATE | BLOCK_FLAG_NOMINAL_LENGTH : BLOCK_FLAG_RECALCULATE;
+  block->flag |= info->nominal_speed_sqr <= v_allowable_sqr ? BLOCK_FLAG_RECALCULATE | BLOCK_FLAG_NOMINAL_LENGTH : BLOCK_FLAG_RECALCULATE;
 
   // Update previous path unit_vector and nominal speed
   previous_speed = current_speed;
-  previous_nominal_speed_sqr = block->nominal_speed_sqr;
+  previous_nominal_speed_sqr = info->nominal_speed_sqr;
 
   // Update the position
   position = target;
@@ -1803,7 +1868,7 @@ bool Planner::fill_block(block_t * const block, bool split_move,
   #endif
 
   #if HAS_SD_RESTART
-    block->sdpos = restart.get_sdpos();
+    info->sdpos = restart.get_sdpos();
   #endif
 
   // Movement was accepted
@@ -1822,6 +1887,7 @@ void Planner::buffer_sync_block() {
 
   // Clear block
   memset(block, 0, sizeof(block_t));
+  memset(get_block_info(block), 0, sizeof(block_info_t));
 
   block->flag = BLOCK_FLAG_SYNC_POSITION;
 
@@ -1916,6 +1982,15 @@ bool Planner::buffer_segment(const float &a, const float &b, const float &c, con
   // Simulation Mode no movement
   if (printer.debugSimulation()) position = target;
 
+  #if ENABLED(PLANNER_SEGMENT_MERGE)
+    // Join the segment to the last block, or keep the planner state for the next one
+    const xyze_pos_t target_mm = { a, b, c, e };
+    planner_state_t state;
+    const bool merged = take_back_segment(target_mm, fr_mm_s, extruder);
+    if (!merged) save_state(state);
+    const uint8_t head = block_buffer_head;
+  #endif
+
   // Queue the movement
   if (!buffer_steps(target
     #if HAS_POSITION_FLOAT
@@ -1924,9 +1999,21 @@ bool Planner::buffer_segment(const float &a, const float &b, const float &c, con
     #if HAS_DIST_MM_ARG
       , cart_dist_mm
     #endif
-    , fr_mm_s, extruder, millimeters
+    , fr_mm_s, extruder
+    #if ENABLED(PLANNER_SEGMENT_MERGE)
+      , merged ? 0.0f : millimeters
+    #else
+      , millimeters
+    #endif
   )) return false;
 
+  #if ENABLED(PLANNER_SEGMENT_MERGE)
+    if (block_buffer_head != head)
+      store_segment(merged, state, target_mm, fr_mm_s, extruder);
+    else if (merged)
+      last_segment.valid = false;
+  #endif
+
   stepper.wake_up();
   return true;
 
@@ -2123,54 +2210,221 @@ void Planner::refresh_positioning() {
  */
 #define MINIMAL_STEP_RATE 120
 
-void Planner::calculate_trapezoid_for_block(block_t* const block, const float &entry_factor, const float &exit_factor) {
+#if ENABLED(S_CURVE_JERK_CONTROL)
 
-  uint32_t initial_rate = CEIL(entry_factor * block->nominal_rate),
-           final_rate   = CEIL(exit_factor  * block->nominal_rate); // (steps per second)
+  /**
+   * Split a speed change of 'delta_rate' steps/s into the three phases of
+   * a jerk limited profile: jerk up, constant acceleration, jerk down.
+   *
+   * The profile is symmetric, so its average speed is the mean of the two
+   * end speeds and it covers the same steps in the same time as the
+   * trapezoid at 'accel'. The lookahead results stay valid as they are.
+   * The price is a peak acceleration above 'accel': the jerk phases of
+   * duration t1 must satisfy jerk * t1 * (time - t1) = delta_rate.
+   * If 'jerk' is too low for that, the jerk phases take the whole time
+   * (peak acceleration 2 * accel) and the jerk is what the time allows.
+   */
+  void Planner::calculate_s_curve(s_curve_t &curve, const uint32_t delta_rate, const float &accel, const float &jerk) {
 
-  // Limit minimal step rate (Otherwise the timer will overflow.)
-  NOLESS(initial_rate,  uint32_t(MINIMAL_STEP_RATE));
-  NOLESS(final_rate,    uint32_t(MINIMAL_STEP_RATE));
+    const float time = (float)delta_rate / accel,
+                disc = sq(time) - 4.0f * delta_rate / jerk;
 
-  #if ENABLED(BEZIER_JERK_CONTROL)
-    uint32_t cruise_rate = initial_rate;
-  #endif
+    float jerk_time = disc > 0 ? 0.5f * (time - SQRT(disc)) : 0.5f * time,
+          jerk_used = jerk_time > 0 ? delta_rate / (jerk_time * (time - jerk_time)) : 0,
+          jerk_rate = jerk_used * (4096.0f * 4096.0f * 4096.0f * 4096.0f / sq(float(STEPPER_TIMER_RATE)));
+
+    // Jerk too high to be scaled: it's a plain trapezoid
+    if (jerk_time * (STEPPER_TIMER_RATE) < 1.0f || jerk_rate >= 4294967040.0f) {
+      jerk_time = 0;
+      jerk_rate = 0;
+    }
+
+    const float accel_used = jerk_time > 0 ? jerk_used * jerk_time : accel;
+
+    curve.time        = time * (STEPPER_TIMER_RATE);
+    curve.jerk_time   = jerk_time * (STEPPER_TIMER_RATE);
+    curve.jerk_rate   = jerk_rate;
+    curve.accel_rate  = accel_used * (4096.0f * 4096.0f / (STEPPER_TIMER_RATE));
+    curve.jerk_delta  = 0.5f * accel_used * jerk_time;
+  }
+
+#endif // ENABLED(S_CURVE_JERK_CONTROL)
 
-  const int32_t accel = block->acceleration_steps_per_s2;
+#if ENABLED(PLANNER_FIXED_POINT)
 
-            // Steps required for acceleration, deceleration to/from nominal rate
-  uint32_t  accelerate_steps = CEIL(estimate_acceleration_distance(initial_rate, block->nominal_rate, accel)),
-            decelerate_steps = FLOOR(estimate_acceleration_distance(block->nominal_rate, final_rate, -accel));
-            // Steps between acceleration and deceleration, if any
-  int32_t   plateau_steps = block->step_event_count - accelerate_steps - decelerate_steps;
+  /**
+   * Integer square root, rounded down
+   */
+  uint16_t Planner::isqrt(uint32_t x) {
+    uint32_t root = 0, bit = 1UL << 30;
+    while (bit > x) bit >>= 2;
+    while (bit) {
+      if (x >= root + bit) {
+        x -= root + bit;
+        root = (root >> 1) + bit;
+      }
+      else
+        root >>= 1;
+      bit >>= 2;
+    }
+    return root;
+  }
 
-  // Does accelerate_steps + decelerate_steps exceed step_event_count?
-  // Then we can't possibly reach the nominal rate, there will be no cruising.
-  // Use intersection_distance() to calculate accel / braking time in order to
-  // reach the final_rate exactly at the end of this block.
-  if (plateau_steps < 0) {
-    const float accelerate_steps_float = CEIL(intersection_distance(initial_rate, final_rate, accel, block->step_event_count));
-    accelerate_steps = MIN(uint32_t(MAX(accelerate_steps_float, 0)), block->step_event_count);
-    plateau_steps = 0;
+  /**
+   * The step rate of a block at speed^2 'v_sqr', rounded up.
+   * nominal_rate * sqrt(v_sqr / nominal_speed_sqr), the ratio as
+   * a 32 bit fraction, its square root as a 16 bit fraction.
+   */
+  uint32_t Planner::rate_for_speed_sqr(const block_t* const block, const speed_sqr_t v_sqr) {
+    const planner_fixed_t &fixed = get_block_info(block)->fixed;
+    if (v_sqr >= fixed.nominal_speed_sqr) return block->nominal_rate;
+    const uint64_t ratio = (uint64_t(v_sqr) * fixed.nominal_sqr_inverse) >> fixed.nominal_sqr_shift;
+    const uint16_t ratio_root = isqrt(ratio > 0xFFFFFFFFUL ? 0xFFFFFFFFUL : uint32_t(ratio));
+    return (uint64_t(block->nominal_rate) * ratio_root + 0xFFFF) >> 16;
+  }
+
+  /**
+   * The steps it takes to change the speed^2 by 'delta_sqr'
+   */
+  uint32_t Planner::steps_for_speed_sqr(const planner_fixed_t &fixed, const speed_sqr_t delta_sqr, const bool round_up) {
+    return (uint64_t(delta_sqr) * fixed.steps_per_sqr + (round_up ? 0xFFFFFFFFUL : 0)) >> 32;
+  }
+
+  /**
+   * Work out the values of planner_fixed_t for a new block, once,
+   * so the kernels and the trapezoid generator need no float math.
+   */
+  void Planner::set_fixed_parameters(const block_t* const block, block_info_t* const info) {
+    planner_fixed_t &fixed = info->fixed;
+
+    fixed.nominal_speed_sqr   = to_speed_sqr(info->nominal_speed_sqr);
+    fixed.accel_distance_sqr  = to_speed_sqr(2 * info->acceleration * info->millimeters);
+
+    // Steps to change the speed^2: distance (v1^2 - v0^2) / (2 * a) times steps per mm
+    const float steps_per_sqr = (float)block->step_event_count / info->millimeters
+                              / (2 * info->acceleration * (SPEED_SQR_SCALE)) * 4294967296.0f;
+    fixed.steps_per_sqr = steps_per_sqr >= 4294967040.0f ? 0xFFFFFFFFUL : uint32_t(steps_per_sqr);
+
+    // Inverse of nominal_speed_sqr, normalized in 2^31 - 2^32
+    const speed_sqr_t nominal = MAX(fixed.nominal_speed_sqr, speed_sqr_t(1));
+    uint8_t shift = 0;
+    while (nominal >> (shift + 1)) shift++;
+    fixed.nominal_sqr_shift   = shift;
+    fixed.nominal_sqr_inverse = MIN(4294967296.0f * (1UL << shift) / nominal, 4294967040.0f);
 
     #if ENABLED(BEZIER_JERK_CONTROL)
-      // We won't reach the cruising rate. Let's calculate the speed we will reach
-      cruise_rate = final_speed(initial_rate, accel, accelerate_steps);
+      const float ticks_per_rate = (STEPPER_TIMER_RATE) * 256.0f / info->acceleration_steps_per_s2;
+      fixed.ticks_per_rate = ticks_per_rate >= 4294967040.0f ? 0xFFFFFFFFUL : uint32_t(ticks_per_rate);
     #endif
   }
-  #if ENABLED(BEZIER_JERK_CONTROL)
-    else // We have some plateau time, so the cruise rate will be the nominal rate
-      cruise_rate = block->nominal_rate;
-  #endif
+
+  /**
+   * The trapezoid of a block from its entry and exit speed^2, like the
+   * float version below but on the values worked out by set_fixed_parameters()
+   */
+  void Planner::calculate_trapezoid_for_block(block_t* const block, const speed_sqr_t entry_speed_sqr, const speed_sqr_t exit_speed_sqr) {
+
+    const planner_fixed_t &fixed = get_block_info(block)->fixed;
+
+    uint32_t initial_rate = rate_for_speed_sqr(block, entry_speed_sqr),
+             final_rate   = rate_for_speed_sqr(block, exit_speed_sqr),
+             cruise_rate  = block->nominal_rate;
+
+    // Limit minimal step rate (Otherwise the timer will overflow.)
+    NOLESS(initial_rate,  uint32_t(MINIMAL_STEP_RATE));
+    NOLESS(final_rate,    uint32_t(MINIMAL_STEP_RATE));
+
+              // Steps required for acceleration, deceleration to/from nominal speed
+    uint32_t  accelerate_steps = entry_speed_sqr < fixed.nominal_speed_sqr ? steps_for_speed_sqr(fixed, fixed.nominal_speed_sqr - entry_speed_sqr, true) : 0,
+              decelerate_steps = exit_speed_sqr < fixed.nominal_speed_sqr ? steps_for_speed_sqr(fixed, fixed.nominal_speed_sqr - exit_speed_sqr, false) : 0;
+              // Steps between acceleration and deceleration, if any
+    int32_t   plateau_steps = block->step_event_count - accelerate_steps - decelerate_steps;
+
+    // No cruising: accelerate until the speed^2 from which the block
+    // can just brake to the exit speed, (accel_distance + exit - entry) / 2
+    if (plateau_steps < 0 || accelerate_steps > block->step_event_count || decelerate_steps > block->step_event_count) {
+      const speed_sqr_t half_sqr = (fixed.accel_distance_sqr >> 1) + (exit_speed_sqr >> 1),
+                        rise_sqr = half_sqr > (entry_speed_sqr >> 1) ? half_sqr - (entry_speed_sqr >> 1) : 0;
+      accelerate_steps = MIN(steps_for_speed_sqr(fixed, rise_sqr, true), block->step_event_count);
+      plateau_steps = 0;
+      // We won't reach the cruising rate. Let's calculate the speed we will reach
+      const speed_sqr_t peak_sqr = entry_speed_sqr + rise_sqr;
+      cruise_rate = rate_for_speed_sqr(block, peak_sqr < entry_speed_sqr ? SPEED_SQR_MAX : peak_sqr);
+    }
+
+    set_trapezoid(block, initial_rate, final_rate, cruise_rate, accelerate_steps, plateau_steps);
+  }
+
+#else // !PLANNER_FIXED_POINT
+
+  void Planner::calculate_trapezoid_for_block(block_t* const block, const float &entry_factor, const float &exit_factor) {
+
+    uint32_t initial_rate = CEIL(entry_factor * block->nominal_rate),
+             final_rate   = CEIL(exit_factor  * block->nominal_rate), // (steps per second)
+             cruise_rate  = block->nominal_rate;
+
+    // Limit minimal step rate (Otherwise the timer will overflow.)
+    NOLESS(initial_rate,  uint32_t(MINIMAL_STEP_RATE));
+    NOLESS(final_rate,    uint32_t(MINIMAL_STEP_RATE));
+
+    const int32_t accel = get_block_info(block)->acceleration_steps_per_s2;
+
+              // Steps required for acceleration, deceleration to/from nominal rate
+    uint32_t  accelerate_steps = CEIL(estimate_acceleration_distance(initial_rate, block->nominal_rate, accel)),
+              decelerate_steps = FLOOR(estimate_acceleration_distance(block->nominal_rate, final_rate, -accel));
+              // Steps between acceleration and deceleration, if any
+    int32_t   plateau_steps = block->step_event_count - accelerate_steps - decelerate_steps;
+
+    // Does accelerate_steps + decelerate_steps exceed step_event_count?
+    // Then we can't possibly reach the nominal rate, there will be no cruising.
+    // Use intersection_distance() to calculate accel / braking time in order to
+    // reach the final_rate exactly at the end of this block.
+    if (plateau_steps < 0) {
+      const float accelerate_steps_float = CEIL(intersection_distance(initial_rate, final_rate, accel, block->step_event_count));
+      accelerate_steps = MIN(uint32_t(MAX(accelerate_steps_float, 0)), block->step_event_count);
+      plateau_steps = 0;
+
+      #if ENABLED(BEZIER_JERK_CONTROL) || ENABLED(S_CURVE_JERK_CONTROL)
+        // We won't reach the cruising rate. Let's calculate the speed we will reach
+        cruise_rate = final_speed(initial_rate, accel, accelerate_steps);
+      #endif
+    }
+
+    set_trapezoid(block, initial_rate, final_rate, cruise_rate, accelerate_steps, plateau_steps);
+  }
+
+#endif // !PLANNER_FIXED_POINT
+
+/**
+ * Store the trapezoid of a block, with the speed curves of the jerk control
+ */
+void Planner::set_trapezoid(block_t* const block, const uint32_t initial_rate, const uint32_t final_rate, const uint32_t cruise_rate, const uint32_t accelerate_steps, const uint32_t plateau_steps) {
 
   #if ENABLED(BEZIER_JERK_CONTROL)
     // Jerk controlled speed requires to express speed versus time, NOT steps
-    uint32_t  acceleration_time = ((float)(cruise_rate - initial_rate) / accel) * (STEPPER_TIMER_RATE),
-              deceleration_time = ((float)(cruise_rate - final_rate) / accel) * (STEPPER_TIMER_RATE);
+    #if ENABLED(PLANNER_FIXED_POINT)
+      const uint32_t ticks_per_rate = get_block_info(block)->fixed.ticks_per_rate;
+      uint32_t  acceleration_time = (uint64_t(cruise_rate - initial_rate) * ticks_per_rate) >> 8,
+                deceleration_time = (uint64_t(cruise_rate - final_rate) * ticks_per_rate) >> 8;
+    #else
+      const int32_t accel = get_block_info(block)->acceleration_steps_per_s2;
+      uint32_t  acceleration_time = ((float)(cruise_rate - initial_rate) / accel) * (STEPPER_TIMER_RATE),
+                deceleration_time = ((float)(cruise_rate - final_rate) / accel) * (STEPPER_TIMER_RATE);
+    #endif
 
     // And to offload calculations from the ISR, we also calculate the inverse of those times here
     uint32_t  acceleration_time_inverse = get_period_inverse(acceleration_time),
               deceleration_time_inverse = get_period_inverse(deceleration_time);
+  #elif ENABLED(S_CURVE_JERK_CONTROL)
+    const block_info_t * const info = get_block_info(block);
+    const int32_t accel = info->acceleration_steps_per_s2;
+    // The jerk in steps/s^3 along the leading axis of the block
+    const float jerk = float(S_CURVE_JERK) * block->step_event_count / info->millimeters;
+    const uint32_t peak_rate = MAX(cruise_rate, initial_rate, final_rate);
+    calculate_s_curve(block->accel_curve, peak_rate - initial_rate, accel, jerk);
+    calculate_s_curve(block->decel_curve, peak_rate - final_rate, accel, jerk);
+  #else
+    UNUSED(cruise_rate);
   #endif
 
   // Store new block parameters
@@ -2183,6 +2437,8 @@ void Planner::calculate_trapezoid_for_block(block_t* const block, const float &e
     block->acceleration_time_inverse = acceleration_time_inverse;
     block->deceleration_time_inverse = deceleration_time_inverse;
     block->cruise_rate = cruise_rate;
+  #elif ENABLED(S_CURVE_JERK_CONTROL)
+    block->cruise_rate = peak_rate;
   #endif
   block->final_rate = final_rate;
 
@@ -2254,15 +2510,16 @@ void Planner::calculate_trapezoid_for_block(block_t* const block, const float &e
 void Planner::reverse_pass_kernel(block_t* const current_block, const block_t* const next_block) {
 
   if (current_block) {
+    block_info_t * const current_info = get_block_info(current_block);
     // If entry speed is already at the maximum entry speed, and there was no change of speed
     // in the next block, there is no need to recheck. Block is cruising and there is no need to
     // compute anything for this block,
     // If not, block entry speed needs to be recalculated to ensure maximum possible planned speed.
-    const float max_entry_speed_sqr = current_block->max_entry_speed_sqr;
+    const speed_sqr_t max_entry_speed_sqr = current_info->max_entry_speed_sqr;
 
     // Compute maximum entry speed decelerating over the current block from its exit speed.
     // If not at the maximum entry speed, or the previous block entry speed changed
-    if (current_block->entry_speed_sqr != max_entry_speed_sqr || (next_block && TEST(next_block->flag, BLOCK_BIT_RECALCULATE))) {
+    if (current_info->entry_speed_sqr != max_entry_speed_sqr || (next_block && TEST(next_block->flag, BLOCK_BIT_RECALCULATE))) {
 
       // If nominal length true, max junction speed is guaranteed to be reached.
       // If a block can de/ac-celerate from nominal speed to zero within the length of the block, then
@@ -2272,10 +2529,10 @@ void Planner::reverse_pass_kernel(block_t* const current_block, const block_t* c
       // the reverse and forward planners, the corresponding block junction speed will always be at the
       // the maximum junction speed and may always be ignored for any speed reduction checks.
 
-      const float new_entry_speed_sqr = TEST(current_block->flag, BLOCK_BIT_NOMINAL_LENGTH)
+      const speed_sqr_t new_entry_speed_sqr = TEST(current_block->flag, BLOCK_BIT_NOMINAL_LENGTH)
         ? max_entry_speed_sqr
-        : MIN(max_entry_speed_sqr, max_allowable_speed_sqr(-current_block->acceleration, next_block ? next_block->entry_speed_sqr : sq(MINIMUM_PLANNER_SPEED), current_block->millimeters));
-      if (current_block->entry_speed_sqr != new_entry_speed_sqr) {
+        : MIN(max_entry_speed_sqr, reachable_speed_sqr(current_info, next_block ? get_block_info(next_block)->entry_speed_sqr : min_planner_speed_sqr));
+      if (current_info->entry_speed_sqr != new_entry_speed_sqr) {
 
         // Need to recalculate the block speed - Mark it now, so the stepper
         // ISR does not consume the block before being recalculated
@@ -2293,7 +2550,7 @@ void Planner::reverse_pass_kernel(block_t* const current_block, const block_t* c
         else {
           // Block is not BUSY, we won the race against the Stepper ISR:
           // Just Set the new entry speed
-          current_block->entry_speed_sqr = new_entry_speed_sqr;
+          current_info->entry_speed_sqr = new_entry_speed_sqr;
         }
       }
     }
@@ -2304,18 +2561,21 @@ void Planner::reverse_pass_kernel(block_t* const current_block, const block_t* c
 void Planner::forward_pass_kernel(const block_t* const previous_block, block_t* const current_block, const uint8_t block_index) {
 
   if (previous_block) {
+    const block_info_t * const previous_info = get_block_info(previous_block);
+    block_info_t * const current_info = get_block_info(current_block);
+
     // If the previous block is an acceleration block, too short to complete the full speed
     // change, adjust the entry speed accordingly. Entry speeds have already been reset,
     // maximized, and reverse-planned. If nominal length is set, max junction speed is
     // guaranteed to be reached. No need to recheck.
     if (!TEST(previous_block->flag, BLOCK_BIT_NOMINAL_LENGTH) &&
-      previous_block->entry_speed_sqr < current_block->entry_speed_sqr) {
+      previous_info->entry_speed_sqr < current_info->entry_speed_sqr) {
 
       // Compute the maximum allowable speed
-      const float new_entry_speed_sqr = max_allowable_speed_sqr(-previous_block->acceleration, previous_block->entry_speed_sqr, previous_block->millimeters);
+      const speed_sqr_t new_entry_speed_sqr = reachable_speed_sqr(previous_info, previous_info->entry_speed_sqr);
 
       // If true, current block is full-acceleration and we can move the planned pointer forward.
-      if (new_entry_speed_sqr < current_block->entry_speed_sqr) {
+      if (new_entry_speed_sqr < current_info->entry_speed_sqr) {
 
         // Mark we need to recompute the trapezoidal shape, and do it now,
         // so the stepper ISR does not consume the block before being recalculated
@@ -2335,7 +2595,7 @@ void Planner::forward_pass_kernel(const block_t* const previous_block, block_t*
           // Block is not BUSY, we won the race against the Stepper ISR:
 
           // Always <= max_entry_speed_sqr. Backward pass sets this.
-          current_block->entry_speed_sqr = new_entry_speed_sqr; // Always <= max_entry_speed_sqr. Backward pass sets this.
+          current_info->entry_speed_sqr = new_entry_speed_sqr; // Always <= max_entry_speed_sqr. Backward pass sets this.
 
           // Set optimal plan pointer.
           block_buffer_planned = block_index;
@@ -2347,7 +2607,7 @@ void Planner::forward_pass_kernel(const block_t* const previous_block, block_t*
     // point in the buffer. When the plan is bracketed by either the beginning of the
     // buffer and a maximum entry speed or two maximum entry speeds, every block in between
     // cannot logically be further improved. Hence, we don't have to recompute them anymore.
-    if (current_block->entry_speed_sqr == current_block->max_entry_speed_sqr)
+    if (current_info->entry_speed_sqr == current_info->max_entry_speed_sqr)
       block_buffer_planned = block_index;
   }
 }
@@ -2474,8 +2734,13 @@ void Planner::recalculate_trapezoids() {
   // Go from the tail (currently executed block) to the first block, without including it)
   block_t *current_block  = nullptr,
           *next_block     = nullptr;
-  float   current_entry_speed = 0.0,
-          next_entry_speed    = 0.0;
+  #if ENABLED(PLANNER_FIXED_POINT)
+    speed_sqr_t current_entry_speed_sqr = 0,
+                next_entry_speed_sqr    = 0;
+  #else
+    float   current_entry_speed = 0.0,
+            next_entry_speed    = 0.0;
+  #endif
 
   while (block_index != head_block_index) {
 
@@ -2483,7 +2748,11 @@ void Planner::recalculate_trapezoids() {
 
     // Skip sync blocks
     if (!TEST(next_block->flag, BLOCK_BIT_SYNC_POSITION)) {
-      next_entry_speed = SQRT(next_block->entry_speed_sqr);
+      #if ENABLED(PLANNER_FIXED_POINT)
+        next_entry_speed_sqr = block_info[block_index].entry_speed_sqr;
+      #else
+        next_entry_speed = SQRT(block_info[block_index].entry_speed_sqr);
+      #endif
 
       if (current_block) {
         // Recalculate if current block entry or exit junction speed has changed.
@@ -2501,12 +2770,22 @@ void Planner::recalculate_trapezoids() {
             // Block is not BUSY, we won the race against the Stepper ISR:
 
             // NOTE: Entry and exit factors always > 0 by all previous logic operations.
-            const float current_nominal_speed = SQRT(current_block->nominal_speed_sqr),
-                        nomr = 1.0f / current_nominal_speed;
-            calculate_trapezoid_for_block(current_block, current_entry_speed * nomr, next_entry_speed * nomr);
+            #if ENABLED(PLANNER_FIXED_POINT)
+              calculate_trapezoid_for_block(current_block, current_entry_speed_sqr, next_entry_speed_sqr);
+            #else
+              const block_info_t * const current_info = get_block_info(current_block);
+              const float current_nominal_speed = SQRT(current_info->nominal_speed_sqr),
+                          nomr = 1.0f / current_nominal_speed;
+              calculate_trapezoid_for_block(current_block, current_entry_speed * nomr, next_entry_speed * nomr);
+            #endif
             #if ENABLED(LIN_ADVANCE)
               if (current_block->use_advance_lead) {
-                const float comp = current_block->e_D_ratio * extruders[toolManager.extruder.active]->data.advance_K * extruders[toolManager.extruder.active]->data.axis_steps_per_mm;
+                #if ENABLED(PLANNER_FIXED_POINT)
+                  const block_info_t * const current_info = get_block_info(current_block);
+                  const float current_nominal_speed = SQRT(current_info->nominal_speed_sqr),
+                              next_entry_speed = SQRT(speed_sqr_to_float(next_entry_speed_sqr));
+                #endif
+                const float comp = current_info->e_D_ratio * extruders[toolManager.extruder.active]->data.advance_K * extruders[toolManager.extruder.active]->data.axis_steps_per_mm;
                 current_block->max_adv_steps = current_nominal_speed * comp;
                 current_block->final_adv_steps = next_entry_speed * comp;
               }
@@ -2520,7 +2799,11 @@ void Planner::recalculate_trapezoids() {
       }
 
       current_block = next_block;
-      current_entry_speed = next_entry_speed;
+      #if ENABLED(PLANNER_FIXED_POINT)
+        current_entry_speed_sqr = next_entry_speed_sqr;
+      #else
+        current_entry_speed = next_entry_speed;
+      #endif
     }
 
     block_index = next_block_index(block_index);
@@ -2540,12 +2823,21 @@ void Planner::recalculate_trapezoids() {
     if (!stepper.is_block_busy(current_block)) {
       // Block is not BUSY, we won the race against the Stepper ISR:
 
-      const float next_nominal_speed = SQRT(next_block->nominal_speed_sqr),
-                  nomr = 1.0f / next_nominal_speed;
-      calculate_trapezoid_for_block(next_block, next_entry_speed * nomr, (MINIMUM_PLANNER_SPEED) * nomr);
+      #if ENABLED(PLANNER_FIXED_POINT)
+        calculate_trapezoid_for_block(next_block, next_entry_speed_sqr, min_planner_speed_sqr);
+      #else
+        const block_info_t * const next_info = get_block_info(next_block);
+        const float next_nominal_speed = SQRT(next_info->nominal_speed_sqr),
+                    nomr = 1.0f / next_nominal_speed;
+        calculate_trapezoid_for_block(next_block, next_entry_speed * nomr, (MINIMUM_PLANNER_SPEED) * nomr);
+      #endif
       #if ENABLED(LIN_ADVANCE)
         if (next_block->use_advance_lead) {
-          const float comp = next_block->e_D_ratio * extruders[toolManager.extruder.active]->data.advance_K * extruders[toolManager.extruder.active]->data.axis_steps_per_mm;
+          #if ENABLED(PLANNER_FIXED_POINT)
+            const block_info_t * const next_info = get_block_info(next_block);
+            const float next_nominal_speed = SQRT(next_info->nominal_speed_sqr);
+          #endif
+          const float comp = next_info->e_D_ratio * extruders[toolManager.extruder.active]->data.advance_K * extruders[toolManager.extruder.active]->data.axis_steps_per_mm;
           next_block->max_adv_steps = next_nominal_speed * comp;
           next_block->final_adv_steps = (MINIMUM_PLANNER_SPEED) * comp;
         }
@@ -2571,3 +2863,163 @@ void Planner::recalculate() {
 
   recalculate_trapezoids();
 }
+
+#if ENABLED(PLANNER_SEGMENT_MERGE)
+
+  void Planner::save_state(planner_state_t &state) {
+    state.position = position;
+    state.previous_speed = previous_speed;
+    state.previous_nominal_speed_sqr = previous_nominal_speed_sqr;
+    #if HAS_JUNCTION_DEVIATION
+      state.previous_unit_vec = previous_unit_vec;
+    #endif
+    #if HAS_CLASSIC_JERK
+      state.previous_safe_speed = previous_safe_speed;
+    #endif
+  }
+
+  void Planner::restore_state(const planner_state_t &state) {
+    position = state.position;
+    previous_speed = state.previous_speed;
+    previous_nominal_speed_sqr = state.previous_nominal_speed_sqr;
+    #if HAS_JUNCTION_DEVIATION
+      previous_unit_vec = state.previous_unit_vec;
+    #endif
+    #if HAS_CLASSIC_JERK
+      previous_safe_speed = state.previous_safe_speed;
+    #endif
+  }
+
+  /**
+   * Take the last block back out of the buffer, if the segment to 'target' can
+   * be joined to it: same extruder, feedrate and extrusion per mm, direction
+   * within SEGMENT_MERGE_ANGLE of the first segment of the block and no
+   * dropped corner farther than SEGMENT_MERGE_DEVIATION from the joined block.
+   *
+   * The block must not be busy, and the one before it must not be busy
+   * either, unless the block is alone in the buffer and held back by
+   * delay_before_delivering.
+   *
+   * Returns true if the block was taken back: the planner is back to the state
+   * it had before the block was filled, ready to fill it up to 'target'.
+   */
+  bool Planner::take_back_segment(const xyze_pos_t &target, const feedrate_t &fr_mm_s, const uint8_t extruder) {
+
+    // cos(SEGMENT_MERGE_ANGLE), rounded up
+    constexpr float max_angle_sq  = RADIANS(SEGMENT_MERGE_ANGLE) * RADIANS(SEGMENT_MERGE_ANGLE),
+                    cos_max_angle = 1.0f - max_angle_sq * 0.5f + max_angle_sq * max_angle_sq * (1.0f / 24.0f);
+
+    segment_merge_t &last = last_segment;
+
+    if (!last.valid || last.count >= SEGMENT_MERGE_MAX_SEGMENTS || extruder != last.extruder || printer.mode != PRINTER_MODE_FFF) return false;
+
+    // Position changed (G92, homing, sync blocks) or other blocks queued
+    if (prev_block_index(block_buffer_head) != last.index
+      || position.x != last.end_steps.x || position.y != last.end_steps.y
+      || position.z != last.end_steps.z || position.e != last.end_steps.e
+    ) return false;
+
+    if (ABS(fr_mm_s - last.fr_mm_s) > last.fr_mm_s * (SEGMENT_MERGE_TOLERANCE)) return false;
+
+    // Direction of the new segment
+    const xyz_float_t segment = { target.x - last.end.x, target.y - last.end.y, target.z - last.end.z };
+    const float segment_sq = sq(segment.x) + sq(segment.y) + sq(segment.z);
+    if (segment_sq < 1e-8f) return false;
+    const float segment_mm = SQRT(segment_sq),
+                along = segment.x * last.direction.x + segment.y * last.direction.y + segment.z * last.direction.z;
+    if (along < segment_mm * cos_max_angle) return false;
+
+    // Extrusion per mm
+    if (ABS((target.e - last.end.e) / segment_mm - last.e_per_mm) > ABS(last.e_per_mm) * (SEGMENT_MERGE_TOLERANCE)) return false;
+
+    // The joined block, from the start of the first segment
+    const xyz_float_t chord = { target.x - last.start.x, target.y - last.start.y, target.z - last.start.z };
+    const float chord_sq = sq(chord.x) + sq(chord.y) + sq(chord.z);
+    if (chord_sq > sq(SEGMENT_MERGE_MAX_LENGTH)) return false;
+
+    // Distance of the corners from the joined block, the end of the block is one more
+    last.corner[last.count - 1].set(last.end.x - last.start.x, last.end.y - last.start.y, last.end.z - last.start.z);
+    for (uint8_t i = 0; i < last.count; i++) {
+      const xyz_float_t &corner = last.corner[i];
+      const float along = corner.x * chord.x + corner.y * chord.y + corner.z * chord.z;
+      if ((sq(corner.x) + sq(corner.y) + sq(corner.z)) * chord_sq - sq(along) > sq(SEGMENT_MERGE_DEVIATION) * chord_sq) return false;
+    }
+
+    // Take the block back, if the Stepper ISR did not get it yet
+    bool taken = false;
+    const bool isr_enabled = STEPPER_ISR_ENABLED();
+    if (isr_enabled) DISABLE_STEPPER_INTERRUPT();
+
+    const uint8_t nonbusy = nonbusy_moves_planned();
+    if (nonbusy >= 2 || (nonbusy == 1 && moves_planned() == 1)) {
+      block_buffer_head = last.index;
+      // Plan again all the blocks that can change
+      block_buffer_planned = block_buffer_nonbusy;
+      #if HAS_SPI_LCD
+        block_buffer_runtime_us -= block_info[last.index].segment_time_us;
+      #endif
+      taken = true;
+    }
+
+    if (isr_enabled) ENABLE_STEPPER_INTERRUPT();
+
+    if (!taken) {
+      last.valid = false;
+      return false;
+    }
+
+    last.entry_speed_sqr = block_info[last.index].entry_speed_sqr;
+    restore_state(last.state);
+    #if HAS_POSITION_FLOAT
+      position_float = last.start;
+    #endif
+
+    return true;
+  }
+
+  /**
+   * Keep the block just queued by buffer_segment() for the next segment
+   */
+  void Planner::store_segment(const bool merged, const planner_state_t &state, const xyze_pos_t &target, const feedrate_t &fr_mm_s, const uint8_t extruder) {
+
+    segment_merge_t &last = last_segment;
+
+    merge_stats.segments++;
+
+    if (merged) {
+      last.count++;
+      merge_stats.merged++;
+      NOLESS(merge_stats.max_count, last.count);
+    }
+    else {
+      // Start of the block in mm, the end of the last one if the position did not change
+      if (state.position.x == last.end_steps.x && state.position.y == last.end_steps.y
+        && state.position.z == last.end_steps.z && state.position.e == last.end_steps.e
+      ) last.start = last.end;
+      else {
+        last.start.set(state.position.x * mechanics.steps_to_mm.x, state.position.y * mechanics.steps_to_mm.y, state.position.z * mechanics.steps_to_mm.z);
+        last.start.e = state.position.e * extruders[extruder]->steps_to_mm;
+      }
+
+      const xyz_float_t segment = { target.x - last.start.x, target.y - last.start.y, target.z - last.start.z };
+      const float segment_sq = sq(segment.x) + sq(segment.y) + sq(segment.z);
+
+      last.index      = prev_block_index(block_buffer_head);
+      last.extruder   = extruder;
+      last.count      = 1;
+      last.state      = state;
+      last.fr_mm_s    = fr_mm_s;
+      // Only moves of the XYZ axes can take more segments
+      last.valid      = segment_sq >= 1e-8f;
+      if (last.valid) {
+        const float inv_mm = RSQRT(segment_sq);
+        last.direction  = segment * inv_mm;
+        last.e_per_mm   = (target.e - last.start.e) * inv_mm;
+      }
+    }
+
+    last.end = target;
+    last.end_steps = position;
+  }
+
+#endif // ENABLED(PLANNER_SEGMENT_MERGE)
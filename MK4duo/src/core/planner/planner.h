@@ -30,6 +30,8 @@
  * Copyright (c) 2009-2011 Simen Svale Skogsrud
  */
 
+#include "../../feature/laser/rasterpool/rasterpool.h"
+
 union plan_flag_t {
   uint8_t all;
   struct {
@@ -45,26 +47,74 @@ union plan_flag_t {
   plan_flag_t() { all = 0x00; }
 };
 
+#if ENABLED(S_CURVE_JERK_CONTROL)
+
+  /**
+   * struct s_curve_t
+   *
+   * A jerk limited speed change, worked out by the planner:
+   * jerk up, constant acceleration, jerk down. The Stepper ISR
+   * only has to find the phase and do a couple of multiplies.
+   */
+  typedef struct s_curve_t {
+    uint32_t  time,                         // Duration of the whole speed change in STEP timer counts
+              jerk_time,                    // Duration of each jerk phase in STEP timer counts
+              jerk_rate,                    // Jerk, scaled for Stepper::_eval_s_curve()
+              accel_rate,                   // Acceleration between the jerk phases, scaled like acceleration_rate
+              jerk_delta;                   // Speed change of each jerk phase in steps/s
+  } s_curve_t;
+
+#endif
+
+#if ENABLED(PLANNER_FIXED_POINT)
+
+  /**
+   * Speed^2 of the lookahead as a scaled integer, (mm/s)^2 * 256,
+   * good up to 4096 mm/s. With it the planner kernels need no float
+   * math, that an AVR can only do in software.
+   */
+  typedef uint32_t speed_sqr_t;
+
+  #define SPEED_SQR_SCALE 256.0f
+  #define SPEED_SQR_MAX   0xFFFFFFFFUL
+
+  /**
+   * struct planner_fixed_t
+   *
+   * The values of a block the fixed point kernels need, worked out
+   * once with float math when the block is queued.
+   */
+  typedef struct planner_fixed_t {
+    speed_sqr_t nominal_speed_sqr,          // nominal_speed_sqr as speed_sqr_t
+                accel_distance_sqr;         // 2 * acceleration * millimeters, the speed^2 change over the block
+    uint32_t    steps_per_sqr,              // Steps to change the speed^2 by 1, 32 bit fraction
+                nominal_sqr_inverse;        // 2^(32 + nominal_sqr_shift) / nominal_speed_sqr
+    uint8_t     nominal_sqr_shift;
+    #if ENABLED(BEZIER_JERK_CONTROL)
+      uint32_t  ticks_per_rate;             // STEP timer counts to change the rate by 1 step/s, 8 bit fraction
+    #endif
+  } planner_fixed_t;
+
+#else
+
+  typedef float speed_sqr_t;
+
+#endif
+
 /**
  * struct block_t
  *
  * A single entry in the planner buffer.
  * Tracks linear movement over multiple axes.
  *
- * The "nominal" values are as-specified by gcode, and
- * may never actually be reached due to acceleration limits.
+ * Only the fields read by the Stepper ISR live here, to keep the
+ * record compact. Planner-only values and bulky payloads are in the
+ * block_info_t stored at the same index of block_info.
  */
 typedef struct block_t {
 
   volatile uint8_t flag;                    // Block flags (See BlockFlagEnum enum above) - Modified by ISR and main thread!
 
-  // Fields used by the motion planner to manage acceleration
-  float nominal_speed_sqr,                  // The nominal speed for this block in (mm/sec)^2
-        entry_speed_sqr,                    // Entry speed at previous-current junction in (mm/sec)^2
-        max_entry_speed_sqr,                // Maximum allowable junction entry speed in (mm/sec)^2
-        millimeters,                        // The total travel of this block in mm
-        acceleration;                       // acceleration mm/sec^2
-
   union {
     xyze_ulong_t steps;                     // Step count along each axis
     xyze_long_t position;                   // New position to force when this sync block is executed
@@ -74,10 +124,6 @@ typedef struct block_t {
 
   uint8_t active_extruder;                  // The extruder to move (if E move)
 
-  #if ENABLED(COLOR_MIXING_EXTRUDER)
-    mixer_color_t b_color[MIXING_STEPPERS]; // Normalized color for the mixing steppers
-  #endif
-
   // Settings for the trapezoid generator
   uint32_t  accelerate_until,               // The index of the step event on which to stop acceleration
             decelerate_after;               // The index of the step event on which to start decelerating
@@ -88,6 +134,10 @@ typedef struct block_t {
               deceleration_time,
               acceleration_time_inverse,    // Inverse of acceleration and deceleration periods, expressed as integer. Scale depends on CPU being used
               deceleration_time_inverse;
+  #elif ENABLED(S_CURVE_JERK_CONTROL)
+    uint32_t  cruise_rate;                  // The actual cruise rate to use, between end of the acceleration phase and start of deceleration phase
+    s_curve_t accel_curve,                  // Jerk limited acceleration and deceleration
+              decel_curve;
   #else
     uint32_t  acceleration_rate;            // The acceleration rate used for acceleration calculation
   #endif
@@ -100,13 +150,49 @@ typedef struct block_t {
     uint16_t  advance_speed,                // STEP timer value for extruder speed offset ISR
               max_adv_steps,                // max. advance steps to get cruising speed pressure (not always nominal_speed!)
               final_adv_steps;              // advance steps due to exit speed
-    float     e_D_ratio;
   #endif
 
   uint32_t  nominal_rate,                   // The nominal step rate for this block in step_events/sec
             initial_rate,                   // The jerk-adjusted step rate at start of block
-            final_rate,                     // The minimal rate at exit
-            acceleration_steps_per_s2;      // acceleration steps/sec^2
+            final_rate;                     // The minimal rate at exit
+
+  #if ENABLED(LASER)
+    uint8_t   laser_mode;       // CONTINUOUS, PULSED, RASTER
+    bool      laser_status;     // LASER_OFF, LASER_ON
+    float     laser_intensity;  // Laser firing instensity in clock cycles for the PWM timer
+    uint32_t  laser_duration,   // Laser firing duration in microseconds, for pulsed and raster firing modes
+              steps_l;          // Step count between firings of the laser, for pulsed firing mode
+  #endif
+
+} block_t;
+
+/**
+ * struct block_info_t
+ *
+ * The planner side of a block_t, kept in a parallel buffer.
+ * Holds the lookahead values and the payloads that the Stepper
+ * ISR reads at most once per block or once per laser firing.
+ */
+typedef struct block_info_t {
+
+  // Fields used by the motion planner to manage acceleration
+  float nominal_speed_sqr;                  // The nominal speed for this block in (mm/sec)^2
+
+  speed_sqr_t entry_speed_sqr,              // Entry speed at previous-current junction in (mm/sec)^2
+              max_entry_speed_sqr;          // Maximum allowable junction entry speed in (mm/sec)^2
+
+  float millimeters,                        // The total travel of this block in mm
+        acceleration;                       // acceleration mm/sec^2
+
+  #if ENABLED(PLANNER_FIXED_POINT)
+    planner_fixed_t fixed;                  // Integer values for the planner kernels
+  #endif
+
+  uint32_t acceleration_steps_per_s2;       // acceleration steps/sec^2
+
+  #if ENABLED(LIN_ADVANCE)
+    float e_D_ratio;
+  #endif
 
   #if ENABLED(BARICUDA)
     uint8_t valve_pressure, e_to_p_pressure;
@@ -116,24 +202,70 @@ typedef struct block_t {
     uint32_t segment_time_us;
   #endif
 
-  #if ENABLED(LASER)
-    uint8_t   laser_mode;       // CONTINUOUS, PULSED, RASTER
-    bool      laser_status;     // LASER_OFF, LASER_ON
-    float     laser_ppm,        // pulses per millimeter, for pulsed and raster firing modes
-              laser_intensity;  // Laser firing instensity in clock cycles for the PWM timer
-    uint32_t  laser_duration,   // Laser firing duration in microseconds, for pulsed and raster firing modes
-              steps_l;          // Step count between firings of the laser, for pulsed firing mode
+  #if ENABLED(COLOR_MIXING_EXTRUDER)
+    mixer_color_t b_color[MIXING_STEPPERS]; // Normalized color for the mixing steppers
+  #endif
 
-    #if ENABLED(LASER_RASTER)
-      unsigned char laser_raster_data[LASER_MAX_RASTER_LINE];
-    #endif
+  #if ENABLED(LASER) && ENABLED(LASER_RASTER)
+    raster_index_t  raster_index,           // First pixel of the raster line in rasterpool
+                    raster_length;          // Pixels of the raster line, 0 if none
   #endif
 
   #if HAS_SD_RESTART
     uint32_t sdpos;
   #endif
 
-} block_t;
+} block_info_t;
+
+#if ENABLED(PLANNER_SEGMENT_MERGE)
+
+  /**
+   * struct planner_state_t
+   *
+   * What fill_block() changes in the planner and uses for the next block
+   */
+  typedef struct planner_state_t {
+    xyze_long_t   position;
+    xyze_float_t  previous_speed;
+    float         previous_nominal_speed_sqr;
+    #if HAS_JUNCTION_DEVIATION
+      xyze_float_t previous_unit_vec;
+    #endif
+    #if HAS_CLASSIC_JERK
+      float previous_safe_speed;
+    #endif
+  } planner_state_t;
+
+  /**
+   * struct segment_merge_t
+   *
+   * The last block queued by buffer_segment(), with the planner
+   * state from before it was filled, so it can be taken back and
+   * filled again joined with the next segment.
+   */
+  typedef struct segment_merge_t {
+    bool            valid;                    // The block can take more segments
+    uint8_t         index,                    // Index of the block in block_buffer
+                    extruder,
+                    count;                    // Segments joined in the block
+    planner_state_t state;                    // Planner state before the block was filled
+    xyze_long_t     end_steps;                // Planner position at the end of the block
+    xyze_pos_t      start,                    // Start and end of the block in mm
+                    end;
+    xyz_float_t     direction,                // Unit vector of the first segment
+                    corner[SEGMENT_MERGE_MAX_SEGMENTS - 1]; // Dropped corners, from the start of the block
+    feedrate_t      fr_mm_s;
+    float           e_per_mm;                 // Extrusion per mm of the first segment
+    speed_sqr_t     entry_speed_sqr;          // Planned entry speed of a block taken back
+  } segment_merge_t;
+
+  typedef struct merge_stats_t {
+    uint32_t  segments,                       // Segments given to buffer_segment()
+              merged;                         // Segments joined to the previous block
+    uint8_t   max_count;                      // Most segments joined in one block
+  } merge_stats_t;
+
+#endif
 
 #define BLOCK_MOD(n) ((n)&(BLOCK_BUFFER_SIZE-1))
 
@@ -161,6 +293,7 @@ class Planner {
      *  Reader of tail is Stepper::isr(). Always consider tail busy / read-only
      */
     static block_t          block_buffer[BLOCK_BUFFER_SIZE];
+    static block_info_t     block_info[BLOCK_BUFFER_SIZE];   // Planner side of block_buffer, same index
     static volatile uint8_t block_buffer_head,        // Index of the next block to be pushed
                             block_buffer_nonbusy,     // Index of the first non busy block
                             block_buffer_planned,     // Index of the optimally planned block
@@ -181,6 +314,10 @@ class Planner {
                     autotemp_factor;
     #endif
 
+    #if ENABLED(PLANNER_SEGMENT_MERGE)
+      static merge_stats_t merge_stats;
+    #endif
+
   private: /** Private Parameters */
 
     /**
@@ -199,11 +336,29 @@ class Planner {
      */
     static float previous_nominal_speed_sqr;
 
+    #if HAS_JUNCTION_DEVIATION
+      /**
+       * Unit vector of previous path line segment
+       */
+      static xyze_float_t previous_unit_vec;
+    #endif
+
+    #if HAS_CLASSIC_JERK
+      /**
+       * Exit speed limited by a jerk to full halt of a previous last segment
+       */
+      static float previous_safe_speed;
+    #endif
+
     /**
      * Limit where 64bit math is necessary for acceleration calculation
      */
     static uint32_t cutoff_long;
 
+    #if ENABLED(PLANNER_SEGMENT_MERGE)
+      static segment_merge_t last_segment;
+    #endif
+
     #if ENABLED(DISABLE_INACTIVE_EXTRUDER)
       /**
        * Counters to manage disabling inactive extruders
@@ -286,6 +441,13 @@ class Planner {
       return &block_buffer[block_buffer_head];
     }
 
+    /**
+     * The planner side of a block in block_buffer
+     */
+    FORCE_INLINE static block_info_t* get_block_info(const block_t * const block) {
+      return &block_info[block - block_buffer];
+    }
+
     /**
      * Planner::buffer_steps
      *
@@ -482,8 +644,13 @@ class Planner {
      * NB: There MUST be a current block to call this function!!
      */
     FORCE_INLINE static void discard_current_block() {
-      if (has_blocks_queued())
+      if (has_blocks_queued()) {
+        #if ENABLED(LASER) && ENABLED(LASER_RASTER)
+          const block_info_t * const info = &block_info[block_buffer_tail];
+          if (info->raster_length) rasterpool.release(info->raster_index, info->raster_length);
+        #endif
         block_buffer_tail = next_block_index(block_buffer_tail);
+      }
     }
 
     /**
@@ -515,7 +682,7 @@ class Planner {
         if (TEST(block->flag, BLOCK_BIT_RECALCULATE)) return nullptr;
 
         #if HAS_SPI_LCD
-          block_buffer_runtime_us -= block->segment_time_us; // We can't be sure how long an active block will take, so don't count it.
+          block_buffer_runtime_us -= block_info[block_buffer_tail].segment_time_us; // We can't be sure how long an active block will take, so don't count it.
         #endif
 
         // As this block is busy, advance the nonbusy block pointer
@@ -625,7 +792,40 @@ class Planner {
       return target_velocity_sqr - 2 * accel * distance;
     }
 
-    #if ENABLED(BEZIER_JERK_CONTROL)
+    #if ENABLED(PLANNER_FIXED_POINT)
+
+      /**
+       * Convert a float speed^2 in (mm/sec)^2 to speed_sqr_t and back
+       */
+      static speed_sqr_t to_speed_sqr(const float &v_sqr) {
+        const float v = v_sqr * (SPEED_SQR_SCALE);
+        return v >= float(SPEED_SQR_MAX) ? SPEED_SQR_MAX : v > 0 ? speed_sqr_t(v) : 0;
+      }
+      static float speed_sqr_to_float(const speed_sqr_t v_sqr) { return v_sqr * (1.0f / (SPEED_SQR_SCALE)); }
+
+      /**
+       * Maximum speed^2 at the start of a block, in order to reach
+       * 'target_velocity_sqr' decelerating over the whole block.
+       */
+      static speed_sqr_t reachable_speed_sqr(const block_info_t * const info, const speed_sqr_t target_velocity_sqr) {
+        const speed_sqr_t v_sqr = target_velocity_sqr + info->fixed.accel_distance_sqr;
+        return v_sqr < target_velocity_sqr ? SPEED_SQR_MAX : v_sqr;
+      }
+
+      static uint16_t isqrt(uint32_t x);
+      static uint32_t rate_for_speed_sqr(const block_t* const block, const speed_sqr_t v_sqr);
+      static uint32_t steps_for_speed_sqr(const planner_fixed_t &fixed, const speed_sqr_t delta_sqr, const bool round_up);
+      static void set_fixed_parameters(const block_t* const block, block_info_t* const info);
+
+    #else
+
+      static float reachable_speed_sqr(const block_info_t * const info, const float &target_velocity_sqr) {
+        return max_allowable_speed_sqr(-info->acceleration, target_velocity_sqr, info->millimeters);
+      }
+
+    #endif
+
+    #if ENABLED(BEZIER_JERK_CONTROL) || ENABLED(S_CURVE_JERK_CONTROL)
       /**
        * Calculate the speed reached given initial speed, acceleration and distance
        */
@@ -634,7 +834,16 @@ class Planner {
       }
     #endif
 
-    static void calculate_trapezoid_for_block(block_t* const block, const float &entry_factor, const float &exit_factor);
+    #if ENABLED(S_CURVE_JERK_CONTROL)
+      static void calculate_s_curve(s_curve_t &curve, const uint32_t delta_rate, const float &accel, const float &jerk);
+    #endif
+
+    #if ENABLED(PLANNER_FIXED_POINT)
+      static void calculate_trapezoid_for_block(block_t* const block, const speed_sqr_t entry_speed_sqr, const speed_sqr_t exit_speed_sqr);
+    #else
+      static void calculate_trapezoid_for_block(block_t* const block, const float &entry_factor, const float &exit_factor);
+    #endif
+    static void set_trapezoid(block_t* const block, const uint32_t initial_rate, const uint32_t final_rate, const uint32_t cruise_rate, const uint32_t accelerate_steps, const uint32_t plateau_steps);
 
     static void reverse_pass_kernel(block_t* const current_block, const block_t* const next_block);
     static void forward_pass_kernel(const block_t* const previous_block, block_t* const current_block, const uint8_t block_index);
@@ -646,6 +855,13 @@ class Planner {
 
     static void recalculate();
 
+    #if ENABLED(PLANNER_SEGMENT_MERGE)
+      static void save_state(planner_state_t &state);
+      static void restore_state(const planner_state_t &state);
+      static bool take_back_segment(const xyze_pos_t &target, const feedrate_t &fr_mm_s, const uint8_t extruder);
+      static void store_segment(const bool merged, const planner_state_t &state, const xyze_pos_t &target, const feedrate_t &fr_mm_s, const uint8_t extruder);
+    #endif
+
     #if HAS_JUNCTION_DEVIATION
 
       FORCE_INLINE static void normalize_junction_vector(xyze_float_t &vector) {
@@ -78,6 +78,11 @@ PrinterModeEnum Printer::mode =
   short_timer_t Printer::chdk_timer;
 #endif
 
+// Deferred half of HAL::Tick
+volatile bool  Printer::tick_spin_pending       = false,
+               Printer::tick_periodical_pending = false,
+               Printer::tick_task_running       = false;
+
 /** Public Function */
 void Printer::setup_pinout() {
 
@@ -213,6 +218,67 @@ void Printer::check_periodical_actions() {
 
 }
 
+/**
+ * Events of HAL::Tick, spin() every 100 ms and the periodical actions every second.
+ * They are only flagged for tick_task(), the HAL runs it as soon as the Tick
+ * interrupt returns, at a lower priority than any other interrupt. Should a spin
+ * still be pending at the next event it runs here in the Tick, as it always did,
+ * so the safety checks of the heaters are never more than one period late.
+ */
+void Printer::tick_events(const bool spin_due, const bool periodical_due) {
+
+  if (spin_due) {
+    if (tick_spin_pending && !tick_task_running) {
+      tick_spin_pending = false;
+      tempManager.spin();
+      #if ENABLED(STEPPER_ISR_PROFILER)
+        isrprofiler.tick_tasks_late++;
+      #endif
+    }
+    else
+      tick_spin_pending = true;
+  }
+
+  if (periodical_due) tick_periodical_pending = true;
+
+  if (tick_task_pending()) HAL_tick_task_request();
+
+}
+
+/**
+ * Deferred half of HAL::Tick: the thermistor math, the PID and the
+ * safety checks of spin() and the periodical actions, out of the Tick
+ * interrupt so that it stays short. A flag is cleared before its job,
+ * an event of a Tick that comes in while it runs is not lost.
+ */
+void Printer::tick_task() {
+
+  if (!tick_task_pending()) return;
+
+  #if ENABLED(STEPPER_ISR_PROFILER)
+    const isr_free_t start = isrprofiler.start_free();
+  #endif
+
+  tick_task_running = true;
+
+  if (tick_spin_pending) {
+    tick_spin_pending = false;
+    tempManager.spin();
+  }
+
+  if (tick_periodical_pending) {
+    tick_periodical_pending = false;
+    check_periodical_actions();
+  }
+
+  tick_task_running = false;
+
+  #if ENABLED(STEPPER_ISR_PROFILER)
+    isrprofiler.stop_free(ISR_PHASE_TICK_TASK, start);
+  #endif
+
+}
+
 void Printer::safe_delay(millis_l time) {
   time += millis();
   while (PENDING(millis(), time)) idle();
@@ -300,6 +366,11 @@ void Printer::minikill(const bool steppers_off/*=false*/) {
     void(*resetFunc)(void) = 0; // Declare resetFunc() at address 0
     resetFunc();                // Jump to address 0
 
+  #elif ENABLED(ARDUINO_ARCH_NATIVE)
+
+    // Nobody can press reset on the host native build
+    HAL::resetHardware();
+
   #else // !HAS_KILL
 
     // Wait for reset
@@ -567,6 +638,11 @@ void Printer::idle(const bool no_stepper_sleep/*=false*/) {
     mmu2.mmu_loop();
   #endif
 
+  // Let the simulated time run on the host native build
+  #if ENABLED(ARDUINO_ARCH_NATIVE)
+    simulator.idle();
+  #endif
+
   watchdog.reset();
 
 }
@@ -827,7 +903,11 @@ void setup() {
   #endif // STRING_REVISION_DATE
 
   SERIAL_SMV(ECHO, STR_FREE_MEMORY, freeMemory());
-  SERIAL_EMV(STR_PLANNER_BUFFER_BYTES, (int)sizeof(block_t)* (BLOCK_BUFFER_SIZE));
+  SERIAL_MV(STR_PLANNER_BUFFER_BYTES, (int)(sizeof(block_t) + sizeof(block_info_t)) * (BLOCK_BUFFER_SIZE));
+  SERIAL_EMV(STR_PLANNER_BLOCK_BYTES, (int)(sizeof(block_t) + sizeof(block_info_t)));
+  #if ENABLED(LASER) && ENABLED(LASER_RASTER)
+    SERIAL_LMV(ECHO, STR_RASTER_POOL_BYTES, LASER_RASTER_POOL_SIZE);
+  #endif
 
   #if HAS_SD_SUPPORT
     SERIAL_RUN(card.mount());
@@ -109,12 +109,21 @@ class Printer {
       static short_timer_t chdk_timer;
     #endif
 
+    // Deferred half of HAL::Tick
+    static volatile bool  tick_spin_pending,
+                          tick_periodical_pending,
+                          tick_task_running;
+
   public: /** Public Function */
 
     static void setup_pinout();
     static void factory_parameters();
 
     static void check_periodical_actions();
+
+    static void tick_events(const bool spin_due, const bool periodical_due);
+    static void tick_task();
+    FORCE_INLINE static bool tick_task_pending() { return tick_spin_pending || tick_periodical_pending; }
     static void safe_delay(millis_l ms);
 
     static void quickstop_stepper();
@@ -118,6 +118,14 @@
 #if DISABLED(BUFSIZE)
   #error "DEPENDENCY ERROR: Missing setting BUFSIZE."
 #endif
+#if ENABLED(GCODE_PREPARSE)
+  #if DISABLED(FASTER_GCODE_PARSER)
+    #error "DEPENDENCY ERROR: GCODE_PREPARSE requires FASTER_GCODE_PARSER."
+  #endif
+  #if MAX_CMD_SIZE > 255
+    #error "DEPENDENCY ERROR: GCODE_PREPARSE requires MAX_CMD_SIZE of 255 or less."
+  #endif
+#endif
 #if ENABLED(SERIAL_XON_XOFF) && RX_BUFFER_SIZE < 1024
   #error "DEPENDENCY ERROR: For SERIAL_XON_XOFF set RX_BUFFER_SIZE to 1024 or more."
 #endif
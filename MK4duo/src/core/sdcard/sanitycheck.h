@@ -36,6 +36,39 @@
   #if DISABLED(SD_FINISHED_RELEASECOMMAND)
     #error "DEPENDENCY ERROR: Missing setting SD_FINISHED_RELEASECOMMAND."
   #endif
+  #if ENABLED(SD_READ_AHEAD)
+    #if DISABLED(SD_READ_AHEAD_SIZE)
+      #error "DEPENDENCY ERROR: Missing setting SD_READ_AHEAD_SIZE is needed by SD_READ_AHEAD."
+    #elif SD_READ_AHEAD_SIZE < 512 || SD_READ_AHEAD_SIZE % 512
+      #error "DEPENDENCY ERROR: SD_READ_AHEAD_SIZE must be a multiple of 512."
+    #endif
+  #endif
+  #if ENABLED(SD_BINARY_JOB) && DISABLED(GCODE_PREPARSE)
+    #error "DEPENDENCY ERROR: SD_BINARY_JOB requires GCODE_PREPARSE."
+  #endif
+  #if ENABLED(SD_WRITE_BEHIND)
+    #if DISABLED(SD_WRITE_BEHIND_SIZE)
+      #error "DEPENDENCY ERROR: Missing setting SD_WRITE_BEHIND_SIZE is needed by SD_WRITE_BEHIND."
+    #elif SD_WRITE_BEHIND_SIZE < 512 || SD_WRITE_BEHIND_SIZE % 512
+      #error "DEPENDENCY ERROR: SD_WRITE_BEHIND_SIZE must be a multiple of 512."
+    #endif
+  #endif
+  #if ENABLED(SD_UPLOAD_RAW)
+    #if DISABLED(SD_WRITE_BEHIND)
+      #error "DEPENDENCY ERROR: SD_UPLOAD_RAW requires SD_WRITE_BEHIND."
+    #elif DISABLED(SD_UPLOAD_RAW_TIMEOUT)
+      #error "DEPENDENCY ERROR: Missing setting SD_UPLOAD_RAW_TIMEOUT is needed by SD_UPLOAD_RAW."
+    #endif
+  #endif
+  #if ENABLED(SD_DIR_INDEX)
+    #if DISABLED(SDCARD_SORT_ALPHA)
+      #error "DEPENDENCY ERROR: SD_DIR_INDEX requires SDCARD_SORT_ALPHA."
+    #elif DISABLED(SD_DIR_INDEX_LIMIT)
+      #error "DEPENDENCY ERROR: Missing setting SD_DIR_INDEX_LIMIT is needed by SD_DIR_INDEX."
+    #elif ENABLED(__AVR__) && SD_DIR_INDEX_LIMIT > 128
+      #error "DEPENDENCY ERROR: SD_DIR_INDEX_LIMIT must be 128 or less on AVR."
+    #endif
+  #endif
 #elif ENABLED(EEPROM_SETTINGS) && ENABLED(EEPROM_SD)
   #error "DEPENDENCY ERROR: You have to enable SDSUPPORT || USB_FLASH_DRIVE_SUPPORT to use EEPROM_SD."
 #endif
@@ -41,6 +41,19 @@ int SDCard::autostart_index = -1;
 uint32_t  SDCard::fileSize  = 0,
           SDCard::sdpos     = 0;
 
+#if ENABLED(SD_READ_AHEAD)
+  Read_Ahead<SdFile, SD_READ_AHEAD_SIZE> SDCard::read_ahead;
+#endif
+
+#if ENABLED(SD_BINARY_JOB)
+  bool SDCard::binary_job = false;
+#endif
+
+#if ENABLED(SD_WRITE_BEHIND)
+  Write_Behind<SdFile, SD_WRITE_BEHIND_SIZE> SDCard::write_behind;
+  millis_l SDCard::upload_start = 0;
+#endif
+
 float SDCard::objectHeight      = 0.0,
       SDCard::firstlayerHeight  = 0.0,
       SDCard::layerHeight       = 0.0,
@@ -103,6 +116,11 @@ LsActionEnum SDCard::lsAction   = LS_Count;
 
   #endif // SDSORT_USES_RAM
 
+  #if ENABLED(SD_DIR_INDEX)
+    SdFile    SDCard::index_file;
+    uint16_t  SDCard::index_count = 0;
+  #endif
+
 #endif // SDCARD_SORT_ALPHA
 
 #if ENABLED(ADVANCED_SD_COMMAND)
@@ -140,6 +158,10 @@ void SDCard::mount() {
 
   if (root.isOpen()) root.close();
 
+  #if ENABLED(SD_RESTART_JOURNAL)
+    restart.journal.reset(0);   // The blocks were of the card before
+  #endif
+
   if (!fat.begin(SS_PIN, SPI_SPEED)
     #if ENABLED(LCD_SDSS) && (LCD_SDSS != SS_PIN)
       && !fat.begin(LCD_SDSS, SPI_SPEED)
@@ -190,6 +212,13 @@ void SDCard::mount() {
 void SDCard::unmount() {
   setMounted(false);
   endFilePrint();
+  #if ENABLED(SD_RESTART_JOURNAL)
+    restart.journal.reset(0);   // No raw write to a card swapped in
+  #endif
+  #if ENABLED(SD_DIR_INDEX)
+    index_file.close();
+    index_count = 0;
+  #endif
 }
 
 void SDCard::ls() {
@@ -231,6 +260,16 @@ void SDCard::manage_sd() {
       }
     }
   }
+
+  #if ENABLED(SD_READ_AHEAD)
+    // Read the next block while the printer has time for it
+    if (isPrinting() && isFileOpen()) read_ahead.refill(gcode_file);
+  #endif
+
+  #if ENABLED(SD_WRITE_BEHIND)
+    // Write the full block of an upload between two lines
+    if (isSaving() && isFileOpen()) write_behind.flush(gcode_file);
+  #endif
 }
 
 void SDCard::getfilename(uint16_t nr, PGM_P const match/*=nullptr*/) {
@@ -290,6 +329,7 @@ void SDCard::startFilePrint() {
 void SDCard::endFilePrint() {
   setPrinting(false);
   if (isFileOpen()) gcode_file.close();
+  commands.reset_sd_line();
 }
 
 void SDCard::write_command(char* buf) {
@@ -305,8 +345,14 @@ void SDCard::write_command(char* buf) {
   end[1] = '\r';
   end[2] = '\n';
   end[3] = '\0';
-  gcode_file.write(begin);
-  if (gcode_file.getWriteError()) {
+  #if ENABLED(SD_WRITE_BEHIND)
+    // Into the buffer, the file gets whole blocks
+    const bool error = !write_behind.write(gcode_file, begin, end + 3 - begin);
+  #else
+    gcode_file.write(begin);
+    const bool error = gcode_file.getWriteError();
+  #endif
+  if (error) {
     SERIAL_LM(ER, STR_SD_ERR_WRITE_TO_FILE);
   }
 }
@@ -326,6 +372,10 @@ void SDCard::startWrite(const char * const path, const bool silent/*=false*/) {
   fat.chdir();
   if (gcode_file.open(path, FILE_WRITE)) {
     setSaving(true);
+    #if ENABLED(SD_WRITE_BEHIND)
+      write_behind.reset();
+      upload_start = millis();
+    #endif
     #if ENABLED(EMERGENCY_PARSER)
       emergency_parser.disable();
     #endif
@@ -358,10 +408,23 @@ void SDCard::deleteFile(const char * const path) {
 }
 
 void SDCard::finishWrite() {
+  #if ENABLED(SD_WRITE_BEHIND)
+    if (!write_behind.finish(gcode_file)) SERIAL_LM(ER, STR_SD_ERR_WRITE_TO_FILE);
+  #endif
   gcode_file.sync();
   gcode_file.close();
   setSaving(false);
+  #if ENABLED(EMERGENCY_PARSER)
+    emergency_parser.enable();
+  #endif
   SERIAL_EM(STR_SD_FILE_SAVED);
+  #if ENABLED(SD_WRITE_BEHIND)
+    const millis_l ms = millis() - upload_start;
+    SERIAL_MV("Upload bytes:", write_behind.bytes);
+    SERIAL_MV(" time:", ms / 1000.0f, 2);
+    SERIAL_MV(" s rate:", ms ? write_behind.bytes / float(ms) : 0.0f, 1);
+    SERIAL_EM(" KB/s");
+  #endif
 }
 
 void SDCard::makeDirectory(const char * const path) {
@@ -377,6 +440,9 @@ void SDCard::makeDirectory(const char * const path) {
 }
 
 void SDCard::closeFile() {
+  #if ENABLED(SD_WRITE_BEHIND)
+    if (isSaving()) write_behind.finish(gcode_file);
+  #endif
   gcode_file.sync();
   gcode_file.close();
   setSaving(false);
@@ -485,6 +551,7 @@ bool SDCard::selectFile(const char * const path, const bool silent/*=false*/) {
 
     fileSize = gcode_file.fileSize();
     sdpos = 0;
+    commands.reset_sd_line();
 
     if (!silent) {
       SERIAL_MT(STR_SD_FILE_OPENED, fname);
@@ -499,6 +566,18 @@ bool SDCard::selectFile(const char * const path, const bool silent/*=false*/) {
       parsejson(gcode_file);
     #endif
 
+    #if ENABLED(SD_BINARY_JOB)
+      // A compiled job starts with its header, a G-code file can't
+      uint8_t header[SD_JOB_HEADER_SIZE];
+      binary_job = gcode_file.read(header, SD_JOB_HEADER_SIZE) == SD_JOB_HEADER_SIZE
+                && !memcmp(header, "MKJB", 4) && header[4] == SD_JOB_VERSION;
+      gcode_file.seekSet(0);
+    #endif
+
+    #if ENABLED(SD_READ_AHEAD)
+      read_ahead.reset(0);
+    #endif
+
     return true;
   }
   else {
@@ -526,6 +605,9 @@ uint16_t SDCard::getnrfilenames() {
 }
 
 uint16_t SDCard::get_num_Files() {
+  #if ENABLED(SD_DIR_INDEX)
+    if (index_file.isOpen()) return index_count;
+  #endif
   return
     #if ENABLED(SDCARD_SORT_ALPHA) && SDSORT_USES_RAM && SDSORT_CACHE_NAMES
       nrFiles // no need to access the SD card for filenames
@@ -566,6 +648,43 @@ uint16_t SDCard::get_num_Files() {
     return exist;
   }
 
+  #if ENABLED(SD_RESTART_JOURNAL)
+
+    /**
+     * First card block of the restart journal, 0 for none. With create
+     * a journal file that is not there, or not of one piece, is made again,
+     * created is true and its blocks have to be erased.
+     */
+    uint32_t SDCard::open_restart_journal(const bool create, bool &created) {
+      constexpr uint32_t size = SD_RESTART_JOURNAL_BLOCKS * 512UL;
+      uint32_t first = 0, last = 0;
+      created = false;
+
+      if (!isMounted()) return 0;
+      restart.job_file.close();
+
+      if (restart.job_file.open(fat.vwd(), restart_file_name, O_READ)) {
+        if (restart.job_file.fileSize() != size || !restart.job_file.contiguousRange(&first, &last)) first = 0;
+        restart.job_file.close();
+      }
+
+      if (!first && create) {
+        delete_restart_file();
+        if (restart.job_file.createContiguous(fat.vwd(), restart_file_name, size)
+          && restart.job_file.contiguousRange(&first, &last)
+        ) created = true;
+        else {
+          first = 0;
+          openFailed(restart_file_name);
+        }
+        restart.job_file.close();
+      }
+
+      return first;
+    }
+
+  #endif
+
 #endif
 
 #if HAS_EEPROM_SD
@@ -600,6 +719,21 @@ uint16_t SDCard::get_num_Files() {
    * Get the name of a file in the current directory by sort-index
    */
   void SDCard::getfilename_sorted(const uint16_t nr) {
+    #if ENABLED(SD_DIR_INDEX)
+      // One entry read from the index, no walk through the directory
+      if (index_file.isOpen() && nr < index_count) {
+        sd_index_entry_t entry;
+        uint16_t n;
+        if (index_file.seekSet(sizeof(sd_index_header_t) + uint32_t(index_count) * sizeof(sd_index_entry_t) + nr * sizeof(uint16_t))
+          && index_file.read(&n, sizeof(n)) == int(sizeof(n))
+          && n < index_count && index_read(index_file, n, entry)
+        ) {
+          strcpy(fileName, entry.name);
+          setFilenameIsDir(entry.is_dir);
+          return;
+        }
+      }
+    #endif
     getfilename(
       #if ENABLED(SDSORT_GCODE)
         sort_alpha &&
@@ -618,6 +752,11 @@ uint16_t SDCard::get_num_Files() {
    */
   void SDCard::presort() {
 
+    #if ENABLED(SD_DIR_INDEX)
+      index_file.close();
+      index_count = 0;
+    #endif
+
     // Sorting may be turned off
     #if ENABLED(SDSORT_GCODE)
       if (!sort_alpha) return;
@@ -626,6 +765,11 @@ uint16_t SDCard::get_num_Files() {
     // Throw away old sort index
     flush_presort();
 
+    #if ENABLED(SD_DIR_INDEX)
+      // The index on the card, sorted here only if it can't be made
+      if (index_update()) return;
+    #endif
+
     // If there are files, sort up to the limit
     uint16_t fileCnt = getnrfilenames();
     if (fileCnt > 0) {
@@ -802,6 +946,224 @@ uint16_t SDCard::get_num_Files() {
     }
   }
 
+  #if ENABLED(SD_DIR_INDEX)
+
+    /**
+     * Open the index of the working directory, made again if the stamp
+     * of the directory or the folder sorting changed.
+     * Return false if there is no index to use: the card is write
+     * protected or the directory has more than SD_DIR_INDEX_LIMIT entries.
+     */
+    bool SDCard::index_update() {
+
+      const int8_t folders =
+        #if ENABLED(SDSORT_GCODE)
+          sort_folders
+        #else
+          FOLDER_SORTING
+        #endif
+      ;
+
+      const uint32_t stamp = index_stamp();
+
+      sd_index_header_t head;
+      SdFile old;
+      const bool has_old = old.open(&workDir, SD_DIR_INDEX_FILE, O_READ)
+                        && old.read(&head, sizeof(head)) == int(sizeof(head))
+                        && !memcmp(head.magic, "MKDX", 4)
+                        && head.version == SD_DIR_INDEX_VERSION
+                        && head.size == sizeof(sd_index_entry_t)
+                        && head.count <= SD_DIR_INDEX_LIMIT;
+
+      if (has_old && head.stamp == stamp && head.folders == folders) {
+        index_file = old;
+        index_count = head.count;
+        return true;
+      }
+
+      // The old order is used only if it was sorted the same way
+      SdFile tmp;
+      const bool done = index_build(tmp, stamp, folders, old, has_old && head.folders == folders ? head.count : 0);
+      old.close();
+      tmp.close();
+
+      if (!done) {
+        SdFile::remove(&workDir, SD_DIR_INDEX_TEMP);
+        return false;
+      }
+
+      SdFile::remove(&workDir, SD_DIR_INDEX_FILE);
+      if (!tmp.open(&workDir, SD_DIR_INDEX_TEMP, O_RDWR) || !tmp.rename(&workDir, SD_DIR_INDEX_FILE)) return false;
+      tmp.close();
+
+      if (!index_file.open(&workDir, SD_DIR_INDEX_FILE, O_READ) || index_file.read(&head, sizeof(head)) != int(sizeof(head))) {
+        index_file.close();
+        return false;
+      }
+      index_count = head.count;
+      return true;
+    }
+
+    /**
+     * Stamp of the working directory: the count of its entries and a CRC
+     * of them, long name parts included. A file added, removed, renamed
+     * or written changes it. The index files are left out.
+     */
+    uint32_t SDCard::index_stamp() {
+      dir_t dir[4];
+      uint16_t crc = 0, count = 0;
+      workDir.rewind();
+      for (;;) {
+        const int n = workDir.read(dir, sizeof(dir));
+        if (n < int(sizeof(dir_t))) break;
+        const uint8_t entries = n / sizeof(dir_t);
+        for (uint8_t i = 0; i < entries; i++) {
+          const dir_t &d = dir[i];
+          if (d.name[0] == DIR_NAME_FREE) return (uint32_t(count) << 16) | crc;
+          if (d.name[0] == DIR_NAME_DELETED || !memcmp(d.name, "MK4INDEX", 8)) continue;
+          if (d.attributes == DIR_ATT_LONG_NAME)
+            crc16(&crc, &d, sizeof(dir_t));
+          else {
+            crc16(&crc, &d, 12);                              // Name and attributes
+            crc16(&crc, (const uint8_t*)&d + 20, 12);         // Cluster, write time and size
+          }
+          count++;
+        }
+      }
+      return (uint32_t(count) << 16) | crc;
+    }
+
+    /**
+     * Write the index to tmp. The entries still in the directory with the
+     * same name keep their place in the old order, the others are put in
+     * place by a binary search. False if the heap has no room for the
+     * tables, the directory is then sorted by presort.
+     */
+    bool SDCard::index_build(SdFile &tmp, const uint32_t stamp, const int8_t folders, SdFile &old, const uint16_t old_count) {
+
+      if (!tmp.open(&workDir, SD_DIR_INDEX_TEMP, O_RDWR | O_CREAT | O_TRUNC)) return false;
+
+      // The entries in directory order, the new place of each old one kept
+      uint16_t * const newpos = (uint16_t*)malloc((old_count + 1) * sizeof(uint16_t));
+      if (!newpos) return false;
+      for (uint16_t j = 0; j < old_count; j++) newpos[j] = 0xFFFF;
+
+      sd_index_entry_t entry, old_entry;
+      memset(&entry, 0, sizeof(entry));
+      uint16_t count = 0, j = 0;
+      if (old_count && !index_read(old, 0, old_entry)) j = old_count;
+
+      bool done = true;
+      SdFile file;
+      workDir.rewind();
+      while (file.openNext(&workDir, O_READ)) {
+        const bool listed = is_listed(file);
+        entry.dir_index = file.dirIndex();
+        entry.is_dir = file.isSubDir();
+        file.close();
+        if (!listed) continue;
+        if (count == SD_DIR_INDEX_LIMIT) { done = false; break; }
+        strncpy(entry.name, tempLongFilename, sizeof(entry.name));
+
+        // Old entries before this one in the directory were removed
+        while (j < old_count && old_entry.dir_index < entry.dir_index)
+          if (++j < old_count && !index_read(old, j, old_entry)) j = old_count;
+        if (j < old_count && old_entry.dir_index == entry.dir_index
+          && old_entry.is_dir == entry.is_dir && !strcmp(old_entry.name, entry.name)
+        ) newpos[j] = count;
+
+        if (!tmp.seekSet(sizeof(sd_index_header_t) + uint32_t(count) * sizeof(entry))
+          || tmp.write(&entry, sizeof(entry)) != int(sizeof(entry))
+        ) { done = false; break; }
+        count++;
+      }
+
+      // Sort key: the folder sorting, then the first characters as strcasecmp sees them
+      uint16_t * const order = done ? (uint16_t*)malloc((count + 1) * sizeof(uint16_t)) : nullptr;
+      uint32_t * const key = order ? (uint32_t*)malloc((count + 1) * sizeof(uint32_t)) : nullptr;
+      uint8_t * const kept = key ? (uint8_t*)malloc((count + 8) >> 3) : nullptr;
+      if (!kept) {
+        free(newpos);
+        free(order);
+        free(key);
+        return false;
+      }
+
+      for (uint16_t i = 0; i < count; i++) {
+        index_read(tmp, i, entry);
+        uint32_t k = (folders != 0 && entry.is_dir == (folders > 0)) ? 1 : 0;   // 1 to come after
+        const char *c = entry.name;
+        for (uint8_t b = 0; b < 3; b++) {
+          k = (k << 8) | uint8_t(tolower(*c));
+          if (*c) c++;
+        }
+        key[i] = k;
+        if (!(i & 7)) kept[i >> 3] = 0;
+      }
+
+      // The kept entries in their old order, read from the old order table
+      uint16_t n = 0;
+      const uint32_t old_order = sizeof(sd_index_header_t) + uint32_t(old_count) * sizeof(sd_index_entry_t);
+      for (uint16_t p = 0; p < old_count; p++) {
+        uint16_t o;
+        if (!old.seekSet(old_order + p * sizeof(o)) || old.read(&o, sizeof(o)) != int(sizeof(o))) break;
+        if (o < old_count && newpos[o] != 0xFFFF) {
+          order[n++] = newpos[o];
+          SBI(kept[newpos[o] >> 3], newpos[o] & 0x07);
+        }
+      }
+      free(newpos);
+
+      // The others put in place
+      for (uint16_t i = 0; i < count; i++) {
+        if (TEST(kept[i >> 3], i & 0x07)) continue;
+        uint16_t lo = 0, hi = n;
+        while (lo < hi) {
+          const uint16_t mid = (lo + hi) >> 1;
+          if (index_compare(tmp, key, order[mid], i) <= 0) lo = mid + 1; else hi = mid;
+        }
+        memmove(&order[lo + 1], &order[lo], (n - lo) * sizeof(uint16_t));
+        order[lo] = i;
+        n++;
+      }
+
+      sd_index_header_t head;
+      memcpy(head.magic, "MKDX", 4);
+      head.version  = SD_DIR_INDEX_VERSION;
+      head.size     = sizeof(sd_index_entry_t);
+      head.count    = count;
+      head.stamp    = stamp;
+      head.folders  = folders;
+      ZERO(head.reserved);
+
+      done = tmp.seekSet(sizeof(head) + uint32_t(count) * sizeof(entry))
+          && tmp.write(order, count * sizeof(uint16_t)) == int(count * sizeof(uint16_t))
+          && tmp.seekSet(0)
+          && tmp.write(&head, sizeof(head)) == int(sizeof(head))
+          && tmp.sync();
+
+      free(order);
+      free(key);
+      free(kept);
+      return done;
+    }
+
+    bool SDCard::index_read(SdFile &file, const uint16_t n, sd_index_entry_t &entry) {
+      return file.seekSet(sizeof(sd_index_header_t) + uint32_t(n) * sizeof(entry))
+          && file.read(&entry, sizeof(entry)) == int(sizeof(entry));
+    }
+
+    // Less than 0 if entry a comes before entry b, the names read only if the keys are the same
+    int SDCard::index_compare(SdFile &file, const uint32_t * const key, const uint16_t a, const uint16_t b) {
+      if (key[a] != key[b]) return key[a] < key[b] ? -1 : 1;
+      sd_index_entry_t ea, eb;
+      index_read(file, a, ea);
+      index_read(file, b, eb);
+      return strcasecmp(ea.name, eb.name);
+    }
+
+  #endif // SD_DIR_INDEX
+
 #endif // SDCARD_SORT_ALPHA
 
 #if ENABLED(ADVANCED_SD_COMMAND)
@@ -903,6 +1265,12 @@ void SDCard::lsRecursive(FatFile *dir, uint8_t level/*=0*/) {
       file.close();
       continue; // MAC CRAP
     }
+    #if ENABLED(SD_DIR_INDEX)
+      if (is_index_name(tempLongFilename)) {
+        file.close();
+        continue;
+      }
+    #endif
     if (file.isDir()) {
       if (level >= SD_MAX_FOLDER_DEPTH) {
         file.close();
@@ -944,6 +1312,20 @@ void SDCard::lsRecursive(FatFile *dir, uint8_t level/*=0*/) {
 
 }
 
+/**
+ * Get the name of an entry in tempLongFilename and
+ * return true if it is listed by lsDive.
+ */
+bool SDCard::is_listed(SdFile &file) {
+  file.getName(tempLongFilename, LONG_FILENAME_LENGTH);
+  if (workDirDepth >= SD_MAX_FOLDER_DEPTH && strcmp(tempLongFilename, "..") == 0) return false;
+  if (tempLongFilename[0] == '.' && tempLongFilename[1] != '.') return false; // MAC CRAP
+  #if ENABLED(SD_DIR_INDEX)
+    if (is_index_name(tempLongFilename)) return false;
+  #endif
+  return (file.isFile() || file.isSubDir()) && !file.isHidden();
+}
+
 /**
  * Dive into a folder and recurse depth-first to perform a pre-set operation lsAction:
  *   LS_Count       - Add +1 to nrFiles for every file within the parent
@@ -957,18 +1339,8 @@ void SDCard::lsDive(SdFile parent, PGM_P const match/*=NULL*/) {
 
   // Read the next entry from a directory
   while (file.openNext(&parent, O_READ)) {
-    file.getName(tempLongFilename, LONG_FILENAME_LENGTH);
-
-    if (workDirDepth >= SD_MAX_FOLDER_DEPTH && strcmp(tempLongFilename, "..") == 0) {
-      file.close();
-      continue;
-    }
-    if (tempLongFilename[0] == '.' && tempLongFilename[1] != '.') {
-      file.close();
-      continue; // MAC CRAP
-    }
 
-    if (!(file.isFile() || file.isSubDir()) || file.isHidden()) {
+    if (!is_listed(file)) {
       file.close();
       continue;
     }
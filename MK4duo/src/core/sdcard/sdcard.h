@@ -29,6 +29,54 @@
   #error "Update SDFAT library to 1.1.1 or newer."
 #endif
 
+#if ENABLED(SD_BINARY_JOB)
+  /**
+   * Compiled job, a G-code file turned into records by scripts/gcodejob.py.
+   * Header of 8 bytes, "MKJB", the version and 3 bytes to 0, then the records:
+   *  - A move, G0 or G1 with values for X Y Z E F only:
+   *    1 byte 0x80 | 0x20 for G1 | a bit for each value (bit 0 X, Y Z E, bit 4 F),
+   *    then the values as 4 byte floats, little endian, in that order.
+   *  - Any other command:
+   *    1 byte with the length of the line, 1 to 127, then the line with no
+   *    comments, no line number and no end of line.
+   * A record starts where the one before it ends, M24 S and the restart
+   * job resume at the offset of a record.
+   */
+  #define SD_JOB_HEADER_SIZE  8
+  #define SD_JOB_VERSION      1
+  #define SD_JOB_MOVE         0x80
+  #define SD_JOB_G1           0x20
+  #define SD_JOB_VALUES       0x1F
+#endif
+
+#if ENABLED(SD_DIR_INDEX)
+  /**
+   * Directory index, a file in each directory the LCD lists: the header,
+   * the entries in directory order, then the sorted order as the entry
+   * number for each place. Made again by presort() when the stamp of the
+   * directory changes.
+   */
+  #define SD_DIR_INDEX_FILE     "MK4INDEX.DAT"
+  #define SD_DIR_INDEX_TEMP     "MK4INDEX.TMP"
+  #define SD_DIR_INDEX_VERSION  1
+
+  struct sd_index_header_t {
+    char      magic[4];                   // "MKDX"
+    uint8_t   version,
+              size;                       // Of an entry
+    uint16_t  count;                      // Entries
+    uint32_t  stamp;                      // Of the directory, see SDCard::index_stamp()
+    int8_t    folders;                    // Folder sorting of the order
+    uint8_t   reserved[3];
+  };
+
+  struct sd_index_entry_t {
+    uint16_t  dir_index;                  // Place of the file in the directory
+    bool      is_dir;
+    char      name[LONG_FILENAME_LENGTH];
+  };
+#endif
+
 union flagcard_t {
   uint8_t all;
   struct {
@@ -65,6 +113,19 @@ class SDCard {
     static uint32_t fileSize,
                     sdpos;
 
+    #if ENABLED(SD_READ_AHEAD)
+      static Read_Ahead<SdFile, SD_READ_AHEAD_SIZE> read_ahead;
+    #endif
+
+    #if ENABLED(SD_BINARY_JOB)
+      static bool binary_job;   // The file selected is a compiled job
+    #endif
+
+    #if ENABLED(SD_WRITE_BEHIND)
+      static Write_Behind<SdFile, SD_WRITE_BEHIND_SIZE> write_behind;
+      static millis_l upload_start;   // millis() at M28, for the upload rate
+    #endif
+
     static float  objectHeight,
                   firstlayerHeight,
                   layerHeight,
@@ -134,6 +195,11 @@ class SDCard {
 
       #endif // SDSORT_USES_RAM
 
+      #if ENABLED(SD_DIR_INDEX)
+        static SdFile   index_file;       // Index of workDir, open when it can be used
+        static uint16_t index_count;      // Entries in the index
+      #endif
+
     #endif // SDCARD_SORT_ALPHA
 
     #if ENABLED(ADVANCED_SD_COMMAND)
@@ -210,6 +276,9 @@ class SDCard {
       static void open_restart_file(const bool read);
       static void delete_restart_file();
       static bool exist_restart_file();
+      #if ENABLED(SD_RESTART_JOURNAL)
+        static uint32_t open_restart_journal(const bool create, bool &created);
+      #endif
     #endif
 
     #if HAS_EEPROM_SD
@@ -257,12 +326,58 @@ class SDCard {
     FORCE_INLINE static void setFilenameIsDir(const bool onoff) { flag.FilenameIsDir = onoff; }
     FORCE_INLINE static bool isFilenameIsDir() { return flag.FilenameIsDir; }
 
+    #if ENABLED(SD_DIR_INDEX)
+      // The index and its temp file are left out of the listings
+      static inline bool is_index_name(const char * const name) { return !strncasecmp(name, "MK4INDEX.", 9); }
+    #endif
+
     static inline void pauseSDPrint() { setPrinting(false); }
     static inline bool isFileOpen()   { return isMounted() && gcode_file.isOpen(); }
     static inline bool isPaused()     { return isFileOpen() && !isPrinting(); }
-    static inline void setIndex(uint32_t newpos) { sdpos = newpos; gcode_file.seekSet(sdpos); }
     static inline uint32_t getIndex() { return sdpos; }
     static inline bool eof() { return sdpos >= fileSize; }
+
+    #if ENABLED(SD_READ_AHEAD)
+
+      static inline void setIndex(uint32_t newpos) { sdpos = newpos; gcode_file.seekSet(sdpos); read_ahead.reset(sdpos); }
+
+      /**
+       * The bytes of the file up to the next line end, see Read_Ahead::line().
+       * sdpos is on the line end, as get() leaves it, or after the bytes.
+       */
+      static inline uint16_t get_line(const char* &p, bool &eol) {
+        const uint16_t n = read_ahead.line(gcode_file, p, eol);
+        sdpos = read_ahead.position() - (eol ? 1 : 0);
+        return n;
+      }
+
+      static inline bool read_error() { return read_ahead.isError(); }
+
+    #else
+
+      static inline void setIndex(uint32_t newpos) { sdpos = newpos; gcode_file.seekSet(sdpos); }
+
+    #endif
+
+    #if ENABLED(SD_BINARY_JOB)
+
+      /**
+       * The next nbyte bytes of a compiled job, sdpos after them.
+       * Return false at the end of the file or on a read error.
+       */
+      static inline bool get_bytes(void * const buf, const uint16_t nbyte) {
+        #if ENABLED(SD_READ_AHEAD)
+          const bool done = read_ahead.read(gcode_file, buf, nbyte) == nbyte;
+          sdpos = read_ahead.position();
+        #else
+          const bool done = gcode_file.read(buf, nbyte) == nbyte;
+          sdpos = gcode_file.curPosition();
+        #endif
+        return done;
+      }
+
+    #endif
+
     static inline int16_t get() { sdpos = gcode_file.curPosition(); return (int16_t)gcode_file.read(); }
     static inline uint8_t percentDone() { return (isFileOpen() && fileSize) ? sdpos / ((fileSize + 99) / 100) : 0; }
     static inline void getWorkDirName() { workDir.getName(fileName, LONG_FILENAME_LENGTH); }
@@ -288,8 +403,17 @@ class SDCard {
     static bool findFilamentNeed(char* buf, float &filament);
     static bool findTotalHeight(char* buf, float &objectHeight);
 
+    static bool is_listed(SdFile &file);
+
     #if ENABLED(SDCARD_SORT_ALPHA)
       static void flush_presort();
+      #if ENABLED(SD_DIR_INDEX)
+        static bool index_update();
+        static uint32_t index_stamp();
+        static bool index_build(SdFile &tmp, const uint32_t stamp, const int8_t folders, SdFile &old, const uint16_t old_count);
+        static bool index_read(SdFile &file, const uint16_t n, sd_index_entry_t &entry);
+        static int index_compare(SdFile &file, const uint32_t * const key, const uint16_t a, const uint16_t b);
+      #endif
     #endif
 
     #if ENABLED(ADVANCED_SD_COMMAND)
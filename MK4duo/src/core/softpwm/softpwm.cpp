@@ -0,0 +1,64 @@
+/**
+ * MK4duo Firmware for 3D Printer, Laser and CNC
+ *
+ * Based on Marlin, Sprinter and grbl
+ * Copyright (c) 2011 Camiel Gubbels / Erik van der Zalm
+ * Copyright (c) 2020 Alberto Cotronei @MagoKimbra
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+/**
+ * softpwm.cpp
+ *
+ * Copyright (c) 2020 Alberto Cotronei @MagoKimbra
+ */
+
+#include "../../../MK4duo.h"
+#include "sanitycheck.h"
+
+#if ENABLED(SOFT_PWM_PORT_WRITE)
+
+SoftPwm softpwm;
+
+/** Private Parameters */
+fastio_mask_t SoftPwm::port_set[FASTIO_PORTS]   = { 0 },
+              SoftPwm::port_clear[FASTIO_PORTS] = { 0 };
+
+uint16_t      SoftPwm::ports_used = 0;
+
+/** Public Function */
+void SoftPwm::set_pin(softpwm_pin_t &out, const pin_t pin) {
+  softpwm_pin_t made;
+  made.pin  = pin;
+  made.port = FASTIO_PORT(pin);
+  made.mask = made.port < FASTIO_PORTS ? FASTIO_PORT_MASK(pin) : 0;
+  // The Tick ISR writes the output, it never sees a port with the mask of another
+  CRITICAL_SECTION_START();
+  out = made;
+  CRITICAL_SECTION_END();
+}
+
+void SoftPwm::flush() {
+  for (uint8_t p = 0; ports_used; p++) {
+    if (TEST(ports_used, p)) {
+      FASTIO_PORT_WRITE(p, port_set[p], port_clear[p]);
+      port_set[p] = port_clear[p] = 0;
+      CBI(ports_used, p);
+    }
+  }
+}
+
+#endif // ENABLED(SOFT_PWM_PORT_WRITE)
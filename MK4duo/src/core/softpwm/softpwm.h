@@ -0,0 +1,83 @@
+/**
+ * MK4duo Firmware for 3D Printer, Laser and CNC
+ *
+ * Based on Marlin, Sprinter and grbl
+ * Copyright (c) 2011 Camiel Gubbels / Erik van der Zalm
+ * Copyright (c) 2020 Alberto Cotronei @MagoKimbra
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#pragma once
+
+/**
+ * softpwm.h
+ *
+ * Copyright (c) 2020 Alberto Cotronei @MagoKimbra
+ */
+
+#if ENABLED(SOFT_PWM_PORT_WRITE)
+
+// Port and mask of a soft PWM output, made when its pin is set
+struct softpwm_pin_t {
+  pin_t         pin;
+  uint8_t       port;     // FASTIO_PORTS for a pin not on a port, written by HAL::digitalWrite
+  fastio_mask_t mask;
+};
+
+class SoftPwm {
+
+  public: /** Constructor */
+
+    SoftPwm() {}
+
+  private: /** Private Parameters */
+
+    static fastio_mask_t  port_set[FASTIO_PORTS],
+                          port_clear[FASTIO_PORTS];
+
+    static uint16_t       ports_used;
+
+  public: /** Public Function */
+
+    /**
+     * Make the port and mask of a pin, set in one go for the Tick ISR
+     */
+    static void set_pin(softpwm_pin_t &out, const pin_t pin);
+
+    /**
+     * Level of an output in this Tick, written by flush()
+     */
+    FORCE_INLINE static void write(const softpwm_pin_t &out, const bool level) {
+      if (out.port < FASTIO_PORTS) {
+        if (level)
+          port_set[out.port] |= out.mask;
+        else
+          port_clear[out.port] |= out.mask;
+        SBI(ports_used, out.port);
+      }
+      else if (out.pin > NoPin)
+        HAL::digitalWrite(out.pin, level);
+    }
+
+    /**
+     * Write the levels of the Tick, one write for each port
+     */
+    static void flush();
+
+};
+
+extern SoftPwm softpwm;
+
+#endif // ENABLED(SOFT_PWM_PORT_WRITE)
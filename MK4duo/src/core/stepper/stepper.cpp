@@ -133,6 +133,10 @@ uint32_t      Stepper::advance_divisor        = 0,
 uint8_t       Stepper::active_extruder        = 0,
               Stepper::active_extruder_driver = 0;
 
+#if ENABLED(INPUT_SHAPING)
+  uint8_t     Stepper::shaping_bits           = 0;
+#endif
+
 #if ENABLED(BEZIER_JERK_CONTROL)
   int32_t __attribute__((used))   Stepper::bezier_A __asm__("bezier_A");      //  A coefficient in Bézier speed curve with alias for assembler
   int32_t __attribute__((used))   Stepper::bezier_B __asm__("bezier_B");      //  B coefficient in Bézier speed curve with alias for assembler
@@ -156,7 +160,7 @@ uint8_t       Stepper::active_extruder        = 0,
 #endif // LIN_ADVANCE
 
 int32_t Stepper::ticks_nominal = -1;
-#if DISABLED(BEZIER_JERK_CONTROL)
+#if DISABLED(BEZIER_JERK_CONTROL) && DISABLED(S_CURVE_JERK_CONTROL)
   uint32_t Stepper::acc_step_rate = 0; // needed for deceleration start point
 #endif
 
@@ -167,7 +171,8 @@ xyze_int8_t Stepper::count_direction{0};
 #if ENABLED(LASER)
   int32_t Stepper::delta_error_laser = 0;
   #if ENABLED(LASER_RASTER)
-    int Stepper::counter_raster = 0;
+    raster_index_t Stepper::counter_raster = 0,
+                   Stepper::raster_end     = 0;
   #endif // LASER_RASTER
 #endif // LASER
 
@@ -284,6 +289,10 @@ void Stepper::init() {
     microstep_init();
   #endif
 
+  #if ENABLED(STEPPER_ISR_PROFILER)
+    isrprofiler.init();
+  #endif
+
   // Init Stepper ISR
   START_STEPPER_INTERRUPT();
   wake_up();
@@ -357,15 +366,51 @@ void Stepper::Step() {
     // Enable ISRs to reduce USART processing latency
     ENABLE_ISRS();
 
-    // Run main stepping pulse phase ISR if we have to
-    if (!nextMainISR) pulse_phase_step();                       // 0 = Do coordinated axes Stepper pulses
+    #if ENABLED(STEPPER_ISR_PROFILER)
+
+      if (!nextMainISR) {
+        const hal_cycle_t start = isrprofiler.start();
+        pulse_phase_step();
+        isrprofiler.stop(ISR_PHASE_PULSE, start);
+      }
+
+      #if ENABLED(LIN_ADVANCE)
+        if (!nextAdvanceISR) {
+          const hal_cycle_t start = isrprofiler.start();
+          nextAdvanceISR = lin_advance_step();
+          isrprofiler.stop(ISR_PHASE_ADVANCE, start);
+        }
+      #endif
+
+      if (!nextMainISR) {
+        const hal_cycle_t start = isrprofiler.start();
+        nextMainISR = block_phase_step();
+        isrprofiler.stop(ISR_PHASE_BLOCK, start);
+      }
+
+    #else
+
+      // Run main stepping pulse phase ISR if we have to
+      if (!nextMainISR) pulse_phase_step();                       // 0 = Do coordinated axes Stepper pulses
+
+      #if ENABLED(LIN_ADVANCE)
+        // Run linear advance stepper ISR
+        if (!nextAdvanceISR) nextAdvanceISR = lin_advance_step(); // 0 = Do Linear Advance E Stepper pulses
+      #endif
+
+      if (!nextMainISR) nextMainISR = block_phase_step();         // Manage acc/deceleration, get next block
 
-    #if ENABLED(LIN_ADVANCE)
-      // Run linear advance stepper ISR
-      if (!nextAdvanceISR) nextAdvanceISR = lin_advance_step(); // 0 = Do Linear Advance E Stepper pulses
     #endif
 
-    if (!nextMainISR) nextMainISR = block_phase_step();         // Manage acc/deceleration, get next block
+    #if ENABLED(INPUT_SHAPING)
+      #if ENABLED(STEPPER_ISR_PROFILER)
+        const hal_cycle_t start = isrprofiler.start();
+        const uint32_t nextShapingISR = shaping_step();
+        isrprofiler.stop(ISR_PHASE_SHAPING, start);
+      #else
+        const uint32_t nextShapingISR = shaping_step();         // Delayed impulses of the shaped axes
+      #endif
+    #endif
 
     #if ENABLED(LIN_ADVANCE)
       uint32_t interval = MIN(nextAdvanceISR, nextMainISR);     // Nearest time interval
@@ -373,6 +418,10 @@ void Stepper::Step() {
       uint32_t interval = nextMainISR;                          // Remaining stepper ISR time
     #endif
 
+    #if ENABLED(INPUT_SHAPING)
+      NOMORE(interval, nextShapingISR);
+    #endif
+
     // Limit the value to the maximum possible value of the timer
     NOMORE(interval, uint32_t(HAL_TIMER_TYPE_MAX));
 
@@ -415,6 +464,10 @@ void Stepper::Step() {
     // Compute the tick count for the next ISR
     next_isr_ticks += interval;
 
+    #if ENABLED(INPUT_SHAPING)
+      inputshaper.clock += interval;
+    #endif
+
     /**
      * The following section must be done with global interrupts disabled.
      * We want nothing to interrupt it, as that could mess the calculations
@@ -439,7 +492,12 @@ void Stepper::Step() {
      * loop to 10 iterations. Beyond that, there's no way to ensure correct pulse
      * timing, since the MCU isn't fast enough.
      */
-    if (!--max_loops) next_isr_ticks = min_ticks;
+    if (!--max_loops) {
+      next_isr_ticks = min_ticks;
+      #if ENABLED(STEPPER_ISR_PROFILER)
+        isrprofiler.loops_exhausted++;
+      #endif
+    }
 
     // Advance pulses if not enough time to wait for the next ISR
   } while (next_isr_ticks < min_ticks);
@@ -578,6 +636,11 @@ void Stepper::set_directions(const bool init/*=false*/) {
   direction_delay();
 
   #if HAS_X_DIR
+    #if ENABLED(INPUT_SHAPING)
+      if (TEST(shaping_bits, X_AXIS))
+        count_direction.x = motor_direction(X_AXIS) ? -1 : 1;
+      else
+    #endif
     if (motor_direction(X_AXIS)) {
       set_X_dir(driver.x->isDir());
       count_direction.x = -1;
@@ -589,6 +652,11 @@ void Stepper::set_directions(const bool init/*=false*/) {
   #endif
 
   #if HAS_Y_DIR
+    #if ENABLED(INPUT_SHAPING)
+      if (TEST(shaping_bits, Y_AXIS))
+        count_direction.y = motor_direction(Y_AXIS) ? -1 : 1;
+      else
+    #endif
     if (motor_direction(Y_AXIS)) {
       set_Y_dir(driver.y->isDir());
       count_direction.y = -1;
@@ -1460,10 +1528,10 @@ void Stepper::pulse_phase_step() {
         if (current_block->laser_mode == PULSED && current_block->laser_status == LASER_ON) // Pulsed Firing Mode
           laser.fire(current_block->laser_intensity);
         #if ENABLED(LASER_RASTER)
-          if (current_block->laser_mode == RASTER && current_block->laser_status == LASER_ON) { // Raster Firing Mode
+          if (current_block->laser_mode == RASTER && current_block->laser_status == LASER_ON && counter_raster < raster_end) { // Raster Firing Mode
             // For some reason, when comparing raster power to ppm line burns the rasters were around 2% more powerful
             // going from darkened paper to burning through paper.
-            laser.fire(current_block->laser_raster_data[counter_raster]);
+            laser.fire(rasterpool.data[counter_raster]);
             counter_raster++;
           }
         #endif // LASER_RASTER
@@ -1481,8 +1549,40 @@ void Stepper::pulse_phase_step() {
 
   } while (--events_to_do);
 
+  #if ENABLED(INPUT_SHAPING)
+    if (shaping_bits) inputshaper.push();
+  #endif
+
 }
 
+#if ENABLED(S_CURVE_JERK_CONTROL)
+
+  /**
+   * Speed change reached 'time' STEP timer counts into a jerk limited
+   * speed change of 'delta_rate' steps/s, worked out by the planner:
+   *
+   *   jerk up:      jerk * t^2 / 2
+   *   constant:     jerk_delta + accel * (t - jerk_time)
+   *   jerk down:    delta_rate - jerk * (time - t)^2 / 2
+   *
+   * jerk * t is scaled like acceleration_rate, so the squares are just
+   * two HAL_MULTI_ACC in a row.
+   */
+  FORCE_INLINE uint32_t Stepper::_eval_s_curve(const s_curve_t &curve, const uint32_t time, const uint32_t delta_rate) {
+    if (time < curve.jerk_time)
+      return HAL_MULTI_ACC(time, HAL_MULTI_ACC(time, curve.jerk_rate)) >> 1;
+    if (time < curve.time - curve.jerk_time)
+      return curve.jerk_delta + HAL_MULTI_ACC(time - curve.jerk_time, curve.accel_rate);
+    if (time < curve.time) {
+      const uint32_t left = curve.time - time,
+                     rate = HAL_MULTI_ACC(left, HAL_MULTI_ACC(left, curve.jerk_rate)) >> 1;
+      return rate < delta_rate ? delta_rate - rate : 0;
+    }
+    return delta_rate;
+  }
+
+#endif // S_CURVE_JERK_CONTROL
+
 uint32_t Stepper::block_phase_step() {
 
   // If no queued movements, just wait 1ms for the next block
@@ -1516,6 +1616,10 @@ uint32_t Stepper::block_phase_step() {
             acceleration_time < current_block->acceleration_time
               ? _eval_bezier_curve(acceleration_time)
               : current_block->cruise_rate;
+        #elif ENABLED(S_CURVE_JERK_CONTROL)
+          // Get the next speed to use (Jerk limited!)
+          const uint32_t acc_step_rate = current_block->initial_rate
+            + _eval_s_curve(current_block->accel_curve, acceleration_time, current_block->cruise_rate - current_block->initial_rate);
         #else
           acc_step_rate = HAL_MULTI_ACC(acceleration_time, current_block->acceleration_rate) + current_block->initial_rate;
           NOMORE(acc_step_rate, current_block->nominal_rate);
@@ -1553,6 +1657,10 @@ uint32_t Stepper::block_phase_step() {
               ? _eval_bezier_curve(deceleration_time)
               : current_block->final_rate;
           }
+        #elif ENABLED(S_CURVE_JERK_CONTROL)
+          // Calculate the next speed to use (Jerk limited!)
+          step_rate = current_block->cruise_rate
+            - _eval_s_curve(current_block->decel_curve, deceleration_time, current_block->cruise_rate - current_block->final_rate);
         #else
 
           // Using the old trapezoidal control
@@ -1607,6 +1715,17 @@ uint32_t Stepper::block_phase_step() {
   // and prepare its movement
   if (!current_block) {
 
+    #if ENABLED(INPUT_SHAPING)
+      // Homing and probing moves are not shaped: wait for the delayed impulses to end first
+      const uint8_t new_shaping_bits = (!endstops.isEnabled() || endstops.isGlobally()) ? inputshaper.axis_bits : 0;
+      if (new_shaping_bits != shaping_bits) {
+        if (inputshaper.busy()) return interval;
+        shaping_bits = new_shaping_bits;
+        LOOP_L_N(a, INPUT_SHAPING_AXES) inputshaper.axis[a].direction = 0;
+        set_directions();
+      }
+    #endif
+
     // Anything in the buffer?
     if ((current_block = planner.get_current_block())) {
 
@@ -1621,7 +1740,7 @@ uint32_t Stepper::block_phase_step() {
       }
 
       #if HAS_SD_RESTART
-        restart.job_info.sdpos = current_block->sdpos;
+        restart.job_info.sdpos = planner.get_block_info(current_block)->sdpos;
       #endif
 
       // Flag all moving axes for proper endstop handling
@@ -1737,7 +1856,7 @@ uint32_t Stepper::block_phase_step() {
       decelerate_after = current_block->decelerate_after << oversampling;
 
       #if ENABLED(COLOR_MIXING_EXTRUDER)
-        mixer.stepper_setup(current_block->b_color);
+        mixer.stepper_setup(planner.get_block_info(current_block)->b_color);
       #endif
 
       #if MAX_EXTRUDER > 1
@@ -1801,18 +1920,22 @@ uint32_t Stepper::block_phase_step() {
       // Mark the time_nominal as not calculated yet
       ticks_nominal = -1;
 
-      #if DISABLED(BEZIER_JERK_CONTROL)
-        // Set as deceleration point the initial rate of the block
-        acc_step_rate = current_block->initial_rate;
-      #else
+      #if ENABLED(BEZIER_JERK_CONTROL)
         // Initialize the Bézier speed curve
         _calc_bezier_curve_coeffs(current_block->initial_rate, current_block->cruise_rate, current_block->acceleration_time_inverse);
         // We haven't started the 2nd half of the trapezoid
         bezier_2nd_half = false;
+      #elif DISABLED(S_CURVE_JERK_CONTROL)
+        // Set as deceleration point the initial rate of the block
+        acc_step_rate = current_block->initial_rate;
       #endif
 
       #if ENABLED(LASER) && ENABLED(LASER_RASTER)
-         if (current_block->laser_mode == RASTER) counter_raster = 0;
+        if (current_block->laser_mode == RASTER) {
+          const block_info_t * const info = planner.get_block_info(current_block);
+          counter_raster = info->raster_index;
+          raster_end = info->raster_index + info->raster_length;
+        }
       #endif
 
       // Calculate the initial timer interval
@@ -1822,11 +1945,13 @@ uint32_t Stepper::block_phase_step() {
 
   // Continuous firing of the laser during a move happens here, PPM and raster happen further down
   #if ENABLED(LASER)
-    if (current_block->laser_mode == CONTINUOUS && current_block->laser_status == LASER_ON)
-      laser.fire(current_block->laser_intensity);
+    if (current_block) {
+      if (current_block->laser_mode == CONTINUOUS && current_block->laser_status == LASER_ON)
+        laser.fire(current_block->laser_intensity);
 
-    if (current_block->laser_status == LASER_OFF)
-      laser.extinguish();
+      if (current_block->laser_status == LASER_OFF)
+        laser.extinguish();
+    }
   #endif
 
   // Return the interval to wait
@@ -1841,6 +1966,10 @@ FORCE_INLINE void Stepper::pulse_tick_prepare() {
     if (step_needed.x) {
       count_position.x += count_direction.x;
       delta_error.x -= advance_divisor;
+      #if ENABLED(INPUT_SHAPING)
+        if (TEST(shaping_bits, X_AXIS))
+          step_needed.x = shaping_dir(X_AXIS, inputshaper.move(X_AXIS, count_direction.x));
+      #endif
     }
   #endif
 
@@ -1850,6 +1979,10 @@ FORCE_INLINE void Stepper::pulse_tick_prepare() {
     if (step_needed.y) {
       count_position.y += count_direction.y;
       delta_error.y -= advance_divisor;
+      #if ENABLED(INPUT_SHAPING)
+        if (TEST(shaping_bits, Y_AXIS))
+          step_needed.y = shaping_dir(Y_AXIS, inputshaper.move(Y_AXIS, count_direction.y));
+      #endif
     }
   #endif
 
@@ -1934,6 +2067,79 @@ FORCE_INLINE void Stepper::pulse_tick_stop() {
 
 }
 
+#if ENABLED(INPUT_SHAPING)
+
+  /**
+   * Output the delayed impulses of the shaped axes that are due
+   * and return the ticks to the next one.
+   */
+  uint32_t Stepper::shaping_step() {
+
+    const uint32_t interval = inputshaper.collect();
+
+    int16_t steps_x = inputshaper.take(X_AXIS),
+            steps_y = inputshaper.take(Y_AXIS);
+
+    if (!steps_x && !steps_y) return interval;
+
+    if (steps_x) shaping_dir(X_AXIS, steps_x > 0 ? 1 : -1);
+    if (steps_y) shaping_dir(Y_AXIS, steps_y > 0 ? 1 : -1);
+
+    steps_x = ABS(steps_x);
+    steps_y = ABS(steps_y);
+
+    hal_timer_t pulse_tick_end;
+
+    for (;;) {
+
+      #if HAS_X_STEP
+        if (steps_x) start_X_step();
+      #endif
+      #if HAS_Y_STEP
+        if (steps_y) start_Y_step();
+      #endif
+
+      pulse_tick_end = HAL_timer_get_current_count(STEPPER_TIMER_NUM) + HAL_pulse_high_tick;
+      while (HAL_timer_get_current_count(STEPPER_TIMER_NUM) < pulse_tick_end) { /* nada */ }
+
+      #if HAS_X_STEP
+        if (steps_x) { stop_X_step(); steps_x--; }
+      #endif
+      #if HAS_Y_STEP
+        if (steps_y) { stop_Y_step(); steps_y--; }
+      #endif
+
+      if (!steps_x && !steps_y) break;
+
+      pulse_tick_end = HAL_timer_get_current_count(STEPPER_TIMER_NUM) + HAL_pulse_low_tick;
+      while (HAL_timer_get_current_count(STEPPER_TIMER_NUM) < pulse_tick_end) { /* nada */ }
+    }
+
+    return interval;
+  }
+
+  /**
+   * Set the DIR pin of a shaped axis for a step in the given direction.
+   * Return true if there is a step to do.
+   */
+  FORCE_INLINE bool Stepper::shaping_dir(const AxisEnum axis, const int8_t dir) {
+    if (!dir) return false;
+    int8_t &last = inputshaper.axis[axis].direction;
+    if (dir != last) {
+      direction_delay();
+      switch (axis) {
+        case X_AXIS: set_X_dir(dir < 0 ? driver.x->isDir() : !driver.x->isDir()); break;
+        case Y_AXIS: set_Y_dir(dir < 0 ? driver.y->isDir() : !driver.y->isDir()); break;
+        default: break;
+      }
+      direction_delay();
+      last = dir;
+    }
+    return true;
+  }
+
+#endif // ENABLED(INPUT_SHAPING)
+
 /**
  * Start X Y Z Step
  */
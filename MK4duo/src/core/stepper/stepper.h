@@ -125,6 +125,10 @@ class Stepper {
       static bool bezier_2nd_half;  // If Bzier curve has been initialized or not
     #endif
 
+    #if ENABLED(INPUT_SHAPING)
+      static uint8_t shaping_bits;  // Axes shaped in the current block
+    #endif
+
     #if ENABLED(LIN_ADVANCE)
       static constexpr uint32_t LA_ADV_NEVER = 0xFFFFFFFF;
       static uint32_t nextAdvanceISR, LA_isr_rate;
@@ -134,7 +138,7 @@ class Stepper {
     #endif
 
     static int32_t ticks_nominal;
-    #if DISABLED(BEZIER_JERK_CONTROL)
+    #if DISABLED(BEZIER_JERK_CONTROL) && DISABLED(S_CURVE_JERK_CONTROL)
       static uint32_t acc_step_rate; // needed for deceleration start point
     #endif
 
@@ -160,7 +164,7 @@ class Stepper {
     #if ENABLED(LASER)
       static int32_t delta_error_laser;
       #if ENABLED(LASER_RASTER)
-        static int counter_raster;
+        static raster_index_t counter_raster, raster_end;
       #endif
     #endif
 
@@ -438,6 +442,12 @@ class Stepper {
       static uint8_t get_active_extruder_driver();
     #endif
 
+    #if ENABLED(INPUT_SHAPING)
+      // The delayed impulses of the shaped axes
+      static uint32_t shaping_step();
+      FORCE_INLINE static bool shaping_dir(const AxisEnum axis, const int8_t dir);
+    #endif
+
     #if ENABLED(LIN_ADVANCE)
       // The Linear advance stepper Step
       static uint32_t lin_advance_step();
@@ -449,6 +459,10 @@ class Stepper {
       static int32_t _eval_bezier_curve(const uint32_t curr_step);
     #endif
 
+    #if ENABLED(S_CURVE_JERK_CONTROL)
+      FORCE_INLINE static uint32_t _eval_s_curve(const s_curve_t &curve, const uint32_t time, const uint32_t delta_rate);
+    #endif
+
     #if HAS_DIGIPOTSS || HAS_MOTOR_CURRENT_PWM
       static void digipot_init();
     #endif
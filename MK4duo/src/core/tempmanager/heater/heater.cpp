@@ -46,6 +46,14 @@ void Heater::init() {
   // Reset valor
   pwm_value             = 0;
   pwm_soft_pos          = 0;
+  #if ENABLED(POWER_BUDGET)
+    pwm_request         = 0;
+    budget              = heater_budget_t();
+    #if DISABLED(SOFTWARE_PDM)
+      pwm_soft_phase      = 0;
+      pwm_soft_phase_next = 0;
+    #endif
+  #endif
   consecutive_low_temp  = 0;
   target_temperature    = 0;
   idle_temperature      = 0;
@@ -65,7 +73,8 @@ void Heater::init() {
 
   thermal_runaway_state = TRInactive;
 
-  data.sensor.CalcDerivedParameters();
+  update_sensor_parameters();
+  update_output_pin();
 
   if (printer.isRunning()) return; // All running not reinitialize
 
@@ -79,6 +88,30 @@ void Heater::init() {
 
 }
 
+/**
+ * Derived parameters of the sensor and the thermistor table,
+ * at start, at EEPROM load and at every change by M305
+ */
+void Heater::update_sensor_parameters() {
+  data.sensor.CalcDerivedParameters();
+  #if HAS_THERMISTOR_TABLE
+    if (WITHIN(data.sensor.type, 1, 9))
+      thermistor_table.build(data.sensor, AD_RANGE, THERMISTOR_TABLE_MAXTEMP);
+    else
+      thermistor_table.reset();
+  #endif
+}
+
+/**
+ * Port and mask of the output pin for the soft PWM,
+ * at start, at EEPROM load and at every change by M306
+ */
+void Heater::update_output_pin() {
+  #if ENABLED(SOFT_PWM_PORT_WRITE)
+    softpwm.set_pin(pwm_soft_pin, data.pin);
+  #endif
+}
+
 void Heater::set_target_temp(const int16_t celsius) {
 
   if (celsius == 0)
@@ -139,6 +172,11 @@ void Heater::wait_for_target(bool no_wait_for_cooling/*=true*/) {
 
   const bool oldReport = printer.isAutoreportTemp();
 
+  #if ENABLED(POWER_BUDGET)
+    const millis_l start_ms = millis();
+    const bool start_heating = isHeating();
+  #endif
+
   printer.setWaitForHeatUp(true);
   printer.setAutoreportTemp(true);
 
@@ -200,6 +238,9 @@ void Heater::wait_for_target(bool no_wait_for_cooling/*=true*/) {
     #if ENABLED(PRINTER_EVENT_LEDS)
       ledevents.onHeatingDone();
     #endif
+    #if ENABLED(POWER_BUDGET)
+      if (start_heating && isActive()) powerbudget.heated(this, millis() - start_ms);
+    #endif
   }
 
   printer.setWaitForHeatUp(false);
@@ -210,6 +251,13 @@ void Heater::get_output() {
 
   update_idle_timer();
 
+  // With the power budget the duty is only asked, the budget gives it
+  #if ENABLED(POWER_BUDGET)
+    uint8_t &output = pwm_request;
+  #else
+    uint8_t &output = pwm_value;
+  #endif
+
   if (isActive()) {
 
     // Get the target temperature and the error
@@ -218,34 +266,34 @@ void Heater::get_output() {
     #if HAS_COOLERS
       if (type == IS_COOLER) {
         if (isUsePid()) {
-          pwm_value = data.pid.compute(current_temperature, targetTemperature
+          output = data.pid.compute(current_temperature, targetTemperature
             #if ENABLED(PID_ADD_EXTRUSION_RATE)
               , 0xFF
             #endif
           );
         }
         else if (next_check_timer.expired(temp_check_interval))
-          pwm_value = current_temperature >= targetTemperature ? data.pid.drive.max : 0;
+          output = current_temperature >= targetTemperature ? data.pid.drive.max : 0;
       }
       else
     #endif
       {
         if (current_temperature >= targetTemperature + temp_hysteresis)
-          pwm_value = 0;
+          output = 0;
         else if (current_temperature <= targetTemperature - temp_hysteresis)
-          pwm_value = data.pid.Max;
+          output = data.pid.Max;
         else if (isUsePid()) {
           #if ENABLED(PID_ADD_EXTRUSION_RATE)
             const uint8_t id = (type == IS_HOTEND) ? data.ID : 0xFF;
           #endif
-          pwm_value = data.pid.compute(targetTemperature, current_temperature
+          output = data.pid.compute(targetTemperature, current_temperature
             #if ENABLED(PID_ADD_EXTRUSION_RATE)
               , id, tempManager.heater.lpq_len
             #endif
           );
         }
         else if (next_check_timer.expired(temp_check_interval)) {
-          pwm_value = current_temperature < targetTemperature ? data.pid.drive.max : data.pid.drive.min;
+          output = current_temperature < targetTemperature ? data.pid.drive.max : data.pid.drive.min;
         }
       }
 
@@ -275,21 +323,60 @@ void Heater::set_output_pwm() {
     else {
       #if ENABLED(SOFTWARE_PDM)
         const uint8_t carry = pwm_soft_pos + new_pwm;
-        HAL::digitalWrite(data.pin, (carry < pwm_soft_pos));
+        write_soft_pwm(carry < pwm_soft_pos);
         pwm_soft_pos = carry;
       #else // SOFTWARE PWM
+        #if ENABLED(POWER_BUDGET)
+          // A new phase only at the start of a window, the window before is never made longer
+          uint8_t soft_count = tempManager.pwm_soft_count + pwm_soft_phase;
+          if (soft_count == 0 && pwm_soft_phase != pwm_soft_phase_next) {
+            pwm_soft_phase = pwm_soft_phase_next;
+            soft_count = tempManager.pwm_soft_count + pwm_soft_phase;
+          }
+        #else
+          const uint8_t soft_count = tempManager.pwm_soft_count;
+        #endif
         // Turn HIGH Software PWM
-        if (tempManager.pwm_soft_count == 0 && ((pwm_soft_pos = (new_pwm & SOFT_PWM_MASK)) > 0))
-          HAL::digitalWrite(data.pin, HIGH);
+        if (soft_count == 0 && ((pwm_soft_pos = (new_pwm & SOFT_PWM_MASK)) > 0))
+          write_soft_pwm(HIGH);
+        #if ENABLED(POWER_BUDGET)
+          // Less given by the budget is taken from the window at once, more only
+          // from the next one, so a heater never takes the watts another still uses
+          const uint8_t new_pos = new_pwm & SOFT_PWM_MASK;
+          if (isHWinvert() ? (new_pos > pwm_soft_pos && soft_count >= pwm_soft_pos && soft_count < new_pos)
+                           : (new_pos < pwm_soft_pos && soft_count >= new_pos)) {
+            pwm_soft_pos = new_pos;
+            write_soft_pwm(isHWinvert());
+          }
+        #endif
         // Turn LOW Software PWM
-        if (pwm_soft_pos == tempManager.pwm_soft_count && pwm_soft_pos != SOFT_PWM_MASK)
-          HAL::digitalWrite(data.pin, LOW);
+        if (pwm_soft_pos == soft_count && pwm_soft_pos != SOFT_PWM_MASK)
+          write_soft_pwm(LOW);
       #endif
     }
   }
 
 }
 
+#if ENABLED(POWER_BUDGET) && DISABLED(SOFTWARE_PDM)
+
+  /**
+   * Soft PWM window of the heater from start on the soft PWM count,
+   * return where it ends. The output is HIGH from 0 to pwm_soft_pos of
+   * its own count, the heater is on after pwm_soft_pos when inverted.
+   */
+  uint8_t Heater::set_soft_pwm_window(const uint8_t start) {
+    const uint8_t pos = (isHWinvert() ? 255 - pwm_value : pwm_value) & SOFT_PWM_MASK;
+    if (isHWinvert()) {
+      pwm_soft_phase_next = pos - start;
+      return start - pos;
+    }
+    pwm_soft_phase_next = -start;
+    return start + pos;
+  }
+
+#endif
+
 void Heater::check_and_power() {
 
   if (isActive() && current_temperature > data.temp.max) max_temp_error();
@@ -623,7 +710,11 @@ void Heater::print_M306() {
   const int8_t heater_id = type == IS_HOTEND ? data.ID : -type;
   SERIAL_SM(CFG, "Heater parameters: H<Heater>");
   if (heater_id < 0) SERIAL_MSG(" T<tools>");
-  SERIAL_EM(" P<Pin> A<Power Drive Min> B<Power Drive Max> C<Power Max> F<Freq> L<Min Temp> O<Max Temp> U<Use Pid 0-1> I<Hardware Inverted 0-1> R<Thermal Protection 0-1> Q<Pwm Hardware 0-1>:");
+  SERIAL_MSG(" P<Pin> A<Power Drive Min> B<Power Drive Max> C<Power Max> F<Freq> L<Min Temp> O<Max Temp> U<Use Pid 0-1> I<Hardware Inverted 0-1> R<Thermal Protection 0-1> Q<Pwm Hardware 0-1>");
+  #if ENABLED(POWER_BUDGET)
+    SERIAL_MSG(" W<Watts>");
+  #endif
+  SERIAL_EM(":");
   SERIAL_SMV(CFG, "  M306 H", (int)heater_id);
   if (heater_id < 0) SERIAL_MV(" T", int(data.ID));
   SERIAL_MV(" P", data.pin);
@@ -637,6 +728,9 @@ void Heater::print_M306() {
   SERIAL_MV(" I", isHWinvert());
   SERIAL_MV(" Q", isHWpwm());
   SERIAL_MV(" R", isThermalProtection());
+  #if ENABLED(POWER_BUDGET)
+    SERIAL_MV(" W", data.watts);
+  #endif
   SERIAL_EOL();
 
   if (printer.debugFeature()) {
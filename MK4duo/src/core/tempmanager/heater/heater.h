@@ -52,6 +52,9 @@ struct heater_data_t {
   limit_int_t     temp;
   pid_data_t      pid;
   sensor_data_t   sensor;
+  #if ENABLED(POWER_BUDGET)
+    uint16_t      watts;
+  #endif
 };
 
 class Heater {
@@ -72,6 +75,11 @@ class Heater {
 
     uint8_t         pwm_value;
 
+    #if ENABLED(POWER_BUDGET)
+      uint8_t         pwm_request;  // Duty asked by PID or bang-bang, the budget gives pwm_value
+      heater_budget_t budget;
+    #endif
+
     int16_t         target_temperature,
                     idle_temperature;
 
@@ -101,9 +109,24 @@ class Heater {
 
     bool            Pidtuning;
 
+    #if HAS_THERMISTOR_TABLE
+      Thermistor_Table<THERMISTOR_TABLE_POINTS> thermistor_table;
+    #endif
+
+    #if ENABLED(SOFT_PWM_PORT_WRITE)
+      softpwm_pin_t pwm_soft_pin;
+    #endif
+
+    #if ENABLED(POWER_BUDGET) && DISABLED(SOFTWARE_PDM)
+      uint8_t       pwm_soft_phase,       // Added to the soft PWM count for this heater
+                    pwm_soft_phase_next;  // Taken at the start of its next window
+    #endif
+
   public: /** Public Function */
 
     void init();
+    void update_sensor_parameters();
+    void update_output_pin();
 
     void set_target_temp(const int16_t celsius);
     void set_idle_temp(const int16_t celsius);
@@ -112,6 +135,10 @@ class Heater {
     void get_output();
     void set_output_pwm();
 
+    #if ENABLED(POWER_BUDGET) && DISABLED(SOFTWARE_PDM)
+      uint8_t set_soft_pwm_window(const uint8_t start);
+    #endif
+
     void check_and_power();
 
     void PID_autotune(const float target_temp, const uint8_t ncycles, const uint8_t method, const bool storeValues=false);
@@ -129,7 +156,12 @@ class Heater {
     void thermal_runaway_protection();
     void start_watching();
 
-    FORCE_INLINE void update_current_temperature() { this->current_temperature = this->data.sensor.getTemperature(); }
+    FORCE_INLINE void update_current_temperature() {
+      #if HAS_THERMISTOR_TABLE
+        if (this->thermistor_table.get(this->data.sensor.adc_raw, this->current_temperature)) return;
+      #endif
+      this->current_temperature = this->data.sensor.getTemperature();
+    }
     FORCE_INLINE int16_t deg_current()  { return this->current_temperature + 0.5f; }
     FORCE_INLINE int16_t deg_target()   { return this->target_temperature;  }
     FORCE_INLINE int16_t deg_idle()     { return this->idle_temperature;    }
@@ -137,6 +169,11 @@ class Heater {
     FORCE_INLINE bool isHeating()       { return this->target_temperature > this->current_temperature;  }
     FORCE_INLINE bool isCooling()       { return this->target_temperature <= this->current_temperature; }
 
+    // At the target or within the hysteresis under it, not heating at full power
+    FORCE_INLINE bool isHolding() {
+      return type == IS_COOLER || this->current_temperature > (isIdle() ? this->idle_temperature : this->target_temperature) - temp_hysteresis;
+    }
+
     FORCE_INLINE bool wait_for_heating() {
       return this->isActive() && ABS(this->current_temperature - this->target_temperature) > temp_hysteresis;
     }
@@ -180,6 +217,9 @@ class Heater {
     // Flag bit 7 Set Fault
     FORCE_INLINE void setFault() {
       pwm_value = 0;
+      #if ENABLED(POWER_BUDGET)
+        pwm_request = 0;
+      #endif
       setActive(false);
       data.flag.Fault = true;
     }
@@ -194,6 +234,9 @@ class Heater {
     FORCE_INLINE void SwitchOff() {
       target_temperature = 0;
       pwm_value = 0;
+      #if ENABLED(POWER_BUDGET)
+        pwm_request = 0;
+      #endif
       data.pid.reset();
       setActive(false);
     }
@@ -208,6 +251,14 @@ class Heater {
 
     void update_idle_timer();
 
+    FORCE_INLINE void write_soft_pwm(const bool level) {
+      #if ENABLED(SOFT_PWM_PORT_WRITE)
+        softpwm.write(pwm_soft_pin, level);
+      #else
+        HAL::digitalWrite(data.pin, level);
+      #endif
+    }
+
 };
 
 #if HAS_HOTENDS
@@ -0,0 +1,286 @@
+/**
+ * MK4duo Firmware for 3D Printer, Laser and CNC
+ *
+ * Based on Marlin, Sprinter and grbl
+ * Copyright (c) 2011 Camiel Gubbels / Erik van der Zalm
+ * Copyright (c) 2020 Alberto Cotronei @MagoKimbra
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+/**
+ * powerbudget.cpp
+ *
+ * Copyright (c) 2020 Alberto Cotronei @MagoKimbra
+ */
+
+#include "../../../../MK4duo.h"
+#include "sanitycheck.h"
+
+#if ENABLED(POWER_BUDGET)
+
+PowerBudget powerbudget;
+
+/** Public Parameters */
+power_budget_data_t PowerBudget::data;
+
+float PowerBudget::asked_watts = 0.0f,
+      PowerBudget::given_watts = 0.0f;
+
+uint32_t PowerBudget::limited = 0;
+
+/** Private Parameters */
+Heater* PowerBudget::slowest = nullptr;
+
+/** Public Function */
+void PowerBudget::factory_parameters() {
+  data.limit = POWER_BUDGET_WATTS;
+}
+
+/**
+ * Every heater asks its duty in pwm_request, here it gets its pwm_value:
+ *  - Heaters out of the budget (no watts set, or no budget) get what they ask
+ *  - Heaters at their target share the budget first, all cut by the
+ *    same factor if they don't fit, so no one falls out of its hysteresis
+ *  - Heaters still heating get what is left, the one with the most
+ *    seconds to its target first. A heater not measured yet goes first,
+ *    the biggest one before the others, so it gets measured. The one
+ *    that went first keeps its turn until another is slower by a tenth,
+ *    the duties don't swap at each spin while two of them are close.
+ * For a first order heater the slowest one sets when all the heaters are
+ * ready, with all the power it can take the others heat in the time it
+ * needs anyway.
+ */
+void PowerBudget::spin() {
+
+  Heater* list[POWER_BUDGET_HEATERS];
+  const uint8_t count = get_heaters(list);
+  const millis_l now = millis();
+
+  Heater  *holding[POWER_BUDGET_HEATERS],
+          *heating[POWER_BUDGET_HEATERS];
+  float   holding_asked[POWER_BUDGET_HEATERS],
+          heating_asked[POWER_BUDGET_HEATERS],
+          heating_key[POWER_BUDGET_HEATERS],
+          holding_watts = 0.0f;
+  uint8_t n_holding = 0,
+          n_heating = 0;
+
+  asked_watts = given_watts = 0.0f;
+
+  for (uint8_t i = 0; i < count; i++) {
+    Heater * const act = list[i];
+
+    if (!act->isActive()) {
+      act->budget.rate_ms = 0;
+      continue;
+    }
+
+    measure_rate(act, now);
+
+    const float asked = act->data.watts * act->pwm_request * (1.0f / 255.0f);
+    asked_watts += asked;
+
+    if (!data.limit || !act->data.watts) {
+      act->pwm_value = act->pwm_request;
+      given_watts += asked;
+    }
+    else if (act->isHolding()) {
+      holding[n_holding] = act;
+      holding_asked[n_holding++] = asked;
+      holding_watts += asked;
+    }
+    else {
+      // Slowest first, by insertion
+      const float seconds = seconds_to_target(act);
+      float key = seconds < 0.0f ? 1e6f + act->data.watts : seconds;
+      if (act == slowest) key *= 1.1f;
+      uint8_t j = n_heating++;
+      for (; j > 0 && heating_key[j - 1] < key; j--) {
+        heating[j] = heating[j - 1];
+        heating_asked[j] = heating_asked[j - 1];
+        heating_key[j] = heating_key[j - 1];
+      }
+      heating[j] = act;
+      heating_asked[j] = asked;
+      heating_key[j] = key;
+    }
+  }
+
+  slowest = n_heating ? heating[0] : nullptr;
+
+  float left = data.limit;
+
+  const float cut = holding_watts > left ? left / holding_watts : 1.0f;
+  for (uint8_t i = 0; i < n_holding; i++) {
+    const float given = holding_asked[i] * cut;
+    give(holding[i], holding_asked[i], given);
+    left -= given;
+  }
+
+  for (uint8_t i = 0; i < n_heating; i++) {
+    const float given = MIN(heating_asked[i], MAX(left, 0.0f));
+    give(heating[i], heating_asked[i], given);
+    left -= given;
+  }
+
+  #if DISABLED(SOFTWARE_PDM)
+    stagger_soft_pwm(list, count);
+  #endif
+
+}
+
+/**
+ * Seconds to the target at full duty, 0 at the target
+ * and -1 when the heater has not been measured yet
+ */
+float PowerBudget::seconds_to_target(Heater * const act) {
+  const float gap = (act->isIdle() ? act->idle_temperature : act->target_temperature) - act->current_temperature;
+  if (gap <= 0.0f) return 0.0f;
+  return act->budget.rate > 0.0f ? gap / act->budget.rate : -1.0f;
+}
+
+void PowerBudget::heated(Heater * const act, const millis_l ms) {
+  act->budget.heated_ms = ms;
+  SERIAL_STR(ECHO);
+  print_heater_name(act);
+  SERIAL_MV(" at ", act->deg_target());
+  SERIAL_MV(" in ", ms * 0.001f, 1);
+  SERIAL_EM(" s");
+}
+
+void PowerBudget::report() {
+
+  Heater* list[POWER_BUDGET_HEATERS];
+  const uint8_t count = get_heaters(list);
+
+  SERIAL_MV("Power budget W:", data.limit);
+  SERIAL_MV(" asked W:", asked_watts, 1);
+  SERIAL_MV(" given W:", given_watts, 1);
+  SERIAL_EMV(" limited:", limited);
+
+  for (uint8_t i = 0; i < count; i++) {
+    Heater * const act = list[i];
+    print_heater_name(act);
+    SERIAL_MV(" W:", act->data.watts);
+    SERIAL_MV(" asked:", act->pwm_request);
+    SERIAL_MV(" given:", act->pwm_value);
+    SERIAL_MV(" degC/s:", act->budget.rate, 2);
+    if (act->isActive()) {
+      const float seconds = seconds_to_target(act);
+      if (seconds >= 0.0f) SERIAL_MV(" to target s:", seconds, 1);
+    }
+    if (act->budget.heated_ms) SERIAL_MV(" heated s:", act->budget.heated_ms * 0.001f, 1);
+    SERIAL_EOL();
+  }
+
+}
+
+void PowerBudget::print_M1007() {
+  SERIAL_LM(CFG, "Power budget: S<Watts>");
+  SERIAL_LMV(CFG, "  M1007 S", data.limit);
+}
+
+/** Private Function */
+uint8_t PowerBudget::get_heaters(Heater* list[]) {
+  uint8_t count = 0;
+  #if HAS_HOTENDS
+    LOOP_HOTEND()   list[count++] = hotends[h];
+  #endif
+  #if HAS_BEDS
+    LOOP_BED()      list[count++] = beds[h];
+  #endif
+  #if HAS_CHAMBERS
+    LOOP_CHAMBER()  list[count++] = chambers[h];
+  #endif
+  #if HAS_COOLERS
+    LOOP_COOLER()   list[count++] = coolers[h];
+  #endif
+  return count;
+}
+
+/**
+ * The degC a second of a heater at full duty, from its rise over two seconds
+ * of heating divided by the mean duty it was given. The duty of the spin
+ * before is still in pwm_value. Only at a quarter of the duty or more, so
+ * that the noise of the sensor doesn't grow too much.
+ */
+void PowerBudget::measure_rate(Heater * const act, const millis_l now) {
+
+  heater_budget_t &b = act->budget;
+
+  if (b.rate_ms && !act->isHolding()) {
+    b.duty_sum += act->pwm_value;
+    b.duty_spins++;
+    const millis_l elapsed = now - b.rate_ms;
+    if (elapsed < 2000UL) return;
+    const float duty = b.duty_sum * (1.0f / 255.0f) / b.duty_spins;
+    if (duty >= 0.25f) {
+      const float rate = (act->current_temperature - b.rate_temp) * 1000.0f / (elapsed * duty);
+      if (rate > 0.0f) b.rate = b.rate > 0.0f ? b.rate + (rate - b.rate) * 0.5f : rate;
+    }
+  }
+
+  b.rate_ms     = now;
+  b.rate_temp   = act->current_temperature;
+  b.duty_sum    = 0;
+  b.duty_spins  = 0;
+
+}
+
+/**
+ * A heater given less than half it asks for doesn't heat as the watch of
+ * the heating expects, the watch starts again from its temperature.
+ */
+void PowerBudget::give(Heater * const act, const float asked, const float given) {
+  if (given >= asked)
+    act->pwm_value = act->pwm_request;
+  else {
+    act->pwm_value = given * 255.0f / act->data.watts;
+    limited++;
+    if (given < asked * 0.5f) act->start_watching();
+  }
+  given_watts += act->data.watts * act->pwm_value * (1.0f / 255.0f);
+}
+
+void PowerBudget::print_heater_name(Heater * const act) {
+  switch (act->type) {
+    case IS_HOTEND:   SERIAL_MSG(STR_HEATER_HOTEND);  break;
+    case IS_BED:      SERIAL_MSG(STR_HEATER_BED);     break;
+    case IS_CHAMBER:  SERIAL_MSG(STR_HEATER_CHAMBER); break;
+    case IS_COOLER:   SERIAL_MSG(STR_HEATER_COOLER);  break;
+  }
+  SERIAL_MV(" ", int(act->data.ID));
+}
+
+#if DISABLED(SOFTWARE_PDM)
+
+  /**
+   * The soft PWM window of each heater starts where the one before ends.
+   * While the duties add up to 100% or less the windows don't overlap,
+   * over it they overlap as little as the duties allow.
+   */
+  void PowerBudget::stagger_soft_pwm(Heater* list[], const uint8_t count) {
+    uint8_t start = 0;
+    for (uint8_t i = 0; i < count; i++) {
+      Heater * const act = list[i];
+      if (act->data.pin > NoPin && !act->isHWpwm())
+        start = act->set_soft_pwm_window(start);
+    }
+  }
+
+#endif
+
+#endif // ENABLED(POWER_BUDGET)
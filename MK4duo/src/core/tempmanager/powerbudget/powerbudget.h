@@ -0,0 +1,114 @@
+/**
+ * MK4duo Firmware for 3D Printer, Laser and CNC
+ *
+ * Based on Marlin, Sprinter and grbl
+ * Copyright (c) 2011 Camiel Gubbels / Erik van der Zalm
+ * Copyright (c) 2020 Alberto Cotronei @MagoKimbra
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#pragma once
+
+/**
+ * powerbudget.h - power budget of the heaters
+ *
+ * Copyright (c) 2020 Alberto Cotronei @MagoKimbra
+ */
+
+#if ENABLED(POWER_BUDGET)
+
+#define POWER_BUDGET_HEATERS  (MAX_HOTEND + MAX_BED + MAX_CHAMBER + MAX_COOLER)
+
+class Heater;
+
+struct power_budget_data_t {
+  uint16_t  limit;          // Watts all the heaters may draw together, 0 for no budget
+};
+
+// Budget state of each heater
+struct heater_budget_t {
+  float     rate,           // degC a second heating at full duty, 0 until measured
+            rate_temp;      // Temperature at the start of the measure
+  uint16_t  duty_sum;       // Duty given in the spins of the measure
+  uint8_t   duty_spins;
+  millis_l  rate_ms,        // Start of the measure, 0 to start again
+            heated_ms;      // Time to temperature of the last M109, M190 or M191
+};
+
+class PowerBudget {
+
+  public: /** Constructor */
+
+    PowerBudget() {}
+
+  public: /** Public Parameters */
+
+    static power_budget_data_t data;
+
+    static float  asked_watts,    // Watts asked by all the heaters in the last spin
+                  given_watts;    // Watts given to them
+
+    static uint32_t limited;      // Spins a heater got less than it asked
+
+  private: /** Private Parameters */
+
+    static Heater* slowest;       // Heating one that went first in the last spin
+
+  public: /** Public Function */
+
+    /**
+     * Initialize to the factory parameters
+     */
+    static void factory_parameters();
+
+    /**
+     * Share the budget among the duty asked by the heaters,
+     * after check_and_power() of all of them in TempManager::spin()
+     */
+    static void spin();
+
+    /**
+     * Seconds a heater needs to its target, at full duty
+     */
+    static float seconds_to_target(Heater * const act);
+
+    /**
+     * Time to temperature at the end of M109, M190 and M191
+     */
+    static void heated(Heater * const act, const millis_l ms);
+
+    static void report();
+
+    static void print_M1007();
+
+  private: /** Private Function */
+
+    static uint8_t get_heaters(Heater* list[]);
+
+    static void measure_rate(Heater * const act, const millis_l now);
+
+    static void give(Heater * const act, const float asked, const float given);
+
+    static void print_heater_name(Heater * const act);
+
+    #if DISABLED(SOFTWARE_PDM)
+      static void stagger_soft_pwm(Heater* list[], const uint8_t count);
+    #endif
+
+};
+
+extern PowerBudget powerbudget;
+
+#endif // ENABLED(POWER_BUDGET)
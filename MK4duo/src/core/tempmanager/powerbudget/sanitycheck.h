@@ -0,0 +1,49 @@
+/**
+ * MK4duo Firmware for 3D Printer, Laser and CNC
+ *
+ * Based on Marlin, Sprinter and grbl
+ * Copyright (c) 2011 Camiel Gubbels / Erik van der Zalm
+ * Copyright (c) 2020 Alberto Cotronei @MagoKimbra
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#pragma once
+
+/**
+ * sanitycheck.h
+ *
+ * Test configuration values for errors at compile-time.
+ */
+
+#if ENABLED(POWER_BUDGET)
+  #if !HAS_HEATER
+    #error "DEPENDENCY ERROR: POWER_BUDGET needs at least one heater."
+  #endif
+  #if DISABLED(POWER_BUDGET_WATTS)
+    #error "DEPENDENCY ERROR: Missing setting POWER_BUDGET_WATTS."
+  #endif
+  #if DISABLED(HOTEND_WATTS)
+    #error "DEPENDENCY ERROR: Missing setting HOTEND_WATTS."
+  #endif
+  #if DISABLED(BED_WATTS)
+    #error "DEPENDENCY ERROR: Missing setting BED_WATTS."
+  #endif
+  #if DISABLED(CHAMBER_WATTS)
+    #error "DEPENDENCY ERROR: Missing setting CHAMBER_WATTS."
+  #endif
+  #if DISABLED(COOLER_WATTS)
+    #error "DEPENDENCY ERROR: Missing setting COOLER_WATTS."
+  #endif
+#endif
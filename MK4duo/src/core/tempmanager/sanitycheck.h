@@ -27,6 +27,34 @@
  * Test configuration values for errors at compile-time.
  */
 
+// Thermistor table
+#if ENABLED(THERMISTOR_TABLE)
+  #if DISABLED(THERMISTOR_TABLE_POINTS)
+    #error "DEPENDENCY ERROR: Missing setting THERMISTOR_TABLE_POINTS."
+  #else
+    static_assert(WITHIN(THERMISTOR_TABLE_POINTS, 8, 128), "DEPENDENCY ERROR: THERMISTOR_TABLE_POINTS must be a value from 8 to 128.");
+  #endif
+  #if DISABLED(THERMISTOR_TABLE_MAXTEMP)
+    #error "DEPENDENCY ERROR: Missing setting THERMISTOR_TABLE_MAXTEMP."
+  #endif
+#endif
+
+// ADC DMA
+#if ENABLED(ADC_DMA)
+  #if DISABLED(ARDUINO_ARCH_SAM) && !defined(STM32F4xx) && DISABLED(ARDUINO_ARCH_NATIVE)
+    #error "DEPENDENCY ERROR: ADC_DMA is only supported on DUE and STM32F4."
+  #endif
+  #if DISABLED(ADC_OVERSAMPLE_BITS)
+    #error "DEPENDENCY ERROR: Missing setting ADC_OVERSAMPLE_BITS."
+  #elif DISABLED(ADC_DMA_SAMPLES)
+    #error "DEPENDENCY ERROR: Missing setting ADC_DMA_SAMPLES."
+  #else
+    static_assert(WITHIN(ADC_OVERSAMPLE_BITS, 0, 2), "DEPENDENCY ERROR: ADC_OVERSAMPLE_BITS must be a value from 0 to 2.");
+    static_assert(WITHIN(ADC_DMA_SAMPLES, 1 << (2 * ADC_OVERSAMPLE_BITS), 256) && !(ADC_DMA_SAMPLES & (ADC_DMA_SAMPLES - 1)),
+                  "DEPENDENCY ERROR: ADC_DMA_SAMPLES must be a power of 2 from 4^ADC_OVERSAMPLE_BITS to 256.");
+  #endif
+#endif
+
 // Temperature defines
 #if ENABLED(TEMP_RESIDENCY_TIME)
   #if DISABLED(HOTEND_HYSTERESIS)
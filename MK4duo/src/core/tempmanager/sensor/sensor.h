@@ -27,6 +27,7 @@
 
 #include "thermistor.h"
 #include "pt100.h"
+#include "../../../lib/thermistor_table.h"
 
 typedef struct {
 
@@ -72,38 +73,7 @@ typedef struct {
           return (adc_raw * float(AD595_MAX) / float(AD_RANGE)) * ad595_gain + ad595_offset;
       #endif
 
-      if (WITHIN(type, 1, 9)) {
-
-        // Calculate the resistance
-        #if HAS_VREF_MONITOR
-          const int32_t adc_mv      = HAL::analog2mv(adc_raw),
-                        adc_low     = 2 * adc_low_offset,
-                        adc_max     = HAL_VREF + (2 * adc_high_offset);
-          const float   resistance  = pullup_res * (float)(adc_mv - adc_low) / (float)(adc_max - adc_mv);
-        #else
-          const int32_t adc_low = 2 * adc_low_offset,
-                        adc_max = AD_RANGE + (2 * adc_high_offset);
-          const float   adc_inverse = (float)(adc_max - adc_raw) - 0.5f;
-          if (adc_inverse <= 0.0) return ABS_ZERO;
-          const float   resistance = pullup_res * ((float)(adc_raw - adc_low) + 0.5f) / adc_inverse;
-        #endif
-
-        const float logResistance = LOG(resistance);
-        const float recipT = shA + shB * logResistance + shC * logResistance * logResistance * logResistance;
-
-        /*
-        SERIAL_MV("Debug adc_inverse:", adc_inverse, 5);
-        SERIAL_MV(" resistance:", resistance, 5);
-        SERIAL_MV(" logResistance:", logResistance, 5);
-        SERIAL_MV(" shA:", shA, 5);
-        SERIAL_MV(" shB:", shB, 5);
-        SERIAL_MV(" shC:", shC, 5);
-        SERIAL_MV(" recipT:", recipT, 5);
-        SERIAL_EOL();
-        */
-
-        return (recipT > 0.0) ? (1.0 / recipT) + (ABS_ZERO) : 2000.0;
-      }
+      if (WITHIN(type, 1, 9)) return calc_thermistor(adc_raw);
 
       #if HAS_DHT
         if (type == 11)
@@ -137,6 +107,43 @@ typedef struct {
       return 25;
     }
 
+    /**
+     * Exact temperature of a thermistor reading, Steinhart-Hart.
+     * It also makes the thermistor table, see lib/thermistor_table.h
+     */
+    float calc_thermistor(const int16_t raw) {
+
+      // Calculate the resistance
+      #if HAS_VREF_MONITOR
+        const int32_t adc_mv      = HAL::analog2mv(raw),
+                      adc_low     = 2 * adc_low_offset,
+                      adc_max     = HAL_VREF + (2 * adc_high_offset);
+        const float   resistance  = pullup_res * (float)(adc_mv - adc_low) / (float)(adc_max - adc_mv);
+      #else
+        const int32_t adc_low = 2 * adc_low_offset,
+                      adc_max = AD_RANGE + (2 * adc_high_offset);
+        const float   adc_inverse = (float)(adc_max - raw) - 0.5f;
+        if (adc_inverse <= 0.0) return ABS_ZERO;
+        const float   resistance = pullup_res * ((float)(raw - adc_low) + 0.5f) / adc_inverse;
+      #endif
+
+      const float logResistance = LOG(resistance);
+      const float recipT = shA + shB * logResistance + shC * logResistance * logResistance * logResistance;
+
+      /*
+      SERIAL_MV("Debug adc_inverse:", adc_inverse, 5);
+      SERIAL_MV(" resistance:", resistance, 5);
+      SERIAL_MV(" logResistance:", logResistance, 5);
+      SERIAL_MV(" shA:", shA, 5);
+      SERIAL_MV(" shB:", shB, 5);
+      SERIAL_MV(" shC:", shC, 5);
+      SERIAL_MV(" recipT:", recipT, 5);
+      SERIAL_EOL();
+      */
+
+      return (recipT > 0.0) ? (1.0 / recipT) + (ABS_ZERO) : 2000.0;
+    }
+
     bool set_pullup_res(const float value) {
       if (!WITHIN(value, 1, 1000000)) return false;
       pullup_res = value;
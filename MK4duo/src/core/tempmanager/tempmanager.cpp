@@ -165,6 +165,10 @@ void TempManager::factory_parameters() {
     heater.lpq_len = 20;  // default last-position-queue size
   #endif
 
+  #if ENABLED(POWER_BUDGET)
+    powerbudget.factory_parameters();
+  #endif
+
 }
 
 void TempManager::change_number_heater(const HeatertypeEnum type, const uint8_t h) {
@@ -294,6 +298,10 @@ void TempManager::spin() {
     } // LOOP_COOLER
   #endif
 
+  #if ENABLED(POWER_BUDGET)
+    powerbudget.spin();
+  #endif
+
   #if HAS_MCU_TEMPERATURE
     mcu_current_temperature = HAL::analog2tempMCU(mcu_current_temperature_raw);
     NOLESS(mcu_highest_temperature, mcu_current_temperature);
@@ -666,6 +674,9 @@ void TempManager::report_temperatures(const bool showRaw/*=false*/) {
                       HEKc[]    = HOTEND_Kc,
                       HE_R25[]  = { HOT0_R25, HOT1_R25, HOT2_R25, HOT3_R25, HOT4_R25, HOT5_R25 },
                       HE_BETA[] = { HOT0_BETA, HOT1_BETA, HOT2_BETA, HOT3_BETA, HOT4_BETA, HOT5_BETA };
+    #if ENABLED(POWER_BUDGET)
+      constexpr uint16_t HE_watts[] = HOTEND_WATTS;
+    #endif
     constexpr pin_t   HE_pin[]  = { HEATER_HE0_PIN, HEATER_HE1_PIN, HEATER_HE2_PIN, HEATER_HE3_PIN, HEATER_HE4_PIN, HEATER_HE5_PIN },
                       SE_pin[]  = { TEMP_HE0_PIN, TEMP_HE1_PIN, TEMP_HE2_PIN, TEMP_HE3_PIN, TEMP_HE4_PIN, TEMP_HE5_PIN };
     constexpr int16_t HE_min[]  = { HOTEND_0_MINTEMP, HOTEND_1_MINTEMP, HOTEND_2_MINTEMP, HOTEND_3_MINTEMP, HOTEND_4_MINTEMP, HOTEND_5_MINTEMP },
@@ -680,6 +691,9 @@ void TempManager::report_temperatures(const bool showRaw/*=false*/) {
     heat->data.temp.min   = HE_min[h];
     heat->data.temp.max   = HE_max[h];
     heat->data.freq       = HOTEND_PWM_FREQUENCY;
+    #if ENABLED(POWER_BUDGET)
+      heat->data.watts    = HE_watts[ALIM(h, HE_watts)];
+    #endif
     // Pid
     pid->Kp               = HEKp[ALIM(h, HEKp)];
     pid->Ki               = HEKi[ALIM(h, HEKi)];
@@ -737,6 +751,9 @@ void TempManager::report_temperatures(const bool showRaw/*=false*/) {
     heat->data.temp.min   = BED_MINTEMP;
     heat->data.temp.max   = BED_MAXTEMP;
     heat->data.freq       = BED_PWM_FREQUENCY;
+    #if ENABLED(POWER_BUDGET)
+      heat->data.watts    = BED_WATTS;
+    #endif
     // Pid
     pid->Kp               = BEDKp[ALIM(h, BEDKp)];
     pid->Ki               = BEDKi[ALIM(h, BEDKi)];
@@ -793,6 +810,9 @@ void TempManager::report_temperatures(const bool showRaw/*=false*/) {
     heat->data.temp.min   = CHAMBER_MINTEMP;
     heat->data.temp.max   = CHAMBER_MAXTEMP;
     heat->data.freq       = CHAMBER_PWM_FREQUENCY;
+    #if ENABLED(POWER_BUDGET)
+      heat->data.watts    = CHAMBER_WATTS;
+    #endif
     // Pid
     pid->Kp               = CHAMBERKp[ALIM(h, CHAMBERKp)];
     pid->Ki               = CHAMBERKi[ALIM(h, CHAMBERKi)];
@@ -842,6 +862,9 @@ void TempManager::report_temperatures(const bool showRaw/*=false*/) {
     heat->data.temp.min   = COOLER_MINTEMP;
     heat->data.temp.max   = COOLER_MAXTEMP;
     heat->data.freq       = COOLER_PWM_FREQUENCY;
+    #if ENABLED(POWER_BUDGET)
+      heat->data.watts    = COOLER_WATTS;
+    #endif
     // Pid
     pid->Kp               = COOLER_Kp;
     pid->Ki               = COOLER_Ki;
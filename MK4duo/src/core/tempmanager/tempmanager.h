@@ -24,6 +24,7 @@
 #include "dhtsensor/dhtsensor.h"
 #include "sensor/sensor.h"
 #include "pid/pid.h"
+#include "powerbudget/powerbudget.h"
 #include "heater/heater.h"
 
 struct temp_data_t {
@@ -62,7 +62,7 @@ char* hex_word(const uint16_t w) {
 
 char* hex_address(const void * const w) {
   #if ENABLED(CPU_32_BIT)
-    (void)hex_long((uint32_t)w);
+    (void)hex_long((uint32_t)(ptr_int_t)w);
   #else
     (void)hex_word((uint16_t)w);
   #endif
@@ -0,0 +1,296 @@
+/**
+ * MK4duo Firmware for 3D Printer, Laser and CNC
+ *
+ * Based on Marlin, Sprinter and grbl
+ * Copyright (c) 2011 Camiel Gubbels / Erik van der Zalm
+ * Copyright (c) 2020 Alberto Cotronei @MagoKimbra
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+/**
+ * binary_protocol.cpp - Binary command frames on a serial port
+ */
+
+#include "../../../MK4duo.h"
+#include "sanitycheck.h"
+
+#if ENABLED(BINARY_PROTOCOL)
+
+BinaryProtocol binary_protocol;
+
+/** Public Parameters */
+int8_t BinaryProtocol::port = -1;
+
+/** Private Parameters */
+BinaryStateEnum BinaryProtocol::state = BP_STATE_SYNC;
+
+uint8_t BinaryProtocol::seq       = 0,
+        BinaryProtocol::type      = 0,
+        BinaryProtocol::len       = 0,
+        BinaryProtocol::count     = 0,
+        BinaryProtocol::expected  = 0,
+        BinaryProtocol::crc_low   = 0,
+        BinaryProtocol::payload[BINARY_MAX_PAYLOAD];
+
+uint16_t BinaryProtocol::crc = 0;
+
+bool  BinaryProtocol::resend      = false,
+      BinaryProtocol::ack_pending = false;
+
+/** Public Function */
+void BinaryProtocol::set_port(const int8_t p, const bool on) {
+  if (on) {
+    port = p;
+    state = BP_STATE_SYNC;
+    expected = 0;
+    resend = ack_pending = false;
+    #if ENABLED(EMERGENCY_PARSER)
+      emergency_parser.disable();
+    #endif
+  }
+  else if (port == p) {
+    port = -1;
+    #if ENABLED(EMERGENCY_PARSER)
+      emergency_parser.enable();
+    #endif
+  }
+}
+
+void BinaryProtocol::check_line(const int8_t p, const char * const line) {
+  const char * const args = commands.match_command(line, 'M', 1004);
+  if (args) {
+    const char * const s = strchr(args, 'S');
+    set_port(p, s && s[1] == '1');
+  }
+}
+
+bool BinaryProtocol::receive(const uint8_t c, char (&line)[MAX_CMD_SIZE], int &ind) {
+
+  switch (state) {
+
+    case BP_STATE_SYNC:
+      if (c == BINARY_SYNC) {
+        ind = 0;
+        crc = 0;
+        state = BP_STATE_SEQ;
+      }
+      else if (c == '\n' || c == '\r') {
+        // A text line between the frames, only M1004 is taken
+        line[ind] = '\0';
+        ind = 0;
+        if (commands.match_command(line, 'M', 1004)) {
+          const int8_t p = port;
+          check_line(p, line);
+          return true;
+        }
+      }
+      else if (ind < MAX_CMD_SIZE - 1)
+        line[ind++] = c;
+      return false;
+
+    case BP_STATE_SEQ:
+      seq = c;
+      state = BP_STATE_TYPE;
+      break;
+
+    case BP_STATE_TYPE:
+      type = c;
+      state = BP_STATE_LEN;
+      break;
+
+    case BP_STATE_LEN:
+      len = c;
+      count = 0;
+      if (len > BINARY_MAX_PAYLOAD) {
+        ask_resend();
+        state = BP_STATE_SYNC;
+        return false;
+      }
+      state = len ? BP_STATE_PAYLOAD : BP_STATE_CRC_L;
+      break;
+
+    case BP_STATE_PAYLOAD:
+      payload[count++] = c;
+      if (count == len) state = BP_STATE_CRC_L;
+      break;
+
+    case BP_STATE_CRC_L:
+      crc_low = c;
+      state = BP_STATE_CRC_H;
+      return false;
+
+    case BP_STATE_CRC_H: {
+      state = BP_STATE_SYNC;
+      if ((uint16_t(crc_low) | (uint16_t(c) << 8)) != crc) {
+        ask_resend();
+        return false;
+      }
+      const uint8_t diff = seq - expected;
+      if (diff) {
+        if (diff < 128)
+          ask_resend();       // Frames were lost
+        else
+          ack_pending = true; // Sent again, the ack was late
+        return false;
+      }
+      // Taken even if it can't be decoded, the error comes before the acknowledge
+      expected++;
+      resend = false;
+      ack_pending = true;
+      return decode(line);
+    }
+  }
+
+  crc16(&crc, &c, 1);
+  return false;
+}
+
+void BinaryProtocol::acknowledge() {
+  if (!ack_pending || port < 0) return;
+  ack_pending = false;
+  SERIAL_PORT(port);
+  SERIAL_EMV("ack:", int(uint8_t(expected - 1)));
+  SERIAL_PORT(-1);
+}
+
+/** Private Function */
+static uint32_t get_le32(const uint8_t * const p) {
+  return uint32_t(p[0]) | (uint32_t(p[1]) << 8) | (uint32_t(p[2]) << 16) | (uint32_t(p[3]) << 24);
+}
+
+static void put_uint(char * &p, uint32_t value) {
+  char digits[10];
+  uint8_t n = 0;
+  do { digits[n++] = '0' + value % 10; value /= 10; } while (value);
+  while (n) *p++ = digits[--n];
+}
+
+// Parameter as " X12.34", false if the line is full
+static bool put_param(char * &p, const char * const end, const char letter, const int32_t value) {
+  if (end - p < 18) return false;
+  *p++ = ' ';
+  *p++ = letter;
+  if (value == BINARY_NO_VALUE) return true;
+  uint32_t u = value;
+  if (value < 0) { *p++ = '-'; u = -u; }
+  uint32_t fpart = u % BINARY_SCALE;
+  put_uint(p, u / BINARY_SCALE);
+  if (fpart) {
+    *p++ = '.';
+    for (uint16_t div = BINARY_SCALE / 10; fpart; div /= 10) {
+      *p++ = '0' + fpart / div;
+      fpart %= div;
+    }
+  }
+  return true;
+}
+
+bool BinaryProtocol::decode(char (&line)[MAX_CMD_SIZE]) {
+
+  char *p = line;
+  const char * const end = line + MAX_CMD_SIZE - 1;
+  const uint8_t *v;
+  char letter;
+  uint16_t code;
+  uint32_t mask;
+  PGM_P names = nullptr;
+
+  switch (type) {
+
+    case BP_TEXT:
+      memcpy(line, payload, len);
+      line[len] = '\0';
+      return len > 0;
+
+    case BP_END:
+      acknowledge();
+      set_port(port, false);
+      return false;
+
+    case BP_MOVE:
+      if (len < 2) { reject(PSTR("Binary frame too short:")); return false; }
+      if (payload[0] > 3) { reject(PSTR("Binary move unknown:")); return false; }
+      letter  = 'G';
+      code    = payload[0];
+      mask    = payload[1];
+      names   = PSTR("XYZEFIJR");
+      v       = payload + 2;
+      break;
+
+    case BP_COMMAND:
+      if (len < 7) { reject(PSTR("Binary frame too short:")); return false; }
+      letter  = payload[0];
+      code    = uint16_t(payload[1]) | (uint16_t(payload[2]) << 8);
+      mask    = get_le32(payload + 3);
+      v       = payload + 7;
+      break;
+
+    default:
+      reject(PSTR("Binary frame unknown:"));
+      return false;
+  }
+
+  // The frame as a G-code line
+  *p++ = letter;
+  put_uint(p, code);
+
+  for (uint8_t b = 0; mask; b++, mask >>= 1) {
+    if (!(mask & 1)) continue;
+    if (v + 4 > payload + len) {
+      reject(PSTR("Binary frame too short:"));
+      return false;
+    }
+    if (!put_param(p, end, names ? pgm_read_byte(&names[b]) : 'A' + b, get_le32(v))) {
+      reject(PSTR("Binary frame too long for a line:"));
+      return false;
+    }
+    v += 4;
+  }
+  *p = '\0';
+
+  // Emergency commands act right away, as they do in text
+  if (letter == 'M') switch (code) {
+    case 108:
+      printer.setWaitForHeatUp(false);
+      #if HAS_LCD_MENU
+        printer.setWaitForUser(false);
+      #endif
+      break;
+    case 112: printer.kill(PSTR("M112")); break;
+    case 410: printer.quickstop_stepper(); break;
+  }
+
+  return true;
+}
+
+// The frame doesn't run, the host is told before the acknowledge that covers it
+void BinaryProtocol::reject(PGM_P const why) {
+  SERIAL_PORT(port);
+  SERIAL_STR(ER);
+  SERIAL_STR(why);
+  SERIAL_EV(int(seq));
+  SERIAL_PORT(-1);
+}
+
+void BinaryProtocol::ask_resend() {
+  if (resend) return;
+  resend = true;
+  SERIAL_PORT(port);
+  SERIAL_EMV("rs:", int(expected));
+  SERIAL_PORT(-1);
+}
+
+#endif // ENABLED(BINARY_PROTOCOL)
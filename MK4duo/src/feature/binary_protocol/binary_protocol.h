@@ -0,0 +1,137 @@
+/**
+ * MK4duo Firmware for 3D Printer, Laser and CNC
+ *
+ * Based on Marlin, Sprinter and grbl
+ * Copyright (c) 2011 Camiel Gubbels / Erik van der Zalm
+ * Copyright (c) 2020 Alberto Cotronei @MagoKimbra
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#pragma once
+
+/**
+ * binary_protocol.h - Binary command frames on a serial port
+ *
+ * After "M1004 S1" the port takes frames instead of text lines:
+ *
+ *   0xA5 | seq | type | len | payload (len bytes) | crc16 low | crc16 high
+ *
+ * The CRC16 (CCITT 0x1021, start 0, as crc16()) covers seq, type, len and
+ * the payload. seq counts the frames from 0 after M1004 S1 and wraps at 255.
+ * Values are int32 little endian fixed point, in 1/10000 units.
+ *
+ *   BP_MOVE     code (0-3 for G0-G3), mask of X Y Z E F I J R (bit 0 = X),
+ *               one value for each bit set
+ *   BP_COMMAND  letter (G, M or T), code (uint16), mask of A-Z (uint32,
+ *               bit 0 = A), one value for each bit set, 0x80000000 for a
+ *               parameter with no value
+ *   BP_TEXT     a G-code line as text, without the line end
+ *   BP_END      back to text lines
+ *
+ * Every frame becomes a line in the command buffer_ring, that runs as any
+ * other with no "ok". The frames are acknowledged instead, "ack:<seq>"
+ * for the last one taken, once for all the frames read in one pass. The
+ * host may have up to BINARY_PROTOCOL_WINDOW bytes of frames not yet
+ * acknowledged. A frame with a bad CRC or out of order is answered with
+ * "rs:<seq>", the host sends again from that frame. A frame that can't be
+ * made into a line (a payload too short, a move code over 3, an unknown
+ * type, too many values) is answered with "Error:Binary frame ...:<seq>"
+ * before its acknowledge, it doesn't run and is not asked again.
+ * M108, M112 and M410 frames act right away, as the emergency parser
+ * does for text.
+ * The text line "M1004 S0" gets the port back to text at any time.
+ */
+
+#if ENABLED(BINARY_PROTOCOL)
+
+#define BINARY_SYNC         0xA5
+#define BINARY_NO_VALUE     int32_t(0x80000000)
+#define BINARY_SCALE        10000
+#define BINARY_MAX_PAYLOAD  MAX_CMD_SIZE
+
+enum BinaryFrameEnum : uint8_t {
+  BP_MOVE     = 1,
+  BP_COMMAND  = 2,
+  BP_TEXT     = 3,
+  BP_END      = 4
+};
+
+enum BinaryStateEnum : uint8_t {
+  BP_STATE_SYNC,
+  BP_STATE_SEQ,
+  BP_STATE_TYPE,
+  BP_STATE_LEN,
+  BP_STATE_PAYLOAD,
+  BP_STATE_CRC_L,
+  BP_STATE_CRC_H
+};
+
+class BinaryProtocol {
+
+  public: /** Constructor */
+
+    BinaryProtocol() {}
+
+  public: /** Public Parameters */
+
+    static int8_t port;           // Serial port in binary mode, -1 for none
+
+  private: /** Private Parameters */
+
+    static BinaryStateEnum state;
+
+    static uint8_t  seq,          // Sequence of the frame being read
+                    type,
+                    len,
+                    count,        // Payload bytes read
+                    expected,     // Sequence of the next frame to take
+                    crc_low,      // Low byte of the frame CRC
+                    payload[BINARY_MAX_PAYLOAD];
+
+    static uint16_t crc;
+
+    static bool     resend,       // Waiting for the frame asked again
+                    ack_pending;  // Frames taken and not acknowledged
+
+  public: /** Public Function */
+
+    // Switch a port to binary frames (on) or back to text lines
+    static void set_port(const int8_t p, const bool on);
+
+    // A text line with M1004 switches the port as soon as it is read
+    static void check_line(const int8_t p, const char * const line);
+
+    /**
+     * Read a byte of the port in binary mode.
+     * Return true when a frame is complete, with the line to enqueue.
+     */
+    static bool receive(const uint8_t c, char (&line)[MAX_CMD_SIZE], int &ind);
+
+    // Acknowledge the frames taken since the last call
+    static void acknowledge();
+
+  private: /** Private Function */
+
+    static bool decode(char (&line)[MAX_CMD_SIZE]);
+
+    static void ask_resend();
+
+    static void reject(PGM_P const why);
+
+};
+
+extern BinaryProtocol binary_protocol;
+
+#endif // ENABLED(BINARY_PROTOCOL)
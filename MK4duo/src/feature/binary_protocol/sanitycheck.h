@@ -0,0 +1,38 @@
+/**
+ * MK4duo Firmware for 3D Printer, Laser and CNC
+ *
+ * Based on Marlin, Sprinter and grbl
+ * Copyright (c) 2011 Camiel Gubbels / Erik van der Zalm
+ * Copyright (c) 2020 Alberto Cotronei @MagoKimbra
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#pragma once
+
+/**
+ * sanitycheck.h
+ *
+ * Test configuration values for errors at compile-time.
+ */
+
+#if ENABLED(BINARY_PROTOCOL)
+  #if DISABLED(BINARY_PROTOCOL_WINDOW)
+    #error "DEPENDENCY ERROR: Missing setting BINARY_PROTOCOL_WINDOW is needed by BINARY_PROTOCOL."
+  #elif BINARY_PROTOCOL_WINDOW < 16 || BINARY_PROTOCOL_WINDOW > RX_BUFFER_SIZE - 1
+    #error "DEPENDENCY ERROR: BINARY_PROTOCOL_WINDOW must be from 16 to RX_BUFFER_SIZE - 1."
+  #elif MAX_CMD_SIZE > 255
+    #error "DEPENDENCY ERROR: BINARY_PROTOCOL requires MAX_CMD_SIZE up to 255."
+  #endif
+#endif
@@ -0,0 +1,203 @@
+/**
+ * MK4duo Firmware for 3D Printer, Laser and CNC
+ *
+ * Based on Marlin, Sprinter and grbl
+ * Copyright (c) 2011 Camiel Gubbels / Erik van der Zalm
+ * Copyright (c) 2020 Alberto Cotronei @MagoKimbra
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+/**
+ * inputshaper.cpp
+ *
+ * Copyright (c) 2020 Alberto Cotronei @MagoKimbra
+ */
+
+#include "../../../MK4duo.h"
+#include "sanitycheck.h"
+
+#if ENABLED(INPUT_SHAPING)
+
+InputShaper inputshaper;
+
+/** Public Parameters */
+input_shaper_data_t InputShaper::data;
+
+shaper_axis_t InputShaper::axis[INPUT_SHAPING_AXES];
+
+uint32_t  InputShaper::clock      = 0;
+uint8_t   InputShaper::axis_bits  = 0;
+uint16_t  InputShaper::overflows  = 0;
+
+/** Public Function */
+void InputShaper::factory_parameters() {
+  constexpr uint8_t type[]      = INPUT_SHAPING_TYPE;
+  constexpr float   frequency[] = INPUT_SHAPING_FREQUENCY,
+                    damping[]   = INPUT_SHAPING_DAMPING;
+  LOOP_L_N(a, INPUT_SHAPING_AXES) {
+    data.type[a]      = type[a];
+    data.frequency[a] = frequency[a];
+    data.damping[a]   = damping[a];
+  }
+}
+
+void InputShaper::refresh() {
+  planner.synchronize();
+  const bool awake = stepper.suspend();
+  axis_bits = 0;
+  LOOP_L_N(a, INPUT_SHAPING_AXES) {
+    shaper_axis_t &s = axis[a];
+    set_impulses(s, data.type[a], data.frequency[a], data.damping[a]);
+    s.head = 0;
+    LOOP_L_N(i, INPUT_SHAPING_MAX_IMPULSES) s.echo[i] = 0;
+    s.accum = s.pending = s.direction = 0;
+    if (s.impulses > 1) SBI(axis_bits, a);
+  }
+  if (awake) stepper.wake_up();
+}
+
+bool InputShaper::busy() {
+  LOOP_L_N(a, INPUT_SHAPING_AXES) {
+    const shaper_axis_t &s = axis[a];
+    if (s.impulses > 1 && (s.echo[s.impulses - 1] != s.head || s.accum || s.pending)) return true;
+  }
+  return false;
+}
+
+void InputShaper::print_M593() {
+  SERIAL_LM(CFG, "Input Shaping: T[0 None, 1 ZV, 2 ZVD, 3 MZV, 4 EI] F[Hz] D[damping]");
+  LOOP_L_N(a, INPUT_SHAPING_AXES) {
+    SERIAL_SM(CFG, "  M593 ");
+    SERIAL_CHR(axis_codes[a]);
+    SERIAL_MV(" T", int(data.type[a]));
+    SERIAL_MV(" F", data.frequency[a]);
+    SERIAL_MV(" D", data.damping[a]);
+    SERIAL_EOL();
+  }
+}
+
+void InputShaper::push() {
+  LOOP_L_N(a, INPUT_SHAPING_AXES) {
+    shaper_axis_t &s = axis[a];
+    if (!s.pending) continue;
+
+    const shaping_index_t tail = s.echo[s.impulses - 1];
+    if (next(s.head) == tail) {
+      // Buffer full: echo the oldest event now, for the impulses still waiting for it
+      for (uint8_t i = 1; i < s.impulses; i++) {
+        if (s.echo[i] == tail) {
+          s.accum += s.steps[tail] * s.amplitude[i];
+          s.echo[i] = next(tail);
+        }
+      }
+      overflows++;
+    }
+
+    s.time[s.head] = clock;
+    s.steps[s.head] = s.pending;
+    s.head = next(s.head);
+    s.pending = 0;
+  }
+}
+
+uint32_t InputShaper::collect() {
+  uint32_t next_echo = INPUT_SHAPING_NEVER;
+  LOOP_L_N(a, INPUT_SHAPING_AXES) {
+    shaper_axis_t &s = axis[a];
+    for (uint8_t i = 1; i < s.impulses; i++) {
+      shaping_index_t e = s.echo[i];
+      while (e != s.head) {
+        const int32_t due = int32_t(s.time[e] + s.delay[i] - clock);
+        if (due > 0) {
+          NOMORE(next_echo, uint32_t(due));
+          break;
+        }
+        s.accum += s.steps[e] * s.amplitude[i];
+        e = next(e);
+      }
+      s.echo[i] = e;
+    }
+  }
+  return next_echo;
+}
+
+/** Private Function */
+
+/**
+ * Impulses of the shapers, from the natural frequency and the damping ratio.
+ * Amplitudes are normalized and rounded so that their sum is exactly
+ * INPUT_SHAPING_SCALE, then every step of the original motion is output
+ * as a whole step once all its impulses have been added.
+ */
+void InputShaper::set_impulses(shaper_axis_t &s, const uint8_t type, const float frequency, const float damping) {
+
+  float A[INPUT_SHAPING_MAX_IMPULSES] = { 1.0f },
+        T[INPUT_SHAPING_MAX_IMPULSES] = { 0.0f };
+
+  s.impulses = 1;
+
+  if (frequency > 0.0f && WITHIN(damping, 0.0f, 0.99f)) {
+
+    const float df = SQRT(1.0f - sq(damping)),
+                K  = expf(-damping * M_PI / df),
+                td = 1.0f / (frequency * df);
+
+    switch (type) {
+      case SHAPER_ZV:
+        s.impulses = 2;
+        A[1] = K;
+        T[1] = 0.5f * td;
+        break;
+      case SHAPER_ZVD:
+        s.impulses = 3;
+        A[1] = 2.0f * K;        A[2] = sq(K);
+        T[1] = 0.5f * td;       T[2] = td;
+        break;
+      case SHAPER_MZV: {
+        s.impulses = 3;
+        const float Km = expf(-0.75f * damping * M_PI / df),
+                    a1 = 1.0f - M_SQRT1_2;
+        A[0] = a1;
+        A[1] = (M_SQRT2 - 1.0f) * Km;
+        A[2] = a1 * sq(Km);
+        T[1] = 0.375f * td;     T[2] = 0.75f * td;
+      } break;
+      case SHAPER_EI: {
+        s.impulses = 3;
+        constexpr float v_tol = 0.05f;  // Residual vibration allowed at the design frequency
+        A[0] = 0.25f * (1.0f + v_tol);
+        A[1] = 0.5f * (1.0f - v_tol) * K;
+        A[2] = A[0] * sq(K);
+        T[1] = 0.5f * td;       T[2] = td;
+      } break;
+      default: break;
+    }
+  }
+
+  float sum = 0.0f;
+  LOOP_L_N(i, s.impulses) sum += A[i];
+
+  int16_t rest = INPUT_SHAPING_SCALE;
+  for (uint8_t i = 1; i < s.impulses; i++) {
+    s.amplitude[i] = LROUND(A[i] * INPUT_SHAPING_SCALE / sum);
+    rest -= s.amplitude[i];
+    s.delay[i] = LROUND(T[i] * STEPPER_TIMER_RATE);
+  }
+  s.amplitude[0] = rest;
+  s.delay[0] = 0;
+}
+
+#endif // ENABLED(INPUT_SHAPING)
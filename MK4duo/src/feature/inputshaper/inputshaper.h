@@ -0,0 +1,159 @@
+/**
+ * MK4duo Firmware for 3D Printer, Laser and CNC
+ *
+ * Based on Marlin, Sprinter and grbl
+ * Copyright (c) 2011 Camiel Gubbels / Erik van der Zalm
+ * Copyright (c) 2020 Alberto Cotronei @MagoKimbra
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#pragma once
+
+/**
+ * inputshaper.h
+ *
+ * Copyright (c) 2020 Alberto Cotronei @MagoKimbra
+ */
+
+#if ENABLED(INPUT_SHAPING)
+
+#define INPUT_SHAPING_AXES          2       // X and Y (A and B on CORE machines)
+#define INPUT_SHAPING_MAX_IMPULSES  3
+#define INPUT_SHAPING_SCALE         256     // Sum of the fixed point amplitudes
+#define INPUT_SHAPING_HALF          (INPUT_SHAPING_SCALE / 2)
+#define INPUT_SHAPING_NEVER         0xFFFFFFFF
+
+#if INPUT_SHAPING_BUFFER_SIZE > 255
+  typedef uint16_t shaping_index_t;
+#else
+  typedef uint8_t shaping_index_t;
+#endif
+
+enum ShaperEnum : uint8_t {
+  SHAPER_NONE,
+  SHAPER_ZV,
+  SHAPER_ZVD,
+  SHAPER_MZV,
+  SHAPER_EI,
+  SHAPER_COUNT
+};
+
+// Struct Input shaper data
+typedef struct {
+  uint8_t type[INPUT_SHAPING_AXES];
+  float   frequency[INPUT_SHAPING_AXES],
+          damping[INPUT_SHAPING_AXES];
+} input_shaper_data_t;
+
+// Struct Input shaper axis, used by the Stepper ISR
+typedef struct {
+  uint8_t         impulses;                               // Impulses of the shaper, less than 2 = not shaped
+  int16_t         amplitude[INPUT_SHAPING_MAX_IMPULSES];  // Fixed point amplitudes, the sum is INPUT_SHAPING_SCALE
+  uint32_t        delay[INPUT_SHAPING_MAX_IMPULSES];      // Delay of the impulses in stepper timer ticks
+  uint32_t        time[INPUT_SHAPING_BUFFER_SIZE];        // Stepper timer tick of the step events
+  int8_t          steps[INPUT_SHAPING_BUFFER_SIZE];       // Signed steps of the step events
+  shaping_index_t head,                                   // Next free event
+                  echo[INPUT_SHAPING_MAX_IMPULSES];       // Next event for every delayed impulse
+  int16_t         accum;                                  // Shaped steps not output yet
+  int8_t          pending,                                // Steps of the running pulse phase
+                  direction;                              // Direction on the DIR pin, 0 = unknown
+} shaper_axis_t;
+
+class InputShaper {
+
+  public: /** Constructor */
+
+    InputShaper() {}
+
+  public: /** Public Parameters */
+
+    static input_shaper_data_t data;
+
+    static shaper_axis_t axis[INPUT_SHAPING_AXES];
+
+    static uint32_t clock;          // Stepper timer ticks of the running Stepper ISR phase
+
+    static uint8_t  axis_bits;      // Axes with an active shaper
+
+    static uint16_t overflows;      // Events echoed early because the buffer was full
+
+  public: /** Public Function */
+
+    static void factory_parameters();
+
+    /**
+     * Compute the impulses from data, once all moves are done
+     */
+    static void refresh();
+
+    /**
+     * True while delayed impulses are waiting
+     */
+    static bool busy();
+
+    static void print_M593();
+
+    /**
+     * Stepper ISR: a step of the original motion.
+     * Returns the direction of the step to output now, 0 for none.
+     */
+    FORCE_INLINE static int8_t move(const AxisEnum a, const int8_t dir) {
+      shaper_axis_t &s = axis[a];
+      s.pending += dir;
+      s.accum += dir > 0 ? s.amplitude[0] : -s.amplitude[0];
+      return take_one(s);
+    }
+
+    /**
+     * Stepper ISR: steps to output now, the rest stays in the accumulator
+     */
+    FORCE_INLINE static int16_t take(const AxisEnum a) {
+      shaper_axis_t &s = axis[a];
+      int16_t n = 0;
+      while (s.accum >= INPUT_SHAPING_HALF) { s.accum -= INPUT_SHAPING_SCALE; n++; }
+      while (s.accum < -INPUT_SHAPING_HALF) { s.accum += INPUT_SHAPING_SCALE; n--; }
+      return n;
+    }
+
+    /**
+     * Stepper ISR: store the steps of the pulse phase for the delayed impulses
+     */
+    static void push();
+
+    /**
+     * Stepper ISR: add the delayed impulses due now to the accumulators.
+     * Returns the ticks to the next delayed impulse.
+     */
+    static uint32_t collect();
+
+  private: /** Private Function */
+
+    FORCE_INLINE static int8_t take_one(shaper_axis_t &s) {
+      if (s.accum >= INPUT_SHAPING_HALF) { s.accum -= INPUT_SHAPING_SCALE; return 1; }
+      if (s.accum < -INPUT_SHAPING_HALF) { s.accum += INPUT_SHAPING_SCALE; return -1; }
+      return 0;
+    }
+
+    FORCE_INLINE static shaping_index_t next(const shaping_index_t i) {
+      return i + 1 < INPUT_SHAPING_BUFFER_SIZE ? i + 1 : 0;
+    }
+
+    static void set_impulses(shaper_axis_t &s, const uint8_t type, const float frequency, const float damping);
+
+};
+
+extern InputShaper inputshaper;
+
+#endif // ENABLED(INPUT_SHAPING)
@@ -0,0 +1,40 @@
+/**
+ * MK4duo Firmware for 3D Printer, Laser and CNC
+ *
+ * Based on Marlin, Sprinter and grbl
+ * Copyright (c) 2011 Camiel Gubbels / Erik van der Zalm
+ * Copyright (c) 2020 Alberto Cotronei @MagoKimbra
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#pragma once
+
+/**
+ * sanitycheck.h
+ *
+ * Test configuration values for errors at compile-time.
+ */
+
+#if ENABLED(INPUT_SHAPING)
+  #if MECH(DELTA) || IS_SCARA
+    #error "DEPENDENCY ERROR: INPUT_SHAPING is only for Cartesian and Core machines."
+  #elif DISABLED(INPUT_SHAPING_TYPE) || DISABLED(INPUT_SHAPING_FREQUENCY) || DISABLED(INPUT_SHAPING_DAMPING)
+    #error "DEPENDENCY ERROR: Missing setting INPUT_SHAPING_TYPE, INPUT_SHAPING_FREQUENCY or INPUT_SHAPING_DAMPING."
+  #elif DISABLED(INPUT_SHAPING_BUFFER_SIZE)
+    #error "DEPENDENCY ERROR: Missing setting INPUT_SHAPING_BUFFER_SIZE is needed by INPUT_SHAPING."
+  #elif INPUT_SHAPING_BUFFER_SIZE < 16 || INPUT_SHAPING_BUFFER_SIZE > 65535
+    #error "DEPENDENCY ERROR: INPUT_SHAPING_BUFFER_SIZE must be from 16 to 65535."
+  #endif
+#endif
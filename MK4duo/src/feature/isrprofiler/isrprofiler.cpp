@@ -0,0 +1,116 @@
+/**
+ * MK4duo Firmware for 3D Printer, Laser and CNC
+ *
+ * Based on Marlin, Sprinter and grbl
+ * Copyright (c) 2011 Camiel Gubbels / Erik van der Zalm
+ * Copyright (c) 2020 Alberto Cotronei @MagoKimbra
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+/**
+ * isrprofiler.cpp
+ *
+ * Copyright (c) 2020 Alberto Cotronei @MagoKimbra
+ */
+
+#include "../../../MK4duo.h"
+
+#if ENABLED(STEPPER_ISR_PROFILER)
+
+IsrProfiler isrprofiler;
+
+/** Public Parameters */
+isr_phase_stats_t IsrProfiler::phase[ISR_PHASE_COUNT];
+
+uint32_t IsrProfiler::loops_exhausted = 0,
+         IsrProfiler::tick_tasks_late = 0;
+
+/** Public Function */
+void IsrProfiler::init() {
+  HAL_cycle_counter_init();
+  reset();
+}
+
+void IsrProfiler::reset() {
+  const bool awake = stepper.suspend();
+  LOOP_L_N(p, ISR_PHASE_COUNT) {
+    ZERO(phase[p].histogram);
+    phase[p].count  = 0;
+    phase[p].sum    = 0;
+    phase[p].min    = 0xFFFFFFFF;
+    phase[p].max    = 0;
+  }
+  loops_exhausted = 0;
+  tick_tasks_late = 0;
+  if (awake) stepper.wake_up();
+}
+
+void IsrProfiler::print() {
+
+  SERIAL_EMV("Stepper ISR profile, cycles at ", uint32_t(HAL_CYCLE_COUNTER_RATE));
+  #if ENABLED(HAL_CYCLE_COUNTER_STEPPER_ONLY)
+    SERIAL_EM("Phases out of the stepper ISR timed by micros()");
+  #endif
+
+  LOOP_L_N(p, ISR_PHASE_COUNT) {
+
+    // Take a consistent copy of one phase at a time to spare the stack
+    const bool awake = stepper.suspend();
+    const isr_phase_stats_t stats = phase[p];
+    if (awake) stepper.wake_up();
+
+    switch (p) {
+      case ISR_PHASE_PULSE: SERIAL_MSG("Pulse"); break;
+      case ISR_PHASE_BLOCK: SERIAL_MSG("Block"); break;
+      #if ENABLED(LIN_ADVANCE)
+        case ISR_PHASE_ADVANCE: SERIAL_MSG("Advance"); break;
+      #endif
+      #if ENABLED(INPUT_SHAPING)
+        case ISR_PHASE_SHAPING: SERIAL_MSG("Shaping"); break;
+      #endif
+      case ISR_PHASE_TICK: SERIAL_MSG("Tick"); break;
+      case ISR_PHASE_TICK_TASK: SERIAL_MSG("Tick task"); break;
+      case ISR_PHASE_PLANNER: SERIAL_MSG("Planner"); break;
+      case ISR_PHASE_PARSE: SERIAL_MSG("Parse"); break;
+      #if ENABLED(GCODE_PREPARSE)
+        case ISR_PHASE_PREPARSE: SERIAL_MSG("Preparse"); break;
+      #endif
+    }
+    SERIAL_MV(" count:", stats.count);
+    if (stats.count) {
+      SERIAL_MV(" min:", stats.min);
+      SERIAL_MV(" avg:", uint32_t(stats.sum / stats.count));
+      SERIAL_MV(" max:", stats.max);
+    }
+    SERIAL_EOL();
+
+    LOOP_L_N(b, ISR_PROFILER_BUCKETS) {
+      if (!stats.histogram[b]) continue;
+      if (b == ISR_PROFILER_BUCKETS - 1)
+        SERIAL_MV(" >=", uint32_t(1UL << (b - 1)));
+      else
+        SERIAL_MV(" <", uint32_t(1UL << b));
+      SERIAL_EMV(":", stats.histogram[b]);
+    }
+
+  }
+
+  SERIAL_EMV("Max loops exhausted:", loops_exhausted);
+  SERIAL_EMV("Tick tasks run late:", tick_tasks_late);
+
+}
+
+#endif // ENABLED(STEPPER_ISR_PROFILER)
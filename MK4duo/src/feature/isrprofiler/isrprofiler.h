@@ -0,0 +1,126 @@
+/**
+ * MK4duo Firmware for 3D Printer, Laser and CNC
+ *
+ * Based on Marlin, Sprinter and grbl
+ * Copyright (c) 2011 Camiel Gubbels / Erik van der Zalm
+ * Copyright (c) 2020 Alberto Cotronei @MagoKimbra
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#pragma once
+
+/**
+ * isrprofiler.h
+ *
+ * Copyright (c) 2020 Alberto Cotronei @MagoKimbra
+ */
+
+#if ENABLED(STEPPER_ISR_PROFILER)
+
+// Number of log2 histogram buckets: bucket n counts phases of 2^(n-1) to 2^n - 1 cycles
+#if ENABLED(__AVR__)
+  #define ISR_PROFILER_BUCKETS  20
+  #define ISR_PROFILER_CLZ(V)   __builtin_clzl(V)
+#else
+  #define ISR_PROFILER_BUCKETS  32
+  #define ISR_PROFILER_CLZ(V)   __builtin_clz(V)
+#endif
+
+enum ISRPhaseEnum : uint8_t {
+  ISR_PHASE_PULSE,
+  ISR_PHASE_BLOCK,
+  #if ENABLED(LIN_ADVANCE)
+    ISR_PHASE_ADVANCE,
+  #endif
+  #if ENABLED(INPUT_SHAPING)
+    ISR_PHASE_SHAPING,
+  #endif
+  ISR_PHASE_TICK,     // HAL::Tick, the 1 ms ISR
+  ISR_PHASE_TICK_TASK, // Deferred half of HAL::Tick, spin() and the periodical actions
+  ISR_PHASE_PLANNER,  // Planner recalculate, out of the ISR (ISRs that interrupt it included)
+  ISR_PHASE_PARSE,    // Parse of the next command, before it runs
+  #if ENABLED(GCODE_PREPARSE)
+    ISR_PHASE_PREPARSE, // Parse of a command added to the buffer ring
+  #endif
+  ISR_PHASE_COUNT
+};
+
+// Phases out of the stepper ISR. Where the cycle counter is the stepper
+// timer, reset at every compare, they are timed by micros() instead
+#if ENABLED(HAL_CYCLE_COUNTER_STEPPER_ONLY)
+  typedef uint32_t isr_free_t;
+#else
+  typedef hal_cycle_t isr_free_t;
+#endif
+
+typedef struct {
+  uint32_t  count,
+            min,
+            max;
+  uint64_t  sum;
+  uint32_t  histogram[ISR_PROFILER_BUCKETS];
+} isr_phase_stats_t;
+
+class IsrProfiler {
+
+  public: /** Constructor */
+
+    IsrProfiler() {}
+
+  public: /** Public Parameters */
+
+    static isr_phase_stats_t phase[ISR_PHASE_COUNT];
+
+    static uint32_t loops_exhausted,
+                    tick_tasks_late;
+
+  public: /** Public Function */
+
+    static void init();
+    static void reset();
+    static void print();
+
+    FORCE_INLINE static hal_cycle_t start() { return HAL_cycle_counter_get(); }
+
+    FORCE_INLINE static void stop(const ISRPhaseEnum p, const hal_cycle_t start_cycle) {
+      record(p, uint32_t(hal_cycle_t(HAL_cycle_counter_get() - start_cycle)) * (HAL_CYCLE_COUNTER_MULT));
+    }
+
+    #if ENABLED(HAL_CYCLE_COUNTER_STEPPER_ONLY)
+      FORCE_INLINE static isr_free_t start_free() { return micros(); }
+      FORCE_INLINE static void stop_free(const ISRPhaseEnum p, const isr_free_t start_us) {
+        record(p, (micros() - start_us) * ((HAL_CYCLE_COUNTER_RATE) / 1000000UL));
+      }
+    #else
+      FORCE_INLINE static isr_free_t start_free() { return start(); }
+      FORCE_INLINE static void stop_free(const ISRPhaseEnum p, const isr_free_t start_cycle) { stop(p, start_cycle); }
+    #endif
+
+    FORCE_INLINE static void record(const ISRPhaseEnum p, const uint32_t cycles) {
+      isr_phase_stats_t &stats = phase[p];
+      stats.count++;
+      stats.sum += cycles;
+      NOMORE(stats.min, cycles);
+      NOLESS(stats.max, cycles);
+      uint8_t bucket = cycles ? 32 - ISR_PROFILER_CLZ(cycles) : 0;
+      NOMORE(bucket, ISR_PROFILER_BUCKETS - 1);
+      stats.histogram[bucket]++;
+    }
+
+};
+
+extern IsrProfiler isrprofiler;
+
+#endif // ENABLED(STEPPER_ISR_PROFILER)
@@ -0,0 +1,95 @@
+/**
+ * MK4duo Firmware for 3D Printer, Laser and CNC
+ *
+ * Based on Marlin, Sprinter and grbl
+ * Copyright (c) 2011 Camiel Gubbels / Erik van der Zalm
+ * Copyright (c) 2020 Alberto Cotronei @MagoKimbra
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+/**
+ * rasterpool.cpp
+ *
+ * Copyright (c) 2020 Alberto Cotronei @MagoKimbra
+ */
+
+#include "../../../../MK4duo.h"
+
+#if ENABLED(LASER) && ENABLED(LASER_RASTER)
+
+RasterPool rasterpool;
+
+/** Public Parameters */
+uint8_t RasterPool::data[LASER_RASTER_POOL_SIZE];
+
+/** Private Parameters */
+volatile raster_index_t RasterPool::head  = 0,
+                        RasterPool::tail  = 0;
+volatile uint8_t        RasterPool::count = 0;
+
+/** Public Function */
+void RasterPool::clear() {
+  const bool awake = stepper.suspend();
+  head = tail = count = 0;
+  if (awake) stepper.wake_up();
+}
+
+raster_index_t RasterPool::reserve(const raster_index_t length) {
+  raster_index_t index;
+  for (;;) {
+    const bool awake = stepper.suspend();
+    const bool done = allocate(length, index);
+    if (awake) stepper.wake_up();
+    if (done) return index;
+    // Wait for the stepper to consume older raster lines
+    printer.idle();
+  }
+}
+
+raster_index_t RasterPool::used() {
+  const bool awake = stepper.suspend();
+  const raster_index_t h = head, t = tail;
+  const uint8_t c = count;
+  if (awake) stepper.wake_up();
+  if (!c) return 0;
+  return h > t ? h - t : (LASER_RASTER_POOL_SIZE) - t + h;
+}
+
+/** Private Function */
+bool RasterPool::allocate(const raster_index_t length, raster_index_t &index) {
+
+  if (!count) head = tail = 0;
+
+  if (!count || head > tail) {
+    // Free space is after head and before tail
+    if ((LASER_RASTER_POOL_SIZE) - head >= length)
+      index = head;
+    else if (tail >= length)
+      index = 0;
+    else
+      return false;
+  }
+  else if (head < tail && tail - head >= length)
+    index = head;
+  else
+    return false;
+
+  head = index + length;
+  count++;
+  return true;
+}
+
+#endif // ENABLED(LASER) && ENABLED(LASER_RASTER)
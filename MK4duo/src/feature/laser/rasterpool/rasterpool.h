@@ -0,0 +1,88 @@
+/**
+ * MK4duo Firmware for 3D Printer, Laser and CNC
+ *
+ * Based on Marlin, Sprinter and grbl
+ * Copyright (c) 2011 Camiel Gubbels / Erik van der Zalm
+ * Copyright (c) 2020 Alberto Cotronei @MagoKimbra
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#pragma once
+
+/**
+ * rasterpool.h
+ *
+ * Copyright (c) 2020 Alberto Cotronei @MagoKimbra
+ */
+
+#if ENABLED(LASER) && ENABLED(LASER_RASTER)
+
+/**
+ * Ring allocated storage for the raster lines of the queued blocks.
+ *
+ * The planner reserves exactly the pixels of each raster move and the
+ * stepper ISR releases them when it discards the block. As blocks are
+ * consumed in order, releasing just moves the tail past the allocation.
+ * An allocation never wraps: if it does not fit at the end of the pool
+ * it starts again from the beginning.
+ */
+class RasterPool {
+
+  public: /** Constructor */
+
+    RasterPool() {}
+
+  public: /** Public Parameters */
+
+    static uint8_t data[LASER_RASTER_POOL_SIZE];
+
+  private: /** Private Parameters */
+
+    static volatile raster_index_t  head,   // First byte after the last allocation
+                                    tail;   // First byte of the oldest allocation
+    static volatile uint8_t         count;  // Live allocations
+
+  public: /** Public Function */
+
+    static void clear();
+
+    /**
+     * Reserve length bytes, waiting for the stepper to release
+     * older lines if needed. Return the index of the first byte.
+     */
+    static raster_index_t reserve(const raster_index_t length);
+
+    /**
+     * Bytes in use, including the gap skipped at the end of the pool
+     */
+    static raster_index_t used();
+
+    /**
+     * Release the oldest allocation - Called from Stepper ISR context!
+     */
+    FORCE_INLINE static void release(const raster_index_t index, const raster_index_t length) {
+      tail = index + length;
+      count--;
+    }
+
+  private: /** Private Function */
+
+    static bool allocate(const raster_index_t length, raster_index_t &index);
+
+};
+
+extern RasterPool rasterpool;
+
+#endif // ENABLED(LASER) && ENABLED(LASER_RASTER)
@@ -49,4 +49,20 @@
       #endif
     #endif
   #endif
+  #if ENABLED(LASER_RASTER)
+    #if DISABLED(LASER_RASTER_POOL_SIZE)
+      #error "DEPENDENCY ERROR: Missing setting LASER_RASTER_POOL_SIZE is needed by LASER_RASTER."
+    #elif LASER_RASTER_POOL_SIZE < LASER_MAX_RASTER_LINE
+      #error "DEPENDENCY ERROR: LASER_RASTER_POOL_SIZE must be at least LASER_MAX_RASTER_LINE."
+    #elif LASER_RASTER_POOL_SIZE > 65535
+      #error "DEPENDENCY ERROR: LASER_RASTER_POOL_SIZE must be less than 65536."
+    #endif
+  #endif
+  #if ENABLED(LASER_RASTER_STREAM)
+    #if DISABLED(LASER_RASTER)
+      #error "DEPENDENCY ERROR: You have to enable LASER_RASTER to use LASER_RASTER_STREAM."
+    #elif DISABLED(LASER_RASTER_STREAM_TIMEOUT)
+      #error "DEPENDENCY ERROR: Missing setting LASER_RASTER_STREAM_TIMEOUT is needed by LASER_RASTER_STREAM."
+    #endif
+  #endif
 #endif
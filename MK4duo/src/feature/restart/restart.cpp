@@ -37,6 +37,10 @@ bool  Restart::enabled;
 uint32_t  Restart::cmd_sdpos      = 0,
           Restart::sdpos[BUFSIZE] = { 0 };  
 
+#if ENABLED(SD_RESTART_JOURNAL)
+  Journal<restart_job_t, SD_RESTART_JOURNAL_BLOCKS> Restart::journal;
+#endif
+
 /** Public Function */
 void Restart::enable(const bool onoff) {
   enabled = onoff;
@@ -62,19 +66,32 @@ void Restart::start_job() {
   card.getAbsFilename(job_info.fileName);
   cmd_sdpos = 0;
   ZERO(sdpos);
+  #if ENABLED(SD_RESTART_JOURNAL)
+    open_journal();
+  #endif
 }
 
 void Restart::purge_job() {
   clear_job();
+  #if ENABLED(SD_RESTART_JOURNAL)
+    journal.reset(0);
+  #endif
   card.delete_restart_file();
 }
 
 void Restart::load_job() {
-  if (exists()) {
-    open(true);
-    (void)job_file.read(&job_info, sizeof(job_info));
-    close();
-  }
+  #if ENABLED(SD_RESTART_JOURNAL)
+    // The last snapshot and the changes after it
+    bool created;
+    journal.reset(card.open_restart_journal(false, created));
+    (void)journal.replay(*card.fat.card(), job_info);
+  #else
+    if (exists()) {
+      open(true);
+      (void)job_file.read(&job_info, sizeof(job_info));
+      close();
+    }
+  #endif
   debug_info(PSTR("Load"));
 }
 
@@ -321,15 +338,42 @@ void Restart::write_job() {
 
   debug_info(PSTR("Write"));
 
-  open(false);
-  if (!job_file.seekSet(0)) failed = true;
-  if (!failed && !job_file.write(&job_info, sizeof(job_info)) == sizeof(job_info))
-    failed = true;
-  close();
+  #if ENABLED(SD_RESTART_JOURNAL)
+    // One block write. The file is looked for first,
+    // the blocks may be freed by a delete or be of another card
+    bool created;
+    if (!journal.isOpen() || card.open_restart_journal(false, created) != journal.getFirst()) open_journal();
+    failed = !journal.append(*card.fat.card(), job_info);
+  #else
+    open(false);
+    if (!job_file.seekSet(0)) failed = true;
+    if (!failed && !job_file.write(&job_info, sizeof(job_info)) == sizeof(job_info))
+      failed = true;
+    close();
+  #endif
   if (failed) DEBUG_LM(DEB, " Restart file write failed.");
 
 }
 
+#if ENABLED(SD_RESTART_JOURNAL)
+
+  /**
+   * Open the journal, made if it is not on the card. The saves go on
+   * after the last state in it, that stays until the ring comes round.
+   */
+  void Restart::open_journal() {
+    bool created;
+    const uint32_t first = card.open_restart_journal(true, created);
+    if (created) {
+      journal.reset(first);
+      if (!journal.erase(*card.fat.card())) journal.reset(0);
+    }
+    else
+      (void)journal.open(*card.fat.card(), first);
+  }
+
+#endif
+
 #if ENABLED(DEBUG_RESTART)
 
   void Restart::debug_info(PGM_P const prefix) {
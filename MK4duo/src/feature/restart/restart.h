@@ -33,6 +33,10 @@
   #include "../mixing/mixing.h"
 #endif
 
+#if ENABLED(SD_RESTART_JOURNAL)
+  #include "../../lib/journal.h"
+#endif
+
 typedef struct {
 
   uint8_t valid_head;
@@ -111,6 +115,10 @@ class Restart {
     static uint32_t cmd_sdpos,
                     sdpos[BUFSIZE];
 
+    #if ENABLED(SD_RESTART_JOURNAL)
+      static Journal<restart_job_t, SD_RESTART_JOURNAL_BLOCKS> journal;
+    #endif
+
   public: /** Public Function */
 
     static void enable(const bool onoff);
@@ -139,6 +147,10 @@ class Restart {
 
     static void write_job();
 
+    #if ENABLED(SD_RESTART_JOURNAL)
+      static void open_journal();
+    #endif
+
     #if ENABLED(DEBUG_RESTART)
       static void debug_info(PGM_P const prefix);
     #else
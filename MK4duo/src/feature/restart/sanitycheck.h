@@ -26,3 +26,13 @@
  *
  * Test configuration values for errors at compile-time.
  */
+
+#if ENABLED(SD_RESTART_JOURNAL)
+  #if DISABLED(SD_RESTART_FILE)
+    #error "DEPENDENCY ERROR: SD_RESTART_JOURNAL requires SD_RESTART_FILE."
+  #elif DISABLED(SD_RESTART_JOURNAL_BLOCKS)
+    #error "DEPENDENCY ERROR: Missing setting SD_RESTART_JOURNAL_BLOCKS is needed by SD_RESTART_JOURNAL."
+  #elif SD_RESTART_JOURNAL_BLOCKS < 2 || SD_RESTART_JOURNAL_BLOCKS > 255
+    #error "DEPENDENCY ERROR: SD_RESTART_JOURNAL_BLOCKS must be from 2 to 255."
+  #endif
+#endif
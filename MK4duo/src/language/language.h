@@ -139,6 +139,8 @@
 #define STR_COMPILED                      "Compiled: "
 #define STR_FREE_MEMORY                   "Free Memory: "
 #define STR_PLANNER_BUFFER_BYTES          " PlannerBufferBytes: "
+#define STR_PLANNER_BLOCK_BYTES           " PlannerBlockBytes: "
+#define STR_RASTER_POOL_BYTES             " RasterPoolBytes: "
 #define STR_STATS                         "Stats: "
 #define STR_SERVICE                       "Service: "
 #define STR_ERR_LINE_NO                   "Line Number is not Last Line Number+1, Last Line: "
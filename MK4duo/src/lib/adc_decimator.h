@@ -0,0 +1,143 @@
+/**
+ * MK4duo Firmware for 3D Printer, Laser and CNC
+ *
+ * Based on Marlin, Sprinter and grbl
+ * Copyright (c) 2011 Camiel Gubbels / Erik van der Zalm
+ * Copyright (c) 2020 Alberto Cotronei @MagoKimbra
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#pragma once
+
+/**
+ * @brief   ADC Decimator class
+ * @details Oversampling and decimation of the samples of a DMA scan of
+ *          the ADC. put() adds a sample of a channel; each SAMPLES samples
+ *          of a channel make one reading of BITS bits more than the ADC,
+ *          the sum shifted down to the new range and rounded. The noise of
+ *          the input, an LSB or more, dithers the extra bits.
+ *
+ *          The sum of squares, lowest and highest sample of the last window
+ *          of each channel are kept for the noise figures of M1006, made
+ *          only when asked. SAMPLES is a power of 2 from 4^BITS to 256,
+ *          the sum of squares of 256 samples of 12 bits still fits 32 bit.
+ *
+ *          scripts/adcdecimate.py runs it on a modelled thermistor input
+ *          against the averaging filter read once for each Tick.
+ */
+template<uint8_t CHANNELS, uint16_t SAMPLES, uint8_t BITS>
+class ADC_Decimator {
+
+  private: /** Private Parameters */
+
+    static constexpr uint8_t log2(const uint16_t n) { return n > 1 ? 1 + log2(n >> 1) : 0; }
+    static constexpr uint8_t SHIFT = log2(SAMPLES) - BITS;
+
+    struct channel_t {
+      uint32_t  sum,
+                squares,
+                last_sum,
+                last_squares,
+                readings;             // Readings made since clear_stats()
+      uint16_t  count,
+                low, high,
+                last_low, last_high,
+                value;                // Last reading, ADC range << BITS
+      bool      valid;
+    };
+
+    channel_t channel[CHANNELS];
+
+    static_assert(SAMPLES >= (1U << (2 * BITS)) && SAMPLES <= 256 && !(SAMPLES & (SAMPLES - 1)),
+                  "ADC_Decimator: SAMPLES must be a power of 2 from 4^BITS to 256.");
+
+  public: /** Constructor */
+
+    ADC_Decimator<CHANNELS, SAMPLES, BITS>() { this->reset(); }
+
+  public: /** Public Parameters */
+
+    uint32_t  samples,                // Samples taken since clear_stats()
+              overruns;               // DMA buffers lost since clear_stats()
+
+  public: /** Public Function */
+
+    void reset() {
+      for (uint8_t ch = 0; ch < CHANNELS; ch++) this->reset(ch);
+      this->clear_stats();
+    }
+
+    // Drop the readings of a channel, as when its pin is changed
+    void reset(const uint8_t ch) {
+      if (ch >= CHANNELS) return;
+      channel_t &c = this->channel[ch];
+      c.sum = c.squares = c.last_sum = c.last_squares = c.readings = 0;
+      c.count = c.high = c.last_low = c.last_high = c.value = 0;
+      c.low = 0xFFFF;
+      c.valid = false;
+    }
+
+    void clear_stats() {
+      this->samples = this->overruns = 0;
+      for (uint8_t ch = 0; ch < CHANNELS; ch++) this->channel[ch].readings = 0;
+    }
+
+    void put(const uint8_t ch, const uint16_t sample) {
+      if (ch >= CHANNELS) return;
+      channel_t &c = this->channel[ch];
+      c.sum += sample;
+      c.squares += uint32_t(sample) * sample;
+      if (sample < c.low) c.low = sample;
+      if (sample > c.high) c.high = sample;
+      if (++c.count == SAMPLES) {
+        c.value = SHIFT ? (c.sum + (1UL << SHIFT >> 1)) >> SHIFT : c.sum;
+        c.last_sum = c.sum;
+        c.last_squares = c.squares;
+        c.last_low = c.low;
+        c.last_high = c.high;
+        c.readings++;
+        c.valid = true;
+        c.sum = c.squares = 0;
+        c.count = c.high = 0;
+        c.low = 0xFFFF;
+      }
+    }
+
+    // Last reading of a channel into value, false before the first one
+    template<typename T>
+    bool read(const uint8_t ch, T &value) {
+      if (ch >= CHANNELS || !this->channel[ch].valid) return false;
+      value = this->channel[ch].value;
+      return true;
+    }
+
+    uint32_t readings(const uint8_t ch) { return ch < CHANNELS ? this->channel[ch].readings : 0; }
+
+    // Standard deviation of the samples of the last window, in ADC LSB
+    float sigma(const uint8_t ch) {
+      if (ch >= CHANNELS || !this->channel[ch].valid) return 0.0f;
+      const channel_t &c = this->channel[ch];
+      // SAMPLES^2 times the variance, exact in 64 bit
+      const uint64_t var = uint64_t(c.last_squares) * SAMPLES - uint64_t(c.last_sum) * c.last_sum;
+      return sqrtf(float(var)) / SAMPLES;
+    }
+
+    // Highest less lowest sample of the last window, in ADC LSB
+    uint16_t peak(const uint8_t ch) {
+      if (ch >= CHANNELS || !this->channel[ch].valid) return 0;
+      return this->channel[ch].last_high - this->channel[ch].last_low;
+    }
+
+};
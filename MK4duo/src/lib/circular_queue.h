@@ -55,24 +55,51 @@ class Circular_Queue {
       if (this->isEmpty()) return T();
 
       uint8_t index = this->buffer.head;
-
-      --this->buffer.count;
-      if (++this->buffer.head >= this->buffer.size)
-        this->buffer.head = 0;
+      this->release();
 
       return this->buffer.queue[index];
     }
 
     bool enqueue(T const &item) {
-      if (this->isFull()) return false;
+      T * const slot = this->reserve();
+      if (!slot) return false;
+
+      *slot = item;
+      this->commit();
 
-      this->buffer.queue[this->buffer.tail] = item;
+      return true;
+    }
+
+    /**
+     * Zero-copy write: reserve() gives the slot at the tail, or nullptr if
+     * the queue is full. Fill it in place, then commit() adds it to the queue.
+     * Nothing is queued until commit(), so a slot can be reserved and dropped.
+     */
+    T* reserve() {
+      if (this->isFull()) return nullptr;
+      return &this->buffer.queue[this->buffer.tail];
+    }
 
+    void commit() {
       ++this->buffer.count;
       if (++this->buffer.tail >= this->buffer.size)
         this->buffer.tail = 0;
+    }
 
-      return true;
+    /**
+     * Zero-copy read: peek_ref() gives the item at the head, it stays valid
+     * (and can be used in place) until release() drops it from the queue.
+     */
+    T& peek_ref() {
+      return this->buffer.queue[this->buffer.head];
+    }
+
+    void release() {
+      if (this->isEmpty()) return;
+
+      --this->buffer.count;
+      if (++this->buffer.head >= this->buffer.size)
+        this->buffer.head = 0;
     }
 
     bool isEmpty() {
@@ -0,0 +1,163 @@
+/**
+ * MK4duo Firmware for 3D Printer, Laser and CNC
+ *
+ * Based on Marlin, Sprinter and grbl
+ * Copyright (c) 2011 Camiel Gubbels / Erik van der Zalm
+ * Copyright (c) 2020 Alberto Cotronei @MagoKimbra
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#pragma once
+
+/**
+ * @brief   Decimal number scanner for G-code
+ * @details Reads a number in the G-code format, [+-]digits[.digits]:
+ *          no exponent, no locale, no hex, no leading spaces.
+ *          The scan stops at the first other char, so 'E' after a
+ *          number is the next parameter and not an exponent.
+ *
+ *          scripts/decimalbench.py checks it against strtof/strtol.
+ */
+class Decimal {
+
+  public: /** Public Function */
+
+    /**
+     * Float value, the same float strtof() gives for the same chars.
+     * Numbers up to 8 significant digits with up to 10 decimals (or 10
+     * trailing zeros) are one exact int to float conversion and one
+     * divide (or multiply) by an exact power of ten, that is correctly
+     * rounded. Longer numbers go to strtof().
+     */
+    static float to_float(const char *p) {
+      const char * const start = p;
+      const bool neg = (*p == '-');
+      if (*p == '-' || *p == '+') ++p;
+
+      uint32_t  mant      = 0;      // Significant digits
+      uint8_t   digits    = 0,      // Significant digits in mant
+                zeros     = 0,      // Zeros not yet added to mant...
+                frac_zeros= 0,      // ...of them after the point
+                decimals  = 0;      // Digits after the point in mant
+      bool      point     = false;
+
+      for (;; ++p) {
+        const uint8_t d = uint8_t(*p - '0');
+        if (d == 0) {
+          ++zeros;
+          if (point) ++frac_zeros;
+        }
+        else if (d <= 9) {
+          // Add the zeros waiting and the digit
+          if (mant) digits += zeros;
+          if (++digits > 8) return slow_float(start, p);
+          for (; zeros; --zeros) mant *= 10;
+          mant = mant * 10 + d;
+          if (point) decimals += frac_zeros + 1;
+          frac_zeros = 0;
+        }
+        else if (*p == '.' && !point)
+          point = true;
+        else
+          break;
+      }
+
+      // Zeros at the end of the integer part
+      const uint8_t int_zeros = mant ? zeros - frac_zeros : 0;
+      if (mant > 0x1000000UL || decimals > 10 || int_zeros > 10) return slow_float(start, p);
+
+      float ret = mant;
+      if (decimals)
+        ret /= pow10(decimals);
+      else if (int_zeros)
+        ret *= pow10(int_zeros);
+      return neg ? -ret : ret;
+    }
+
+    /**
+     * Integer part as int32_t, the same as strtol() on a 32 bit long:
+     * out of range values are clamped.
+     */
+    static int32_t to_long(const char *p) {
+      const bool neg = (*p == '-');
+      if (*p == '-' || *p == '+') ++p;
+      const uint32_t v = scan_digits(p);
+      if (neg) return v >= 0x80000000UL ? INT32_MIN : -int32_t(v);
+      return v >= 0x80000000UL ? INT32_MAX : int32_t(v);
+    }
+
+    /**
+     * Integer part as uint32_t, the same as strtoul() on a 32 bit long:
+     * a minus sign negates, out of range values give 0xFFFFFFFF.
+     */
+    static uint32_t to_ulong(const char *p) {
+      const bool neg = (*p == '-');
+      if (*p == '-' || *p == '+') ++p;
+      const uint32_t v = scan_digits(p);
+      return neg && v != 0xFFFFFFFFUL ? -v : v;
+    }
+
+    /**
+     * Fixed point value, the number times 10^decimals rounded half away
+     * from zero on the decimal digits, with no float math at all.
+     * Out of range values are clamped.
+     */
+    static int32_t to_fixed(const char *p, const uint8_t decimals) {
+      const bool neg = (*p == '-');
+      if (*p == '-' || *p == '+') ++p;
+      uint32_t v = scan_digits(p);
+      uint8_t d = 0;
+      if (*p == '.') {
+        for (++p; d < decimals && uint8_t(*p - '0') <= 9; ++d, ++p) v = mul10_add(v, *p - '0');
+        if (d == decimals && uint8_t(*p - '5') <= 4 && v != 0xFFFFFFFFUL) ++v;
+      }
+      for (; d < decimals; ++d) v = mul10_add(v, 0);
+      if (neg) return v >= 0x80000000UL ? INT32_MIN : -int32_t(v);
+      return v >= 0x80000000UL ? INT32_MAX : int32_t(v);
+    }
+
+  private: /** Private Function */
+
+    // v * 10 + d, 0xFFFFFFFF when it does not fit
+    static inline uint32_t mul10_add(const uint32_t v, const uint8_t d) {
+      if (v > 429496729UL || (v == 429496729UL && d > 5)) return 0xFFFFFFFFUL;
+      return v * 10 + d;
+    }
+
+    // Digits up to the first other char, p is left on it
+    static inline uint32_t scan_digits(const char* &p) {
+      uint32_t v = 0;
+      for (uint8_t d; (d = uint8_t(*p - '0')) <= 9; ++p) v = mul10_add(v, d);
+      return v;
+    }
+
+    // Exact up to 10^10, 5^10 still fits the float mantissa
+    static inline float pow10(uint8_t n) {
+      float p = 10.0f;
+      while (--n) p *= 10.0f;
+      return p;
+    }
+
+    // strtof() on a copy of the number chars alone
+    static float slow_float(const char * const start, const char *end) {
+      while (uint8_t(*end - '0') <= 9 || *end == '.') ++end;   // Rest of the number
+      char buff[40];
+      uint8_t len = 0;
+      for (const char *c = start; c < end && len < sizeof(buff) - 1; ++c) buff[len++] = *c;
+      buff[len] = '\0';
+      return strtof(buff, nullptr);
+    }
+
+};
@@ -0,0 +1,256 @@
+/**
+ * MK4duo Firmware for 3D Printer, Laser and CNC
+ *
+ * Based on Marlin, Sprinter and grbl
+ * Copyright (c) 2011 Camiel Gubbels / Erik van der Zalm
+ * Copyright (c) 2020 Alberto Cotronei @MagoKimbra
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#pragma once
+
+
+/**
+ * @brief   Journal class
+ * @details The states of a T saved as records in a ring of BLOCKS blocks of
+ *          512 bytes on a card, one block write for each save:
+ *
+ *            type | len (uint16) | seq (uint32) | payload (len bytes) | crc16
+ *
+ *          A SNAPSHOT holds the whole T, a DELTA the bytes changed since the
+ *          record before, as runs of offset (uint16), count (uint8) and the
+ *          bytes. The CRC16 (as crc16()) covers type, len, seq and payload,
+ *          seq counts the records.
+ *
+ *          The block image kept here starts with a snapshot and takes a delta
+ *          for each save until one does not fit, then a new image starts with
+ *          a snapshot: the journal is compacted as it goes, one block is all
+ *          a replay needs. Each save writes the image to the next block of
+ *          the ring, never over the one before: a write cut by a power loss
+ *          spoils at most the save being written.
+ *
+ *          open() and replay() take the block whose records, from a good
+ *          snapshot up to the first bad one, end with the highest seq.
+ *
+ *          D is a card with readBlock(block, buf) and writeBlock(block, buf),
+ *          as the SdSpiCard of SdFat, the blocks from first on are the
+ *          journal. scripts/restartjournal.py cuts the power on a host copy.
+ */
+
+#define JOURNAL_BLOCK       512
+#define JOURNAL_SNAPSHOT    0x53
+#define JOURNAL_DELTA       0x44
+#define JOURNAL_HEAD        7       // type, len, seq
+#define JOURNAL_FRAME       (JOURNAL_HEAD + 2)
+
+template<typename T, uint8_t BLOCKS>
+class Journal {
+
+  static_assert(sizeof(T) + JOURNAL_FRAME <= JOURNAL_BLOCK, "The state must fit in a journal block.");
+
+  private: /** Private Parameters */
+
+    uint8_t   block[JOURNAL_BLOCK]; // Image of the records
+    T         last;                 // State of the last record
+    uint32_t  first,                // Card block of the journal, 0 for none
+              seq;                  // Seq of the next record
+    uint16_t  used;                 // Bytes of records in the image
+    uint8_t   cur;                  // Block written last
+
+  public: /** Constructor */
+
+    Journal<T, BLOCKS>() { this->reset(0); }
+
+  public: /** Public Function */
+
+    // Forget the journal, the next one starts at the card block first
+    void reset(const uint32_t block_first) {
+      this->first = block_first;
+      this->seq = 1;
+      this->cur = BLOCKS - 1;
+      this->used = JOURNAL_BLOCK;   // The next record starts a new image
+    }
+
+    bool isOpen() { return this->first != 0; }
+
+    uint32_t getFirst() { return this->first; }
+
+    // Clear the blocks of a new journal. Return false if a write failed.
+    template<typename D>
+    bool erase(D &dev) {
+      memset(this->block, 0, JOURNAL_BLOCK);
+      for (uint8_t b = 0; b < BLOCKS; b++)
+        if (!dev.writeBlock(this->first + b, this->block)) return false;
+      return true;
+    }
+
+    /**
+     * Open the journal at the card block first and find its last state.
+     * The next save goes on from it, in the next block of the ring.
+     * Return false if there is no state.
+     */
+    template<typename D>
+    bool open(D &dev, const uint32_t block_first) {
+      this->reset(block_first);
+      if (!block_first) return false;
+
+      uint32_t best_seq = 0;
+      uint8_t best = 0;
+      for (uint8_t b = 0; b < BLOCKS; b++) {
+        if (!dev.readBlock(block_first + b, this->block)) continue;
+        const uint32_t s = this->walk(false);
+        if (s > best_seq) { best_seq = s; best = b; }
+      }
+      if (!best_seq || !dev.readBlock(block_first + best, this->block)) return false;
+
+      this->seq = this->walk(true) + 1;
+      this->cur = best;
+      return true;
+    }
+
+    // The last state on the card in data. Return false if there is none.
+    template<typename D>
+    bool replay(D &dev, T &data) {
+      if (!this->open(dev, this->first)) return false;
+      memcpy(&data, &this->last, sizeof(T));
+      return true;
+    }
+
+    /**
+     * Save a state: a delta from the last one if it is shorter and fits in
+     * the image, else a new image with a snapshot. One block write.
+     * Return false if the write failed.
+     */
+    template<typename D>
+    bool append(D &dev, const T &data) {
+      if (!this->first) return false;
+
+      const uint8_t * const now = (const uint8_t*)&data,
+                    * const old = (const uint8_t*)&this->last;
+
+      // The delta, built in place after the records of the image
+      uint16_t len = 0;
+      bool delta = this->used < JOURNAL_BLOCK;
+      if (delta) {
+        uint8_t * const out = this->block + this->used + JOURNAL_HEAD;
+        const uint16_t room = JOURNAL_BLOCK - this->used - JOURNAL_FRAME;
+        for (uint16_t i = 0; i < sizeof(T); ) {
+          if (now[i] == old[i]) { i++; continue; }
+          // A run goes on over gaps up to the size of a run head
+          uint16_t end = i + 1, last_diff = i;
+          while (end < sizeof(T) && end - last_diff <= 3 && end - i < 255) {
+            if (now[end] != old[end]) last_diff = end;
+            end++;
+          }
+          const uint8_t n = last_diff - i + 1;
+          if (len + 3 + n > room || len + 3 + n >= sizeof(T)) { delta = false; break; }
+          out[len] = i & 0xFF; out[len + 1] = i >> 8; out[len + 2] = n;
+          memcpy(out + len + 3, now + i, n);
+          len += 3 + n;
+          i += n;
+        }
+        if (delta && !len) return true;   // Nothing changed
+      }
+
+      if (!delta) {
+        // A new image from a snapshot, the journal compacted
+        memset(this->block, 0, JOURNAL_BLOCK);
+        this->used = 0;
+        len = sizeof(T);
+        memcpy(this->block + JOURNAL_HEAD, now, len);
+      }
+
+      // Frame it
+      uint8_t * const r = this->block + this->used;
+      r[0] = delta ? JOURNAL_DELTA : JOURNAL_SNAPSHOT;
+      r[1] = len & 0xFF; r[2] = len >> 8;
+      memcpy(r + 3, &this->seq, 4);
+      uint16_t crc = 0;
+      crc16(&crc, r, len + JOURNAL_HEAD);
+      r[len + JOURNAL_HEAD] = crc & 0xFF; r[len + JOURNAL_HEAD + 1] = crc >> 8;
+
+      // Next block of the ring, the one before keeps the last state
+      const uint8_t b = this->cur + 1 < BLOCKS ? this->cur + 1 : 0;
+      if (!dev.writeBlock(this->first + b, this->block)) {
+        // Not on the card, the record is dropped from the image
+        memset(r, 0, len + JOURNAL_FRAME);
+        if (!this->used) this->used = JOURNAL_BLOCK;
+        return false;
+      }
+
+      this->cur = b;
+      this->used += len + JOURNAL_FRAME;
+      this->seq++;
+      memcpy(&this->last, now, sizeof(T));
+      return true;
+    }
+
+  private: /** Private Function */
+
+    uint16_t length(const uint16_t pos) { return this->block[pos + 1] | (this->block[pos + 2] << 8); }
+
+    // The record at pos is good, its seq in s
+    bool check(const uint16_t pos, uint32_t &s) {
+      if (pos + JOURNAL_FRAME > JOURNAL_BLOCK) return false;
+      const uint8_t type = this->block[pos];
+      const uint16_t len = this->length(pos);
+      if (pos + len + JOURNAL_FRAME > JOURNAL_BLOCK) return false;
+      if (type == JOURNAL_SNAPSHOT ? len != sizeof(T) : type != JOURNAL_DELTA) return false;
+      uint16_t crc = 0;
+      crc16(&crc, this->block + pos, len + JOURNAL_HEAD);
+      const uint8_t * const c = this->block + pos + len + JOURNAL_HEAD;
+      if (c[0] != (crc & 0xFF) || c[1] != (crc >> 8)) return false;
+      memcpy(&s, this->block + pos + 3, 4);
+      return s != 0;
+    }
+
+    /**
+     * The records of the image, a snapshot first, up to the first bad one
+     * or out of order. With apply the state in last and used after them.
+     * Return the seq of the last one, 0 for none.
+     */
+    uint32_t walk(const bool apply) {
+      uint16_t pos = 0;
+      uint32_t s = 0, rs;
+      while (this->check(pos, rs) && (pos ? rs == s + 1 : this->block[0] == JOURNAL_SNAPSHOT)) {
+        if (apply) {
+          const uint8_t * const p = this->block + pos + JOURNAL_HEAD;
+          if (pos) this->apply_delta(p, this->length(pos));
+          else memcpy(&this->last, p, sizeof(T));
+        }
+        s = rs;
+        pos += this->length(pos) + JOURNAL_FRAME;
+      }
+      if (apply) {
+        this->used = s ? pos : JOURNAL_BLOCK;
+        if (s) memset(this->block + pos, 0, JOURNAL_BLOCK - pos);
+      }
+      return s;
+    }
+
+    // The runs of a delta on the last state
+    void apply_delta(const uint8_t *p, uint16_t len) {
+      uint8_t * const dst = (uint8_t*)&this->last;
+      while (len >= 3) {
+        const uint16_t off = p[0] | (p[1] << 8);
+        const uint8_t n = p[2];
+        if (len < 3 + n || off + n > sizeof(T)) break;
+        memcpy(dst + off, p + 3, n);
+        p += 3 + n;
+        len -= 3 + n;
+      }
+    }
+
+};
@@ -0,0 +1,136 @@
+/**
+ * MK4duo Firmware for 3D Printer, Laser and CNC
+ *
+ * Based on Marlin, Sprinter and grbl
+ * Copyright (c) 2011 Camiel Gubbels / Erik van der Zalm
+ * Copyright (c) 2020 Alberto Cotronei @MagoKimbra
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#pragma once
+
+/**
+ * @brief   Read Ahead class
+ * @details Two buffers of N bytes read from a file in whole blocks.
+ *          The lines are taken from one buffer while the other one is
+ *          filled by refill(), out of the way of the reader, from idle().
+ *          An empty buffer is filled at once when the reader needs it.
+ *
+ *          T is a file with read(buf, nbyte), as SdFile. The file must be
+ *          at the position given to reset() and is read by refill() and
+ *          line() alone from then on.
+ *
+ *          scripts/sdreadbench.py times it with a file on the host.
+ */
+template<typename T, uint16_t N>
+class Read_Ahead {
+
+  private: /** Private Parameters */
+
+    uint8_t   buff[2][N];
+    uint16_t  len[2],       // Bytes in each buffer, 0 for empty
+              index;        // Next byte in the current buffer
+    uint32_t  start[2],     // File position of each buffer
+              next_read;    // File position of the next block to read
+    uint8_t   cur;          // Buffer being read
+    bool      error;        // Last read failed
+
+  public: /** Constructor */
+
+    Read_Ahead<T, N>() { this->reset(0); }
+
+  public: /** Public Function */
+
+    // Drop the buffers, the file is at pos
+    void reset(const uint32_t pos) {
+      this->len[0] = this->len[1] = this->index = 0;
+      this->cur = 0;
+      this->next_read = pos;
+      this->error = false;
+    }
+
+    /**
+     * Fill the empty buffer, the current one first.
+     * Return false if both are full or nothing was read.
+     */
+    bool refill(T &file) {
+      const uint8_t b = this->len[this->cur] ? this->cur ^ 1 : this->cur;
+      if (this->len[b]) return false;
+      const int n = file.read(this->buff[b], N);
+      this->error = n < 0;
+      if (n <= 0) return false;
+      this->len[b] = n;
+      this->start[b] = this->next_read;
+      this->next_read += n;
+      return true;
+    }
+
+    /**
+     * The bytes up to the next line end, itself included, or up to the end
+     * of the buffer. A line split between the buffers comes in two parts,
+     * eol is true on the last one. Return the number of bytes, 0 at the end
+     * of the file or on a read error.
+     */
+    uint16_t line(T &file, const char* &p, bool &eol) {
+      if (!this->len[this->cur] && !this->refill(file)) return 0;
+
+      const uint8_t * const b = this->buff[this->cur];
+      const uint16_t first = this->index, last = this->len[this->cur];
+      uint16_t i = first;
+      while (i < last && b[i] != '\n' && b[i] != '\r') i++;
+      eol = (i < last);
+      if (eol) i++;
+
+      p = (const char*)b + first;
+      this->index = i;
+      if (i == last) {
+        // Buffer done, on to the other one
+        this->len[this->cur] = this->index = 0;
+        this->cur ^= 1;
+      }
+      return i - first;
+    }
+
+    /**
+     * Copy the next n bytes, from both buffers if they are split.
+     * Return the number of bytes copied, less than n at the end of
+     * the file or on a read error.
+     */
+    uint16_t read(T &file, void * const dst, const uint16_t n) {
+      uint8_t *d = (uint8_t*)dst;
+      uint16_t done = 0;
+      while (done < n) {
+        if (!this->len[this->cur] && !this->refill(file)) break;
+        uint16_t count = this->len[this->cur] - this->index;
+        if (count > n - done) count = n - done;
+        memcpy(d + done, this->buff[this->cur] + this->index, count);
+        done += count;
+        this->index += count;
+        if (this->index == this->len[this->cur]) {
+          this->len[this->cur] = this->index = 0;
+          this->cur ^= 1;
+        }
+      }
+      return done;
+    }
+
+    // File position of the next byte to take
+    uint32_t position() {
+      return this->len[this->cur] ? this->start[this->cur] + this->index : this->next_read;
+    }
+
+    bool isError() { return this->error; }
+
+};
@@ -0,0 +1,113 @@
+/**
+ * MK4duo Firmware for 3D Printer, Laser and CNC
+ *
+ * Based on Marlin, Sprinter and grbl
+ * Copyright (c) 2011 Camiel Gubbels / Erik van der Zalm
+ * Copyright (c) 2020 Alberto Cotronei @MagoKimbra
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#pragma once
+
+/**
+ * @brief   Thermistor Table class
+ * @details ADC to temperature table of a thermistor, POINTS points made by
+ *          build() from the exact formula of the sensor, calc_thermistor().
+ *          The points are at equal steps of temperature, from maxtemp down
+ *          to the reading of the top of the ADC range, each one at the
+ *          highest reading still at its temperature, in 1/16 degC.
+ *          get() finds the two points around a reading by binary search
+ *          and interpolates, no float math and no LOG.
+ *
+ *          T is the sensor with float calc_thermistor(raw), the formula
+ *          going down as the reading goes up.
+ *
+ *          scripts/thermistortable.py checks the error over the whole ADC
+ *          range and counts the cycles of a reading on the host.
+ */
+template<uint8_t POINTS>
+class Thermistor_Table {
+
+  private: /** Private Parameters */
+
+    int16_t raw[POINTS],
+            temp[POINTS];           // 1/16 degC
+    uint8_t points;
+    volatile bool ready;            // Read from the ISR, off while building
+
+  public: /** Constructor */
+
+    Thermistor_Table<POINTS>() { this->reset(); }
+
+  public: /** Public Function */
+
+    void reset() {
+      this->ready = false;
+      this->points = 0;
+    }
+
+    template<typename T>
+    void build(T &sensor, const int16_t range, const float maxtemp) {
+
+      this->reset();
+
+      const float mintemp = sensor.calc_thermistor(range - 1);
+      if (!(mintemp < maxtemp)) return;
+
+      int16_t low = 0;
+      for (uint8_t i = 0; i < POINTS; i++) {
+        int16_t r = range - 1;
+        if (i < POINTS - 1) {
+          // Highest reading at t or hotter, the ones above it are colder
+          const float t = maxtemp - (maxtemp - mintemp) * i / (POINTS - 1);
+          int16_t high = range - 1;
+          r = low;
+          while (r < high) {
+            const int16_t mid = (r + high + 1) >> 1;
+            if (sensor.calc_thermistor(mid) >= t) r = mid;
+            else high = mid - 1;
+          }
+        }
+        if (this->points && r <= this->raw[this->points - 1]) continue;
+        const float t = sensor.calc_thermistor(r);
+        this->raw[this->points] = r;
+        this->temp[this->points] = int16_t((t < -2000.0f ? -2000.0f : t > 2000.0f ? 2000.0f : t) * 16.0f);
+        this->points++;
+        low = r;
+      }
+
+      this->ready = this->points > 1;
+    }
+
+    /**
+     * Temperature of a reading, false out of the table or while
+     * building, the reading is then left to the formula.
+     */
+    bool get(const int16_t adc, float &celsius) {
+      if (!this->ready || adc < this->raw[0] || adc > this->raw[this->points - 1]) return false;
+      uint8_t l = 0, h = this->points - 1;
+      while (h - l > 1) {
+        const uint8_t m = (l + h) >> 1;
+        if (adc <= this->raw[m]) h = m;
+        else l = m;
+      }
+      const int16_t t = this->temp[l] + int32_t(this->temp[h] - this->temp[l]) * (adc - this->raw[l]) / (this->raw[h] - this->raw[l]);
+      celsius = t * (1.0f / 16.0f);
+      return true;
+    }
+
+    uint8_t size() { return this->points; }
+
+};
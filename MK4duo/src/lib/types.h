@@ -48,6 +48,15 @@ typedef uint16_t  millis_s;
   typedef int8_t        mixer_perc_t;
 #endif
 
+/**
+ * Index in the laser raster pool
+ */
+#if ENABLED(LASER_RASTER) && LASER_RASTER_POOL_SIZE > 255
+  typedef uint16_t      raster_index_t;
+#else
+  typedef uint8_t       raster_index_t;
+#endif
+
 /**
  * Conditional type assignment magic. For example...
  *
@@ -0,0 +1,115 @@
+/**
+ * MK4duo Firmware for 3D Printer, Laser and CNC
+ *
+ * Based on Marlin, Sprinter and grbl
+ * Copyright (c) 2011 Camiel Gubbels / Erik van der Zalm
+ * Copyright (c) 2020 Alberto Cotronei @MagoKimbra
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#pragma once
+
+
+/**
+ * @brief   Write Behind class
+ * @details Two buffers of N bytes written to a file in whole blocks.
+ *          The bytes go into one buffer while the other one, once full,
+ *          is written by flush() from idle(), out of the way of the
+ *          writer. A full buffer is written at once when both are full.
+ *          finish() writes what is left, the last block in part.
+ *
+ *          T is a file with write(buf, nbyte), as SdFile. Written from a
+ *          position at the start of a block, the file gets only whole
+ *          blocks and SdFat has no block to read before each write.
+ *
+ *          scripts/sduploadbench.py times it with a file on the host.
+ */
+template<typename T, uint16_t N>
+class Write_Behind {
+
+  private: /** Private Parameters */
+
+    uint8_t   buff[2][N];
+    uint16_t  len[2];       // Bytes in each buffer
+    uint8_t   cur;          // Buffer being filled
+    bool      full,         // The other buffer waits for flush()
+              error;        // A write failed
+
+  public: /** Constructor */
+
+    Write_Behind<T, N>() { this->reset(); }
+
+  public: /** Public Parameters */
+
+    uint32_t  bytes;        // Bytes taken since reset()
+
+  public: /** Public Function */
+
+    // Drop the buffers
+    void reset() {
+      this->len[0] = this->len[1] = 0;
+      this->cur = 0;
+      this->full = this->error = false;
+      this->bytes = 0;
+    }
+
+    /**
+     * Take n bytes, the full buffer written first if both fill up.
+     * Return false on a write error.
+     */
+    bool write(T &file, const void * const src, const uint16_t n) {
+      const uint8_t *s = (const uint8_t*)src;
+      uint16_t done = 0;
+      while (done < n) {
+        uint16_t count = N - this->len[this->cur];
+        if (count > n - done) count = n - done;
+        memcpy(this->buff[this->cur] + this->len[this->cur], s + done, count);
+        this->len[this->cur] += count;
+        done += count;
+        if (this->len[this->cur] == N) {
+          if (this->full) this->flush(file);
+          this->cur ^= 1;
+          this->full = true;
+        }
+      }
+      this->bytes += n;
+      return !this->error;
+    }
+
+    /**
+     * Write the full buffer, if there is one.
+     * Return false if there was nothing to write or it failed.
+     */
+    bool flush(T &file) {
+      if (!this->full) return false;
+      const uint8_t b = this->cur ^ 1;
+      if (file.write(this->buff[b], N) != int(N)) this->error = true;
+      this->len[b] = 0;
+      this->full = false;
+      return !this->error;
+    }
+
+    // Write all that is left. Return false if a write failed.
+    bool finish(T &file) {
+      this->flush(file);
+      const uint16_t n = this->len[this->cur];
+      if (n && file.write(this->buff[this->cur], n) != int(n)) this->error = true;
+      this->len[this->cur] = 0;
+      return !this->error;
+    }
+
+    bool isError() { return this->error; }
+
+};
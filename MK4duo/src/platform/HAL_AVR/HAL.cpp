@@ -348,11 +348,13 @@ void HAL::Tick() {
   // Fans set output PWM
   fanManager.set_output_pwm();
 
-  // Event every 100 ms
-  if (cycle_100_timer.expired(100)) tempManager.spin();
+  #if ENABLED(SOFT_PWM_PORT_WRITE)
+    // Soft PWM levels of heaters and fans, one write for each port
+    softpwm.flush();
+  #endif
 
-  // Event every second
-  if (cycle_1s_timer.expired(SECOND_TO_MILLIS(1))) printer.check_periodical_actions();
+  // Events every 100 ms and every second, run by the deferred half
+  printer.tick_events(cycle_100_timer.expired(100), cycle_1s_timer.expired(SECOND_TO_MILLIS(1)));
 
   if ((ADCSRA & _BV(ADSC)) == 0) {  // Conversion finished?
     channel = pgm_read_byte(&AnalogInputChannels[adcSamplePos]);
@@ -433,10 +435,31 @@ void HAL::set_current_temp_raw() {
  *  - Manage PWM to all the heaters and fan
  *  - Prepare or Measure one of the raw ADC sensor values
  *  - For ENDSTOP_INTERRUPTS_FEATURE check endstops if flagged
+ *
+ * The deferred half, Printer::tick_task(), runs at the end with the
+ * interrupts on and only this one held off, so the stepper ISR can
+ * come in while the temperatures are computed.
  */
 HAL_TEMP_TIMER_ISR {
   if (printer.isStopped()) return;
+
+  #if ENABLED(STEPPER_ISR_PROFILER)
+    const isr_free_t start = isrprofiler.start_free();
+  #endif
+
   HAL::Tick();
+
+  #if ENABLED(STEPPER_ISR_PROFILER)
+    isrprofiler.stop_free(ISR_PHASE_TICK, start);
+  #endif
+
+  if (printer.tick_task_pending()) {
+    DISABLE_TEMP_INTERRUPT();
+    ENABLE_ISRS();
+    printer.tick_task();
+    DISABLE_ISRS();
+    ENABLE_TEMP_INTERRUPT();
+  }
 }
 
 /**
@@ -215,6 +215,21 @@ typedef uint16_t  ptr_int_t;
 #define HAL_timer_set_count(timer, count)   (_CAT(TIMER_OCR_, timer) = count)
 #define HAL_timer_get_current_count(timer)  _CAT(TIMER_COUNTER_, timer)
 
+// Cycle counter used by the stepper ISR profiler.
+// AVR has no free-running cycle counter, so use Timer1: while the ISR runs
+// its compare is set to the maximum so the count does not wrap mid-phase.
+// Out of the stepper ISR the count is reset at every compare, the other
+// phases are timed by micros().
+#define HAL_CYCLE_COUNTER_STEPPER_ONLY
+typedef uint16_t hal_cycle_t;
+#define HAL_CYCLE_COUNTER_MULT      (STEPPER_TIMER_PRESCALE)
+#define HAL_CYCLE_COUNTER_RATE      (F_CPU)
+#define HAL_cycle_counter_init()    NOOP
+#define HAL_cycle_counter_get()     hal_cycle_t(TIMER_COUNTER_1)
+
+// Deferred half of HAL::Tick, the temp ISR runs it at its end with the interrupts on
+#define HAL_tick_task_request()     NOOP
+
 // Estimate the amount of time the ISR will take to execute
 #define TIMER_CYCLES                13UL
 
@@ -226,6 +226,28 @@ enum ClockSource2 : char {
 // define which hardware PWMs are available for the current CPU
 #define USEABLE_HARDWARE_PWM(p) digitalPinHasPWM(p)
 
+/**
+ * Port writes for the soft PWM outputs
+ * The port and mask of a pin are made once, then the pins of a port that
+ * must change are toggled with one write of PINx, the others untouched.
+ */
+#define FASTIO_PORTS  13  // digitalPinToPort() is 1 (PA) to 12 (PL)
+typedef uint8_t fastio_mask_t;
+
+// Port of a pin, FASTIO_PORTS for a pin not on a port
+FORCE_INLINE static uint8_t FASTIO_PORT(const pin_t pin) {
+  if (pin < 0 || pin >= NUM_DIGITAL_PINS) return FASTIO_PORTS;
+  const uint8_t port = digitalPinToPort(pin);
+  return port == NOT_A_PORT ? FASTIO_PORTS : port;
+}
+FORCE_INLINE static fastio_mask_t FASTIO_PORT_MASK(const pin_t pin) {
+  return digitalPinToBitMask(pin);
+}
+FORCE_INLINE static void FASTIO_PORT_WRITE(const uint8_t port, const fastio_mask_t set, const fastio_mask_t clear) {
+  const uint8_t bits = *portOutputRegister(port);
+  *portInputRegister(port) = (~bits & set) | (bits & clear);
+}
+
 /**
  * Ports and Functions
  */
@@ -63,29 +63,41 @@
 uint8_t MCUSR;
 
 /** Private Parameters */
-#if HAS_HOTENDS
-  ADCAveragingFilter HAL::HOTENDsensorFilters[MAX_HOTEND];
-#endif
-#if HAS_BEDS
-  ADCAveragingFilter HAL::BEDsensorFilters[MAX_BED];
-#endif
-#if HAS_CHAMBERS
-  ADCAveragingFilter HAL::CHAMBERsensorFilters[MAX_CHAMBER];
-#endif
-#if HAS_COOLERS
-  ADCAveragingFilter HAL::COOLERsensorFilters[MAX_COOLER];
-#endif
+#if ENABLED(ADC_DMA)
 
-#if ENABLED(FILAMENT_WIDTH_SENSOR)
-  ADCAveragingFilter  HAL::filamentFilter;
-#endif
+  ADCDecimator HAL::adc_decimator;
 
-#if HAS_POWER_CONSUMPTION_SENSOR
-  ADCAveragingFilter  HAL::powerFilter;
-#endif
+  // Two buffers of tagged samples for the PDC, one filled while the Tick reads the other
+  static uint16_t adc_dma_buffer[2][ADC_DMA_BUFFER];
+  static uint8_t  adc_dma_done = 0;  // Buffer the PDC fills first
+
+#else
+
+  #if HAS_HOTENDS
+    ADCAveragingFilter HAL::HOTENDsensorFilters[MAX_HOTEND];
+  #endif
+  #if HAS_BEDS
+    ADCAveragingFilter HAL::BEDsensorFilters[MAX_BED];
+  #endif
+  #if HAS_CHAMBERS
+    ADCAveragingFilter HAL::CHAMBERsensorFilters[MAX_CHAMBER];
+  #endif
+  #if HAS_COOLERS
+    ADCAveragingFilter HAL::COOLERsensorFilters[MAX_COOLER];
+  #endif
+
+  #if ENABLED(FILAMENT_WIDTH_SENSOR)
+    ADCAveragingFilter  HAL::filamentFilter;
+  #endif
+
+  #if HAS_POWER_CONSUMPTION_SENSOR
+    ADCAveragingFilter  HAL::powerFilter;
+  #endif
+
+  #if HAS_MCU_TEMPERATURE
+    ADCAveragingFilter  HAL::mcuFilter;
+  #endif
 
-#if HAS_MCU_TEMPERATURE
-  ADCAveragingFilter  HAL::mcuFilter;
 #endif
 
 __attribute__ ((aligned(256)))
@@ -176,6 +188,7 @@ HAL::~HAL() {
 void HAL::hwSetup() {
   TimeTick_Configure(F_CPU);
   NVIC_SetPriority(SysTick_IRQn, NvicPrioritySystick);
+  NVIC_SetPriority(PendSV_IRQn, NvicPriorityPendSV);
   NVIC_SetPriority(UART_IRQn, NvicPriorityUart);
 }
 
@@ -322,15 +335,100 @@ void HAL::analogStart() {
   ADC->ADC_IER = 0;             // no ADC interrupts
   ADC->ADC_COR = 0;             // Single-ended, no offset
 
-  // start first conversion
-  AnalogInStartConversion();
+  #if ENABLED(ADC_DMA)
+    // Free run over the enabled channels, each sample tagged with its channel
+    // in ADC_LCDR and moved by the PDC to the two buffers in turn
+    ADC->ADC_MR |= ADC_MR_FREERUN_ON;
+    ADC->ADC_EMR = ADC_EMR_TAG;
+    ADC->ADC_PTCR = ADC_PTCR_RXTDIS;
+    ADC->ADC_RPR = (uint32_t)adc_dma_buffer[0];
+    ADC->ADC_RCR = ADC_DMA_BUFFER;
+    ADC->ADC_RNPR = (uint32_t)adc_dma_buffer[1];
+    ADC->ADC_RNCR = ADC_DMA_BUFFER;
+    adc_dma_done = 0;
+    adc_decimator.reset();
+    ADC->ADC_PTCR = ADC_PTCR_RXTEN;
+    ADC->ADC_CR = ADC_CR_START;
+  #else
+    // start first conversion
+    AnalogInStartConversion();
+  #endif
 }
 
 void HAL::AdcChangePin(const pin_t old_pin, const pin_t new_pin) {
   AnalogInEnablePin(old_pin, false);
   AnalogInEnablePin(new_pin, true);
+  #if ENABLED(ADC_DMA)
+    adc_decimator.reset(PinToAdcChannel(old_pin));
+    adc_decimator.reset(PinToAdcChannel(new_pin));
+  #endif
 }
 
+#if ENABLED(ADC_DMA)
+
+  uint8_t HAL::adc_dma_channel(const pin_t pin) { return PinToAdcChannel(pin); }
+
+  /**
+   * Add up the samples of the buffers filled by the PDC and set the
+   * readings of the sensors. The PDC has taken the next buffer when
+   * RNCR is 0, the one before is full and is given back as the next.
+   * With RCR at 0 too both were full and the PDC stopped, samples are
+   * lost until the buffer is given back.
+   */
+  static void adc_dma_read() {
+
+    while (ADC->ADC_RNCR == 0) {
+      if (ADC->ADC_RCR == 0) HAL::adc_decimator.overruns++;
+      uint16_t * const buffer = adc_dma_buffer[adc_dma_done];
+      for (uint16_t i = 0; i < ADC_DMA_BUFFER; i++)
+        HAL::adc_decimator.put(buffer[i] >> 12, buffer[i] & 0x0FFF);
+      HAL::adc_decimator.samples += ADC_DMA_BUFFER;
+      ADC->ADC_RNPR = (uint32_t)buffer;
+      ADC->ADC_RNCR = ADC_DMA_BUFFER;
+      adc_dma_done ^= 1;
+    }
+
+    #if HAS_HOTENDS
+      LOOP_HOTEND() {
+        if (WITHIN(hotends[h]->data.sensor.pin, 0, 15))
+          HAL::adc_decimator.read(PinToAdcChannel(hotends[h]->data.sensor.pin), hotends[h]->data.sensor.adc_raw);
+      }
+    #endif
+    #if HAS_BEDS
+      LOOP_BED() {
+        if (WITHIN(beds[h]->data.sensor.pin, 0, 15))
+          HAL::adc_decimator.read(PinToAdcChannel(beds[h]->data.sensor.pin), beds[h]->data.sensor.adc_raw);
+      }
+    #endif
+    #if HAS_CHAMBERS
+      LOOP_CHAMBER() {
+        if (WITHIN(chambers[h]->data.sensor.pin, 0, 15))
+          HAL::adc_decimator.read(PinToAdcChannel(chambers[h]->data.sensor.pin), chambers[h]->data.sensor.adc_raw);
+      }
+    #endif
+    #if HAS_COOLERS
+      LOOP_COOLER() {
+        if (WITHIN(coolers[h]->data.sensor.pin, 0, 15))
+          HAL::adc_decimator.read(PinToAdcChannel(coolers[h]->data.sensor.pin), coolers[h]->data.sensor.adc_raw);
+      }
+    #endif
+
+    #if ENABLED(FILAMENT_WIDTH_SENSOR)
+      HAL::adc_decimator.read(PinToAdcChannel(FILWIDTH_PIN), tempManager.current_raw_filwidth);
+    #endif
+
+    #if HAS_POWER_CONSUMPTION_SENSOR
+      HAL::adc_decimator.read(PinToAdcChannel(POWER_CONSUMPTION_PIN), powerManager.current_raw_powconsumption);
+    #endif
+
+    #if HAS_MCU_TEMPERATURE
+      HAL::adc_decimator.read(ADC_TEMPERATURE_SENSOR, tempManager.mcu_current_temperature_raw);
+    #endif
+
+  }
+
+#endif // ENABLED(ADC_DMA)
+
 // Reset peripherals and cpu
 void HAL::resetHardware() {
   // BANZAIIIIIII!!!
@@ -542,7 +640,8 @@ void HAL::analogWrite(const pin_t pin, uint32_t ulValue, const uint16_t freq/*=1
  * It is used to update pwm values for heater and some other frequent jobs.
  *
  *  - Manage PWM to all the heaters and fan
- *  - Prepare or Measure one of the raw ADC sensor values
+ *  - Flag spin() and the periodical actions for the deferred half, Printer::tick_task()
+ *  - Prepare or Measure one of the raw ADC sensor values, with ADC_DMA add up the DMA samples
  *  - Step the babysteps value for each axis towards 0
  *  - For PINS_DEBUGGING, monitor and report endstop pins
  *  - For ENDSTOP_INTERRUPTS_FEATURE check endstops if flagged
@@ -560,77 +659,87 @@ void HAL::Tick() {
   // Fans set output PWM
   fanManager.set_output_pwm();
 
-  // Event every 100 ms
-  if (cycle_100_timer.expired(100)) tempManager.spin();
+  #if ENABLED(SOFT_PWM_PORT_WRITE)
+    // Soft PWM levels of heaters and fans, one write for each port
+    softpwm.flush();
+  #endif
 
-  // Event every second
-  if (cycle_1s_timer.expired(SECOND_TO_MILLIS(1))) printer.check_periodical_actions();
+  // Events every 100 ms and every second, run by the deferred half
+  printer.tick_events(cycle_100_timer.expired(100), cycle_1s_timer.expired(SECOND_TO_MILLIS(1)));
 
   // Read analog or SPI values
-  if (adc_get_status(ADC)) { // conversion finished?
+  #if ENABLED(ADC_DMA)
 
-    #if HAS_HOTENDS
-      LOOP_HOTEND() {
-        if (WITHIN(hotends[h]->data.sensor.pin, 0, 15)) {
-          ADCAveragingFilter& currentFilter = const_cast<ADCAveragingFilter&>(HOTENDsensorFilters[h]);
-          currentFilter.process_reading(AnalogInReadPin(hotends[h]->data.sensor.pin));
-          if (currentFilter.IsValid())
-            hotends[h]->data.sensor.adc_raw = currentFilter.GetSum();
+    adc_dma_read();
+
+  #else
+
+    if (adc_get_status(ADC)) { // conversion finished?
+
+      #if HAS_HOTENDS
+        LOOP_HOTEND() {
+          if (WITHIN(hotends[h]->data.sensor.pin, 0, 15)) {
+            ADCAveragingFilter& currentFilter = const_cast<ADCAveragingFilter&>(HOTENDsensorFilters[h]);
+            currentFilter.process_reading(AnalogInReadPin(hotends[h]->data.sensor.pin));
+            if (currentFilter.IsValid())
+              hotends[h]->data.sensor.adc_raw = currentFilter.GetSum();
+          }
         }
-      }
-    #endif
-    #if HAS_BEDS
-      LOOP_BED() {
-        if (WITHIN(beds[h]->data.sensor.pin, 0, 15)) {
-          ADCAveragingFilter& currentFilter = const_cast<ADCAveragingFilter&>(BEDsensorFilters[h]);
-          currentFilter.process_reading(AnalogInReadPin(beds[h]->data.sensor.pin));
-          if (currentFilter.IsValid())
-            beds[h]->data.sensor.adc_raw = currentFilter.GetSum();
+      #endif
+      #if HAS_BEDS
+        LOOP_BED() {
+          if (WITHIN(beds[h]->data.sensor.pin, 0, 15)) {
+            ADCAveragingFilter& currentFilter = const_cast<ADCAveragingFilter&>(BEDsensorFilters[h]);
+            currentFilter.process_reading(AnalogInReadPin(beds[h]->data.sensor.pin));
+            if (currentFilter.IsValid())
+              beds[h]->data.sensor.adc_raw = currentFilter.GetSum();
+          }
         }
-      }
-    #endif
-    #if HAS_CHAMBERS
-      LOOP_CHAMBER() {
-        if (WITHIN(chambers[h]->data.sensor.pin, 0, 15)) {
-          ADCAveragingFilter& currentFilter = const_cast<ADCAveragingFilter&>(CHAMBERsensorFilters[h]);
-          currentFilter.process_reading(AnalogInReadPin(chambers[h]->data.sensor.pin));
-          if (currentFilter.IsValid())
-            chambers[h]->data.sensor.adc_raw = currentFilter.GetSum();
+      #endif
+      #if HAS_CHAMBERS
+        LOOP_CHAMBER() {
+          if (WITHIN(chambers[h]->data.sensor.pin, 0, 15)) {
+            ADCAveragingFilter& currentFilter = const_cast<ADCAveragingFilter&>(CHAMBERsensorFilters[h]);
+            currentFilter.process_reading(AnalogInReadPin(chambers[h]->data.sensor.pin));
+            if (currentFilter.IsValid())
+              chambers[h]->data.sensor.adc_raw = currentFilter.GetSum();
+          }
         }
-      }
-    #endif
-    #if HAS_COOLERS
-      LOOP_COOLER() {
-        if (WITHIN(coolers[h]->data.sensor.pin, 0, 15)) {
-          ADCAveragingFilter& currentFilter = const_cast<ADCAveragingFilter&>(COOLERsensorFilters[h]);
-          currentFilter.process_reading(AnalogInReadPin(coolers[h]->data.sensor.pin));
-          if (currentFilter.IsValid())
-            coolers[h]->data.sensor.adc_raw = currentFilter.GetSum();
+      #endif
+      #if HAS_COOLERS
+        LOOP_COOLER() {
+          if (WITHIN(coolers[h]->data.sensor.pin, 0, 15)) {
+            ADCAveragingFilter& currentFilter = const_cast<ADCAveragingFilter&>(COOLERsensorFilters[h]);
+            currentFilter.process_reading(AnalogInReadPin(coolers[h]->data.sensor.pin));
+            if (currentFilter.IsValid())
+              coolers[h]->data.sensor.adc_raw = currentFilter.GetSum();
+          }
         }
-      }
-    #endif
-
-    #if ENABLED(FILAMENT_WIDTH_SENSOR)
-      const_cast<ADCAveragingFilter&>(filamentFilter).process_reading(AnalogInReadPin(FILWIDTH_PIN));
-      if (filamentFilter.IsValid())
-        tempManager.current_raw_filwidth = filamentFilter.GetSum();
-    #endif
+      #endif
+
+      #if ENABLED(FILAMENT_WIDTH_SENSOR)
+        const_cast<ADCAveragingFilter&>(filamentFilter).process_reading(AnalogInReadPin(FILWIDTH_PIN));
+        if (filamentFilter.IsValid())
+          tempManager.current_raw_filwidth = filamentFilter.GetSum();
+      #endif
+
+      #if HAS_POWER_CONSUMPTION_SENSOR
+        const_cast<ADCAveragingFilter&>(powerFilter).process_reading(AnalogInReadPin(POWER_CONSUMPTION_PIN));
+        if (powerFilter.IsValid())
+          powerManager.current_raw_powconsumption = powerFilter.GetSum();
+      #endif
+
+      #if HAS_MCU_TEMPERATURE
+        const_cast<ADCAveragingFilter&>(mcuFilter).process_reading(AnalogInReadPin(ADC_TEMPERATURE_SENSOR));
+        if (mcuFilter.IsValid())
+          tempManager.mcu_current_temperature_raw = mcuFilter.GetSum();
+      #endif
 
-    #if HAS_POWER_CONSUMPTION_SENSOR
-      const_cast<ADCAveragingFilter&>(powerFilter).process_reading(AnalogInReadPin(POWER_CONSUMPTION_PIN));
-      if (powerFilter.IsValid())
-        powerManager.current_raw_powconsumption = powerFilter.GetSum();
-    #endif
+    }
 
-    #if HAS_MCU_TEMPERATURE
-      const_cast<ADCAveragingFilter&>(mcuFilter).process_reading(AnalogInReadPin(ADC_TEMPERATURE_SENSOR));
-      if (mcuFilter.IsValid())
-        tempManager.mcu_current_temperature_raw = mcuFilter.GetSum();
-    #endif
+    AnalogInStartConversion();
 
-  }
-
-  AnalogInStartConversion();
+  #endif
 
   // Tick endstops state, if required
   endstops.Tick();
@@ -658,10 +767,19 @@ pin_t HAL::analog_value_pin() {
 
 // This intercepts the 1ms system tick. It must return 'false', otherwise the Arduino core tick handler will be bypassed.
 extern "C" int sysTickHook() {
+  #if ENABLED(STEPPER_ISR_PROFILER)
+    const isr_free_t start = isrprofiler.start_free();
+  #endif
   HAL::Tick();
+  #if ENABLED(STEPPER_ISR_PROFILER)
+    isrprofiler.stop_free(ISR_PHASE_TICK, start);
+  #endif
   return 0;
 }
 
+// Deferred half of the system tick, at the lowest priority so that every other interrupt comes first
+extern "C" void PendSV_Handler() { printer.tick_task(); }
+
 HAL_TONE_TIMER_ISR() {
   static uint8_t pin_state = 0;
   HAL_timer_isr_prologue(TONE_TIMER_NUM);
@@ -73,6 +73,9 @@ typedef uint32_t  ptr_int_t;
 #include "fastio.h"
 #include "math.h"
 #include "delay.h"
+#if ENABLED(ADC_DMA)
+  #include "../../lib/adc_decimator.h"
+#endif
 #include "HAL_timers.h"
 
 // --------------------------------------------------------------------------
@@ -188,7 +191,12 @@ typedef uint32_t  ptr_int_t;
 #define ADC_TEMPERATURE_SENSOR  15
 // Bits of the ADC converter
 #define ANALOG_INPUT_BITS 12
-#define AD_RANGE          _BV(ANALOG_INPUT_BITS)
+#if ENABLED(ADC_DMA)
+  #define AD_RANGE        _BV(ANALOG_INPUT_BITS + ADC_OVERSAMPLE_BITS)
+  #define ADC_DMA_BUFFER  128   // Samples of each of the two PDC buffers
+#else
+  #define AD_RANGE        _BV(ANALOG_INPUT_BITS)
+#endif
 #define ABS_ZERO        -273.15f
 #define NUM_ADC_SAMPLES   32
 #define AD595_MAX        330.0f
@@ -216,6 +224,9 @@ extern "C" {
 extern "C" char *dtostrf (double __val, signed char __width, unsigned char __prec, char *__s);
 
 typedef AveragingFilter<NUM_ADC_SAMPLES> ADCAveragingFilter;
+#if ENABLED(ADC_DMA)
+  typedef ADC_Decimator<NUM_ANALOG_INPUTS, ADC_DMA_SAMPLES, ADC_OVERSAMPLE_BITS> ADCDecimator;
+#endif
 
 // ISR handler type
 using pfnISR_Handler = void(*)(void);
@@ -231,31 +242,41 @@ class HAL {
 
     virtual ~HAL();
 
-  private: /** Private Parameters */
+  public: /** Public Parameters */
 
-    #if HAS_HOTENDS
-      static ADCAveragingFilter HOTENDsensorFilters[MAX_HOTEND];
-    #endif
-    #if HAS_BEDS
-      static ADCAveragingFilter BEDsensorFilters[MAX_BED];
-    #endif
-    #if HAS_CHAMBERS
-      static ADCAveragingFilter CHAMBERsensorFilters[MAX_CHAMBER];
-    #endif
-    #if HAS_COOLERS
-      static ADCAveragingFilter COOLERsensorFilters[MAX_COOLER];
+    #if ENABLED(ADC_DMA)
+      static ADCDecimator adc_decimator;
     #endif
 
-    #if ENABLED(FILAMENT_WIDTH_SENSOR)
-      static ADCAveragingFilter filamentFilter;
-    #endif
+  private: /** Private Parameters */
 
-    #if HAS_POWER_CONSUMPTION_SENSOR
-      static ADCAveragingFilter powerFilter;
-    #endif
+    #if DISABLED(ADC_DMA)
+
+      #if HAS_HOTENDS
+        static ADCAveragingFilter HOTENDsensorFilters[MAX_HOTEND];
+      #endif
+      #if HAS_BEDS
+        static ADCAveragingFilter BEDsensorFilters[MAX_BED];
+      #endif
+      #if HAS_CHAMBERS
+        static ADCAveragingFilter CHAMBERsensorFilters[MAX_CHAMBER];
+      #endif
+      #if HAS_COOLERS
+        static ADCAveragingFilter COOLERsensorFilters[MAX_COOLER];
+      #endif
+
+      #if ENABLED(FILAMENT_WIDTH_SENSOR)
+        static ADCAveragingFilter filamentFilter;
+      #endif
+
+      #if HAS_POWER_CONSUMPTION_SENSOR
+        static ADCAveragingFilter powerFilter;
+      #endif
+
+      #if HAS_MCU_TEMPERATURE
+        static ADCAveragingFilter mcuFilter;
+      #endif
 
-    #if HAS_MCU_TEMPERATURE
-      static ADCAveragingFilter mcuFilter;
     #endif
 
   public: /** Public Function */
@@ -263,6 +284,10 @@ class HAL {
     static void analogStart();
     static void AdcChangePin(const pin_t old_pin, const pin_t new_pin);
 
+    #if ENABLED(ADC_DMA)
+      static uint8_t adc_dma_channel(const pin_t pin);
+    #endif
+
     static void hwSetup(void);
 
     static bool pwm_status(const pin_t pin);
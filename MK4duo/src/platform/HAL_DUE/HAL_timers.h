@@ -62,7 +62,8 @@
 #define NUM_HARDWARE_TIMERS 9
 
 #define NvicPriorityUart    1
-#define NvicPrioritySystick 15
+#define NvicPrioritySystick 14
+#define NvicPriorityPendSV  15
 
 // Tone for due
 #define TONE_TIMER_NUM              3  // index of timer to use for beeper tones
@@ -105,9 +106,11 @@
   #define ISR_LA_BASE_CYCLES         0UL
 #endif
 
-// Bezier interpolation adds 40 cycles
+// Bezier interpolation adds 40 cycles, S-curve interpolation 20 cycles
 #if ENABLED(BEZIER_JERK_CONTROL)
   #define ISR_BEZIER_CYCLES         40UL
+#elif ENABLED(S_CURVE_JERK_CONTROL)
+  #define ISR_BEZIER_CYCLES         20UL
 #else
   #define ISR_BEZIER_CYCLES          0UL
 #endif
@@ -239,3 +242,19 @@ FORCE_INLINE static void HAL_timer_isr_prologue(const uint8_t timer_num) {
   // Reading the status register clears the interrupt flag
   pConfig->pTimerRegs->TC_CHANNEL[pConfig->channel].TC_SR;
 }
+
+// Cycle counter used by the stepper ISR profiler (DWT on Cortex-M3)
+typedef uint32_t hal_cycle_t;
+#define HAL_CYCLE_COUNTER_MULT      1UL
+#define HAL_CYCLE_COUNTER_RATE      (F_CPU)
+
+FORCE_INLINE static void HAL_cycle_counter_init() {
+  CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+  DWT->CYCCNT = 0;
+  DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+}
+
+FORCE_INLINE static hal_cycle_t HAL_cycle_counter_get() { return DWT->CYCCNT; }
+
+// Deferred half of HAL::Tick, PendSV runs it when no other interrupt is pending
+FORCE_INLINE static void HAL_tick_task_request() { SCB->ICSR = SCB_ICSR_PENDSVSET_Msk; }
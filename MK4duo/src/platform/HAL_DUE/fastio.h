@@ -263,3 +263,28 @@ FORCE_INLINE static bool USEABLE_HARDWARE_PWM(const pin_t pin) {
   const uint32_t attr = g_APinDescription[pin].ulPinAttribute;
   return (attr & PIN_ATTR_PWM) != 0 || (attr & PIN_ATTR_TIMER) != 0;
 }
+
+/**
+ * Port writes for the soft PWM outputs
+ * The port and mask of a pin are made once, then the pins of a port go
+ * high with a write of PIO_SODR and low with a write of PIO_CODR.
+ */
+#define FASTIO_PORTS  4   // PIOA to PIOD
+typedef uint32_t fastio_mask_t;
+
+// Port of a pin, FASTIO_PORTS for a pin not on a port
+FORCE_INLINE static uint8_t FASTIO_PORT(const pin_t pin) {
+  #if ENABLED(PCF8574_EXPANSION_IO)
+    if (pin >= PIN_START_FOR_PCF8574) return FASTIO_PORTS;
+  #endif
+  if (pin < 0 || pin >= (pin_t)COUNT(fastio)) return FASTIO_PORTS;
+  return ((uint32_t)fastio[pin].base_address - (uint32_t)PIOA) / ((uint32_t)PIOB - (uint32_t)PIOA);
+}
+FORCE_INLINE static fastio_mask_t FASTIO_PORT_MASK(const pin_t pin) {
+  return MASK(fastio[pin].shift_count);
+}
+FORCE_INLINE static void FASTIO_PORT_WRITE(const uint8_t port, const fastio_mask_t set, const fastio_mask_t clear) {
+  Pio* pPio = (Pio*)((uint32_t)PIOA + port * ((uint32_t)PIOB - (uint32_t)PIOA));
+  if (set) pPio->PIO_SODR = set;
+  if (clear) pPio->PIO_CODR = clear;
+}
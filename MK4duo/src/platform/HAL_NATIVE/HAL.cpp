@@ -0,0 +1,246 @@
+/**
+ * MK4duo Firmware for 3D Printer, Laser and CNC
+ *
+ * Based on Marlin, Sprinter and grbl
+ * Copyright (c) 2011 Camiel Gubbels / Erik van der Zalm
+ * Copyright (c) 2020 Alberto Cotronei @MagoKimbra
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+/**
+ * This is the main Hardware Abstraction Layer (HAL).
+ * To make the firmware work with different processors and toolchains,
+ * all hardware related code should be packed into the hal files.
+ *
+ * Description: HAL for the host native build (Linux executable)
+ *
+ * ARDUINO_ARCH_NATIVE
+ */
+
+#ifdef ARDUINO_ARCH_NATIVE
+
+// --------------------------------------------------------------------------
+// Includes
+// --------------------------------------------------------------------------
+#include "../../../MK4duo.h"
+#include <SPI.h>
+
+/** Public Parameters */
+uint8_t MCUSR = RST_POWER_ON;
+
+SPIClass SPI;
+
+#if ENABLED(ADC_DMA)
+  ADCDecimator HAL::adc_decimator;
+#endif
+
+// disable interrupts
+void cli() {
+  noInterrupts();
+}
+
+// enable interrupts
+void sei() {
+  interrupts();
+}
+
+// There is no fixed RAM on host
+int freeMemory() {
+  return 0x7FFF;
+}
+
+char *dtostrf(double __val, signed char __width, unsigned char __prec, char *__s) {
+  sprintf(__s, "%*.*f", __width, __prec, __val);
+  return __s;
+}
+
+// Tone, the beeper pin is only driven high for the simulated duration
+void tone(const pin_t _pin, const uint16_t, const uint16_t duration) {
+  HAL::digitalWrite(_pin, HIGH);
+  if (duration) {
+    HAL::delayMilliseconds(duration);
+    HAL::digitalWrite(_pin, LOW);
+  }
+}
+
+void noTone(const pin_t _pin) {
+  HAL::digitalWrite(_pin, LOW);
+}
+
+// do any hardware-specific initialization here
+void HAL::hwSetup() {
+  simulator.stats.wall_ns = simulator.host_ns();
+}
+
+// Print apparent cause of start/restart
+void HAL::showStartReason() {
+  if (MCUSR & RST_POWER_ON)   SERIAL_EM(STR_POWERUP);
+  if (MCUSR & RST_SOFTWARE)   SERIAL_EM(STR_SOFTWARE_RESET);
+  MCUSR = 0;
+}
+
+void HAL::resetHardware() {
+  SERIAL_EM("Reset requested, simulation stopped");
+  simulator.report();
+  exit(EXIT_SUCCESS);
+}
+
+void HAL::analogWrite(const pin_t pin, uint32_t ulValue, const uint16_t/*=1000U*/) {
+  ::analogWrite(pin, ulValue);
+}
+
+/**
+ * Called every 1 ms by the simulator, same jobs of the DUE SysTick.
+ * The simulator runs Printer::tick_task() after it, as PendSV on DUE.
+ */
+void HAL::Tick() {
+
+  static short_timer_t  cycle_1s_timer(millis()),
+                        cycle_100_timer(millis());
+
+  if (printer.isStopped()) return;
+
+  // Heaters set output PWM
+  tempManager.set_output_pwm();
+
+  // Fans set output PWM
+  fanManager.set_output_pwm();
+
+  #if ENABLED(SOFT_PWM_PORT_WRITE)
+    // Soft PWM levels of heaters and fans, one write for each port
+    softpwm.flush();
+  #endif
+
+  // Events every 100 ms and every second, run by the deferred half
+  printer.tick_events(cycle_100_timer.expired(100), cycle_1s_timer.expired(SECOND_TO_MILLIS(1)));
+
+  #if ENABLED(ADC_DMA)
+
+    // Add up the tagged samples of the simulated PDC, as on DUE
+    uint16_t sample;
+    while (simulator.adc_dma_get(sample)) {
+      adc_decimator.put(sample >> 12, sample & 0x0FFF);
+      adc_decimator.samples++;
+    }
+
+    #if HAS_HOTENDS
+      LOOP_HOTEND() {
+        if (WITHIN(hotends[h]->data.sensor.pin, 0, SIM_NUM_ANALOG - 1))
+          adc_decimator.read(hotends[h]->data.sensor.pin, hotends[h]->data.sensor.adc_raw);
+      }
+    #endif
+    #if HAS_BEDS
+      LOOP_BED() {
+        if (WITHIN(beds[h]->data.sensor.pin, 0, SIM_NUM_ANALOG - 1))
+          adc_decimator.read(beds[h]->data.sensor.pin, beds[h]->data.sensor.adc_raw);
+      }
+    #endif
+    #if HAS_CHAMBERS
+      LOOP_CHAMBER() {
+        if (WITHIN(chambers[h]->data.sensor.pin, 0, SIM_NUM_ANALOG - 1))
+          adc_decimator.read(chambers[h]->data.sensor.pin, chambers[h]->data.sensor.adc_raw);
+      }
+    #endif
+    #if HAS_COOLERS
+      LOOP_COOLER() {
+        if (WITHIN(coolers[h]->data.sensor.pin, 0, SIM_NUM_ANALOG - 1))
+          adc_decimator.read(coolers[h]->data.sensor.pin, coolers[h]->data.sensor.adc_raw);
+      }
+    #endif
+
+  #else
+
+    // Read the simulated analog values
+    #if HAS_HOTENDS
+      LOOP_HOTEND() {
+        if (WITHIN(hotends[h]->data.sensor.pin, 0, SIM_NUM_ANALOG - 1))
+          hotends[h]->data.sensor.adc_raw = simulator.analog_value[hotends[h]->data.sensor.pin];
+      }
+    #endif
+    #if HAS_BEDS
+      LOOP_BED() {
+        if (WITHIN(beds[h]->data.sensor.pin, 0, SIM_NUM_ANALOG - 1))
+          beds[h]->data.sensor.adc_raw = simulator.analog_value[beds[h]->data.sensor.pin];
+      }
+    #endif
+    #if HAS_CHAMBERS
+      LOOP_CHAMBER() {
+        if (WITHIN(chambers[h]->data.sensor.pin, 0, SIM_NUM_ANALOG - 1))
+          chambers[h]->data.sensor.adc_raw = simulator.analog_value[chambers[h]->data.sensor.pin];
+      }
+    #endif
+    #if HAS_COOLERS
+      LOOP_COOLER() {
+        if (WITHIN(coolers[h]->data.sensor.pin, 0, SIM_NUM_ANALOG - 1))
+          coolers[h]->data.sensor.adc_raw = simulator.analog_value[coolers[h]->data.sensor.pin];
+      }
+    #endif
+
+  #endif
+
+  // Tick endstops state, if required
+  endstops.Tick();
+
+}
+
+pin_t HAL::digital_value_pin() {
+  const pin_t pin = parser.value_pin();
+  return WITHIN(pin, 0 , NUM_DIGITAL_PINS - 1) ? pin : NoPin;
+}
+
+pin_t HAL::analog_value_pin() {
+  const pin_t pin = parser.value_pin();
+  return WITHIN(pin, 0 , NUM_ANALOG_INPUTS - 1) ? pin : NoPin;
+}
+
+/**
+ * Wiring API on the simulated machine
+ */
+uint32_t millis() { return simulator.millis(); }
+uint32_t micros() { return simulator.micros(); }
+
+void delay(const uint32_t ms) {
+  simulator.advance((uint64_t)ms * (SIM_TIMER_RATE / 1000UL));
+}
+
+void delayMicroseconds(const uint32_t us) {
+  simulator.advance((uint64_t)us * (SIM_TIMER_RATE / 1000000UL));
+}
+
+void pinMode(const uint8_t pin, const uint8_t mode) { HAL::pinMode(pin, mode); }
+void digitalWrite(const uint8_t pin, const uint8_t value) { WRITE(pin, value); }
+int  digitalRead(const uint8_t pin) { return READ(pin); }
+
+int analogRead(const uint8_t pin) {
+  return pin < SIM_NUM_ANALOG ? simulator.analog_value[pin] : 0;
+}
+
+void analogWrite(const uint8_t pin, const int value) {
+  SET_OUTPUT(pin);
+  WRITE(pin, value > 127);
+}
+
+void attachInterrupt(const uint8_t, void (*)(void), const int) {}
+void detachInterrupt(const uint8_t) {}
+
+void noInterrupts() { DISABLE_ISRS(); }
+void interrupts()   { ENABLE_ISRS(); }
+
+long random(const long max) { return max ? ::random() % max : 0; }
+long random(const long min, const long max) { return min >= max ? min : min + random(max - min); }
+void randomSeed(const unsigned long seed) { srandom(seed); }
+
+#endif // ARDUINO_ARCH_NATIVE
@@ -0,0 +1,246 @@
+/**
+ * MK4duo Firmware for 3D Printer, Laser and CNC
+ *
+ * Based on Marlin, Sprinter and grbl
+ * Copyright (c) 2011 Camiel Gubbels / Erik van der Zalm
+ * Copyright (c) 2020 Alberto Cotronei @MagoKimbra
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+/**
+ * This is the main Hardware Abstraction Layer (HAL).
+ * To make the firmware work with different processors and toolchains,
+ * all hardware related code should be packed into the hal files.
+ *
+ * Description: HAL for the host native build (Linux executable)
+ *
+ * The firmware runs single threaded against a simulated clock: the stepper
+ * timer, the 1ms tick, millis() and micros() are all derived from it, so a
+ * G-code file always produces the same steps at the same ticks.
+ *
+ * ARDUINO_ARCH_NATIVE
+ */
+#pragma once
+
+// --------------------------------------------------------------------------
+// Includes
+// --------------------------------------------------------------------------
+#include <stdint.h>
+#include <stdarg.h>
+#include <Arduino.h>
+
+// --------------------------------------------------------------------------
+// Types
+// --------------------------------------------------------------------------
+typedef uint32_t  hal_timer_t;
+typedef uintptr_t ptr_int_t;
+
+// --------------------------------------------------------------------------
+// Includes
+// --------------------------------------------------------------------------
+#include "simulator.h"
+#include "hardwareserial/HardwareSerial.h"
+#include "watchdog/watchdog.h"
+#include "fastio.h"
+#include "math.h"
+#include "delay.h"
+#include "HAL_timers.h"
+#if ENABLED(ADC_DMA)
+  #include "../../lib/adc_decimator.h"
+#endif
+
+// --------------------------------------------------------------------------
+// Defines
+// --------------------------------------------------------------------------
+
+// Serial port
+#define MKSERIAL1 MKSerial1
+
+// CRITICAL SECTION
+#define CRITICAL_SECTION_START()  const bool irqon = ISRS_ENABLED(); DISABLE_ISRS()
+#define CRITICAL_SECTION_END()    if (irqon) ENABLE_ISRS()
+
+// ISR function
+#define ISRS_ENABLED()          simulator.isr_enabled
+#define ENABLE_ISRS()           (simulator.isr_enabled = true)
+#define DISABLE_ISRS()          (simulator.isr_enabled = false)
+
+// Voltage
+#define HAL_VOLTAGE_PIN 3.3
+
+// Reset reason
+#define RST_POWER_ON   1
+#define RST_EXTERNAL   2
+#define RST_BROWN_OUT  4
+#define RST_WATCHDOG   8
+#define RST_JTAG      16
+#define RST_SOFTWARE  32
+#define RST_BACKUP    64
+
+#define SPR0    0
+#define SPR1    1
+
+#define PACK    __attribute__ ((packed))
+
+// Macros for stepper.cpp
+#define HAL_MULTI_ACC(A,B)  MultiU32X24toH32(A,B)
+
+#define HAL_TIMER_TYPE_MAX  0xFFFFFFFF
+
+// TEMPERATURE
+#define ADC_TEMPERATURE_SENSOR  15
+// Bits of the ADC converter
+#define ANALOG_INPUT_BITS 12
+#if ENABLED(ADC_DMA)
+  #define AD_RANGE        _BV(ANALOG_INPUT_BITS + ADC_OVERSAMPLE_BITS)
+#else
+  #define AD_RANGE        _BV(ANALOG_INPUT_BITS)
+#endif
+#define ABS_ZERO        -273.15f
+#define NUM_ADC_SAMPLES   32
+#define AD595_MAX        330.0f
+#define AD8495_MAX       660.0f
+
+#define GET_PIN_MAP_PIN(index) index
+#define GET_PIN_MAP_INDEX(pin) pin
+#define PARSED_PIN_INDEX(code, dval) parser.intval(code, dval)
+
+// --------------------------------------------------------------------------
+// Public Variables
+// --------------------------------------------------------------------------
+
+// Reset reason
+extern uint8_t MCUSR;
+
+int freeMemory(void);
+
+char *dtostrf(double __val, signed char __width, unsigned char __prec, char *__s);
+
+#if ENABLED(ADC_DMA)
+  typedef ADC_Decimator<NUM_ANALOG_INPUTS, ADC_DMA_SAMPLES, ADC_OVERSAMPLE_BITS> ADCDecimator;
+#endif
+
+class HAL {
+
+  public: /** Constructor */
+
+    HAL() {}
+
+    virtual ~HAL() {}
+
+  public: /** Public Parameters */
+
+    #if ENABLED(ADC_DMA)
+      static ADCDecimator adc_decimator;
+    #endif
+
+  public: /** Public Function */
+
+    static void analogStart() {}
+
+    #if ENABLED(ADC_DMA)
+      static uint8_t adc_dma_channel(const pin_t pin) { return pin; }
+    #endif
+    static void AdcChangePin(const pin_t old_pin, const pin_t new_pin) {
+      #if ENABLED(ADC_DMA)
+        adc_decimator.reset(old_pin);
+        adc_decimator.reset(new_pin);
+      #else
+        UNUSED(old_pin); UNUSED(new_pin);
+      #endif
+    }
+
+    static void hwSetup();
+
+    static bool pwm_status(const pin_t) { return false; }
+    static bool tc_status(const pin_t)  { return false; }
+
+    static void analogWrite(const pin_t pin, uint32_t ulValue, const uint16_t freq=1000U);
+
+    static void Tick();
+
+    static int32_t analog2tempMCU(const int16_t) { return 25; }
+
+    static pin_t digital_value_pin();
+    static pin_t analog_value_pin();
+
+    FORCE_INLINE static void pinMode(const pin_t pin, const uint8_t mode) {
+      switch (mode) {
+        case INPUT:         SET_INPUT(pin);         break;
+        case OUTPUT:        SET_OUTPUT(pin);        break;
+        case INPUT_PULLUP:  SET_INPUT_PULLUP(pin);  break;
+        case OUTPUT_LOW:    SET_OUTPUT_LOW(pin);    break;
+        case OUTPUT_HIGH:   SET_OUTPUT_HIGH(pin);   break;
+        default:                                    break;
+      }
+    }
+    FORCE_INLINE static void digitalWrite(const pin_t pin, const bool value) {
+      WRITE(pin, value);
+    }
+    FORCE_INLINE static bool digitalRead(const pin_t pin) {
+      return READ(pin);
+    }
+    FORCE_INLINE static void setInputPullup(const pin_t pin, const bool onoff) {
+      onoff ? SET_INPUT_PULLUP(pin) : SET_INPUT(pin);
+    }
+
+    // Busy waits only move the simulated clock forward
+    FORCE_INLINE static void delayNanoseconds(const uint32_t delayNs) {
+      simulator.delay_ns(delayNs);
+    }
+    FORCE_INLINE static void delayMicroseconds(const uint32_t delayUs) {
+      simulator.delay_ns(delayUs * 1000UL);
+    }
+    FORCE_INLINE static void delayMilliseconds(const uint16_t delayMs) {
+      delay(delayMs);
+    }
+    FORCE_INLINE static uint32_t timeInMilliseconds() {
+      return millis();
+    }
+
+    static void showStartReason();
+
+    static void resetHardware();
+
+    //
+    // SPI related functions, no device is connected on host
+    //
+    static void spiBegin() {}
+    static void spiInit(uint8_t=6) {}
+    static void spiSend(uint8_t) {}
+    static void spiSend(const uint8_t*, size_t) {}
+    static void spiSend(uint32_t, uint8_t) {}
+    static void spiSend(uint32_t, const uint8_t*, size_t) {}
+    static uint8_t spiReceive(void) { return 0xFF; }
+    static uint8_t spiReceive(uint32_t) { return 0xFF; }
+    static void spiReadBlock(uint8_t* buf, uint16_t nbyte) { memset(buf, 0xFF, nbyte); }
+    static void spiSendBlock(uint8_t, const uint8_t*) {}
+
+};
+
+/**
+ * Public functions
+ */
+
+// Disable interrupts
+void cli(void);
+
+// Enable interrupts
+void sei(void);
+
+// Tone
+void tone(const pin_t _pin, const uint16_t frequency, const uint16_t duration=0);
+void noTone(const pin_t _pin);
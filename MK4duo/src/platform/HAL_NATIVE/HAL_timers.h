@@ -0,0 +1,191 @@
+/**
+ * MK4duo Firmware for 3D Printer, Laser and CNC
+ *
+ * Based on Marlin, Sprinter and grbl
+ * Copyright (c) 2011 Camiel Gubbels / Erik van der Zalm
+ * Copyright (c) 2020 Alberto Cotronei @MagoKimbra
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+/**
+ * This is the main Hardware Abstraction Layer (HAL).
+ * To make the firmware work with different processors and toolchains,
+ * all hardware related code should be packed into the hal files.
+ *
+ * Description: HAL timers for the host native build
+ *
+ * The stepper timer behaves like the DUE TC: the counter is reset on
+ * compare match and HAL_timer_set_count() programs the compare value.
+ *
+ * ARDUINO_ARCH_NATIVE
+ */
+#pragma once
+
+// --------------------------------------------------------------------------
+// Includes
+// --------------------------------------------------------------------------
+#include <stdint.h>
+
+// --------------------------------------------------------------------------
+// Defines
+// --------------------------------------------------------------------------
+#define NUM_HARDWARE_TIMERS 1
+
+#define HAL_TIMER_RATE              SIM_TIMER_RATE  // 42 MHz
+
+// Stepper Timer
+#define STEPPER_TIMER_NUM           0
+#define STEPPER_TIMER_RATE          HAL_TIMER_RATE
+#define STEPPER_TIMER_TICKS_PER_US  ((STEPPER_TIMER_RATE) / 1000000UL)                        // 42 - stepper timer ticks per µs
+#define STEPPER_TIMER_PULSE_TICK_NS (1000000000UL / STEPPER_TIMER_RATE)
+#define STEPPER_TIMER_PRESCALE      2                                                         // 2
+#define STEPPER_TIMER_MIN_INTERVAL  1                                                         // minimum time in µs between stepper interrupts
+#define STEPPER_TIMER_MAX_INTERVAL  (STEPPER_TIMER_TICKS_PER_US * STEPPER_TIMER_MIN_INTERVAL) // maximum time in µs between stepper interrupts
+#define STEPPER_CLOCK_RATE          ((F_CPU) / 128)                                           // frequency of the clock used for stepper pulse timing
+
+#define START_STEPPER_INTERRUPT()   HAL_timer_start(STEPPER_TIMER_NUM)
+#define ENABLE_STEPPER_INTERRUPT()  HAL_timer_enable_interrupt(STEPPER_TIMER_NUM)
+#define DISABLE_STEPPER_INTERRUPT() HAL_timer_disable_interrupt(STEPPER_TIMER_NUM)
+#define STEPPER_ISR_ENABLED()       HAL_timer_interrupt_is_enabled(STEPPER_TIMER_NUM)
+
+// Estimate the amount of time the ISR will take to execute, same as DUE
+#define TIMER_CYCLES                34UL
+
+// The base ISR takes 792 cycles
+#define ISR_BASE_CYCLES            792UL
+
+// Linear advance base time is 64 cycles
+#if ENABLED(LIN_ADVANCE)
+  #define ISR_LA_BASE_CYCLES        64UL
+#else
+  #define ISR_LA_BASE_CYCLES         0UL
+#endif
+
+// Bezier interpolation adds 40 cycles, S-curve interpolation 20 cycles
+#if ENABLED(BEZIER_JERK_CONTROL)
+  #define ISR_BEZIER_CYCLES         40UL
+#elif ENABLED(S_CURVE_JERK_CONTROL)
+  #define ISR_BEZIER_CYCLES         20UL
+#else
+  #define ISR_BEZIER_CYCLES          0UL
+#endif
+
+// Stepper Loop base cycles
+#define ISR_LOOP_BASE_CYCLES         4UL
+
+// And each stepper (start + stop pulse) takes in worst case
+#define ISR_STEPPER_CYCLES          16UL
+
+// For each stepper, we add its time
+#if HAS_X_STEP
+  #define ISR_X_STEPPER_CYCLES        ISR_STEPPER_CYCLES
+#else
+  #define ISR_X_STEPPER_CYCLES        0UL
+#endif
+#if HAS_Y_STEP
+  #define ISR_Y_STEPPER_CYCLES        ISR_STEPPER_CYCLES
+#else
+  #define ISR_Y_STEPPER_CYCLES        0UL
+#endif
+#if HAS_Z_STEP
+  #define ISR_Z_STEPPER_CYCLES        ISR_STEPPER_CYCLES
+#else
+  #define ISR_Z_STEPPER_CYCLES        0UL
+#endif
+
+// E is always interpolated
+#define ISR_E_STEPPER_CYCLES          ISR_STEPPER_CYCLES
+
+// If linear advance is disabled, then the loop also handles them
+#if DISABLED(LIN_ADVANCE) && ENABLED(COLOR_MIXING_EXTRUDER)
+  #define ISR_MIXING_STEPPER_CYCLES   ((MIXING_STEPPERS) * 16UL)
+#else
+  #define ISR_MIXING_STEPPER_CYCLES   0UL
+#endif
+
+// And the total minimum loop time is, without including the base
+#define MIN_ISR_LOOP_CYCLES           (ISR_X_STEPPER_CYCLES + ISR_Y_STEPPER_CYCLES + ISR_Z_STEPPER_CYCLES + ISR_E_STEPPER_CYCLES + ISR_MIXING_STEPPER_CYCLES)
+
+// But the user could be enforcing a minimum time, so the loop time is
+#define ISR_LOOP_CYCLES               (ISR_LOOP_BASE_CYCLES + MAX(HAL_min_pulse_cycle, MIN_ISR_LOOP_CYCLES))
+
+#define TIMER_SETUP_NS                (1000UL * TIMER_CYCLES / ((F_CPU) / 1000000UL))
+
+// If linear advance is enabled, then it is handled separately
+#if ENABLED(LIN_ADVANCE)
+
+  // Estimate the minimum LA loop time
+  #if ENABLED(COLOR_MIXING_EXTRUDER)
+    #define MIN_ISR_LA_LOOP_CYCLES  ((MIXING_STEPPERS) * 16UL)
+  #else
+    #define MIN_ISR_LA_LOOP_CYCLES  16UL
+  #endif
+
+  // And the real loop time
+  #define ISR_LA_LOOP_CYCLES  MAX(HAL_min_pulse_cycle, MIN_ISR_LA_LOOP_CYCLES)
+
+#else
+  #define ISR_LA_LOOP_CYCLES  0UL
+#endif
+
+// --------------------------------------------------------------------------
+// Public Variables
+// --------------------------------------------------------------------------
+
+extern uint32_t HAL_min_pulse_cycle,
+                HAL_pulse_high_tick,
+                HAL_pulse_low_tick,
+                HAL_frequency_limit[8];
+
+// --------------------------------------------------------------------------
+// Public functions
+// --------------------------------------------------------------------------
+
+void HAL_timer_start(const uint8_t timer_num, const uint32_t frequency=100);
+
+void HAL_calc_pulse_cycle();
+
+FORCE_INLINE static void HAL_timer_enable_interrupt(const uint8_t timer_num) {
+  if (timer_num == STEPPER_TIMER_NUM) simulator.stepper_irq(true);
+}
+
+FORCE_INLINE static void HAL_timer_disable_interrupt(const uint8_t timer_num) {
+  if (timer_num == STEPPER_TIMER_NUM) simulator.stepper_irq(false);
+}
+
+FORCE_INLINE static bool HAL_timer_interrupt_is_enabled(const uint8_t timer_num) {
+  return timer_num == STEPPER_TIMER_NUM && simulator.stepper_irq_is_enabled();
+}
+
+FORCE_INLINE static void HAL_timer_set_count(const uint8_t timer_num, const uint32_t count) {
+  if (timer_num == STEPPER_TIMER_NUM) simulator.stepper_timer_set_compare(count);
+}
+
+FORCE_INLINE static uint32_t HAL_timer_get_current_count(const uint8_t timer_num) {
+  return timer_num == STEPPER_TIMER_NUM ? simulator.stepper_timer_count() : 0;
+}
+
+// Cycle counter used by the stepper ISR profiler (host nanoseconds)
+typedef uint32_t hal_cycle_t;
+#define HAL_CYCLE_COUNTER_MULT      1UL
+#define HAL_CYCLE_COUNTER_RATE      1000000000UL
+
+FORCE_INLINE static void HAL_cycle_counter_init() {}
+
+FORCE_INLINE static hal_cycle_t HAL_cycle_counter_get() { return hal_cycle_t(simulator.host_ns()); }
+
+// Deferred half of HAL::Tick, the simulator runs it right after the Tick like PendSV
+FORCE_INLINE static void HAL_tick_task_request() { simulator.tick_task_requested = true; }
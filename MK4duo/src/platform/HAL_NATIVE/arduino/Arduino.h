@@ -0,0 +1,127 @@
+/**
+ * MK4duo Firmware for 3D Printer, Laser and CNC
+ *
+ * Based on Marlin, Sprinter and grbl
+ * Copyright (c) 2011 Camiel Gubbels / Erik van der Zalm
+ * Copyright (c) 2020 Alberto Cotronei @MagoKimbra
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#pragma once
+
+/**
+ * Minimal Arduino core for the host native build.
+ *
+ * Only the part of the Wiring API used by MK4duo is provided. Time is the
+ * simulated clock of HAL_NATIVE, pins are the virtual pins of fastio.h.
+ */
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+
+#include "pgmspace.h"
+
+typedef uint8_t   byte;
+typedef bool      boolean;
+typedef uint16_t  word;
+
+#define INPUT         0x0
+#define OUTPUT        0x1
+#define INPUT_PULLUP  0x2
+
+#define LOW           0x0
+#define HIGH          0x1
+
+#define CHANGE        1
+#define FALLING       2
+#define RISING        3
+
+#define NOT_AN_INTERRUPT -1
+#define digitalPinToInterrupt(p)  (p)
+
+#define NUM_DIGITAL_PINS  128
+#define NUM_ANALOG_INPUTS 16
+
+#define A0  54
+#define A1  55
+#define A2  56
+#define A3  57
+#define A4  58
+#define A5  59
+#define A6  60
+#define A7  61
+#define A8  62
+#define A9  63
+#define A10 64
+#define A11 65
+#define A12 66
+#define A13 67
+#define A14 68
+#define A15 69
+
+#define analogInputToDigitalPin(p)  (((p) < NUM_ANALOG_INPUTS) ? (p) + A0 : -1)
+
+#define F_CPU 84000000UL
+
+#define _BV(bit) (1UL << (bit))
+
+#define PI          3.1415926535897932384626433832795
+#define HALF_PI     1.5707963267948966192313216916398
+#define TWO_PI      6.283185307179586476925286766559
+#define DEG_TO_RAD  0.017453292519943295769236907684886
+#define RAD_TO_DEG  57.295779513082320876798154814105
+
+#define constrain(amt,low,high) ((amt)<(low)?(low):((amt)>(high)?(high):(amt)))
+#define sq(x)       ((x)*(x))
+#define radians(deg) ((deg)*DEG_TO_RAD)
+#define degrees(rad) ((rad)*RAD_TO_DEG)
+
+#define lowByte(w)  ((uint8_t) ((w) & 0xFF))
+#define highByte(w) ((uint8_t) ((w) >> 8))
+#define bit(b)      (1UL << (b))
+
+class __FlashStringHelper;
+#define F(string_literal) (reinterpret_cast<const __FlashStringHelper *>(string_literal))
+
+// Time, driven by the simulated clock
+uint32_t millis();
+uint32_t micros();
+void delay(const uint32_t ms);
+void delayMicroseconds(const uint32_t us);
+
+// Wiring
+void pinMode(const uint8_t pin, const uint8_t mode);
+void digitalWrite(const uint8_t pin, const uint8_t value);
+int  digitalRead(const uint8_t pin);
+int  analogRead(const uint8_t pin);
+void analogWrite(const uint8_t pin, const int value);
+
+void attachInterrupt(const uint8_t pin, void (*handler)(void), const int mode);
+void detachInterrupt(const uint8_t pin);
+
+void noInterrupts();
+void interrupts();
+
+long random(const long max);
+long random(const long min, const long max);
+void randomSeed(const unsigned long seed);
+
+// Setup and main loop of the firmware
+void setup();
+void loop();
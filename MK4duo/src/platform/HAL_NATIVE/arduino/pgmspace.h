@@ -0,0 +1,80 @@
+/**
+ * MK4duo Firmware for 3D Printer, Laser and CNC
+ *
+ * Based on Marlin, Sprinter and grbl
+ * Copyright (c) 2011 Camiel Gubbels / Erik van der Zalm
+ * Copyright (c) 2020 Alberto Cotronei @MagoKimbra
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#pragma once
+
+// No program space memory on host
+#define PROGMEM
+#ifndef PGM_P
+  #define PGM_P const char *
+#endif
+#undef PSTR
+#define PSTR(s) s
+#undef pgm_read_byte_near
+#define pgm_read_byte_near(x) (*(int8_t*)x)
+#undef pgm_read_byte
+#define pgm_read_byte(x) (*(const uint8_t*)(x))
+#undef pgm_read_float
+#define pgm_read_float(addr) (*(const float *)(addr))
+#undef pgm_read_word
+#define pgm_read_word(addr) (*(addr))
+#undef pgm_read_dword
+#define pgm_read_dword(addr) (*(addr))
+#undef pgm_read_dword_near
+#define pgm_read_dword_near(addr) pgm_read_dword(addr)
+#undef pgm_read_ptr
+#define pgm_read_ptr(addr) (*(addr))
+#ifndef strncpy_P
+  #define strncpy_P strncpy
+#endif
+#ifndef strcpy_P
+  #define strcpy_P strcpy
+#endif
+#ifndef strcat_P
+  #define strcat_P strcat
+#endif
+#ifndef strlen_P
+  #define strlen_P strlen
+#endif
+#ifndef strcmp_P
+  #define strcmp_P strcmp
+#endif
+#ifndef strncmp_P
+  #define strncmp_P strncmp
+#endif
+#ifndef strchr_P
+  #define strchr_P strchr
+#endif
+#ifndef strstr_P
+  #define strstr_P strstr
+#endif
+#ifndef memcpy_P
+  #define memcpy_P memcpy
+#endif
+#ifndef sprintf_P
+  #define sprintf_P sprintf
+#endif
+#ifndef vsnprintf_P
+  #define vsnprintf_P vsnprintf
+#endif
+#ifndef snprintf_P
+  #define snprintf_P snprintf
+#endif
@@ -0,0 +1,97 @@
+/**
+ * MK4duo Firmware for 3D Printer, Laser and CNC
+ *
+ * Based on Marlin, Sprinter and grbl
+ * Copyright (c) 2011 Camiel Gubbels / Erik van der Zalm
+ * Copyright (c) 2020 Alberto Cotronei @MagoKimbra
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+/**
+ * eeprom_file.cpp - EEPROM of the host native build
+ *
+ * The whole EEPROM is kept in RAM and saved to a file (-e option of the
+ * simulator, eeprom.bin by default) on every access_write().
+ */
+
+#ifdef ARDUINO_ARCH_NATIVE
+
+#include "../../../MK4duo.h"
+
+#if HAS_EEPROM
+
+static uint8_t  eeprom_image[EEPROM_SIZE + 1];
+static bool     eeprom_loaded = false;
+
+static void eeprom_load() {
+  if (eeprom_loaded) return;
+  memset(eeprom_image, 0xFF, sizeof(eeprom_image));
+  FILE * const f = fopen(simulator.eeprom_path, "rb");
+  if (f) {
+    (void)fread(eeprom_image, 1, sizeof(eeprom_image), f);
+    fclose(f);
+  }
+  eeprom_loaded = true;
+}
+
+/** Public Function */
+size_t  MemoryStore::capacity()     { return EEPROM_SIZE + 1; }
+bool    MemoryStore::access_start() { eeprom_load(); return false; }
+
+bool MemoryStore::access_write() {
+  FILE * const f = fopen(simulator.eeprom_path, "wb");
+  if (!f) return true;
+  const bool error = fwrite(eeprom_image, 1, sizeof(eeprom_image), f) != sizeof(eeprom_image);
+  fclose(f);
+  return error;
+}
+
+bool MemoryStore::write_data(int &pos, const uint8_t *value, size_t size, uint16_t *crc) {
+
+  eeprom_load();
+
+  while (size--) {
+    uint8_t v = *value;
+    if (pos < 0 || pos > EEPROM_SIZE) {
+      SERIAL_LM(ECHO, STR_ERR_EEPROM_WRITE);
+      return true;
+    }
+    eeprom_image[pos] = v;
+    crc16(crc, &v, 1);
+    pos++;
+    value++;
+  };
+
+  return false;
+}
+
+bool MemoryStore::read_data(int &pos, uint8_t *value, size_t size, uint16_t *crc, const bool writing/*=true*/) {
+
+  eeprom_load();
+
+  while (size--) {
+    uint8_t c = (pos >= 0 && pos <= EEPROM_SIZE) ? eeprom_image[pos] : 0xFF;
+    if (writing) *value = c;
+    crc16(crc, &c, 1);
+    pos++;
+    value++;
+  };
+
+  return false;
+}
+
+#endif // HAS_EEPROM
+#endif // ARDUINO_ARCH_NATIVE
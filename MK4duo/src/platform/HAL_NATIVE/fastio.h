@@ -0,0 +1,115 @@
+/**
+ * MK4duo Firmware for 3D Printer, Laser and CNC
+ *
+ * Based on Marlin, Sprinter and grbl
+ * Copyright (c) 2011 Camiel Gubbels / Erik van der Zalm
+ * Copyright (c) 2020 Alberto Cotronei @MagoKimbra
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#pragma once
+
+/**
+ * Description: Fast IO functions for the host native build
+ *
+ * Pins are entries of a virtual table in the simulator, every change
+ * of an output level is counted as an edge.
+ *
+ * ARDUINO_ARCH_NATIVE
+ */
+
+/**
+ * utility functions
+ */
+
+#ifndef MASK
+  #define MASK(PIN) (1 << PIN)
+#endif
+
+#define OUTPUT_LOW  0x3
+#define OUTPUT_HIGH 0x4
+
+/**
+ * magic I/O routines
+ * now you can simply SET_OUTPUT(STEP); WRITE(STEP, 1); WRITE(STEP, 0);
+ */
+
+// NOT CHANGE uint8_t in pin_t!
+// Read a pin
+FORCE_INLINE static bool READ(const uint8_t pin) {
+  return simulator.pin_read(pin);
+}
+
+// Write to a pin
+FORCE_INLINE static void WRITE(const uint8_t pin, const bool flag) {
+  simulator.pin_write(pin, flag);
+}
+
+// Toogle pin
+FORCE_INLINE static void TOGGLE(const uint8_t pin) {
+  WRITE(pin, !READ(pin));
+}
+
+// Set pin as input
+FORCE_INLINE static void SET_INPUT(const pin_t pin) {
+  simulator.pin_mode(pin, false, false);
+}
+
+// Set pin as output
+FORCE_INLINE static void SET_OUTPUT(const pin_t pin) {
+  simulator.pin_mode(pin, true, false);
+}
+FORCE_INLINE static void SET_OUTPUT_LOW(const pin_t pin) {
+  SET_OUTPUT(pin);
+  WRITE(pin, LOW);
+}
+FORCE_INLINE static void SET_OUTPUT_HIGH(const pin_t pin) {
+  SET_OUTPUT(pin);
+  WRITE(pin, HIGH);
+}
+
+// Set pin as input with pullup
+FORCE_INLINE static void SET_INPUT_PULLUP(const pin_t pin) {
+  simulator.pin_mode(pin, false, true);
+}
+
+// Shorthand
+FORCE_INLINE static void OUT_WRITE(const pin_t pin, const uint8_t flag) {
+  if (flag)
+    SET_OUTPUT_HIGH(pin);
+  else
+    SET_OUTPUT_LOW(pin);
+}
+
+FORCE_INLINE static bool USEABLE_HARDWARE_PWM(const pin_t) { return false; }
+
+/**
+ * Port writes for the soft PWM outputs
+ * The virtual pins make ports of 32, as on DUE; a port write changes
+ * the pins of its masks one by one, each edge counted as before.
+ */
+#define FASTIO_PORTS  ((SIM_NUM_PINS + 31) / 32)
+typedef uint32_t fastio_mask_t;
+
+// Port of a pin, FASTIO_PORTS for a pin not on a port
+FORCE_INLINE static uint8_t FASTIO_PORT(const pin_t pin) {
+  return (pin < 0 || pin >= SIM_NUM_PINS) ? FASTIO_PORTS : pin / 32;
+}
+FORCE_INLINE static fastio_mask_t FASTIO_PORT_MASK(const pin_t pin) {
+  return 1UL << (pin % 32);
+}
+FORCE_INLINE static void FASTIO_PORT_WRITE(const uint8_t port, const fastio_mask_t set, const fastio_mask_t clear) {
+  simulator.port_write(port, set, clear);
+}
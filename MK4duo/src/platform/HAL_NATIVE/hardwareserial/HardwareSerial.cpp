@@ -0,0 +1,197 @@
+/**
+ * MK4duo Firmware for 3D Printer, Laser and CNC
+ *
+ * Based on Marlin, Sprinter and grbl
+ * Copyright (c) 2011 Camiel Gubbels / Erik van der Zalm
+ * Copyright (c) 2020 Alberto Cotronei @MagoKimbra
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+/**
+ * HardwareSerial.cpp - Serial port for the host native build
+ */
+
+#ifdef ARDUINO_ARCH_NATIVE
+
+#include "../../../../MK4duo.h"
+
+/** Private Parameters */
+template<typename Cfg> FILE* MKHardwareSerial<Cfg>::in_file  = nullptr;
+template<typename Cfg> FILE* MKHardwareSerial<Cfg>::out_file = nullptr;
+
+/** Public Function */
+template<typename Cfg>
+void MKHardwareSerial<Cfg>::begin(const long) {
+  if (!in_file) in_file = stdin;
+  if (!out_file) out_file = stdout;
+}
+
+template<typename Cfg>
+void MKHardwareSerial<Cfg>::end() {}
+
+template<typename Cfg>
+bool MKHardwareSerial<Cfg>::open_input(const char * const path) {
+  in_file = fopen(path, "rb");
+  return in_file != nullptr;
+}
+
+template<typename Cfg>
+bool MKHardwareSerial<Cfg>::input_eof() {
+  return !in_file || peek() < 0;
+}
+
+template<typename Cfg>
+int MKHardwareSerial<Cfg>::peek() {
+  if (!in_file) return -1;
+  const int c = fgetc(in_file);
+  if (c != EOF) ungetc(c, in_file);
+  return c == EOF ? -1 : c;
+}
+
+template<typename Cfg>
+int MKHardwareSerial<Cfg>::read() {
+  if (!in_file) return -1;
+  const int c = fgetc(in_file);
+  return c == EOF ? -1 : c;
+}
+
+template<typename Cfg>
+int MKHardwareSerial<Cfg>::available() {
+  return peek() < 0 ? 0 : 1;
+}
+
+template<typename Cfg>
+void MKHardwareSerial<Cfg>::flush() {}
+
+template<typename Cfg>
+void MKHardwareSerial<Cfg>::write(const uint8_t c) {
+  if (out_file) fputc(c, out_file);
+}
+
+template<typename Cfg>
+void MKHardwareSerial<Cfg>::flushTX() {
+  if (out_file) fflush(out_file);
+}
+
+/**
+ * Imports from print.h
+ */
+template<typename Cfg>
+void MKHardwareSerial<Cfg>::print(char c, int base) {
+  print((long)c, base);
+}
+
+template<typename Cfg>
+void MKHardwareSerial<Cfg>::print(unsigned char b, int base) {
+  print((unsigned long)b, base);
+}
+
+template<typename Cfg>
+void MKHardwareSerial<Cfg>::print(int n, int base) {
+  print((long)n, base);
+}
+
+template<typename Cfg>
+void MKHardwareSerial<Cfg>::print(unsigned int n, int base) {
+  print((unsigned long)n, base);
+}
+
+template<typename Cfg>
+void MKHardwareSerial<Cfg>::print(long n, int base) {
+  if (base == 0) write(n);
+  else if (base == 10) {
+    if (n < 0) { print('-'); n = -n; }
+    printNumber(n, 10);
+  }
+  else
+    printNumber(n, base);
+}
+
+template<typename Cfg>
+void MKHardwareSerial<Cfg>::print(unsigned long n, int base) {
+  if (base == 0) write(n);
+  else printNumber(n, base);
+}
+
+template<typename Cfg>
+void MKHardwareSerial<Cfg>::print(double n, int digits) {
+  printFloat(n, digits);
+}
+
+template<typename Cfg>
+void MKHardwareSerial<Cfg>::println() {
+  print('\n');
+}
+
+/** Private Function */
+template<typename Cfg>
+void MKHardwareSerial<Cfg>::printNumber(unsigned long n, uint8_t base) {
+
+  if (n) {
+    unsigned char buf[8 * sizeof(long)]; // Enough space for base 2
+    int8_t i = 0;
+    while (n) {
+      buf[i++] = n % base;
+      n /= base;
+    }
+    while (i--)
+      print((char)(buf[i] + (buf[i] < 10 ? '0' : 'A' - 10)));
+  }
+  else
+    print('0');
+
+}
+
+template<typename Cfg>
+void MKHardwareSerial<Cfg>::printFloat(double number, uint8_t digits) {
+
+  // Handle negative numbers
+  if (number < 0.0) {
+    print('-');
+    number = -number;
+  }
+
+  // Round correctly so that print(1.999, 2) prints as "2.00"
+  double rounding = 0.5;
+  for (uint8_t i = 0; i < digits; ++i) rounding *= 0.1;
+  number += rounding;
+
+  // Extract the integer part of the number and print it
+  unsigned long int_part = (unsigned long)number;
+  double remainder = number - (double)int_part;
+  print(int_part);
+
+  // Print the decimal point, but only if there are digits beyond
+  if (digits) {
+    print('.');
+    // Extract digits from the remainder one at a time
+    while (digits--) {
+      remainder *= 10.0;
+      int toPrint = int(remainder);
+      print(toPrint);
+      remainder -= toPrint;
+    }
+  }
+
+}
+
+// Instantiate Class
+#if SERIAL_PORT_1 >= 0
+  template class MKHardwareSerial<MK4duoSerialHostCfg<SERIAL_PORT_1>>;
+  MKHardwareSerial<MK4duoSerialHostCfg<SERIAL_PORT_1>> MKSerial1;
+#endif
+
+#endif // ARDUINO_ARCH_NATIVE
@@ -0,0 +1,90 @@
+/**
+ * MK4duo Firmware for 3D Printer, Laser and CNC
+ *
+ * Based on Marlin, Sprinter and grbl
+ * Copyright (c) 2011 Camiel Gubbels / Erik van der Zalm
+ * Copyright (c) 2020 Alberto Cotronei @MagoKimbra
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#pragma once
+
+/**
+ * HardwareSerial.h - Serial port for the host native build
+ *
+ * The port reads the G-code stream from a file (or stdin) one byte at
+ * a time when the firmware asks for it, so the command queue is fed
+ * exactly like a host that waits for "ok". Output goes to stdout.
+ */
+
+#include <stdio.h>
+
+template<typename Cfg>
+class MKHardwareSerial {
+
+  public: /** Constructor */
+
+    MKHardwareSerial() {}
+
+  private: /** Private Parameters */
+
+    static FILE *in_file,
+                *out_file;
+
+  public: /** Public Function */
+
+    static void begin(const long);
+    static void end();
+    static int peek(void);
+    static int read(void);
+    static void flush(void);
+    static int available(void);
+    static void write(const uint8_t c);
+    static void flushTX(void);
+
+    // Host side streams
+    static bool open_input(const char * const path);
+    static void set_output(FILE * const file) { out_file = file; }
+    static bool input_eof();
+
+    FORCE_INLINE static uint8_t dropped() { return 0; }
+    FORCE_INLINE static uint8_t buffer_overruns() { return 0; }
+    FORCE_INLINE static uint8_t framing_errors() { return 0; }
+    FORCE_INLINE static int rxMaxEnqueued() { return 0; }
+
+    FORCE_INLINE static void write(const char* str) { while (*str) write(*str++); }
+    FORCE_INLINE static void write(const uint8_t* buffer, size_t size) { while (size--) write(*buffer++); }
+    FORCE_INLINE static void print(const char* str) { write(str); }
+    static void print(char, int=BYTE);
+    static void print(unsigned char, int=DEC);
+    static void print(int, int=DEC);
+    static void print(unsigned int, int=DEC);
+    static void print(long, int=DEC);
+    static void print(unsigned long, int=DEC);
+    static void print(double, int=2);
+    static void println(void);
+
+    operator bool() { return true; }
+
+  private: /** Private Function */
+
+    static void printNumber(unsigned long, const uint8_t);
+    static void printFloat(double, uint8_t);
+
+};
+
+#if SERIAL_PORT_1 >= 0
+  extern MKHardwareSerial<MK4duoSerialHostCfg<SERIAL_PORT_1>> MKSerial1;
+#endif
@@ -0,0 +1,64 @@
+/**
+ * MK4duo Firmware for 3D Printer, Laser and CNC
+ *
+ * Based on Marlin, Sprinter and grbl
+ * Copyright (c) 2011 Camiel Gubbels / Erik van der Zalm
+ * Copyright (c) 2020 Alberto Cotronei @MagoKimbra
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+/**
+ * main.cpp - Entry point of the host native build
+ *
+ * Runs setup() and then loop() until the G-code stream is finished, the
+ * command queue is empty and the planner has executed every block.
+ */
+
+#ifdef ARDUINO_ARCH_NATIVE
+
+#include "../../../MK4duo.h"
+
+int main(int argc, char *argv[]) {
+
+  if (!simulator.parse_args(argc, argv)) {
+    simulator.print_usage(argv[0]);
+    return EXIT_FAILURE;
+  }
+
+  if (simulator.gcode_path && !MKSerial1.open_input(simulator.gcode_path)) {
+    fprintf(stderr, "Unable to open %s\n", simulator.gcode_path);
+    return EXIT_FAILURE;
+  }
+
+  if (simulator.trace_path && !steptrace.open(simulator.trace_path)) {
+    fprintf(stderr, "Unable to create %s\n", simulator.trace_path);
+    return EXIT_FAILURE;
+  }
+
+  if (simulator.quiet) MKSerial1.set_output(fopen("/dev/null", "w"));
+
+  setup();
+
+  while (!simulator.finished()) loop();
+
+  MKSerial1.flushTX();
+  steptrace.close();
+  simulator.report();
+
+  return EXIT_SUCCESS;
+}
+
+#endif // ARDUINO_ARCH_NATIVE
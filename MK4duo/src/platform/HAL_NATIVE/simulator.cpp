@@ -0,0 +1,362 @@
+/**
+ * MK4duo Firmware for 3D Printer, Laser and CNC
+ *
+ * Based on Marlin, Sprinter and grbl
+ * Copyright (c) 2011 Camiel Gubbels / Erik van der Zalm
+ * Copyright (c) 2020 Alberto Cotronei @MagoKimbra
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+/**
+ * simulator.cpp - Simulated clock and machine for the host native build
+ */
+
+#ifdef ARDUINO_ARCH_NATIVE
+
+#include "../../../MK4duo.h"
+#include <time.h>
+#include <getopt.h>
+
+Simulator simulator;
+
+/** Public Parameters */
+volatile bool   Simulator::isr_enabled      = true;
+uint64_t        Simulator::clock            = 0;
+uint32_t        Simulator::idle_quantum_us  = SIM_DEFAULT_IDLE_US;
+float           Simulator::thermal_scale    = 1.0f;
+sim_pin_flag_t  Simulator::pin[SIM_NUM_PINS];
+uint32_t        Simulator::pin_edges[SIM_NUM_PINS]      = { 0 };
+uint16_t        Simulator::analog_value[SIM_NUM_ANALOG] = { 0 };
+float           Simulator::analog_temp[SIM_NUM_ANALOG]  = { 0 };
+sim_stats_t     Simulator::stats;
+const char      *Simulator::gcode_path      = nullptr,
+                *Simulator::eeprom_path     = "eeprom.bin",
+                *Simulator::trace_path      = nullptr;
+bool            Simulator::quiet            = false;
+volatile bool   Simulator::tick_task_requested = false;
+
+/** Private Parameters */
+bool            Simulator::stepper_timer_running  = false,
+                Simulator::stepper_irq_enabled    = false;
+uint64_t        Simulator::stepper_timer_base     = 0;
+uint32_t        Simulator::stepper_timer_compare  = 0;
+uint64_t        Simulator::next_tick              = 0;
+bool            Simulator::in_isr                 = false;
+#if ENABLED(ADC_DMA)
+  float         Simulator::analog_input[SIM_NUM_ANALOG]       = { 0 };
+  uint16_t      Simulator::analog_used                        = 0,
+                Simulator::adc_dma_buffer[SIM_ADC_DMA_BUFFER] = { 0 },
+                Simulator::adc_dma_head                       = 0,
+                Simulator::adc_dma_tail                       = 0;
+  uint32_t      Simulator::adc_noise_seed                     = 1;
+#endif
+
+/** Public Function */
+void Simulator::print_usage(const char * const name) {
+  fprintf(stderr, "Usage: %s [-q] [-i idle_us] [-T scale] [-e eeprom_file] [-t trace_file] [file.gcode]\n", name);
+  fprintf(stderr, "  -q            Don't echo the firmware output\n");
+  fprintf(stderr, "  -i idle_us    Simulated time spent in each idle() call (default %u)\n", SIM_DEFAULT_IDLE_US);
+  fprintf(stderr, "  -T scale      Time constants of the thermal model multiplied by scale (default 1)\n");
+  fprintf(stderr, "  -e file       EEPROM image file (default eeprom.bin)\n");
+  fprintf(stderr, "  -t file       Record the step trace to file\n");
+  fprintf(stderr, "Without a file the G-code is read from stdin.\n");
+}
+
+bool Simulator::parse_args(const int argc, char * const argv[]) {
+  int opt;
+  while ((opt = getopt(argc, argv, "qi:T:e:t:h")) != -1) {
+    switch (opt) {
+      case 'q': quiet = true; break;
+      case 'i': idle_quantum_us = MAX(1, atoi(optarg)); break;
+      case 'T': thermal_scale = MAX(0.1f, float(atof(optarg))); break;
+      case 'e': eeprom_path = optarg; break;
+      case 't': trace_path = optarg; break;
+      default: return false;
+    }
+  }
+  if (optind < argc) gcode_path = argv[optind];
+  for (uint8_t a = 0; a < SIM_NUM_ANALOG; a++) analog_temp[a] = SIM_AMBIENT_TEMP;
+  next_tick = SIM_TIMER_RATE / 1000UL;
+  return true;
+}
+
+void Simulator::advance(const uint64_t ticks) {
+
+  const uint64_t target = clock + ticks;
+
+  // Nested delays inside an ISR only consume time
+  if (in_isr) {
+    clock = target;
+    return;
+  }
+
+  for (;;) {
+
+    const bool  stepper_armed = isr_enabled && stepper_timer_running && stepper_irq_enabled,
+                tick_armed    = isr_enabled;
+    const uint64_t stepper_at = stepper_timer_base + stepper_timer_compare;
+
+    if (stepper_armed && stepper_at <= target && (!tick_armed || stepper_at <= next_tick)) {
+      if (stepper_at > clock) clock = stepper_at;
+      // Counter is reset on compare match
+      stepper_timer_base = clock;
+      fire_stepper_isr();
+    }
+    else if (tick_armed && next_tick <= target) {
+      if (next_tick > clock) clock = next_tick;
+      next_tick += SIM_TIMER_RATE / 1000UL;
+      fire_tick();
+    }
+    else {
+      if (target > clock) clock = target;
+      break;
+    }
+
+  }
+
+}
+
+void Simulator::idle() {
+  stats.idle_count++;
+  advance((uint64_t)idle_quantum_us * (SIM_TIMER_RATE / 1000000UL));
+}
+
+bool Simulator::finished() {
+  return MKSerial1.input_eof()
+      && commands.buffer_ring.isEmpty()
+      && !planner.has_blocks_queued();
+}
+
+void Simulator::report() {
+  FILE * const out = stderr;
+  fprintf(out, "\n--- Native simulation report ---\n");
+  fprintf(out, "Simulated time   : %.3f s\n", double(clock) / double(SIM_TIMER_RATE));
+  fprintf(out, "Host time        : %.3f s\n", double(host_ns() - stats.wall_ns) * 1e-9);
+  fprintf(out, "Stepper ISR      : %u calls, avg %.0f ns, max %llu ns\n",
+    stats.stepper_isr_count,
+    stats.stepper_isr_count ? double(stats.stepper_isr_ns) / stats.stepper_isr_count : 0.0,
+    (unsigned long long)stats.stepper_isr_max_ns
+  );
+  fprintf(out, "Tick             : %u calls, avg %.0f ns, max %llu ns\n",
+    stats.tick_count,
+    stats.tick_count ? double(stats.tick_ns) / stats.tick_count : 0.0,
+    (unsigned long long)stats.tick_max_ns
+  );
+  fprintf(out, "Tick task        : %u calls, avg %.0f ns, max %llu ns\n",
+    stats.tick_task_count,
+    stats.tick_task_count ? double(stats.tick_task_ns) / stats.tick_task_count : 0.0,
+    (unsigned long long)stats.tick_task_max_ns
+  );
+  fprintf(out, "Idle calls       : %u\n", stats.idle_count);
+  #if ENABLED(POWER_BUDGET)
+    fprintf(out, "Heater power     : mean %.1f W, highest %u ms %.1f W\n",
+      clock ? stats.heater_joules * double(SIM_TIMER_RATE) / double(clock) : 0.0,
+      SIM_POWER_WINDOW_MS, double(stats.heater_window_max)
+    );
+    fprintf(out, "Over the budget  : %u ms, %u ms with the soft PWM windows together\n",
+      stats.heater_over_ms, stats.heater_over_together_ms
+    );
+  #endif
+  if (trace_path)
+    fprintf(out, "Trace events     : %u (%s)\n", steptrace.events, trace_path);
+  #if HAS_X_STEP
+    fprintf(out, "X steps          : %u\n", pin_edges[X_STEP_PIN] >> 1);
+  #endif
+  #if HAS_Y_STEP
+    fprintf(out, "Y steps          : %u\n", pin_edges[Y_STEP_PIN] >> 1);
+  #endif
+  #if HAS_Z_STEP
+    fprintf(out, "Z steps          : %u\n", pin_edges[Z_STEP_PIN] >> 1);
+  #endif
+  #if HAS_E0_STEP
+    fprintf(out, "E0 steps         : %u\n", pin_edges[E0_STEP_PIN] >> 1);
+  #endif
+}
+
+void Simulator::stepper_timer_start() {
+  stepper_timer_running = true;
+  stepper_timer_base    = clock;
+}
+
+void Simulator::stepper_timer_set_compare(const uint32_t count) {
+  stepper_timer_compare = count;
+}
+
+uint64_t Simulator::host_ns() {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return uint64_t(ts.tv_sec) * 1000000000ULL + ts.tv_nsec;
+}
+
+/** Private Function */
+void Simulator::fire_stepper_isr() {
+  in_isr = true;
+  const uint64_t start = host_ns();
+  stepper.Step();
+  const uint64_t elapsed = host_ns() - start;
+  in_isr = false;
+  stats.stepper_isr_count++;
+  stats.stepper_isr_ns += elapsed;
+  NOLESS(stats.stepper_isr_max_ns, elapsed);
+}
+
+void Simulator::fire_tick() {
+  in_isr = true;
+  thermal_model();
+  #if ENABLED(ADC_DMA)
+    adc_dma();
+  #endif
+  const uint64_t start = host_ns();
+  HAL::Tick();
+  const uint64_t elapsed = host_ns() - start;
+  #if ENABLED(STEPPER_ISR_PROFILER)
+    isrprofiler.record(ISR_PHASE_TICK, uint32_t(elapsed));
+  #endif
+  stats.tick_count++;
+  stats.tick_ns += elapsed;
+  NOLESS(stats.tick_max_ns, elapsed);
+  if (tick_task_requested) {
+    tick_task_requested = false;
+    const uint64_t task_start = host_ns();
+    printer.tick_task();
+    const uint64_t task_elapsed = host_ns() - task_start;
+    stats.tick_task_count++;
+    stats.tick_task_ns += task_elapsed;
+    NOLESS(stats.tick_task_max_ns, task_elapsed);
+  }
+  in_isr = false;
+  // Step() and Tick() both leave the interrupts enabled on exit
+  isr_enabled = true;
+}
+
+/**
+ * First order thermal model of every heater, run once per millisecond.
+ * The temperature moves toward the equilibrium point of the applied power
+ * and is turned back into the ADC value the thermistor would give.
+ */
+void Simulator::thermal_model() {
+
+  auto model = [](Heater * const act, const float max_temp, const float tau_s) {
+    const pin_t a = act->data.sensor.pin;
+    if (!WITHIN(a, 0, SIM_NUM_ANALOG - 1)) return;
+
+    const sensor_data_t &sensor = act->data.sensor;
+    const float power = act->pwm_value * (1.0f / 255.0f),
+                equilibrium = SIM_AMBIENT_TEMP + (max_temp - SIM_AMBIENT_TEMP) * power;
+    float &temp = analog_temp[a];
+    temp += (equilibrium - temp) * (0.001f / (tau_s * thermal_scale));
+
+    if (WITHIN(sensor.type, 1, 9) && sensor.beta > 0) {
+      // Inverse of the Beta equation, shC is neglected
+      const float recipT = 1.0f / (temp - (ABS_ZERO)),
+                  resistance = sensor.res_25 * expf(sensor.beta * (recipT - 1.0f / (25.0f - (ABS_ZERO)))),
+                  adc = (float)(AD_RANGE) * resistance / (resistance + sensor.pullup_res);
+      analog_value[a] = (uint16_t)constrain(adc, 0, AD_RANGE - 1);
+      #if ENABLED(ADC_DMA)
+        analog_input[a] = adc * (float)_BV(ANALOG_INPUT_BITS) / (float)(AD_RANGE);
+        SBI(analog_used, a);
+      #endif
+    }
+  };
+
+  #if HAS_HOTENDS
+    LOOP_HOTEND() model(hotends[h], 300.0f, 8.0f);
+  #endif
+  #if HAS_BEDS
+    LOOP_BED() model(beds[h], 130.0f, 30.0f);
+  #endif
+  #if HAS_CHAMBERS
+    LOOP_CHAMBER() model(chambers[h], 80.0f, 60.0f);
+  #endif
+
+  #if ENABLED(POWER_BUDGET)
+
+    // Watts of the heaters in this millisecond from the level of their outputs,
+    // and what they would be if all the soft PWM windows started together
+    float watts = 0.0f, together = 0.0f;
+    auto meter = [&](Heater * const act) {
+      if (act->data.pin <= NoPin) return;
+      if (act->isHWpwm()) {
+        const float w = act->data.watts * act->pwm_value * (1.0f / 255.0f);
+        watts += w;
+        together += w;
+        return;
+      }
+      const bool invert = act->isHWinvert();
+      if (pin_read(act->data.pin) != invert) watts += act->data.watts;
+      #if ENABLED(SOFTWARE_PDM)
+        if (pin_read(act->data.pin) != invert) together += act->data.watts;
+      #else
+        const uint8_t pos = (invert ? 255 - act->pwm_value : act->pwm_value) & SOFT_PWM_MASK;
+        if ((tempManager.pwm_soft_count < pos || pos == SOFT_PWM_MASK) != invert) together += act->data.watts;
+      #endif
+    };
+
+    #if HAS_HOTENDS
+      LOOP_HOTEND() meter(hotends[h]);
+    #endif
+    #if HAS_BEDS
+      LOOP_BED() meter(beds[h]);
+    #endif
+    #if HAS_CHAMBERS
+      LOOP_CHAMBER() meter(chambers[h]);
+    #endif
+    #if HAS_COOLERS
+      LOOP_COOLER() meter(coolers[h]);
+    #endif
+
+    stats.heater_joules += watts * 0.001;
+    stats.heater_window_joules += watts * 0.001;
+    if (stats.tick_count % SIM_POWER_WINDOW_MS == SIM_POWER_WINDOW_MS - 1) {
+      NOLESS(stats.heater_window_max, stats.heater_window_joules * 1000.0 / SIM_POWER_WINDOW_MS);
+      stats.heater_window_joules = 0.0;
+    }
+    const uint16_t limit = powerbudget.data.limit;
+    if (limit && watts > limit) stats.heater_over_ms++;
+    if (limit && together > limit) stats.heater_over_together_ms++;
+
+  #endif
+
+}
+
+#if ENABLED(ADC_DMA)
+
+  /**
+   * The PDC of the DUE in free run: SIM_ADC_DMA_SCANS scans a millisecond
+   * of the channels of the sensors, samples of ANALOG_INPUT_BITS tagged
+   * with the channel. Triangular noise from a fixed seed dithers them, and
+   * the runs stay the same.
+   */
+  void Simulator::adc_dma() {
+    for (uint8_t s = 0; s < SIM_ADC_DMA_SCANS; s++) {
+      for (uint8_t a = 0; a < SIM_NUM_ANALOG; a++) {
+        if (!TEST(analog_used, a)) continue;
+        adc_noise_seed = adc_noise_seed * 1103515245UL + 12345UL;
+        const float n1 = (adc_noise_seed >> 16) & 0xFF;
+        adc_noise_seed = adc_noise_seed * 1103515245UL + 12345UL;
+        const float n2 = (adc_noise_seed >> 16) & 0xFF,
+                    v = analog_input[a] + (n1 + n2 - 255.0f) * (SIM_ADC_NOISE / 255.0f);
+        const uint16_t next = (adc_dma_head + 1) % SIM_ADC_DMA_BUFFER;
+        if (next == adc_dma_tail) return;   // Full, samples lost
+        adc_dma_buffer[adc_dma_head] = (a << 12) | (uint16_t)constrain(lroundf(v), 0, _BV(ANALOG_INPUT_BITS) - 1);
+        adc_dma_head = next;
+      }
+    }
+  }
+
+#endif // ENABLED(ADC_DMA)
+
+#endif // ARDUINO_ARCH_NATIVE
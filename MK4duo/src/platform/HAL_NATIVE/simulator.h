@@ -0,0 +1,228 @@
+/**
+ * MK4duo Firmware for 3D Printer, Laser and CNC
+ *
+ * Based on Marlin, Sprinter and grbl
+ * Copyright (c) 2011 Camiel Gubbels / Erik van der Zalm
+ * Copyright (c) 2020 Alberto Cotronei @MagoKimbra
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#pragma once
+
+/**
+ * simulator.h - Simulated clock and machine for the host native build
+ *
+ * Every time source of the firmware is derived from one virtual clock,
+ * counted in stepper timer ticks (SIM_TIMER_RATE):
+ *  - The stepper timer compare match calls Stepper::Step()
+ *  - Every millisecond HAL::Tick() is called like SysTick on DUE, and
+ *    then Printer::tick_task() when the Tick asked for it, like PendSV
+ *  - millis() and micros() read the clock
+ *  - Each pass through Printer::idle() moves the clock of idle_quantum_us
+ *
+ * Interrupts only fire while the clock is advanced, so the firmware runs
+ * single threaded and a G-code file always produces the same motion.
+ */
+
+// --------------------------------------------------------------------------
+// Defines
+// --------------------------------------------------------------------------
+#define SIM_TIMER_RATE            ((F_CPU) / 2)  // 42 MHz like the DUE stepper timer
+#define SIM_NUM_PINS              128
+#define SIM_NUM_ANALOG            16
+#define SIM_DEFAULT_IDLE_US       100
+#define SIM_AMBIENT_TEMP          25.0f
+#define SIM_ADC_DMA_SCANS         4       // ADC_DMA: scans of the used channels each ms
+#define SIM_ADC_DMA_BUFFER        256     // ADC_DMA: tagged samples waiting for the Tick
+#define SIM_ADC_NOISE             3.0f    // ADC_DMA: peak of the triangular noise, LSB
+#if ENABLED(SOFTWARE_PDM)
+  #define SIM_POWER_WINDOW_MS     1000    // POWER_BUDGET: the mean power is taken over this
+#else
+  #define SIM_POWER_WINDOW_MS     (4 * 256 / (SOFT_PWM_STEP)) // Four whole soft PWM cycles
+#endif
+
+#include "steptrace.h"
+
+union sim_pin_flag_t {
+  uint8_t all;
+  struct {
+    bool  Output  : 1;
+    bool  Pullup  : 1;
+    bool  Value   : 1;
+    bool  Pwm     : 1;
+    bool  bit4    : 1;
+    bool  bit5    : 1;
+    bool  bit6    : 1;
+    bool  bit7    : 1;
+  };
+  sim_pin_flag_t() { all = 0x00; }
+};
+
+struct sim_stats_t {
+  uint32_t  stepper_isr_count,
+            tick_count,
+            tick_task_count,
+            idle_count;
+  uint64_t  stepper_isr_ns,
+            stepper_isr_max_ns,
+            tick_ns,
+            tick_max_ns,
+            tick_task_ns,
+            tick_task_max_ns,
+            wall_ns;
+  #if ENABLED(POWER_BUDGET)
+    double    heater_joules,            // Drawn by the heaters from the level of their outputs
+              heater_window_joules;
+    float     heater_window_max;        // Highest mean of a SIM_POWER_WINDOW_MS window
+    uint32_t  heater_over_ms,           // Milliseconds over the budget
+              heater_over_together_ms;  // The same with all the soft PWM windows starting together
+  #endif
+};
+
+class Simulator {
+
+  public: /** Constructor */
+
+    Simulator() {}
+
+  public: /** Public Parameters */
+
+    static volatile bool  isr_enabled;
+
+    static uint64_t       clock;                // Virtual time in SIM_TIMER_RATE ticks
+
+    static uint32_t       idle_quantum_us;      // Virtual time consumed by each Printer::idle()
+
+    static float          thermal_scale;        // Time constants of the thermal model multiplied by this
+
+    static sim_pin_flag_t pin[SIM_NUM_PINS];
+    static uint32_t       pin_edges[SIM_NUM_PINS];
+
+    static uint16_t       analog_value[SIM_NUM_ANALOG];   // Raw ADC reading of each channel
+    static float          analog_temp[SIM_NUM_ANALOG];    // Modelled temperature seen by each channel
+    #if ENABLED(ADC_DMA)
+      static float        analog_input[SIM_NUM_ANALOG];   // Exact input of each channel in LSB of the ADC
+    #endif
+
+    static sim_stats_t    stats;
+
+    static const char     *gcode_path,
+                          *eeprom_path,
+                          *trace_path;
+
+    static bool           quiet;
+
+    static volatile bool  tick_task_requested;  // Set by HAL_tick_task_request()
+
+  private: /** Private Parameters */
+
+    // Stepper timer, the counter is reset on compare match like TC on DUE
+    static bool           stepper_timer_running,
+                          stepper_irq_enabled;
+    static uint64_t       stepper_timer_base;
+    static uint32_t       stepper_timer_compare;
+
+    static uint64_t       next_tick;
+
+    static bool           in_isr;
+
+    #if ENABLED(ADC_DMA)
+      static uint16_t     analog_used,                    // Channels scanned, one bit each
+                          adc_dma_buffer[SIM_ADC_DMA_BUFFER],
+                          adc_dma_head,
+                          adc_dma_tail;
+      static uint32_t     adc_noise_seed;
+    #endif
+
+  public: /** Public Function */
+
+    static bool parse_args(const int argc, char * const argv[]);
+    static void print_usage(const char * const name);
+
+    static void advance(const uint64_t ticks);
+    static void idle();
+
+    static bool finished();
+    static void report();
+
+    #if ENABLED(ADC_DMA)
+      // Next tagged sample of the simulated PDC, channel << 12 | value
+      static bool adc_dma_get(uint16_t &sample) {
+        if (adc_dma_tail == adc_dma_head) return false;
+        sample = adc_dma_buffer[adc_dma_tail];
+        adc_dma_tail = (adc_dma_tail + 1) % SIM_ADC_DMA_BUFFER;
+        return true;
+      }
+    #endif
+
+    // Stepper timer
+    static void stepper_timer_start();
+    static void stepper_timer_set_compare(const uint32_t count);
+    static uint32_t stepper_timer_count() {
+      // Every read costs one tick, so the pulse busy waits come to an end
+      advance(1);
+      return uint32_t(clock - stepper_timer_base);
+    }
+    static void stepper_irq(const bool onoff) { stepper_irq_enabled = onoff; }
+    static bool stepper_irq_is_enabled() { return stepper_irq_enabled; }
+
+    // Time
+    static uint32_t millis() { return uint32_t(clock / (SIM_TIMER_RATE / 1000UL)); }
+    static uint32_t micros() { return uint32_t(clock / (SIM_TIMER_RATE / 1000000UL)); }
+    static void delay_ns(const uint32_t ns) { advance(((uint64_t)ns * (SIM_TIMER_RATE / 1000000UL) + 999UL) / 1000UL); }
+
+    // Pins
+    static void pin_write(const uint8_t p, const bool value) {
+      if (p >= SIM_NUM_PINS) return;
+      if (pin[p].Value != value) {
+        pin[p].Value = value;
+        pin_edges[p]++;
+        if (steptrace.is_traced(p)) steptrace.edge(p, value, clock);
+      }
+    }
+    static void port_write(const uint8_t port, const uint32_t set, const uint32_t clear) {
+      for (uint32_t bits = set | clear; bits; bits &= bits - 1) {
+        const uint8_t b = __builtin_ctz(bits);
+        pin_write(port * 32 + b, TEST32(set, b));
+      }
+    }
+    static bool pin_read(const uint8_t p) {
+      return p < SIM_NUM_PINS && pin[p].Value;
+    }
+    static void pin_mode(const uint8_t p, const bool output, const bool pullup) {
+      if (p >= SIM_NUM_PINS) return;
+      pin[p].Output = output;
+      pin[p].Pullup = pullup;
+      // An open input with pullup reads high
+      if (!output && pullup) pin[p].Value = true;
+    }
+
+    // Host clock for profiling
+    static uint64_t host_ns();
+
+  private: /** Private Function */
+
+    static void fire_stepper_isr();
+    static void fire_tick();
+
+    static void thermal_model();
+
+    #if ENABLED(ADC_DMA)
+      static void adc_dma();
+    #endif
+
+};
+
+extern Simulator simulator;
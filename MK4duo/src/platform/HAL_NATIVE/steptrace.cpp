@@ -0,0 +1,131 @@
+/**
+ * MK4duo Firmware for 3D Printer, Laser and CNC
+ *
+ * Based on Marlin, Sprinter and grbl
+ * Copyright (c) 2011 Camiel Gubbels / Erik van der Zalm
+ * Copyright (c) 2020 Alberto Cotronei @MagoKimbra
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+/**
+ * steptrace.cpp - Step trace recorder for the host native build
+ */
+
+#ifdef ARDUINO_ARCH_NATIVE
+
+#include "../../../MK4duo.h"
+
+StepTrace steptrace;
+
+/** Public Parameters */
+uint8_t   StepTrace::pin_code[SIM_NUM_PINS] = { 0 };
+uint32_t  StepTrace::events                 = 0;
+
+/** Private Parameters */
+FILE*     StepTrace::file                   = nullptr;
+uint64_t  StepTrace::last_tick              = 0;
+bool      StepTrace::step_active[STEPTRACE_AXES];
+
+/** Public Function */
+bool StepTrace::open(const char * const path) {
+
+  file = fopen(path, "wb");
+  if (!file) return false;
+  setvbuf(file, nullptr, _IOFBF, 1 << 16);
+
+  const uint32_t rate = SIM_TIMER_RATE;
+  const uint8_t header[] = {
+    'M', 'K', 'S', 'T', STEPTRACE_VERSION, STEPTRACE_AXES,
+    uint8_t(rate), uint8_t(rate >> 8), uint8_t(rate >> 16), uint8_t(rate >> 24)
+  };
+  fwrite(header, 1, sizeof(header), file);
+
+  #if HAS_X_STEP
+    add_pin(X_STEP_PIN, 0, false, !INVERT_X_STEP_PIN);
+    add_pin(X_DIR_PIN,  0, true, false);
+  #endif
+  #if HAS_Y_STEP
+    add_pin(Y_STEP_PIN, 1, false, !INVERT_Y_STEP_PIN);
+    add_pin(Y_DIR_PIN,  1, true, false);
+  #endif
+  #if HAS_Z_STEP
+    add_pin(Z_STEP_PIN, 2, false, !INVERT_Z_STEP_PIN);
+    add_pin(Z_DIR_PIN,  2, true, false);
+  #endif
+  #if HAS_E0_STEP
+    add_pin(E0_STEP_PIN, 3, false, !INVERT_E_STEP_PIN);
+    add_pin(E0_DIR_PIN,  3, true, false);
+  #endif
+  #if HAS_E1_STEP
+    add_pin(E1_STEP_PIN, 4, false, !INVERT_E_STEP_PIN);
+    add_pin(E1_DIR_PIN,  4, true, false);
+  #endif
+  #if HAS_E2_STEP
+    add_pin(E2_STEP_PIN, 5, false, !INVERT_E_STEP_PIN);
+    add_pin(E2_DIR_PIN,  5, true, false);
+  #endif
+  #if HAS_E3_STEP
+    add_pin(E3_STEP_PIN, 6, false, !INVERT_E_STEP_PIN);
+    add_pin(E3_DIR_PIN,  6, true, false);
+  #endif
+  #if HAS_E4_STEP
+    add_pin(E4_STEP_PIN, 7, false, !INVERT_E_STEP_PIN);
+    add_pin(E4_DIR_PIN,  7, true, false);
+  #endif
+  #if HAS_E5_STEP
+    add_pin(E5_STEP_PIN, 8, false, !INVERT_E_STEP_PIN);
+    add_pin(E5_DIR_PIN,  8, true, false);
+  #endif
+
+  return true;
+}
+
+void StepTrace::close() {
+  if (!file) return;
+  fclose(file);
+  file = nullptr;
+  ZERO(pin_code);
+}
+
+void StepTrace::edge(const uint8_t p, const bool value, const uint64_t tick) {
+  const uint8_t code = pin_code[p],
+                axis = (code & 0x0F) - 1;
+  if (code & STEPTRACE_DIR_EVENT)
+    write_record(tick, axis | STEPTRACE_DIR_EVENT | (value ? STEPTRACE_DIR_LEVEL : 0));
+  else if (value == step_active[axis])
+    write_record(tick, axis);
+}
+
+/** Private Function */
+void StepTrace::add_pin(const pin_t p, const uint8_t axis, const bool is_dir, const bool step_active_level) {
+  if (!WITHIN(p, 0, SIM_NUM_PINS - 1)) return;
+  pin_code[p] = (axis + 1) | (is_dir ? STEPTRACE_DIR_EVENT : 0);
+  if (!is_dir) step_active[axis] = step_active_level;
+}
+
+void StepTrace::write_record(const uint64_t tick, const uint8_t event) {
+  uint64_t delta = tick - last_tick;
+  last_tick = tick;
+  do {
+    const uint8_t b = delta & 0x7F;
+    delta >>= 7;
+    fputc(delta ? (b | 0x80) : b, file);
+  } while (delta);
+  fputc(event, file);
+  events++;
+}
+
+#endif // ARDUINO_ARCH_NATIVE
@@ -0,0 +1,79 @@
+/**
+ * MK4duo Firmware for 3D Printer, Laser and CNC
+ *
+ * Based on Marlin, Sprinter and grbl
+ * Copyright (c) 2011 Camiel Gubbels / Erik van der Zalm
+ * Copyright (c) 2020 Alberto Cotronei @MagoKimbra
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#pragma once
+
+/**
+ * steptrace.h - Step trace recorder for the host native build
+ *
+ * Records every step pulse and every direction change emitted by
+ * Stepper::pulse_phase_step() and Stepper::set_directions() together with
+ * the simulated timer tick, so two builds can be compared edge by edge
+ * with scripts/steptrace.py.
+ *
+ * File format, little endian:
+ *  header  "MKST", version (1 byte), number of axes (1 byte), tick rate (4 bytes)
+ *  records delta ticks from the previous record (LEB128 varint), event (1 byte)
+ *          event bit 0-3 axis, bit 4 direction change, bit 5 direction level
+ *
+ * Axes are X, Y, Z, E0 ... E5 in this order.
+ */
+
+#define STEPTRACE_VERSION     1
+#define STEPTRACE_AXES        9
+#define STEPTRACE_DIR_EVENT   0x10
+#define STEPTRACE_DIR_LEVEL   0x20
+
+class StepTrace {
+
+  public: /** Constructor */
+
+    StepTrace() {}
+
+  public: /** Public Parameters */
+
+    static uint8_t  pin_code[SIM_NUM_PINS];   // 0 untraced, else bit 0-3 axis + 1, STEPTRACE_DIR_EVENT for dir pins
+
+    static uint32_t events;
+
+  private: /** Private Parameters */
+
+    static FILE     *file;
+    static uint64_t last_tick;
+    static bool     step_active[STEPTRACE_AXES];
+
+  public: /** Public Function */
+
+    static bool open(const char * const path);
+    static void close();
+
+    FORCE_INLINE static bool is_traced(const uint8_t p) { return pin_code[p] != 0; }
+
+    static void edge(const uint8_t p, const bool value, const uint64_t tick);
+
+  private: /** Private Function */
+
+    static void add_pin(const pin_t p, const uint8_t axis, const bool is_dir, const bool step_active_level);
+    static void write_record(const uint64_t tick, const uint8_t event);
+
+};
+
+extern StepTrace steptrace;
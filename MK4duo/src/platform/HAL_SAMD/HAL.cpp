@@ -114,14 +114,27 @@ void tone(const pin_t t_pin, const uint16_t frequency, const uint16_t duration)
 
 // This intercepts the 1ms system tick. It must return 'false', otherwise the Arduino core tick handler will be bypassed.
 extern "C" int sysTickHook() {
+  #if ENABLED(STEPPER_ISR_PROFILER)
+    const isr_free_t start = isrprofiler.start_free();
+  #endif
   HAL::Tick();
+  #if ENABLED(STEPPER_ISR_PROFILER)
+    isrprofiler.stop_free(ISR_PHASE_TICK, start);
+  #endif
   return 0;
 }
 
+// Deferred half of the system tick, at the lowest priority so that every other interrupt comes first
+extern "C" void PendSV_Handler() { printer.tick_task(); }
+
 bool HAL::SPIReady = false;
 
 // do any hardware-specific initialization here
-void HAL::hwSetup() { SPIReady= true; }
+void HAL::hwSetup() {
+  SPIReady = true;
+  NVIC_SetPriority(SysTick_IRQn, NvicPrioritySystick);
+  NVIC_SetPriority(PendSV_IRQn, NvicPriorityPendSV);
+}
 
 HAL::HAL() {
   // ctor
@@ -316,6 +329,7 @@ void HAL::analogWrite(pin_t pin, uint32_t value, const uint16_t freq/*=1000U*/)
  * It is used to update pwm values for heater and some other frequent jobs.
  *
  *  - Manage PWM to all the heaters and fan
+ *  - Flag spin() and the periodical actions for the deferred half, Printer::tick_task()
  *  - Prepare or Measure one of the raw ADC sensor values
  *  - Step the babysteps value for each axis towards 0
  *  - For PINS_DEBUGGING, monitor and report endstop pins
@@ -334,11 +348,13 @@ void HAL::Tick() {
   // Fans set output PWM
   fanManager.set_output_pwm();
 
-  // Event 100 ms
-  if (cycle_100_timer.expired(100)) tempManager.spin();
+  #if ENABLED(SOFT_PWM_PORT_WRITE)
+    // Soft PWM levels of heaters and fans, one write for each port
+    softpwm.flush();
+  #endif
 
-  // Event 1.0 Second
-  if (cycle_1s_timer.expired(1000)) printer.check_periodical_actions();
+  // Events every 100 ms and every second, run by the deferred half
+  printer.tick_events(cycle_100_timer.expired(100), cycle_1s_timer.expired(SECOND_TO_MILLIS(1)));
 
   // read analog values
   #if ANALOG_INPUTS > 0
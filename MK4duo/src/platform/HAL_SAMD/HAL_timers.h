@@ -75,7 +75,8 @@ typedef struct {
 #define NUM_HARDWARE_TIMERS 5
 
 #define NvicPriorityUart    1
-#define NvicPrioritySystick 15
+#define NvicPrioritySystick 14
+#define NvicPriorityPendSV  15
 
 #define HAL_TIMER_RATE              ((F_CPU)/2) // 24 MHz
 
@@ -112,9 +113,11 @@ typedef struct {
   #define ISR_LA_BASE_CYCLES          0UL
 #endif
 
-// Bezier interpolation adds 40 cycles
+// Bezier interpolation adds 40 cycles, S-curve interpolation 20 cycles
 #if ENABLED(BEZIER_JERK_CONTROL)
   #define ISR_BEZIER_CYCLES           40UL
+#elif ENABLED(S_CURVE_JERK_CONTROL)
+  #define ISR_BEZIER_CYCLES           20UL
 #else
   #define ISR_BEZIER_CYCLES           0UL
 #endif
@@ -268,3 +271,20 @@ FORCE_INLINE static void HAL_timer_isr_prologue(uint8_t timer_num) {
   const tTimerConfig * const pConfig = &TimerConfig[timer_num];
   pConfig->pTimerRegs->COUNT16.INTFLAG.bit.MC0 = 1;
 }
+
+// Cycle counter used by the stepper ISR profiler.
+// The Cortex-M0+ has no DWT, so use the stepper timer: while the ISR runs
+// its compare is set to the maximum so the count does not wrap mid-phase.
+// Out of the stepper ISR the count is reset at every compare, the other
+// phases are timed by micros().
+#define HAL_CYCLE_COUNTER_STEPPER_ONLY
+typedef hal_timer_t hal_cycle_t;
+#define HAL_CYCLE_COUNTER_MULT      ((F_CPU) / (HAL_TIMER_RATE))
+#define HAL_CYCLE_COUNTER_RATE      (F_CPU)
+
+FORCE_INLINE static void HAL_cycle_counter_init() {}
+
+FORCE_INLINE static hal_cycle_t HAL_cycle_counter_get() { return HAL_timer_get_current_count(STEPPER_TIMER_NUM); }
+
+// Deferred half of HAL::Tick, PendSV runs it when no other interrupt is pending
+FORCE_INLINE static void HAL_tick_task_request() { SCB->ICSR = SCB_ICSR_PENDSVSET_Msk; }
@@ -107,3 +107,24 @@ FORCE_INLINE static bool USEABLE_HARDWARE_PWM(const pin_t pin) {
   else
     return false;
 }
+
+/**
+ * Port writes for the soft PWM outputs
+ * The port and mask of a pin are made once, then the pins of a port go
+ * high with a write of OUTSET and low with a write of OUTCLR.
+ */
+#define FASTIO_PORTS  4   // PA to PD
+typedef uint32_t fastio_mask_t;
+
+// Port of a pin, FASTIO_PORTS for a pin not on a port
+FORCE_INLINE static uint8_t FASTIO_PORT(const pin_t pin) {
+  if (pin < 0 || pin >= (pin_t)PINS_COUNT || g_APinDescription[pin].ulPinType == PIO_NOT_A_PIN) return FASTIO_PORTS;
+  return g_APinDescription[pin].ulPort;
+}
+FORCE_INLINE static fastio_mask_t FASTIO_PORT_MASK(const pin_t pin) {
+  return 1ul << g_APinDescription[pin].ulPin;
+}
+FORCE_INLINE static void FASTIO_PORT_WRITE(const uint8_t port, const fastio_mask_t set, const fastio_mask_t clear) {
+  if (set) PORT->Group[port].OUTSET.reg = set;
+  if (clear) PORT->Group[port].OUTCLR.reg = clear;
+}
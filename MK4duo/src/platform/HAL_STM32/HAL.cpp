@@ -31,33 +31,49 @@ int32_t HAL_VREF = 0;
 uint8_t MCUSR;
 
 /** Private Parameters */
-#if HAS_HOTENDS
-  ADCAveragingFilter  HAL::HOTENDsensorFilters[MAX_HOTEND];
-#endif
-#if HAS_BEDS
-  ADCAveragingFilter  HAL::BEDsensorFilters[MAX_BED];
-#endif
-#if HAS_CHAMBERS
-  ADCAveragingFilter  HAL::CHAMBERsensorFilters[MAX_CHAMBER];
-#endif
-#if HAS_COOLERS
-  ADCAveragingFilter  HAL::COOLERsensorFilters[MAX_COOLER];
-#endif
+#if ENABLED(ADC_DMA)
 
-#if ENABLED(FILAMENT_WIDTH_SENSOR)
-  ADCAveragingFilter  HAL::filamentFilter;
-#endif
+  ADCDecimator HAL::adc_decimator;
 
-#if HAS_POWER_CONSUMPTION_SENSOR
-  ADCAveragingFilter  HAL::powerFilter;
-#endif
+  static ADC_HandleTypeDef  adc_dma_adc;
+  static DMA_HandleTypeDef  adc_dma_dma;
+  static pin_t              adc_dma_pin[ADC_DMA_CHANNELS];  // Pin of each rank of the scan
+  static uint8_t            adc_dma_ranks = 0;
+  static uint16_t           adc_dma_buffer[ADC_DMA_CHANNELS * ADC_DMA_SCANS],
+                            adc_dma_length = 0,             // Ranks * scans, whole scans in the buffer
+                            adc_dma_tail = 0;               // Next sample to add up
 
-#if HAS_MCU_TEMPERATURE
-  ADCAveragingFilter  HAL::mcuFilter;
-#endif
+#else
+
+  #if HAS_HOTENDS
+    ADCAveragingFilter  HAL::HOTENDsensorFilters[MAX_HOTEND];
+  #endif
+  #if HAS_BEDS
+    ADCAveragingFilter  HAL::BEDsensorFilters[MAX_BED];
+  #endif
+  #if HAS_CHAMBERS
+    ADCAveragingFilter  HAL::CHAMBERsensorFilters[MAX_CHAMBER];
+  #endif
+  #if HAS_COOLERS
+    ADCAveragingFilter  HAL::COOLERsensorFilters[MAX_COOLER];
+  #endif
+
+  #if ENABLED(FILAMENT_WIDTH_SENSOR)
+    ADCAveragingFilter  HAL::filamentFilter;
+  #endif
+
+  #if HAS_POWER_CONSUMPTION_SENSOR
+    ADCAveragingFilter  HAL::powerFilter;
+  #endif
+
+  #if HAS_MCU_TEMPERATURE
+    ADCAveragingFilter  HAL::mcuFilter;
+  #endif
+
+  #if HAS_VREF_MONITOR
+    ADCAveragingFilter  HAL::vrefFilter;
+  #endif
 
-#if HAS_VREF_MONITOR
-  ADCAveragingFilter  HAL::vrefFilter;
 #endif
 
 // Return available memory
@@ -75,6 +91,7 @@ void HAL::hwSetup() {
   hw_config_init();
 
   HAL_InitTick(NvicPrioritySystick); // Start SysTick to priority low
+  HAL_NVIC_SetPriority(PendSV_IRQn, NvicPriorityPendSV, 0); // Deferred half of the SysTick, lowest
 
   #if PIN_EXISTS(LED)
     OUT_WRITE(LED_PIN, LOW);
@@ -91,6 +108,189 @@ void HAL::showStartReason() {
   __HAL_RCC_CLEAR_RESET_FLAGS();
 }
 
+#if ENABLED(ADC_DMA)
+
+  uint8_t HAL::adc_dma_channel(const pin_t pin) {
+    for (uint8_t r = 0; r < adc_dma_ranks; r++)
+      if (adc_dma_pin[r] == pin) return r;
+    return 0xFF;
+  }
+
+  // ADC1 channel of a pin, ADC_CHANNEL_x is x on STM32F4
+  static uint32_t adc_dma_adc_channel(const pin_t pin) {
+    const PinName name = analogInputToPinName(pin);
+    #ifdef ATEMP
+      if (name == PADC_TEMP) return ADC_CHANNEL_TEMPSENSOR;
+    #endif
+    #ifdef AVREF
+      if (name == PADC_VREF) return ADC_CHANNEL_VREFINT;
+    #endif
+    return STM_PIN_CHANNEL(pinmap_function(name, PinMap_ADC));
+  }
+
+  // Add a pin to the scan, once. The internal channels are all on ADC1
+  static void adc_dma_add(const pin_t pin) {
+    if (pin == NoPin || HAL::adc_dma_channel(pin) != 0xFF || adc_dma_ranks == ADC_DMA_CHANNELS) return;
+    const PinName name = analogInputToPinName(pin);
+    if (name < PADC_BASE && pinmap_peripheral(name, PinMap_ADC) != ADC1) {
+      SERIAL_LMV(ER, "ADC_DMA: pin not on ADC1 ", (int)pin);
+      return;
+    }
+    adc_dma_pin[adc_dma_ranks++] = pin;
+  }
+
+  // Start the scan into the buffer from its first sample, rank 0
+  static void adc_dma_transfer() {
+    adc_dma_tail = 0;
+    HAL_ADC_Start_DMA(&adc_dma_adc, (uint32_t*)adc_dma_buffer, adc_dma_length);
+    // Polled from the Tick, no DMA or ADC interrupts
+    __HAL_DMA_DISABLE_IT(&adc_dma_dma, DMA_IT_TC | DMA_IT_HT | DMA_IT_TE | DMA_IT_DME);
+    __HAL_ADC_DISABLE_IT(&adc_dma_adc, ADC_IT_OVR);
+  }
+
+  /**
+   * Scan of the pins of the sensors on ADC1 in continuous mode, each scan
+   * moved by DMA2 Stream0 into a circular buffer of ADC_DMA_SCANS scans.
+   * No interrupt, the Tick adds up the samples written since the last one.
+   */
+  static void adc_dma_start() {
+
+    adc_dma_ranks = 0;
+    #if HAS_HOTENDS
+      LOOP_HOTEND() adc_dma_add(hotends[h]->data.sensor.pin);
+    #endif
+    #if HAS_BEDS
+      LOOP_BED() adc_dma_add(beds[h]->data.sensor.pin);
+    #endif
+    #if HAS_CHAMBERS
+      LOOP_CHAMBER() adc_dma_add(chambers[h]->data.sensor.pin);
+    #endif
+    #if HAS_COOLERS
+      LOOP_COOLER() adc_dma_add(coolers[h]->data.sensor.pin);
+    #endif
+    #if ENABLED(FILAMENT_WIDTH_SENSOR)
+      adc_dma_add(FILWIDTH_PIN);
+    #endif
+    #if HAS_POWER_CONSUMPTION_SENSOR
+      adc_dma_add(POWER_CONSUMPTION_PIN);
+    #endif
+    #if HAS_MCU_TEMPERATURE
+      adc_dma_add(ATEMP);
+    #endif
+    #if HAS_VREF_MONITOR
+      adc_dma_add(AVREF);
+    #endif
+
+    HAL::adc_decimator.reset();
+    adc_dma_length = adc_dma_ranks * ADC_DMA_SCANS;
+    if (!adc_dma_ranks) return;
+
+    __HAL_RCC_ADC1_CLK_ENABLE();
+    __HAL_RCC_DMA2_CLK_ENABLE();
+
+    adc_dma_dma.Instance                  = DMA2_Stream0;
+    adc_dma_dma.Init.Channel              = DMA_CHANNEL_0;
+    adc_dma_dma.Init.Direction            = DMA_PERIPH_TO_MEMORY;
+    adc_dma_dma.Init.PeriphInc            = DMA_PINC_DISABLE;
+    adc_dma_dma.Init.MemInc               = DMA_MINC_ENABLE;
+    adc_dma_dma.Init.PeriphDataAlignment  = DMA_PDATAALIGN_HALFWORD;
+    adc_dma_dma.Init.MemDataAlignment     = DMA_MDATAALIGN_HALFWORD;
+    adc_dma_dma.Init.Mode                 = DMA_CIRCULAR;
+    adc_dma_dma.Init.Priority             = DMA_PRIORITY_LOW;
+    adc_dma_dma.Init.FIFOMode             = DMA_FIFOMODE_DISABLE;
+    HAL_DMA_DeInit(&adc_dma_dma);
+    HAL_DMA_Init(&adc_dma_dma);
+    __HAL_LINKDMA(&adc_dma_adc, DMA_Handle, adc_dma_dma);
+
+    // PCLK2 / 8 and 480 cycles a sample, about 20 kHz for the whole scan
+    adc_dma_adc.Instance                    = ADC1;
+    adc_dma_adc.Init.ClockPrescaler         = ADC_CLOCK_SYNC_PCLK_DIV8;
+    adc_dma_adc.Init.Resolution             = ADC_RESOLUTION_12B;
+    adc_dma_adc.Init.ScanConvMode           = ENABLE;
+    adc_dma_adc.Init.ContinuousConvMode     = ENABLE;
+    adc_dma_adc.Init.DiscontinuousConvMode  = DISABLE;
+    adc_dma_adc.Init.ExternalTrigConvEdge   = ADC_EXTERNALTRIGCONVEDGE_NONE;
+    adc_dma_adc.Init.ExternalTrigConv       = ADC_SOFTWARE_START;
+    adc_dma_adc.Init.DataAlign              = ADC_DATAALIGN_RIGHT;
+    adc_dma_adc.Init.NbrOfConversion        = adc_dma_ranks;
+    adc_dma_adc.Init.DMAContinuousRequests  = ENABLE;
+    adc_dma_adc.Init.EOCSelection           = ADC_EOC_SEQ_CONV;
+    HAL_ADC_Init(&adc_dma_adc);
+
+    ADC_ChannelConfTypeDef config = { 0 };
+    config.SamplingTime = ADC_SAMPLETIME_480CYCLES;
+    for (uint8_t r = 0; r < adc_dma_ranks; r++) {
+      config.Channel = adc_dma_adc_channel(adc_dma_pin[r]);
+      config.Rank = r + 1;
+      HAL_ADC_ConfigChannel(&adc_dma_adc, &config);
+    }
+
+    adc_dma_transfer();
+  }
+
+  /**
+   * Add up the samples the DMA has written since the last Tick, the head
+   * from the count left of the stream, and set the readings of the sensors.
+   * The rank of a sample is its place in the scan.
+   */
+  static void adc_dma_read() {
+
+    if (!adc_dma_length) return;
+
+    if (__HAL_ADC_GET_FLAG(&adc_dma_adc, ADC_FLAG_OVR)) {
+      // A sample missed by the DMA puts the ranks out of step, start again
+      HAL::adc_decimator.overruns++;
+      HAL_ADC_Stop_DMA(&adc_dma_adc);
+      __HAL_ADC_CLEAR_FLAG(&adc_dma_adc, ADC_FLAG_OVR);
+      adc_dma_transfer();
+      return;
+    }
+
+    const uint16_t head = adc_dma_length - __HAL_DMA_GET_COUNTER(&adc_dma_dma);
+    uint16_t n = head >= adc_dma_tail ? head - adc_dma_tail : head + adc_dma_length - adc_dma_tail;
+    HAL::adc_decimator.samples += n;
+    uint8_t rank = adc_dma_tail % adc_dma_ranks;
+    while (n--) {
+      HAL::adc_decimator.put(rank, adc_dma_buffer[adc_dma_tail]);
+      if (++rank == adc_dma_ranks) rank = 0;
+      if (++adc_dma_tail == adc_dma_length) adc_dma_tail = 0;
+    }
+
+    #if HAS_HOTENDS
+      LOOP_HOTEND() HAL::adc_decimator.read(HAL::adc_dma_channel(hotends[h]->data.sensor.pin), hotends[h]->data.sensor.adc_raw);
+    #endif
+    #if HAS_BEDS
+      LOOP_BED() HAL::adc_decimator.read(HAL::adc_dma_channel(beds[h]->data.sensor.pin), beds[h]->data.sensor.adc_raw);
+    #endif
+    #if HAS_CHAMBERS
+      LOOP_CHAMBER() HAL::adc_decimator.read(HAL::adc_dma_channel(chambers[h]->data.sensor.pin), chambers[h]->data.sensor.adc_raw);
+    #endif
+    #if HAS_COOLERS
+      LOOP_COOLER() HAL::adc_decimator.read(HAL::adc_dma_channel(coolers[h]->data.sensor.pin), coolers[h]->data.sensor.adc_raw);
+    #endif
+
+    #if ENABLED(FILAMENT_WIDTH_SENSOR)
+      HAL::adc_decimator.read(HAL::adc_dma_channel(FILWIDTH_PIN), tempManager.current_raw_filwidth);
+    #endif
+
+    #if HAS_POWER_CONSUMPTION_SENSOR
+      HAL::adc_decimator.read(HAL::adc_dma_channel(POWER_CONSUMPTION_PIN), powerManager.current_raw_powconsumption);
+    #endif
+
+    #if HAS_MCU_TEMPERATURE
+      HAL::adc_decimator.read(HAL::adc_dma_channel(ATEMP), tempManager.mcu_current_temperature_raw);
+    #endif
+
+    #if HAS_VREF_MONITOR
+      uint16_t vref;
+      if (HAL::adc_decimator.read(HAL::adc_dma_channel(AVREF), vref) && vref)
+        HAL_VREF = 1210 * AD_RANGE / vref; // ADC sample to mV
+    #endif
+
+  }
+
+#endif // ENABLED(ADC_DMA)
+
 // Initialize ADC channels
 void HAL::analogStart() {
 
@@ -125,10 +325,19 @@ void HAL::analogStart() {
     SET_INPUT_ANALOG(POWER_CONSUMPTION_PIN);
   #endif
 
+  #if ENABLED(ADC_DMA)
+    adc_dma_start();
+  #endif
+
 }
 
 void HAL::AdcChangePin(const pin_t, const pin_t new_pin) {
   SET_INPUT_ANALOG(new_pin);
+  #if ENABLED(ADC_DMA)
+    // The scan is made again with the new pin in it
+    HAL_ADC_Stop_DMA(&adc_dma_adc);
+    adc_dma_start();
+  #endif
 }
 
 // Reset peripherals and cpu
@@ -176,7 +385,8 @@ void HAL::analogWrite(const pin_t pin, uint32_t ulValue, const uint16_t PWM_freq
  * It is used to update pwm values for heater and some other frequent jobs.
  *
  *  - Manage PWM to all the heaters and fan
- *  - Prepare or Measure one of the raw ADC sensor values
+ *  - Flag spin() and the periodical actions for the deferred half, Printer::tick_task()
+ *  - Prepare or Measure one of the raw ADC sensor values, with ADC_DMA add up the DMA samples
  *  - Step the babysteps value for each axis towards 0
  *  - For PINS_DEBUGGING, monitor and report endstop pins
  *  - For ENDSTOP_INTERRUPTS_FEATURE check endstops if flagged
@@ -194,67 +404,77 @@ void HAL::Tick() {
   // Fans set output PWM
   fanManager.set_output_pwm();
 
-  // Event every 100 ms
-  if (cycle_100_timer.expired(100)) tempManager.spin();
-
-  // Event every second
-  if (cycle_1s_timer.expired(SECOND_TO_MILLIS(1))) printer.check_periodical_actions();
-
-  #if HAS_HOTENDS
-    LOOP_HOTEND() {
-      ADCAveragingFilter& currentFilter = const_cast<ADCAveragingFilter&>(HOTENDsensorFilters[h]);
-      currentFilter.process_reading(analogRead(hotends[h]->data.sensor.pin));
-      if (currentFilter.IsValid())
-        hotends[h]->data.sensor.adc_raw = currentFilter.GetSum();
-    }
-  #endif
-  #if HAS_BEDS
-    LOOP_BED() {
-      ADCAveragingFilter& currentFilter = const_cast<ADCAveragingFilter&>(BEDsensorFilters[h]);
-      currentFilter.process_reading(analogRead(beds[h]->data.sensor.pin));
-      if (currentFilter.IsValid())
-        beds[h]->data.sensor.adc_raw = currentFilter.GetSum();
-    }
-  #endif
-  #if HAS_CHAMBERS
-    LOOP_CHAMBER() {
-      ADCAveragingFilter& currentFilter = const_cast<ADCAveragingFilter&>(CHAMBERsensorFilters[h]);
-      currentFilter.process_reading(analogRead(chambers[h]->data.sensor.pin));
-      if (currentFilter.IsValid())
-        chambers[h]->data.sensor.adc_raw = currentFilter.GetSum();
-    }
-  #endif
-  #if HAS_COOLERS
-    LOOP_COOLER() {
-      ADCAveragingFilter& currentFilter = const_cast<ADCAveragingFilter&>(COOLERsensorFilters[h]);
-      currentFilter.process_reading(analogRead(coolers[h]->data.sensor.pin));
-      if (currentFilter.IsValid())
-        coolers[h]->data.sensor.adc_raw = currentFilter.GetSum();
-    }
-  #endif
-
-  #if ENABLED(FILAMENT_WIDTH_SENSOR)
-    const_cast<ADCAveragingFilter&>(filamentFilter).process_reading(analogRead(FILWIDTH_PIN));
-    if (filamentFilter.IsValid())
-      tempManager.current_raw_filwidth = filamentFilter.GetSum();
+  #if ENABLED(SOFT_PWM_PORT_WRITE)
+    // Soft PWM levels of heaters and fans, one write for each port
+    softpwm.flush();
   #endif
 
-  #if HAS_POWER_CONSUMPTION_SENSOR
-    const_cast<ADCAveragingFilter&>(powerFilter).process_reading(analogRead(POWER_CONSUMPTION_PIN));
-    if (powerFilter.IsValid())
-      powerManager.current_raw_powconsumption = powerFilter.GetSum();
-  #endif
-
-  #if HAS_MCU_TEMPERATURE
-    const_cast<ADCAveragingFilter&>(mcuFilter).process_reading(analogRead(ATEMP));
-    if (mcuFilter.IsValid())
-      tempManager.mcu_current_temperature_raw = mcuFilter.GetSum();
-  #endif
+  // Events every 100 ms and every second, run by the deferred half
+  printer.tick_events(cycle_100_timer.expired(100), cycle_1s_timer.expired(SECOND_TO_MILLIS(1)));
+
+  #if ENABLED(ADC_DMA)
+
+    adc_dma_read();
+
+  #else
+
+    #if HAS_HOTENDS
+      LOOP_HOTEND() {
+        ADCAveragingFilter& currentFilter = const_cast<ADCAveragingFilter&>(HOTENDsensorFilters[h]);
+        currentFilter.process_reading(analogRead(hotends[h]->data.sensor.pin));
+        if (currentFilter.IsValid())
+          hotends[h]->data.sensor.adc_raw = currentFilter.GetSum();
+      }
+    #endif
+    #if HAS_BEDS
+      LOOP_BED() {
+        ADCAveragingFilter& currentFilter = const_cast<ADCAveragingFilter&>(BEDsensorFilters[h]);
+        currentFilter.process_reading(analogRead(beds[h]->data.sensor.pin));
+        if (currentFilter.IsValid())
+          beds[h]->data.sensor.adc_raw = currentFilter.GetSum();
+      }
+    #endif
+    #if HAS_CHAMBERS
+      LOOP_CHAMBER() {
+        ADCAveragingFilter& currentFilter = const_cast<ADCAveragingFilter&>(CHAMBERsensorFilters[h]);
+        currentFilter.process_reading(analogRead(chambers[h]->data.sensor.pin));
+        if (currentFilter.IsValid())
+          chambers[h]->data.sensor.adc_raw = currentFilter.GetSum();
+      }
+    #endif
+    #if HAS_COOLERS
+      LOOP_COOLER() {
+        ADCAveragingFilter& currentFilter = const_cast<ADCAveragingFilter&>(COOLERsensorFilters[h]);
+        currentFilter.process_reading(analogRead(coolers[h]->data.sensor.pin));
+        if (currentFilter.IsValid())
+          coolers[h]->data.sensor.adc_raw = currentFilter.GetSum();
+      }
+    #endif
+
+    #if ENABLED(FILAMENT_WIDTH_SENSOR)
+      const_cast<ADCAveragingFilter&>(filamentFilter).process_reading(analogRead(FILWIDTH_PIN));
+      if (filamentFilter.IsValid())
+        tempManager.current_raw_filwidth = filamentFilter.GetSum();
+    #endif
+
+    #if HAS_POWER_CONSUMPTION_SENSOR
+      const_cast<ADCAveragingFilter&>(powerFilter).process_reading(analogRead(POWER_CONSUMPTION_PIN));
+      if (powerFilter.IsValid())
+        powerManager.current_raw_powconsumption = powerFilter.GetSum();
+    #endif
+
+    #if HAS_MCU_TEMPERATURE
+      const_cast<ADCAveragingFilter&>(mcuFilter).process_reading(analogRead(ATEMP));
+      if (mcuFilter.IsValid())
+        tempManager.mcu_current_temperature_raw = mcuFilter.GetSum();
+    #endif
+
+    #if HAS_VREF_MONITOR
+      const_cast<ADCAveragingFilter&>(vrefFilter).process_reading(analogRead(AVREF));
+      if (mcuFilter.IsValid())
+        HAL_VREF = 1210 * AD_RANGE / vrefFilter.GetSum(); // ADC sample to mV
+    #endif
 
-  #if HAS_VREF_MONITOR
-    const_cast<ADCAveragingFilter&>(vrefFilter).process_reading(analogRead(AVREF));
-    if (mcuFilter.IsValid())
-      HAL_VREF = 1210 * AD_RANGE / vrefFilter.GetSum(); // ADC sample to mV
   #endif
 
   // Tick endstops state, if required
@@ -264,13 +484,21 @@ void HAL::Tick() {
 
 #if HAS_VREF_MONITOR
   int32_t HAL::analog2mv(const int16_t adc_raw) {
-    return (__LL_ADC_CALC_DATA_TO_VOLTAGE(HAL_VREF, adc_raw, LL_ADC_RESOLUTION_12B));
+    #if ENABLED(ADC_DMA)
+      return (__LL_ADC_CALC_DATA_TO_VOLTAGE(HAL_VREF, adc_raw >> ADC_OVERSAMPLE_BITS, LL_ADC_RESOLUTION_12B));
+    #else
+      return (__LL_ADC_CALC_DATA_TO_VOLTAGE(HAL_VREF, adc_raw, LL_ADC_RESOLUTION_12B));
+    #endif
   }
 #endif
 
 #if HAS_MCU_TEMPERATURE
   int32_t HAL::analog2tempMCU(const int16_t adc_raw) {
-    return (__LL_ADC_CALC_TEMPERATURE(HAL_VREF, adc_raw, LL_ADC_RESOLUTION_12B));
+    #if ENABLED(ADC_DMA)
+      return (__LL_ADC_CALC_TEMPERATURE(HAL_VREF, adc_raw >> ADC_OVERSAMPLE_BITS, LL_ADC_RESOLUTION_12B));
+    #else
+      return (__LL_ADC_CALC_TEMPERATURE(HAL_VREF, adc_raw, LL_ADC_RESOLUTION_12B));
+    #endif
   }
 #endif
 
@@ -289,7 +517,18 @@ pin_t HAL::analog_value_pin() {
  */
 
 // This intercepts the 1ms system tick.
-extern "C" void HAL_SYSTICK_Callback(void) { HAL::Tick(); }
+extern "C" void HAL_SYSTICK_Callback(void) {
+  #if ENABLED(STEPPER_ISR_PROFILER)
+    const isr_free_t start = isrprofiler.start_free();
+  #endif
+  HAL::Tick();
+  #if ENABLED(STEPPER_ISR_PROFILER)
+    isrprofiler.stop_free(ISR_PHASE_TICK, start);
+  #endif
+}
+
+// Deferred half of the system tick, at the lowest priority so that every other interrupt comes first
+extern "C" void PendSV_Handler() { printer.tick_task(); }
 
 void Step_Handler() { stepper.Step(); }
 
@@ -41,6 +41,9 @@ typedef uint32_t  ptr_int_t;
 #include "math.h"
 #include "delay.h"
 #include "HAL_timers.h"
+#if ENABLED(ADC_DMA)
+  #include "../../lib/adc_decimator.h"
+#endif
 
 // --------------------------------------------------------------------------
 // Defines
@@ -133,7 +136,13 @@ typedef uint32_t  ptr_int_t;
 
 // Bits of the ADC converter
 #define ANALOG_INPUT_BITS   12
-#define AD_RANGE            _BV(ANALOG_INPUT_BITS)
+#if ENABLED(ADC_DMA)
+  #define AD_RANGE          _BV(ANALOG_INPUT_BITS + ADC_OVERSAMPLE_BITS)
+  #define ADC_DMA_CHANNELS  16    // Ranks of the ADC1 scan
+  #define ADC_DMA_SCANS     32    // Scans in the circular DMA buffer
+#else
+  #define AD_RANGE          _BV(ANALOG_INPUT_BITS)
+#endif
 #define ABS_ZERO          -273.15f
 #define NUM_ADC_SAMPLES     32
 #define AD595_MAX          330.0f
@@ -162,6 +171,9 @@ extern "C" {
 #pragma GCC diagnostic pop
 
 typedef AveragingFilter<NUM_ADC_SAMPLES> ADCAveragingFilter;
+#if ENABLED(ADC_DMA)
+  typedef ADC_Decimator<ADC_DMA_CHANNELS, ADC_DMA_SAMPLES, ADC_OVERSAMPLE_BITS> ADCDecimator;
+#endif
 
 class HAL {
 
@@ -171,35 +183,45 @@ class HAL {
 
     virtual ~HAL() {}
 
-  private: /** Private Parameters */
+  public: /** Public Parameters */
 
-    #if HAS_HOTENDS
-      static ADCAveragingFilter HOTENDsensorFilters[MAX_HOTEND];
-    #endif
-    #if HAS_BEDS
-      static ADCAveragingFilter BEDsensorFilters[MAX_BED];
-    #endif
-    #if HAS_CHAMBERS
-      static ADCAveragingFilter CHAMBERsensorFilters[MAX_CHAMBER];
-    #endif
-    #if HAS_COOLERS
-      static ADCAveragingFilter COOLERsensorFilters[MAX_COOLER];
+    #if ENABLED(ADC_DMA)
+      static ADCDecimator adc_decimator;
     #endif
 
-    #if ENABLED(FILAMENT_WIDTH_SENSOR)
-      static ADCAveragingFilter filamentFilter;
-    #endif
-
-    #if HAS_POWER_CONSUMPTION_SENSOR
-      static ADCAveragingFilter powerFilter;
-    #endif
+  private: /** Private Parameters */
 
-    #if HAS_MCU_TEMPERATURE
-      static ADCAveragingFilter mcuFilter;
-    #endif
+    #if DISABLED(ADC_DMA)
+
+      #if HAS_HOTENDS
+        static ADCAveragingFilter HOTENDsensorFilters[MAX_HOTEND];
+      #endif
+      #if HAS_BEDS
+        static ADCAveragingFilter BEDsensorFilters[MAX_BED];
+      #endif
+      #if HAS_CHAMBERS
+        static ADCAveragingFilter CHAMBERsensorFilters[MAX_CHAMBER];
+      #endif
+      #if HAS_COOLERS
+        static ADCAveragingFilter COOLERsensorFilters[MAX_COOLER];
+      #endif
+
+      #if ENABLED(FILAMENT_WIDTH_SENSOR)
+        static ADCAveragingFilter filamentFilter;
+      #endif
+
+      #if HAS_POWER_CONSUMPTION_SENSOR
+        static ADCAveragingFilter powerFilter;
+      #endif
+
+      #if HAS_MCU_TEMPERATURE
+        static ADCAveragingFilter mcuFilter;
+      #endif
+
+      #if HAS_VREF_MONITOR
+        static ADCAveragingFilter vrefFilter;
+      #endif
 
-    #if HAS_VREF_MONITOR
-      static ADCAveragingFilter vrefFilter;
     #endif
 
   public: /** Public Function */
@@ -207,6 +229,10 @@ class HAL {
     static void analogStart();
     static void AdcChangePin(const pin_t, const pin_t new_pin);
 
+    #if ENABLED(ADC_DMA)
+      static uint8_t adc_dma_channel(const pin_t pin);
+    #endif
+
     static void hwSetup(void);
 
     static void analogWrite(const pin_t pin, uint32_t ulValue, const uint16_t PWM_freq=1000U);
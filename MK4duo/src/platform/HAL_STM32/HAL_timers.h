@@ -30,7 +30,8 @@
 #define HAL_TIMER_RATE              ((F_CPU)/2)
 #define NUM_HARDWARE_TIMERS         1                                           // Only Stepper use Hardware Timer
 #define NvicPriorityStepper         2
-#define NvicPrioritySystick         15
+#define NvicPrioritySystick         14
+#define NvicPriorityPendSV          15
 
 // Stepper Timer
 #define STEPPER_TIMER_NUM           0                                           // Index of timer to use for stepper
@@ -59,9 +60,11 @@
   #define ISR_LA_BASE_CYCLES         0UL
 #endif
 
-// Bezier interpolation adds 40 cycles
+// Bezier interpolation adds 40 cycles, S-curve interpolation 20 cycles
 #if ENABLED(BEZIER_JERK_CONTROL)
   #define ISR_BEZIER_CYCLES         40UL
+#elif ENABLED(S_CURVE_JERK_CONTROL)
+  #define ISR_BEZIER_CYCLES         20UL
 #else
   #define ISR_BEZIER_CYCLES          0UL
 #endif
@@ -167,3 +170,19 @@ FORCE_INLINE void HAL_timer_set_count(const uint8_t, const uint32_t count) {
       MK_step_timer->refresh(); // Generate an immediate update interrupt
   }
 }
+
+// Cycle counter used by the stepper ISR profiler (DWT on Cortex-M3/M4)
+typedef uint32_t hal_cycle_t;
+#define HAL_CYCLE_COUNTER_MULT      1UL
+#define HAL_CYCLE_COUNTER_RATE      (F_CPU)
+
+FORCE_INLINE void HAL_cycle_counter_init() {
+  CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+  DWT->CYCCNT = 0;
+  DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+}
+
+FORCE_INLINE hal_cycle_t HAL_cycle_counter_get() { return DWT->CYCCNT; }
+
+// Deferred half of HAL::Tick, PendSV runs it when no other interrupt is pending
+FORCE_INLINE void HAL_tick_task_request() { SCB->ICSR = SCB_ICSR_PENDSVSET_Msk; }
@@ -179,3 +179,26 @@ FORCE_INLINE static void OUT_WRITE(const pin_t pin, const uint8_t flag) {
 FORCE_INLINE static bool USEABLE_HARDWARE_PWM(const pin_t pin) {
   return digitalPinHasPWM(pin);
 }
+
+/**
+ * Port writes for the soft PWM outputs
+ * The port and mask of a pin are made once, then all the pins of a port
+ * are set and reset with one write of BSRR.
+ */
+#define FASTIO_PORTS  MAX_NB_PORT
+typedef uint16_t fastio_mask_t;
+
+// Port of a pin, FASTIO_PORTS for a pin not on a port
+FORCE_INLINE static uint8_t FASTIO_PORT(const pin_t pin) {
+  #if ENABLED(PCF8574_EXPANSION_IO)
+    if (pin >= PIN_START_FOR_PCF8574) return FASTIO_PORTS;
+  #endif
+  if (pin < 0 || GPIO2PORT(pin) >= MAX_NB_PORT) return FASTIO_PORTS;
+  return GPIO2PORT(pin);
+}
+FORCE_INLINE static fastio_mask_t FASTIO_PORT_MASK(const pin_t pin) {
+  return GPIO2BIT(pin);
+}
+FORCE_INLINE static void FASTIO_PORT_WRITE(const uint8_t port, const fastio_mask_t set, const fastio_mask_t clear) {
+  GPIOPort[port]->BSRR = set | ((uint32_t)clear << 16);
+}
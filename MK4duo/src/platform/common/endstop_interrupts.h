@@ -32,6 +32,8 @@ void endstop_ISR() { endstops.update(); }
   #include "../HAL_DUE/endstop_interrupts.h"
 #elif ENABLED(ARDUINO_ARCH_STM32)
   #include "../HAL_STM32/endstop_interrupts.h"
+#elif ENABLED(ARDUINO_ARCH_NATIVE)
+  #include "../HAL_NATIVE/endstop_interrupts.h"
 #else
   #error "Unsupported Platform!"
 #endif
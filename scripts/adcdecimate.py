@@ -0,0 +1,268 @@
+#!/usr/bin/python3
+
+# Host model of the MK4duo ADC decimation (ADC_DMA, src/lib/adc_decimator.h)
+#
+# Builds a small host program with the host g++ around src/lib/adc_decimator.h
+# and the AveragingFilter of HAL_DUE/math.h, then feeds both the samples of a
+# thermistor input with gaussian noise, as the two ways of the DUE read it:
+#
+#   filter   a sample each Tick (1 ms), the mean of the last 32 read each Tick
+#   dma      the scan at --rate samples a second for the channel, each
+#            --samples of them a reading of --bits bits more, read each Tick
+#
+#   adcdecimate.py [--rate 20000] [--samples 64] [--bits 2] [--noise 1.0]
+#                  [--seconds 2] [--seed 1]
+#
+# For the static figures the input is held at 64 points across one LSB of
+# 12 bits, the readings from 0.2 s on compared with it: the error is mean
+# (bias) and rms in 12 bit LSB, the noise of the readings alone as well.
+# For the step the input goes from 1000 to 2000 LSB, the latency is the time
+# to the first reading over 1900. CPU times are host ns a sample.
+#
+# Before that the readings, sigma and peak of the decimator are checked
+# against a reference in Python on random samples of three channels.
+# Exit code is 0 when they are the same.
+
+import argparse
+import math
+import os
+import random
+import subprocess
+import sys
+import tempfile
+
+HERE = os.path.dirname(os.path.abspath(__file__))
+LIB = os.path.join(HERE, '..', 'MK4duo', 'src', 'lib')
+
+HARNESS = r'''
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "adc_decimator.h"
+
+// AveragingFilter of HAL_DUE/math.h
+template<size_t numAveraged>
+class AveragingFilter {
+  public:
+    uint16_t  sample[numAveraged];
+    size_t    index;
+    uint32_t  sum;
+    bool      valid;
+    void init(uint16_t val) {
+      sum = (uint32_t)val * (uint32_t)numAveraged;
+      index = 0;
+      valid = false;
+      for (size_t i = 0; i < numAveraged; ++i) sample[i] = val;
+    }
+    __attribute__((noinline)) void process_reading(const uint16_t read_adc) {
+      sum += read_adc - sample[index];
+      sample[index] = read_adc;
+      if (++index == numAveraged) { index = 0; valid = true; }
+    }
+    uint32_t GetSum() const { return sum / numAveraged; }
+    bool IsValid() const { return valid; }
+};
+
+typedef ADC_Decimator<3, DMA_SAMPLES, OVERSAMPLE_BITS> Decimator;
+
+static AveragingFilter<32> filter;
+static Decimator decimator;
+static volatile uint32_t sink;
+
+static uint32_t rng_state;
+static double uniform() { rng_state = rng_state * 1664525 + 1013904223; return (rng_state + 0.5) / 4294967296.0; }
+static double gauss() { return sqrt(-2.0 * log(uniform())) * cos(2.0 * M_PI * uniform()); }
+
+static uint16_t adc(const double x, const double noise) {
+  const long v = lround(x + noise * gauss());
+  return v < 0 ? 0 : v > 4095 ? 4095 : v;
+}
+
+__attribute__((noinline)) static void put(const uint16_t s) { decimator.put(1, s); }
+
+// Both ways from time 0, read each Tick; the input x0, x1 from step_at, in LSB
+struct Run {
+  double sum[2], squares[2], err[2], err2[2];
+  long   n[2];
+  double latency[2];
+};
+
+static void run(const double rate, const double noise, const double seconds, const double x0, const double x1,
+                const double step_at, Run &r) {
+  filter.init(0);
+  decimator.reset();
+  for (int m = 0; m < 2; m++) r.sum[m] = r.squares[m] = r.err[m] = r.err2[m] = 0, r.n[m] = 0, r.latency[m] = -1;
+  const long ticks = lround(seconds * 1000);
+  double t = 0;
+  const double dt = 1.0 / rate;
+  for (long k = 1; k <= ticks; k++) {
+    const double tick = k * 0.001;
+    // The scan up to this Tick
+    for (; t < tick; t += dt) decimator.put(1, adc(t < step_at ? x0 : x1, noise));
+    // The Tick
+    filter.process_reading(adc(tick < step_at ? x0 : x1, noise));
+    double got[2] = { -1, -1 };
+    if (filter.IsValid()) got[0] = filter.GetSum();
+    uint16_t v;
+    if (decimator.read(1, v)) got[1] = v / double(1 << OVERSAMPLE_BITS);
+    const double x = tick < step_at ? x0 : x1;
+    for (int m = 0; m < 2; m++) {
+      if (got[m] < 0) continue;
+      if (tick >= step_at && r.latency[m] < 0 && got[m] >= x0 + 0.9 * (x1 - x0)) r.latency[m] = tick - step_at;
+      if (tick < 0.2 || tick >= step_at) continue;
+      r.sum[m] += got[m]; r.squares[m] += got[m] * got[m];
+      r.err[m] += got[m] - x; r.err2[m] += (got[m] - x) * (got[m] - x);
+      r.n[m]++;
+    }
+  }
+}
+
+static double now() {
+  timespec t;
+  clock_gettime(CLOCK_MONOTONIC, &t);
+  return t.tv_sec + t.tv_nsec * 1e-9;
+}
+
+int main(int argc, char **argv) {
+  // check: samples "ch value" on stdin, each reading out as "ch value sigma peak"
+  if (argc == 2) {
+    unsigned ch, s;
+    uint32_t seen[3] = { 0, 0, 0 };
+    while (scanf("%u %u", &ch, &s) == 2) {
+      decimator.put(ch, s);
+      if (decimator.readings(ch) != seen[ch]) {
+        seen[ch] = decimator.readings(ch);
+        uint16_t v = 0;
+        decimator.read(ch, v);
+        printf("%u %u %.3f %u\n", ch, v, decimator.sigma(ch), decimator.peak(ch));
+      }
+    }
+    return 0;
+  }
+
+  const double rate = atof(argv[1]), noise = atof(argv[2]), seconds = atof(argv[3]);
+  rng_state = atoi(argv[4]);
+
+  // Static: 64 points across one LSB
+  double err[2] = { 0, 0 }, err2[2] = { 0, 0 }, var[2] = { 0, 0 };
+  long n[2] = { 0, 0 };
+  for (int p = 0; p < 64; p++) {
+    Run r;
+    const double x = 2000 + p / 64.0;
+    run(rate, noise, seconds, x, x, 1e9, r);
+    for (int m = 0; m < 2; m++) {
+      err[m] += r.err[m]; err2[m] += r.err2[m]; n[m] += r.n[m];
+      const double mean = r.sum[m] / r.n[m];
+      var[m] += r.squares[m] - r.n[m] * mean * mean;
+    }
+  }
+
+  // Step
+  Run r;
+  run(rate, noise, 1.0, 1000, 2000, 0.5, r);
+
+  // CPU a sample
+  double best[2] = { 1e9, 1e9 };
+  for (int k = 0; k < 20; k++) {
+    double t0 = now();
+    for (uint32_t i = 0; i < 1000000; i++) filter.process_reading(i & 0xFFF);
+    double e = now() - t0;
+    if (e < best[0]) best[0] = e;
+    t0 = now();
+    for (uint32_t i = 0; i < 1000000; i++) put(i & 0xFFF);
+    e = now() - t0;
+    if (e < best[1]) best[1] = e;
+    sink = filter.GetSum();
+  }
+
+  for (int m = 0; m < 2; m++)
+    printf("%.5f %.5f %.5f %.2f %.3f\n", err[m] / n[m], sqrt(err2[m] / n[m]), sqrt(var[m] / n[m]),
+           r.latency[m] * 1000, best[m] * 1000);
+  return 0;
+}
+'''
+
+
+def reference(stream, samples, bits):
+    # ADC_Decimator::put() and the M1006 figures, in Python
+    shift = int(math.log2(samples)) - bits
+    windows = {}
+    out = []
+    for ch, s in stream:
+        w = windows.setdefault(ch, [])
+        w.append(s)
+        if len(w) == samples:
+            total = sum(w)
+            value = (total + ((1 << shift) >> 1)) >> shift if shift else total
+            var = sum(x * x for x in w) * samples - total * total
+            out.append((ch, value, math.sqrt(var) / samples, max(w) - min(w)))
+            windows[ch] = []
+    return out
+
+
+def check(exe, args):
+    rng = random.Random(args.seed)
+    stream = []
+    for _ in range(args.samples * 200):
+        ch = rng.randrange(3)
+        base = (500, 2047, 4000)[ch]
+        stream.append((ch, max(0, min(4095, int(rng.gauss(base, (1, 10, 200)[ch]))))))
+    stream += [(0, 0)] * args.samples + [(2, 4095)] * args.samples
+    run = subprocess.run([exe, 'check'], input=''.join('%d %d\n' % s for s in stream), check=True,
+                         stdout=subprocess.PIPE, universal_newlines=True)
+    got = [l.split() for l in run.stdout.splitlines()]
+    got = [(int(c), int(v), float(s), int(p)) for c, v, s, p in got]
+    ref = reference(stream, args.samples, args.bits)
+    bad = len(got) != len(ref)
+    for g, r in zip(got, ref):
+        if g[0] != r[0] or g[1] != r[1] or g[3] != r[3] or abs(g[2] - r[2]) > 1e-3 * max(1.0, r[2]):
+            bad = True
+    print('Decimator check: %d samples, %d readings, %s' % (len(stream), len(ref), 'the same' if not bad else
+                                                            'DIFFERENT'))
+    return not bad
+
+
+def degc_per_lsb():
+    # EPCOS 100K, 4.7k pullup, at 200 degC: degC of one LSB of 12 bits
+    def raw(t):
+        r = 100000.0 * math.exp(4092.0 * (1.0 / (t + 273.15) - 1.0 / 298.15))
+        return 4096.0 * r / (r + 4700.0)
+    return 1.0 / abs(raw(200.5) - raw(199.5))
+
+
+def main():
+    parser = argparse.ArgumentParser(description='MK4duo ADC decimation model')
+    parser.add_argument('--rate', type=float, default=20000, help='samples a second of the channel in the scan')
+    parser.add_argument('--samples', type=int, default=64, help='ADC_DMA_SAMPLES')
+    parser.add_argument('--bits', type=int, default=2, help='ADC_OVERSAMPLE_BITS')
+    parser.add_argument('--noise', type=float, default=1.0, help='rms noise of the input in LSB')
+    parser.add_argument('--seconds', type=float, default=2.0, help='time held at each static point')
+    parser.add_argument('--seed', type=int, default=1)
+    args = parser.parse_args()
+
+    with tempfile.TemporaryDirectory() as tmp:
+        src = os.path.join(tmp, 'adc_harness.cpp')
+        exe = os.path.join(tmp, 'adc_harness')
+        with open(src, 'w') as f:
+            f.write(HARNESS)
+        subprocess.run(['g++', '-O2', '-std=gnu++11', '-DDMA_SAMPLES=%d' % args.samples,
+                        '-DOVERSAMPLE_BITS=%d' % args.bits,
+                        '-I', LIB, '-o', exe, src], check=True)
+        ok = check(exe, args)
+        out = subprocess.run([exe, str(args.rate), str(args.noise), str(args.seconds), str(args.seed)], check=True,
+                             stdout=subprocess.PIPE, universal_newlines=True).stdout.splitlines()
+
+    print('Input noise %.2f LSB, scan %.0f samples/s, %d samples a reading of %d bits, one 12 bit LSB %.2f degC' % (
+        args.noise, args.rate, args.samples, 12 + args.bits, degc_per_lsb()))
+    print('%-7s %10s %10s %10s %10s %10s %10s' % ('way', 'readings/s', 'bias', 'rms error', 'noise', 'latency',
+                                                 'ns/sample'))
+    for name, line, rate in (('filter', out[0], 1000.0), ('dma', out[1], args.rate / args.samples)):
+        bias, rms, noise, latency, ns = (float(x) for x in line.split())
+        print('%-7s %10.0f %7.3fLSB %7.3fLSB %7.3fLSB %8.1fms %10.2f' % (name, rate, bias, rms, noise, latency, ns))
+    return 0 if ok else 1
+
+
+if __name__ == '__main__':
+    sys.exit(main())
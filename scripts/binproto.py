@@ -0,0 +1,351 @@
+#!/usr/bin/python3
+
+# Binary command frames for MK4duo (BINARY_PROTOCOL, M1004)
+#
+# After "M1004 S1" the firmware reads frames in place of text lines:
+#
+#   0xA5 | seq | type | len | payload | crc16 low | crc16 high
+#
+# See src/feature/binary_protocol/binary_protocol.h for the frame types.
+# Frames are acknowledged with "ack:<seq>" in windows, there is no "ok" for
+# each line, and a bad frame is answered with "rs:<seq>".
+#
+#   binproto.py encode print.gcode --out print.bin [--exact]
+#   binproto.py send   print.gcode --port /dev/ttyACM0 [--baud 250000]
+#   binproto.py bench  [--bin mk4duo_native] [--corpus print.gcode] [--baud 250000]
+#                      [--rtt-ms 1] [--window 96] [--corrupt 50]
+#
+# encode writes the whole stream, "M1004 S1" then one frame for each line and
+# the end frame, the native executable takes it as its serial input.
+# send streams a G-code file to a printer with a window of frames not yet
+# acknowledged, sends again from the frame asked by "rs:" or from the oldest
+# one after a timeout (needs pyserial).
+# bench reports the bytes of each move and the moves per second the link
+# allows, text lines with line number and checksum sent one "ok" at a time
+# against frames in a window. With --bin both run through the native
+# executable and the step traces must be the same. --corrupt N also breaks
+# every Nth frame in a copy of the stream, followed by what a host sends
+# again after "rs:", and checks the firmware asked for it and stepped the
+# same.
+#
+# Values are sent in 1/10000 units. encode rounds values with more decimals,
+# with --exact such a line is sent as a text frame.
+
+import argparse
+import os
+import random
+import re
+import struct
+import subprocess
+import sys
+import tempfile
+import time
+
+from steptrace import compare
+
+SYNC = 0xA5
+BP_MOVE, BP_COMMAND, BP_TEXT, BP_END = 1, 2, 3, 4
+NO_VALUE = -0x80000000
+SCALE = 10000
+MOVE_LETTERS = 'XYZEFIJR'
+MAX_PAYLOAD = 96        # MAX_CMD_SIZE
+WINDOW = 96             # BINARY_PROTOCOL_WINDOW
+
+WORD = re.compile(r'([A-Za-z])([-+]?(?:\d+\.?\d*|\.\d+))?')
+
+
+def crc16(data, crc=0):
+    # CRC16 CCITT (0x1021), same as crc16() in core/utility/utility.cpp
+    for b in data:
+        crc ^= b << 8
+        for _ in range(8):
+            crc = ((crc << 1) ^ 0x1021) if crc & 0x8000 else (crc << 1)
+            crc &= 0xFFFF
+    return crc
+
+
+def frame(seq, kind, payload):
+    body = bytes([seq & 0xFF, kind, len(payload)]) + payload
+    return bytes([SYNC]) + body + struct.pack('<H', crc16(body))
+
+
+def clean(line):
+    # Line as the firmware takes it: no comment, line number or checksum
+    line = line.split(';', 1)[0].strip()
+    if '*' in line:
+        line = line[:line.rindex('*')].strip()
+    if line[:1] in 'Nn' and len(line) > 1:
+        line = re.sub(r'^[Nn]\d+\s*', '', line)
+    return line
+
+
+def fixed(text, exact):
+    if text is None:
+        return NO_VALUE
+    value = round(float(text) * SCALE)
+    if exact and abs(float(text) * SCALE - value) > 1e-6:
+        return None
+    if not -0x7FFFFFFF <= value <= 0x7FFFFFFF:
+        return None
+    return value
+
+
+def payload_of(line, exact=False):
+    # (type, payload) for a clean G-code line
+    words = []
+    pos = 0
+    text = line.replace(' ', '')
+    while pos < len(text):
+        m = WORD.match(text, pos)
+        if not m or m.end() == pos:
+            break
+        words.append((m.group(1), m.group(2)))
+        pos = m.end()
+    if pos == len(text) and words and words[0][0] in 'GMT' and words[0][1] and words[0][1].isdigit():
+        letter, code = words[0][0], int(words[0][1])
+        params = words[1:]
+        names = [p[0] for p in params]
+        values = [fixed(v, exact) for _, v in params]
+        if len(set(names)) == len(names) and None not in values and all(n.isupper() for n in names):
+            if letter == 'G' and code <= 3 and all(n in MOVE_LETTERS and params[i][1] for i, n in enumerate(names)):
+                order = sorted(range(len(names)), key=lambda i: MOVE_LETTERS.index(names[i]))
+                mask = sum(1 << MOVE_LETTERS.index(n) for n in names)
+                return BP_MOVE, bytes([code, mask]) + b''.join(struct.pack('<i', values[i]) for i in order)
+            if code <= 0xFFFF:
+                order = sorted(range(len(names)), key=lambda i: names[i])
+                mask = sum(1 << (ord(n) - ord('A')) for n in names)
+                payload = bytes([ord(letter)]) + struct.pack('<HI', code, mask) + \
+                    b''.join(struct.pack('<i', values[i]) for i in order)
+                if len(payload) <= MAX_PAYLOAD:
+                    return BP_COMMAND, payload
+    data = line.encode()
+    if len(data) >= MAX_PAYLOAD:
+        raise ValueError('line too long: ' + line)
+    return BP_TEXT, data
+
+
+def frames_of(lines, exact=False):
+    # Frames of the G-code lines, the end frame last
+    out = []
+    for line in lines:
+        line = clean(line)
+        if line:
+            kind, payload = payload_of(line, exact)
+            out.append(frame(len(out), kind, payload))
+    out.append(frame(len(out), BP_END, b''))
+    return out
+
+
+def text_lines(lines):
+    # The same lines as a host sends them in text, with line number and checksum,
+    # from N1 as after a reset (a M110 would run after the lines read with it)
+    out = []
+    n = 0
+    for line in lines:
+        line = clean(line)
+        if line:
+            n += 1
+            body = ('N%d %s' % (n, line)).encode()
+            checksum = 0
+            for b in body:
+                checksum ^= b
+            out.append(body + b'*%d\n' % checksum)
+    return out
+
+
+def cmd_encode(args):
+    with open(args.gcode, errors='replace') as f:
+        frames = frames_of(f.read().splitlines(), args.exact)
+    with open(args.out, 'wb') as f:
+        f.write(b'M1004 S1\n' + b''.join(frames))
+    kinds = [fr[2] for fr in frames]
+    print('%d frames, %d moves, %d commands, %d text, %d bytes' % (
+        len(frames), kinds.count(BP_MOVE), kinds.count(BP_COMMAND), kinds.count(BP_TEXT),
+        sum(len(fr) for fr in frames)))
+    return 0
+
+
+def open_port(port, baud):
+    import serial
+    ser = serial.Serial(port, baud, timeout=0.05)
+    time.sleep(2)
+    ser.reset_input_buffer()
+    return ser
+
+
+def send_frames(ser, frames, window, timeout=2.0):
+    # Go back N: frames not yet acknowledged are kept to be sent again
+    base = nxt = 0
+    inflight = 0
+    last = time.time()
+    buffer = b''
+    while base < len(frames):
+        while nxt < len(frames) and inflight + len(frames[nxt]) <= window:
+            ser.write(frames[nxt])
+            inflight += len(frames[nxt])
+            nxt += 1
+        buffer += ser.read(64)
+        while b'\n' in buffer:
+            line, buffer = buffer.split(b'\n', 1)
+            m = re.match(rb'(ack|rs):(\d+)', line)
+            if not m:
+                if line.startswith(b'Error') or line.startswith(b'echo:Unknown'):
+                    sys.stderr.write(line.decode(errors='replace') + '\n')
+                continue
+            # Back to the frame index from the 8 bit sequence
+            seq = int(m.group(2))
+            if m.group(1) == b'ack':
+                done = base + ((seq - base + 1) & 0xFF)
+                if base < done <= nxt:
+                    inflight -= sum(len(fr) for fr in frames[base:done])
+                    base = done
+                    last = time.time()
+            else:
+                resend = base + ((seq - base) & 0xFF)
+                if base <= resend <= nxt:
+                    base = nxt = resend
+                    inflight = 0
+                    last = time.time()
+        if base < nxt and time.time() - last > timeout:
+            nxt = base
+            inflight = 0
+            last = time.time()
+
+
+def cmd_send(args):
+    with open(args.gcode, errors='replace') as f:
+        frames = frames_of(f.read().splitlines(), args.exact)
+    ser = open_port(args.port, args.baud)
+    ser.write(b'M1004 S1\n')
+    start = time.time()
+    send_frames(ser, frames, args.window)
+    elapsed = time.time() - start
+    print('%d frames in %.2f s, %.0f frames/s' % (len(frames), elapsed, len(frames) / elapsed))
+    return 0
+
+
+def made_up(rng, lines=4000):
+    out = ['G92 X0 Y0 Z0 E0', 'M302 P1', 'G1 Z0.3 F3000']
+    e = 0.0
+    for _ in range(lines):
+        e += rng.uniform(0.01, 0.2)
+        if rng.random() < 0.1:
+            out.append('G0 X%.3f Y%.3f F9000' % (rng.uniform(10, 190), rng.uniform(10, 190)))
+        else:
+            out.append('G1 X%.3f Y%.3f E%.4f F3600' % (rng.uniform(10, 190), rng.uniform(10, 190), e))
+    out.append('M400')
+    return out
+
+
+def corrupted(frames, every, rng):
+    # Every Nth frame broken, then the frames sent before the "rs:" came back
+    # and again from the broken one, as the go back N host does
+    out = []
+    broken = 0
+    i = 0
+    while i < len(frames):
+        if i and i % every == 0 and frames[i][2] != BP_END:
+            bad = bytearray(frames[i])
+            bad[rng.randrange(4, len(bad))] ^= 0x10
+            out.append(bytes(bad))
+            out += frames[i + 1:i + 4]
+            broken += 1
+        out.append(frames[i])
+        i += 1
+    return out, broken
+
+
+def run_native(binary, stream, tmp, name):
+    path = os.path.join(tmp, name + '.gcode')
+    trace = os.path.join(tmp, name + '.trc')
+    with open(path, 'wb') as f:
+        f.write(stream)
+    out = subprocess.run([os.path.abspath(binary), '-e', os.path.join(tmp, name + '.eeprom'), '-t', trace, path],
+                         check=True, stdout=subprocess.PIPE, stderr=subprocess.DEVNULL).stdout
+    return trace, out.decode(errors='replace')
+
+
+def cmd_bench(args):
+    if args.corpus:
+        with open(args.corpus, errors='replace') as f:
+            lines = f.read().splitlines()
+    else:
+        lines = made_up(random.Random(args.seed))
+    text = text_lines(lines)
+    frames = frames_of(lines, args.exact)
+    moves = sum(1 for fr in frames if fr[2] == BP_MOVE)
+    count = len(frames) - 1
+
+    rtt = args.rtt_ms / 1000.0
+    byte_time = 10.0 / args.baud
+    text_bytes = sum(len(t) for t in text)
+    # One line, then its "ok" back and the round trip
+    text_time = sum((len(t) + 3) * byte_time + rtt for t in text)
+    frame_bytes = sum(len(fr) for fr in frames[:-1])
+    # A window of bytes, then the wait for its acknowledge
+    window_time = args.window * byte_time + rtt
+    frame_time = max(frame_bytes * byte_time, frame_bytes / float(args.window) * window_time)
+
+    print('%d lines, %d of them moves sent as move frames, link %d baud, round trip %g ms, window %d' % (
+        count, moves, args.baud, args.rtt_ms, args.window))
+    print('%-7s %10s %12s %14s' % ('format', 'bytes', 'bytes/line', 'link lines/s'))
+    print('%-7s %10d %12.2f %14.0f' % ('text', text_bytes, text_bytes / float(count), count / text_time))
+    print('%-7s %10d %12.2f %14.0f' % ('binary', frame_bytes, frame_bytes / float(count), count / frame_time))
+
+    if not args.bin:
+        return 0
+
+    ok = True
+    rng = random.Random(args.seed)
+    with tempfile.TemporaryDirectory() as tmp:
+        text_trace, _ = run_native(args.bin, b''.join(text), tmp, 'text')
+        stream = b'M1004 S1\n' + b''.join(frames)
+        bin_trace, out = run_native(args.bin, stream, tmp, 'binary')
+        print('Native, text lines against frames:')
+        ok = compare(text_trace, bin_trace, 0) and ok
+        acks = len(re.findall(r'^ack:\d+', out, re.M))
+        print('%d acknowledges for %d frames' % (acks, len(frames)))
+        if args.corrupt:
+            bad, broken = corrupted(frames, args.corrupt, rng)
+            bad_trace, out = run_native(args.bin, b'M1004 S1\n' + b''.join(bad), tmp, 'corrupt')
+            asked = len(re.findall(r'^rs:\d+', out, re.M))
+            print('Native, %d frames broken, %d sent again on "rs:":' % (broken, asked))
+            ok = compare(text_trace, bad_trace, 0) and ok and asked == broken
+    return 0 if ok else 1
+
+
+def main():
+    parser = argparse.ArgumentParser(description='MK4duo binary command frames')
+    sub = parser.add_subparsers(dest='cmd', required=True)
+
+    p = sub.add_parser('encode', help='encode a G-code file as a binary stream')
+    p.add_argument('gcode')
+    p.add_argument('--out', required=True)
+    p.add_argument('--exact', action='store_true', help='send values finer than 1/10000 as text')
+    p.set_defaults(func=cmd_encode)
+
+    p = sub.add_parser('send', help='stream a G-code file to a printer as frames')
+    p.add_argument('gcode')
+    p.add_argument('--port', required=True)
+    p.add_argument('--baud', type=int, default=250000)
+    p.add_argument('--window', type=int, default=WINDOW)
+    p.add_argument('--exact', action='store_true')
+    p.set_defaults(func=cmd_send)
+
+    p = sub.add_parser('bench', help='compare text lines and frames')
+    p.add_argument('--bin', help='native executable built with BINARY_PROTOCOL')
+    p.add_argument('--corpus', help='G-code file, a slicer output')
+    p.add_argument('--baud', type=int, default=250000)
+    p.add_argument('--rtt-ms', type=float, default=1.0, help='round trip of the link, USB is about 1 ms')
+    p.add_argument('--window', type=int, default=WINDOW)
+    p.add_argument('--corrupt', type=int, default=0, help='break every Nth frame')
+    p.add_argument('--exact', action='store_true')
+    p.add_argument('--seed', type=int, default=1)
+    p.set_defaults(func=cmd_bench)
+
+    args = parser.parse_args()
+    return args.func(args)
+
+
+if __name__ == '__main__':
+    sys.exit(main())
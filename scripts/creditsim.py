@@ -0,0 +1,258 @@
+#!/usr/bin/python3
+
+# Host streaming simulation for MK4duo credit flow control (CREDIT_FLOW_CONTROL, M1005)
+#
+# Streams a G-code file over a modelled serial link to a model of the
+# firmware loop (command buffer_ring, planner, moves running) and reports the
+# lines per second and how full the planner was, for:
+#
+#   ok      the host sends the next line after the "ok" of the one before
+#   credit  the host sends up to the line granted by "ok N<n> C<credits>",
+#           the grants follow Commands::report_credit()
+#
+#   creditsim.py [--corpus print.gcode] [--baud 250000] [--rtt-ms 1]
+#                [--bufsize 4] [--block-buffer 16] [--loop-us 50] [--cmd-us 150]
+#                [--segment 0.2] [--feedrate 100]
+#
+# Without --corpus the moves are short segments of a curve, --segment mm long
+# at --feedrate mm/s, the case where the link limits the print. A move runs
+# for its length over its feedrate, acceleration is left out. The planner is
+# starved when it is empty before the last line has run, each one is a stop
+# on the print.
+
+import argparse
+import math
+import re
+import sys
+
+BYTE_TIME_BITS = 10
+
+
+def made_up(args):
+    lines = ['G92 X0 Y0 Z0 E0', 'G1 Z0.3 F3000']
+    e = 0.0
+    radius = 30.0
+    count = int(2 * math.pi * radius / args.segment)
+    for i in range(1, count * args.laps + 1):
+        a = 2 * math.pi * i / count
+        e += args.segment * 0.033
+        lines.append('G1 X%.3f Y%.3f E%.4f F%d' % (100 + radius * math.cos(a), 100 + radius * math.sin(a), e,
+                                                   args.feedrate * 60))
+    lines.append('M400')
+    return lines
+
+
+def numbered(lines):
+    out = []
+    for line in lines:
+        line = line.split(';', 1)[0].strip()
+        if not line:
+            continue
+        body = 'N%d %s' % (len(out) + 1, line)
+        checksum = 0
+        for b in body.encode():
+            checksum ^= b
+        out.append('%s*%d\n' % (body, checksum))
+    return out
+
+
+def durations(lines):
+    # Run time of each line, moves only
+    pos = {'X': 0.0, 'Y': 0.0, 'Z': 0.0}
+    feed = 50.0
+    out = []
+    for line in lines:
+        words = dict((m.group(1), float(m.group(2))) for m in re.finditer(r'([A-Z])([-+]?[\d.]+)', line.split(' ', 1)[1]))
+        code = line.split(' ', 2)[1]
+        if code in ('G0', 'G1'):
+            if 'F' in words:
+                feed = words['F'] / 60.0
+            dist = math.sqrt(sum((words.get(a, pos[a]) - pos[a]) ** 2 for a in pos))
+            for a in pos:
+                pos[a] = words.get(a, pos[a])
+            out.append(dist / feed)
+            continue
+        if code == 'G92':
+            for a in pos:
+                pos[a] = words.get(a, pos[a])
+        out.append(None)
+    return out
+
+
+class Firmware:
+
+    def __init__(self, args):
+        self.args = args
+        self.ring = []          # Line numbers in the buffer_ring
+        self.rx = []            # Lines arrived and not taken yet
+        self.planned = []       # Move times in the planner, the first one is running
+        self.run_left = 0.0
+        self.last_n = 0
+        self.edge = 0
+        self.reports = 0
+
+    def moves_free(self):
+        return self.args.block_buffer - 1 - len(self.planned)
+
+    def report_credit(self, force=False):
+        # The same as Commands::report_credit()
+        free = self.args.bufsize - len(self.ring)
+        edge = self.last_n + free
+        if not force:
+            if edge <= self.edge:
+                return None
+            if self.last_n < self.edge and edge - self.edge < (self.args.bufsize + 1) // 2 \
+                    and self.moves_free() < self.args.block_buffer // 2:
+                return None
+        self.edge = edge
+        self.reports += 1
+        return 'ok N%d C%d P%d\n' % (self.last_n, free, self.moves_free())
+
+
+def simulate(args, lines, times, mode):
+    byte_time = BYTE_TIME_BITS / float(args.baud)
+    latency = args.rtt_ms / 2000.0
+    loop = args.loop_us * 1e-6
+    fw = Firmware(args)
+
+    to_fw = []              # (arrival time, line index)
+    to_host = []            # (arrival time, message)
+    tx_free = rx_free = 0.0
+    next_line = 0
+    granted = 0
+    now = 0.0
+    busy_until = 0.0
+    occupancy = 0.0
+    starved = 0.0
+    started = None
+    done = 0
+    answer_bytes = 0
+    rx_peak = 0
+
+    def host_send(i):
+        nonlocal tx_free
+        tx_free = max(now, tx_free) + len(lines[i]) * byte_time
+        to_fw.append((tx_free + latency, i))
+
+    def fw_answer(msg):
+        nonlocal rx_free, answer_bytes
+        rx_free = max(now, rx_free) + len(msg) * byte_time
+        to_host.append((rx_free + latency, msg))
+        answer_bytes += len(msg)
+
+    if mode == 'credit':
+        fw_answer(fw.report_credit(True))
+    else:
+        host_send(0)
+        next_line = 1
+
+    while done < len(lines):
+        # Host
+        while to_host and to_host[0][0] <= now:
+            msg = to_host.pop(0)[1]
+            if mode == 'ok':
+                if next_line < len(lines):
+                    host_send(next_line)
+                    next_line += 1
+            else:
+                m = re.match(r'ok N(\d+) C(\d+)', msg)
+                granted = max(granted, int(m.group(1)) + int(m.group(2)))
+        if mode == 'credit':
+            while next_line < len(lines) and next_line + 1 <= granted:
+                host_send(next_line)
+                next_line += 1
+
+        # Serial bytes
+        while to_fw and to_fw[0][0] <= now:
+            fw.rx.append(to_fw.pop(0)[1])
+        rx_peak = max(rx_peak, sum(len(lines[i]) for i in fw.rx))
+
+        # Firmware loop, get_available() then advance_queue()
+        if now >= busy_until:
+            while fw.rx and len(fw.ring) < args.bufsize:
+                i = fw.rx.pop(0)
+                fw.ring.append(i)
+                fw.last_n = i + 1
+            if mode == 'credit':
+                msg = fw.report_credit()
+                if msg:
+                    fw_answer(msg)
+            if fw.ring:
+                i = fw.ring[0]
+                if times[i] is None or fw.moves_free() > 0:
+                    if times[i] is not None:
+                        if not fw.planned:
+                            fw.run_left = times[i]
+                        fw.planned.append(times[i])
+                        if started is None:
+                            started = now
+                    fw.ring.pop(0)
+                    done += 1
+                    busy_until = now + args.cmd_us * 1e-6
+                    if mode == 'ok':
+                        fw_answer('ok\n')
+
+        # Moves running
+        if fw.planned:
+            occupancy += len(fw.planned) * loop
+            fw.run_left -= loop
+            while fw.planned and fw.run_left <= 0:
+                fw.planned.pop(0)
+                if fw.planned:
+                    fw.run_left += fw.planned[0]
+        elif started is not None:
+            starved += loop
+
+        now += loop
+
+    # The moves still in the planner run to the end
+    tail = fw.run_left + sum(fw.planned[1:])
+    end = now + max(tail, 0.0)
+    span = end - (started or 0.0)
+    return {
+        'time': end,
+        'lines/s': len(lines) / now,
+        'occupancy': occupancy / span if span else 0.0,
+        'starved': starved,
+        'answers': (fw.reports if mode == 'credit' else len(lines)),
+        'answer bytes': answer_bytes,
+        'rx peak': rx_peak,
+    }
+
+
+def main():
+    parser = argparse.ArgumentParser(description='MK4duo credit flow control host simulation')
+    parser.add_argument('--corpus', help='G-code file, a slicer output')
+    parser.add_argument('--baud', type=int, default=250000)
+    parser.add_argument('--rtt-ms', type=float, default=1.0, help='round trip of the link, USB is about 1 ms')
+    parser.add_argument('--bufsize', type=int, default=4, help='BUFSIZE')
+    parser.add_argument('--block-buffer', type=int, default=16, help='BLOCK_BUFFER_SIZE')
+    parser.add_argument('--loop-us', type=float, default=50.0, help='firmware main loop time')
+    parser.add_argument('--cmd-us', type=float, default=150.0, help='time to parse and plan a line')
+    parser.add_argument('--segment', type=float, default=0.2, help='segment length in mm')
+    parser.add_argument('--feedrate', type=float, default=100.0, help='mm/s')
+    parser.add_argument('--laps', type=int, default=2)
+    args = parser.parse_args()
+
+    if args.corpus:
+        with open(args.corpus, errors='replace') as f:
+            source = f.read().splitlines()
+    else:
+        source = made_up(args)
+    lines = numbered(source)
+    times = durations(lines)
+    move_time = sum(t for t in times if t)
+
+    print('%d lines, %.2f s of moves, link %d baud, round trip %g ms, BUFSIZE %d, BLOCK_BUFFER_SIZE %d' % (
+        len(lines), move_time, args.baud, args.rtt_ms, args.bufsize, args.block_buffer))
+    print('%-7s %9s %9s %14s %11s %9s %13s %9s' % (
+        'mode', 'time s', 'lines/s', 'planner moves', 'starved s', 'answers', 'answer bytes', 'RX peak'))
+    for mode in ('ok', 'credit'):
+        r = simulate(args, lines, times, mode)
+        print('%-7s %9.2f %9.0f %14.1f %11.2f %9d %13d %9d' % (
+            mode, r['time'], r['lines/s'], r['occupancy'], r['starved'], r['answers'], r['answer bytes'], r['rx peak']))
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
@@ -0,0 +1,247 @@
+#!/usr/bin/python3
+
+# G-code number scanner check for MK4duo (src/lib/decimal.h)
+#
+# Builds a small host program around src/lib/decimal.h with the host g++ and
+#
+#   decimalbench.py fuzz [--count 1000000] [--seed 1]
+#   decimalbench.py bench [--corpus print.gcode] [--rounds 20]
+#
+# fuzz feeds random G-code numbers (signs, leading and trailing zeros, lone
+# points, long mantissas, a letter or an 'E' right after them) to the scanner
+# and compares it with what the parser did before: strtof with 'E' cut off,
+# strtol and strtoul of a 32 bit long, and an exact decimal rounding for the
+# fixed point value. Floats must have the same bits. Exit code is 0 when all
+# values match, 1 otherwise.
+#
+# bench takes every parameter value of a G-code file, a slicer output is the
+# real load, and times Decimal::to_float / to_long against the strtof and
+# strtol calls they replace. Without --corpus a slicer like file is made up.
+# Times are host times, the gain on the AVR, where strtof is software, is
+# larger.
+
+import argparse
+import decimal
+import os
+import random
+import re
+import subprocess
+import sys
+import tempfile
+
+HERE = os.path.dirname(os.path.abspath(__file__))
+LIB = os.path.join(HERE, '..', 'MK4duo', 'src', 'lib')
+
+HARNESS = r'''
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <time.h>
+#include <vector>
+#include <string>
+#include "decimal.h"
+
+// The parser value_float() before Decimal
+static float old_float(char *value_ptr) {
+  char *e = value_ptr;
+  for (;;) {
+    const char c = *e;
+    if (c == '\0' || c == ' ') break;
+    if (c == 'E' || c == 'e') {
+      *e = '\0';
+      const float ret = strtof(value_ptr, nullptr);
+      *e = c;
+      return ret;
+    }
+    ++e;
+  }
+  return strtof(value_ptr, nullptr);
+}
+
+// strtol and strtoul of a 32 bit long
+static int32_t ref_long(const char *p) {
+  const long long v = strtoll(p, nullptr, 10);
+  return v > INT32_MAX ? INT32_MAX : v < INT32_MIN ? INT32_MIN : int32_t(v);
+}
+
+static uint32_t ref_ulong(const char *p) {
+  const bool neg = (*p == '-');
+  const unsigned long long m = strtoull(p + (*p == '-' || *p == '+'), nullptr, 10);
+  if (m > 0xFFFFFFFFULL) return 0xFFFFFFFFUL;
+  return neg ? uint32_t(-uint32_t(m)) : uint32_t(m);
+}
+
+static double now() {
+  timespec t;
+  clock_gettime(CLOCK_MONOTONIC, &t);
+  return t.tv_sec + t.tv_nsec * 1e-9;
+}
+
+int main(int argc, char **argv) {
+  std::vector<std::string> values;
+  char line[256];
+  while (fgets(line, sizeof(line), stdin)) {
+    line[strcspn(line, "\n")] = '\0';
+    values.push_back(line);
+  }
+
+  if (argc > 1 && !strcmp(argv[1], "check")) {
+    for (auto &v : values) {
+      char *p = &v[0];
+      const float a = Decimal::to_float(p), b = old_float(p);
+      uint32_t ba, bb;
+      memcpy(&ba, &a, 4);
+      memcpy(&bb, &b, 4);
+      printf("%08x %08x %d %d %u %u %d\n", ba, bb,
+        Decimal::to_long(p), ref_long(p), Decimal::to_ulong(p), ref_ulong(p), Decimal::to_fixed(p, 3));
+    }
+    return 0;
+  }
+
+  const int rounds = argc > 2 ? atoi(argv[2]) : 20;
+  volatile float fsink = 0;
+  volatile int32_t lsink = 0;
+  double t, t_fast = 0, t_old = 0, t_lfast = 0, t_lold = 0;
+  for (int r = 0; r < rounds; r++) {
+    t = now(); for (auto &v : values) fsink = fsink + Decimal::to_float(&v[0]); t_fast += now() - t;
+    t = now(); for (auto &v : values) fsink = fsink + old_float(&v[0]); t_old += now() - t;
+    t = now(); for (auto &v : values) lsink = lsink + Decimal::to_long(&v[0]); t_lfast += now() - t;
+    t = now(); for (auto &v : values) lsink = lsink + strtol(&v[0], nullptr, 10); t_lold += now() - t;
+  }
+  const double n = double(values.size()) * rounds * 1e-9;
+  printf("%zu %.2f %.2f %.2f %.2f\n", values.size(), t_fast / n, t_old / n, t_lfast / n, t_lold / n);
+  return 0;
+}
+'''
+
+
+def build(tmp):
+    src = os.path.join(tmp, 'decimal_harness.cpp')
+    exe = os.path.join(tmp, 'decimal_harness')
+    with open(src, 'w') as f:
+        f.write(HARNESS)
+    subprocess.run(['g++', '-O2', '-std=gnu++11', '-I', LIB, '-o', exe, src], check=True)
+    return exe
+
+
+def random_number(rng):
+    sign = rng.choice(['', '', '', '-', '+'])
+    ints = ''.join(rng.choice('0123456789') for _ in range(rng.choice([0, 1, 1, 2, 3, 3, 4, 6, 9, 11])))
+    fracs = ''.join(rng.choice('0123456789') for _ in range(rng.choice([0, 1, 2, 3, 4, 5, 5, 6, 8, 12])))
+    if rng.random() < 0.2:
+        ints = '0' * rng.randrange(1, 4) + ints
+    if rng.random() < 0.2:
+        fracs += '0' * rng.randrange(1, 6)
+    if not ints and not fracs:
+        ints = rng.choice('0123456789')
+    if not ints:
+        body = '.' + fracs
+    elif fracs or rng.random() < 0.1:
+        body = ints + '.' + fracs
+    else:
+        body = ints
+    return sign + body + rng.choice(['', '', ' ', ' X1', 'E2', 'e-3', 'Y', '*71', '.5'])
+
+
+def fixed_reference(text, decimals):
+    m = re.match(r'([-+]?)(\d*)(?:\.(\d*))?', text)
+    number = decimal.Decimal((m.group(2) or '0') + '.' + (m.group(3) or '0'))
+    v = int(number.scaleb(decimals).quantize(decimal.Decimal(1), rounding=decimal.ROUND_HALF_UP))
+    if m.group(1) == '-':
+        v = -v
+    return max(-2 ** 31, min(2 ** 31 - 1, v))
+
+
+def cmd_fuzz(args):
+    rng = random.Random(args.seed)
+    values = [random_number(rng) for _ in range(args.count)]
+    with tempfile.TemporaryDirectory() as tmp:
+        exe = build(tmp)
+        out = subprocess.run([exe, 'check'], input='\n'.join(values) + '\n', check=True,
+                             stdout=subprocess.PIPE, universal_newlines=True).stdout.splitlines()
+    bad = {'float': 0, 'long': 0, 'ulong': 0, 'fixed': 0}
+    shown = 0
+    for text, row in zip(values, out):
+        fa, fb, la, lb, ua, ub, fx = row.split()
+        errors = []
+        if fa != fb:
+            errors.append('float')
+        if la != lb:
+            errors.append('long')
+        if ua != ub:
+            errors.append('ulong')
+        if int(fx) != fixed_reference(text, 3):
+            errors.append('fixed')
+        for e in errors:
+            bad[e] += 1
+        if errors and shown < 20:
+            print('"%s": %s (%s)' % (text, ' '.join(errors), row))
+            shown += 1
+    print('%d numbers, mismatches: %s' % (len(values), ' '.join('%s:%d' % kv for kv in bad.items())))
+    return 1 if any(bad.values()) else 0
+
+
+def slicer_like(rng, lines=20000):
+    out = [';Generated perimeters', 'G21', 'G90', 'M82', 'M104 S210', 'G28', 'G92 E0']
+    e = 0.0
+    for i in range(lines):
+        r = rng.random()
+        if r < 0.02:
+            out.append('G1 Z%.3f F9000' % (0.2 + i * 0.0001))
+        elif r < 0.05:
+            out.append('G1 E%.5f F2400' % (e - 0.8))
+        elif r < 0.15:
+            out.append('G0 F7800 X%.3f Y%.3f' % (rng.uniform(10, 200), rng.uniform(10, 200)))
+        else:
+            e += rng.uniform(0.01, 0.3)
+            out.append('G1 X%.3f Y%.3f E%.5f' % (rng.uniform(10, 200), rng.uniform(10, 200), e))
+    return out
+
+
+def cmd_bench(args):
+    if args.corpus:
+        with open(args.corpus, errors='replace') as f:
+            lines = f.read().splitlines()
+    else:
+        lines = slicer_like(random.Random(1))
+    values = []
+    for line in lines:
+        line = line.split(';', 1)[0]
+        for m in re.finditer(r'[A-Za-z]([-+]?(?:\d|\.\d)[^ ]*)', line):
+            values.append(m.group(1))
+    if not values:
+        print('No numbers in the corpus')
+        return 1
+    with tempfile.TemporaryDirectory() as tmp:
+        exe = build(tmp)
+        out = subprocess.run([exe, 'bench', str(args.rounds)], input='\n'.join(values) + '\n', check=True,
+                             stdout=subprocess.PIPE, universal_newlines=True).stdout.split()
+    count, fast, old, lfast, lold = out
+    print('%s values from %s' % (count, args.corpus or 'a made up slicer file'))
+    print('%-8s %12s %12s %8s' % ('', 'Decimal ns', 'strtox ns', 'speedup'))
+    print('%-8s %12s %12s %7.1fx' % ('float', fast, old, float(old) / max(float(fast), 1e-3)))
+    print('%-8s %12s %12s %7.1fx' % ('long', lfast, lold, float(lold) / max(float(lfast), 1e-3)))
+    return 0
+
+
+def main():
+    parser = argparse.ArgumentParser(description='MK4duo G-code number scanner check')
+    sub = parser.add_subparsers(dest='cmd', required=True)
+
+    p = sub.add_parser('fuzz', help='compare with strtof/strtol on random numbers')
+    p.add_argument('--count', type=int, default=1000000)
+    p.add_argument('--seed', type=int, default=1)
+
+    p = sub.add_parser('bench', help='time the scanner on the numbers of a G-code file')
+    p.add_argument('--corpus', help='G-code file, a slicer output')
+    p.add_argument('--rounds', type=int, default=20)
+
+    args = parser.parse_args()
+    if args.cmd == 'fuzz':
+        return cmd_fuzz(args)
+    return cmd_bench(args)
+
+
+if __name__ == '__main__':
+    sys.exit(main())
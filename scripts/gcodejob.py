@@ -0,0 +1,552 @@
+#!/usr/bin/python3
+
+# Compiled SD jobs for MK4duo (SD_BINARY_JOB)
+#
+#   gcodejob.py compile print.gcode PRINT.JOB
+#   gcodejob.py text PRINT.JOB back.gcode
+#   gcodejob.py bench [--corpus print.gcode] [--size-mb 5] [--block 512] [--rounds 3]
+#
+# compile turns a G-code file into the records of SDCard (see SD_JOB_HEADER_SIZE
+# in src/core/sdcard/sdcard.h). The lines are cut as Commands::get_sdcard()
+# does, comments and all. A G0 or G1 with values for X Y Z E F only becomes a
+# move record, the values converted as the parser does, to the nearest float.
+# Any other line is kept as it is. Copy the file to the card and print it as
+# any other file, M23 tells the two apart by the header.
+#
+# text gives a compiled job back as G-code, the moves with values that convert
+# to the same floats. Run the original and this one through the native build
+# and scripts/steptrace.py to check a conversion.
+#
+# bench builds a small host program around src/lib/read_ahead.h and
+# src/lib/decimal.h with the host g++ and reads the same print both ways from
+# a stand-in for SdFile, as in sdreadbench.py:
+#
+#   gcode  SDCard::get_line(), the lines cut, parsed and the values of
+#          X Y Z E F converted, as enqueue() does with GCODE_PREPARSE
+#   job    Commands::get_sdcard_job(), the moves taken as they are, the
+#          other lines parsed
+#
+# The commands, codes, parameters and values must be the same both ways.
+# Without --corpus a slicer like file is made up. Times are host times, the
+# card itself is left out.
+
+import argparse
+import os
+import random
+import re
+import struct
+import subprocess
+import sys
+import tempfile
+from fractions import Fraction
+
+HERE = os.path.dirname(os.path.abspath(__file__))
+LIB = os.path.join(HERE, '..', 'MK4duo', 'src', 'lib')
+
+JOB_HEADER = b'MKJB' + bytes([1, 0, 0, 0])
+JOB_MOVE = 0x80
+JOB_G1 = 0x20
+JOB_LETTERS = 'XYZEF'
+MAX_CMD_SIZE = 96
+
+MOVE_RE = re.compile(r'G([01])((?: *[XYZEF][-+]?(?:\d+\.?\d*|\.\d+))*) *$')
+WORD_RE = re.compile(r' *([XYZEF])([-+]?(?:\d+\.?\d*|\.\d+))')
+
+
+def nearest_float(text):
+    # The float nearest to the decimal value, ties to even, as Decimal::to_float
+    d = float(text)
+    f = struct.pack('<f', d)
+    v = struct.unpack('<f', f)[0]
+    if v == d:
+        return f
+    bits = struct.unpack('<I', f)[0]
+    w = struct.unpack('<f', struct.pack('<I', bits + (1 if abs(d) > abs(v) else -1)))[0]
+    if d != (v + w) / 2:
+        return f
+    # The double fell on the middle of two floats, ask the exact value
+    exact = Fraction(text)
+    dv, dw = abs(Fraction(v) - exact), abs(Fraction(w) - exact)
+    if dw < dv or (dw == dv and bits % 2):
+        return struct.pack('<f', w)
+    return f
+
+
+SPECIAL_RE = re.compile(r'[;("\\]')
+
+
+def cut_line(line):
+    # The line as Commands::process_stream_char() leaves it
+    if len(line) < MAX_CMD_SIZE - 1 and not SPECIAL_RE.search(line):
+        return line
+    buff = []
+    state = 'normal'
+    esc = False
+    for ch in line:
+        if len(buff) >= MAX_CMD_SIZE - 1:
+            break
+        if state == 'eol':
+            break
+        if state == 'paren':
+            if ch == ')':
+                state = 'normal'
+            continue
+        if esc:
+            esc = False
+        elif ch == '\\':
+            esc = True
+            if state != 'quoted':
+                continue
+        elif state == 'quoted':
+            if ch == '"':
+                state = 'normal'
+        elif ch == '"':
+            state = 'quoted'
+        elif ch == ';':
+            state = 'eol'
+            continue
+        elif ch == '(':
+            state = 'paren'
+            continue
+        buff.append(ch)
+    return ''.join(buff)
+
+
+def cut_lines(data):
+    out = []
+    for line in re.split(r'[\r\n]', data.decode('latin-1')):
+        line = cut_line(line)
+        if line:
+            out.append(line)
+    return out
+
+
+def move_record(line):
+    m = MOVE_RE.match(line.lstrip(' '))
+    if not m:
+        return None
+    values = {}
+    for w in WORD_RE.finditer(m.group(2)):
+        if w.group(1) in values:
+            return None
+        values[w.group(1)] = w.group(2)
+    tag = JOB_MOVE | (JOB_G1 if m.group(1) == '1' else 0)
+    body = b''
+    for i, letter in enumerate(JOB_LETTERS):
+        if letter in values:
+            tag |= 1 << i
+            body += nearest_float(values[letter])
+    return bytes([tag]) + body
+
+
+def compile_job(data):
+    out = bytearray(JOB_HEADER)
+    moves = lines = 0
+    for line in cut_lines(data):
+        rec = move_record(line)
+        if rec:
+            moves += 1
+        else:
+            text = line.encode('latin-1')
+            rec = bytes([len(text)]) + text
+            lines += 1
+        out += rec
+    return bytes(out), moves, lines
+
+
+def job_text(job):
+    if job[:len(JOB_HEADER)] != JOB_HEADER:
+        raise ValueError('not a compiled job')
+    out = []
+    i = len(JOB_HEADER)
+    while i < len(job):
+        tag = job[i]
+        i += 1
+        if tag & JOB_MOVE:
+            words = ['G1' if tag & JOB_G1 else 'G0']
+            for n, letter in enumerate(JOB_LETTERS):
+                if tag & (1 << n):
+                    v = struct.unpack('<f', job[i:i + 4])[0]
+                    words.append('%s%s' % (letter, float_text(v)))
+                    i += 4
+            out.append(' '.join(words))
+        else:
+            out.append(job[i:i + tag].decode('latin-1'))
+            i += tag
+    return '\n'.join(out) + '\n'
+
+
+def float_text(v):
+    # Nine digits give back the float, written with no exponent
+    text = '%.9g' % v
+    if 'e' in text:
+        text = ('%.12f' % v).rstrip('0').rstrip('.')
+        if nearest_float(text) != struct.pack('<f', v):
+            text = ('%.45f' % v).rstrip('0').rstrip('.')
+    return text
+
+
+HARNESS = r'''
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "decimal.h"
+#include "read_ahead.h"
+
+#define MAX_CMD_SIZE  96
+#define BUFSIZE       4
+#define BLOCK         512
+#define WITHIN(N,L,H) ((N) >= (L) && (N) <= (H))
+#define NUMERIC(a)    WITHIN(a, '0', '9')
+#define DECIMAL_SIGNED(a) (NUMERIC(a) || (a) == '-' || (a) == '+' || (a) == '.')
+
+enum e_parser_state : uint8_t { PS_NORMAL, PS_EOL, PS_QUOTED, PS_PAREN, PS_ESC };
+
+// SdFile on a host file, as in sdreadbench.py
+class StandInFile {
+  public:
+    uint8_t *image;
+    uint32_t pos, size, cached;
+    uint8_t cache[BLOCK];
+
+    void load_file(const char *path) {
+      FILE *f = fopen(path, "rb");
+      fseek(f, 0, SEEK_END); size = ftell(f); fseek(f, 0, SEEK_SET);
+      image = (uint8_t*)calloc(size + BLOCK, 1);
+      if (fread(image, 1, size, f) != size) exit(1);
+      fclose(f);
+    }
+    void open() { pos = 0; cached = 0xFFFFFFFF; }
+    __attribute__((noinline)) int read(void *buf, size_t nbyte) {
+      uint8_t *dst = (uint8_t*)buf;
+      if (pos >= size) return 0;
+      if (nbyte > size - pos) nbyte = size - pos;
+      size_t toRead = nbyte;
+      while (toRead) {
+        const uint32_t offset = pos % BLOCK, block = pos / BLOCK;
+        size_t n;
+        if (offset == 0 && toRead >= BLOCK && block != cached) {
+          n = BLOCK;
+          memcpy(dst, image + block * BLOCK, BLOCK);
+        }
+        else {
+          if (block != cached) { memcpy(cache, image + block * BLOCK, BLOCK); cached = block; }
+          n = BLOCK - offset;
+          if (n > toRead) n = toRead;
+          memcpy(dst, cache + offset, n);
+        }
+        dst += n; pos += n; toRead -= n;
+      }
+      return nbyte;
+    }
+};
+
+// gcode_record_t, the parts the handlers use
+struct record_t {
+  char      command_letter;
+  uint16_t  codenum;
+  uint8_t   valuebits;
+  uint32_t  codebits;
+  uint8_t   param[26];
+  float     value[5];
+};
+
+static const char job_letters[5] = { 'X', 'Y', 'Z', 'E', 'F' };
+
+static inline int8_t value_index(const char c) {
+  switch (c) {
+    case 'X': return 0; case 'Y': return 1; case 'Z': return 2;
+    case 'E': return 3; case 'F': return 4; default: return -1;
+  }
+}
+
+static inline bool valid_float(const char *p) {
+  if (*p == '-' || *p == '+') p++;
+  return NUMERIC(p[0]) || (p[0] == '.' && NUMERIC(p[1]));
+}
+
+// GCodeParser::parse() with FASTER_GCODE_PARSER, then the values of preparse()
+static void parse(char *p, record_t &rec) {
+  rec.command_letter = '?'; rec.codenum = 0; rec.codebits = 0; rec.valuebits = 0;
+  while (*p == ' ') ++p;
+  if (*p == 'N' && (NUMERIC(p[1]) || p[1] == '-')) { p += 2; while (NUMERIC(*p)) ++p; while (*p == ' ') ++p; }
+  char * const command_ptr = p;
+  const char letter = *p++;
+  char *starpos = strchr(p, '*');
+  if (starpos) { --starpos; while (*starpos == ' ') --starpos; starpos[1] = '\0'; }
+  if (letter != 'G' && letter != 'M' && letter != 'T') return;
+  while (*p == ' ') ++p;
+  if (!NUMERIC(*p)) return;
+  rec.command_letter = letter;
+  do { rec.codenum = rec.codenum * 10 + *p++ - '0'; } while (NUMERIC(*p));
+  while (*p == ' ') ++p;
+  if (letter == 'M' && (rec.codenum == 23 || rec.codenum == 28 || rec.codenum == 117)) return;
+  while (const char param = *p++) {
+    if (WITHIN(param, 'A', 'Z')) {
+      while (*p == ' ') ++p;
+      const uint8_t ind = param - 'A';
+      rec.codebits |= 1UL << ind;
+      rec.param[ind] = valid_float(p) ? p - command_ptr : 0;
+    }
+    if (!WITHIN(*p, 'A', 'Z')) {
+      while (*p && DECIMAL_SIGNED(*p)) p++;
+      while (*p == ' ') ++p;
+    }
+  }
+  for (uint8_t v = 0; v < 5; v++) {
+    const uint8_t ind = job_letters[v] - 'A';
+    if ((rec.codebits & (1UL << ind)) && rec.param[ind]) {
+      rec.value[v] = Decimal::to_float(command_ptr + rec.param[ind]);
+      rec.valuebits |= 1 << v;
+    }
+  }
+}
+
+static inline void process_stream_char(const char c, uint8_t &sis, char (&buff)[MAX_CMD_SIZE], int &ind) {
+  if (ind >= MAX_CMD_SIZE - 1) sis = PS_EOL;
+  if (sis == PS_EOL) return;
+  else if (sis == PS_PAREN) { if (c == ')') sis = PS_NORMAL; return; }
+  else if (sis >= PS_ESC) sis -= PS_ESC;
+  else if (c == '\\') { sis += PS_ESC; if (sis == PS_ESC) return; }
+  else if (sis == PS_QUOTED) { if (c == '"') sis = PS_NORMAL; }
+  else if (c == '"') sis = PS_QUOTED;
+  else if (c == ';') { sis = PS_EOL; return; }
+  else if (c == '(') { sis = PS_PAREN; return; }
+  buff[ind++] = c;
+}
+
+static inline bool process_line_done(uint8_t &sis, char (&buff)[MAX_CMD_SIZE], int &ind) {
+  sis = PS_NORMAL;
+  buff[ind] = 0;
+  if (ind) { ind = 0; return false; }
+  return true;
+}
+
+static StandInFile file;
+static Read_Ahead<StandInFile, SD_BUFFER> read_ahead;
+static uint32_t commands, ring;
+static uint64_t digest;
+static char ring_line[BUFSIZE][MAX_CMD_SIZE];
+static record_t ring_rec[BUFSIZE];
+
+// What the handlers see of a command
+static void run(const record_t &rec) {
+  digest = digest * 131 + uint8_t(rec.command_letter);
+  digest = digest * 131 + rec.codenum;
+  digest = digest * 131 + rec.codebits;
+  for (uint8_t v = 0; v < 5; v++) if (rec.valuebits & (1 << v)) {
+    uint32_t bits;
+    memcpy(&bits, &rec.value[v], 4);
+    digest = digest * 131 + bits;
+  }
+  commands++;
+}
+
+// enqueue(), the line parsed into its record
+static void enqueue(const char *line) {
+  strcpy(ring_line[ring], line);
+  parse(ring_line[ring], ring_rec[ring]);
+  run(ring_rec[ring]);
+  if (++ring == BUFSIZE) { ring = 0; read_ahead.refill(file); }
+}
+
+// enqueue_parsed()
+static void enqueue_parsed(const char *line, const record_t &rec) {
+  strcpy(ring_line[ring], line);
+  ring_rec[ring] = rec;
+  run(ring_rec[ring]);
+  if (++ring == BUFSIZE) { ring = 0; read_ahead.refill(file); }
+}
+
+static void run_gcode() {
+  static char buff[MAX_CMD_SIZE];
+  uint8_t sis = PS_NORMAL;
+  int count = 0;
+  for (;;) {
+    const char *p;
+    bool is_eol;
+    uint16_t n = read_ahead.line(file, p, is_eol);
+    if (!n) {
+      if (!process_line_done(sis, buff, count)) enqueue(buff);
+      break;
+    }
+    if (is_eol) n--;
+    while (n--) process_stream_char(*p++, sis, buff, count);
+    if (is_eol && !process_line_done(sis, buff, count)) enqueue(buff);
+  }
+}
+
+static void run_job() {
+  read_ahead.read(file, ring_line[0], 8);
+  for (;;) {
+    char line[MAX_CMD_SIZE];
+    uint8_t tag;
+    if (read_ahead.read(file, &tag, 1) != 1) break;
+    if (tag & 0x80) {
+      float value[5];
+      const uint8_t valuebits = tag & 0x1F;
+      uint8_t count = 0;
+      for (uint8_t v = 0; v < 5; v++) if (valuebits & (1 << v)) count++;
+      if (read_ahead.read(file, value, count * sizeof(float)) != count * sizeof(float)) break;
+      record_t rec;
+      rec.command_letter = 'G';
+      rec.codenum = (tag & 0x20) ? 1 : 0;
+      rec.valuebits = valuebits;
+      rec.codebits = 0;
+      memset(rec.param, 0, sizeof(rec.param));
+      count = 0;
+      for (uint8_t v = 0; v < 5; v++) if (valuebits & (1 << v)) {
+        rec.codebits |= 1UL << (job_letters[v] - 'A');
+        rec.value[v] = value[count++];
+      }
+      strcpy(line, rec.codenum ? "G1" : "G0");
+      enqueue_parsed(line, rec);
+    }
+    else {
+      if (!tag || tag >= MAX_CMD_SIZE || read_ahead.read(file, line, tag) != tag) break;
+      line[tag] = '\0';
+      enqueue(line);
+    }
+  }
+}
+
+static double now() {
+  timespec t;
+  clock_gettime(CLOCK_MONOTONIC, &t);
+  return t.tv_sec + t.tv_nsec * 1e-9;
+}
+
+int main(int argc, char **argv) {
+  const int rounds = atoi(argv[2]);
+  const bool job = !strcmp(argv[3], "job");
+  double best = 1e9;
+  file.load_file(argv[1]);
+  for (int r = 0; r < rounds; r++) {
+    file.open();
+    read_ahead.reset(0);
+    commands = ring = 0;
+    digest = 0;
+    const double t = now();
+    if (job) run_job(); else run_gcode();
+    const double e = now() - t;
+    if (e < best) best = e;
+  }
+  printf("%u %u %.6f %016llx\n", commands, file.size, best, (unsigned long long)digest);
+  return 0;
+}
+'''
+
+
+def build(tmp, block):
+    src = os.path.join(tmp, 'job_harness.cpp')
+    exe = os.path.join(tmp, 'job_harness')
+    with open(src, 'w') as f:
+        f.write(HARNESS)
+    subprocess.run(['g++', '-O2', '-std=gnu++11', '-DSD_BUFFER=%d' % block, '-I', LIB, '-o', exe, src], check=True)
+    return exe
+
+
+def made_up(path, size):
+    # Slicer like lines, with comments, CR LF and a last line with no newline
+    rng = random.Random(1)
+    e = 0.0
+    written = 0
+    with open(path, 'w', newline='') as f:
+        f.write(';FLAVOR:Marlin\n;Generated with a made up slicer\nG21\nG90\nM82\nM104 S200\nG28\n')
+        while written < size:
+            r = rng.random()
+            if r < 0.02:
+                line = ';LAYER:%d\n' % rng.randrange(1000)
+            elif r < 0.03:
+                line = 'M117 "Layer (%d)"\n' % rng.randrange(1000)
+            elif r < 0.04:
+                line = 'M106 S%d\n' % rng.randrange(256)
+            elif r < 0.10:
+                line = 'G0 F7800 X%.3f Y%.3f\r\n' % (rng.uniform(10, 200), rng.uniform(10, 200))
+            else:
+                e += rng.uniform(0.01, 0.3)
+                line = 'G1 X%.3f Y%.3f E%.5f ; perimeter\n' % (rng.uniform(10, 200), rng.uniform(10, 200), e)
+            f.write(line)
+            written += len(line)
+        f.write('M84')
+
+
+def cmd_compile(args):
+    with open(args.gcode, 'rb') as f:
+        data = f.read()
+    job, moves, lines = compile_job(data)
+    with open(args.job, 'wb') as f:
+        f.write(job)
+    print('%d moves, %d lines, %d bytes from %d (%.0f%%)' % (moves, lines, len(job), len(data),
+                                                          100.0 * len(job) / max(len(data), 1)))
+    return 0
+
+
+def cmd_text(args):
+    with open(args.job, 'rb') as f:
+        job = f.read()
+    with open(args.gcode, 'w') as f:
+        f.write(job_text(job))
+    return 0
+
+
+def cmd_bench(args):
+    with tempfile.TemporaryDirectory() as tmp:
+        exe = build(tmp, args.block)
+        path = args.corpus
+        if not path:
+            path = os.path.join(tmp, 'made_up.gcode')
+            made_up(path, int(args.size_mb * 1e6))
+        with open(path, 'rb') as f:
+            job, moves, lines = compile_job(f.read())
+        job_path = os.path.join(tmp, 'print.job')
+        with open(job_path, 'wb') as f:
+            f.write(job)
+        results = {}
+        for mode, target in (('gcode', path), ('job', job_path)):
+            out = subprocess.run([exe, target, str(args.rounds), mode], check=True,
+                                 stdout=subprocess.PIPE, universal_newlines=True).stdout.split()
+            results[mode] = (int(out[0]), int(out[1]), float(out[2]), out[3])
+
+    print('%d commands, %d moves compiled, buffers of %d bytes, %s' % (
+        results['gcode'][0], moves, args.block, args.corpus or 'a made up file'))
+    print('%-6s %12s %10s %14s %18s' % ('file', 'records/s', 'MB', 'MB/s read', 'commands'))
+    for mode in ('gcode', 'job'):
+        n, size, t, digest = results[mode]
+        print('%-6s %12.0f %10.1f %14.1f %18s' % (mode, n / t, size / 1e6, size / t / 1e6, digest))
+    same = results['gcode'][0] == results['job'][0] and results['gcode'][3] == results['job'][3]
+    print('Speedup %.1fx, file %.0f%% of the G-code, %s' % (
+        results['gcode'][2] / results['job'][2], 100.0 * results['job'][1] / results['gcode'][1],
+        'same commands' if same else 'DIFFERENT COMMANDS'))
+    return 0 if same else 1
+
+
+def main():
+    parser = argparse.ArgumentParser(description='MK4duo compiled SD jobs')
+    sub = parser.add_subparsers(dest='cmd')
+    p = sub.add_parser('compile', help='G-code file to compiled job')
+    p.add_argument('gcode')
+    p.add_argument('job')
+    p = sub.add_parser('text', help='compiled job back to G-code')
+    p.add_argument('job')
+    p.add_argument('gcode')
+    p = sub.add_parser('bench', help='records/s of a compiled job against the G-code')
+    p.add_argument('--corpus', help='G-code file to read')
+    p.add_argument('--size-mb', type=float, default=5.0, help='size of the made up file')
+    p.add_argument('--block', type=int, default=512, help='SD_READ_AHEAD_SIZE')
+    p.add_argument('--rounds', type=int, default=3)
+    args = parser.parse_args()
+    if args.cmd == 'compile':
+        return cmd_compile(args)
+    if args.cmd == 'text':
+        return cmd_text(args)
+    if args.cmd == 'bench':
+        return cmd_bench(args)
+    parser.print_help()
+    return 2
+
+
+if __name__ == '__main__':
+    sys.exit(main())
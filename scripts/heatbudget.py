@@ -0,0 +1,122 @@
+#!/usr/bin/python3
+
+# Heat-up of the MK4duo power budget (POWER_BUDGET) in the host native build
+#
+# Runs the native executable, built with DEFINES="-DPOWER_BUDGET", on the
+# start G-code of a printer with a bed and a hotend, its thermal model slowed
+# down by --scale to the time constants of a real machine (the default 10
+# gives the hotend 80 s and the bed 300 s):
+#
+#   sequential   M190 then M109, one heater after the other so the supply
+#                is never asked for more than it gives, as start G-code does
+#   budget       M140 and M104 first, then M190 and M109, the heaters share
+#                --budget watts and heat at the same time
+#   no budget    the same G-code with M1007 S0, what the supply would be
+#                asked for without the budget
+#
+#   heatbudget.py --bin mk4duo_native [--budget 240] [--bed 60] [--hotend 210]
+#                 [--bed-watts 220] [--hotend-watts 40] [--scale 10]
+#
+# The seconds are the time to temperature reported at the end of M190 and
+# M109, a heater already at temperature when its wait starts has none; ready
+# is the time the start G-code takes in all. The watts are the mean and the
+# highest mean over four soft PWM cycles (about a second) drawn by the
+# heaters from the level of their outputs. Over is the time the heaters draw more than the budget at once,
+# together the same if all the soft PWM windows started at the same time.
+# Exit code is 0 when the budget run heats both heaters without errors, its
+# highest mean stays within the budget, and the staggered windows are
+# over the budget for less time than together.
+
+import argparse
+import os
+import re
+import subprocess
+import sys
+import tempfile
+
+HEATED = re.compile(r'echo:(Bed|Hotend) 0 at (-?\d+) in ([\d.]+) s')
+POWER = re.compile(r'Heater power\s*: mean ([\d.]+) W, highest \d+ ms ([\d.]+) W')
+OVER = re.compile(r'Over the budget\s*: (\d+) ms, (\d+) ms')
+SIMULATED = re.compile(r'Simulated time\s*: ([\d.]+) s')
+
+
+def setup(args):
+    return [
+        'M353 B1',                          # One bed
+        'M305 H-1 S1 A100000 B4092 R4700',  # EPCOS 100k on the bed
+        'M306 H-1 W%d' % args.bed_watts,
+        'M306 H0 W%d' % args.hotend_watts,
+        'G4 S1',                            # The bed sensor settles
+    ]
+
+
+def scenarios(args):
+    bed, hotend = 'M190 S%d' % args.bed, 'M109 S%d' % args.hotend
+    start = ['M140 S%d' % args.bed, 'M104 S%d' % args.hotend]
+    return [
+        ('sequential', ['M1007 S%d' % args.budget, bed, hotend]),
+        ('budget', ['M1007 S%d' % args.budget] + start + [bed, hotend]),
+        ('no budget', ['M1007 S0'] + start + [bed, hotend]),
+    ]
+
+
+def run(args, lines):
+    with tempfile.TemporaryDirectory() as tmp:
+        gcode = os.path.join(tmp, 'heat.gcode')
+        with open(gcode, 'w') as f:
+            f.write('\n'.join(setup(args) + lines + ['M1007']) + '\n')
+        out = subprocess.run([os.path.abspath(args.bin), '-T', str(args.scale), '-e', os.path.join(tmp, 'eeprom.bin'),
+                              gcode], check=True, stdout=subprocess.PIPE, stderr=subprocess.STDOUT,
+                             universal_newlines=True).stdout
+    if 'Power budget W:' not in out:
+        sys.exit('%s has no M1007, build it with DEFINES="-DPOWER_BUDGET"' % args.bin)
+    heated = {m.group(1): float(m.group(3)) for m in HEATED.finditer(out)}
+    power = [float(x) for x in POWER.search(out).groups() + OVER.search(out).groups()]
+    errors = [l for l in out.splitlines() if l.startswith('Error:')]
+    return float(SIMULATED.search(out).group(1)), heated, power, errors
+
+
+def main():
+    parser = argparse.ArgumentParser(description='MK4duo power budget heat-up')
+    parser.add_argument('--bin', required=True, help='native executable built with POWER_BUDGET')
+    parser.add_argument('--budget', type=int, default=240, help='watts of the supply for the heaters')
+    parser.add_argument('--bed', type=int, default=60, help='bed target')
+    parser.add_argument('--hotend', type=int, default=210, help='hotend target')
+    parser.add_argument('--bed-watts', type=int, default=220)
+    parser.add_argument('--hotend-watts', type=int, default=40)
+    parser.add_argument('--scale', type=float, default=10.0, help='time constants of the thermal model times this')
+    args = parser.parse_args()
+
+    print('Budget %d W, bed %d W to %d degC, hotend %d W to %d degC, thermal model x%g' % (
+        args.budget, args.bed_watts, args.bed, args.hotend_watts, args.hotend, args.scale))
+    print('%-11s %8s %8s %8s %8s %8s %8s %10s' % ('run', 'bed s', 'hotend s', 'ready s', 'mean W', 'window W',
+                                                  'over ms', 'together'))
+    # The setup alone, taken off the time of each run
+    setup_s = run(args, [])[0]
+    ready = {}
+    ok = True
+    for name, lines in scenarios(args):
+        simulated, heated, (mean, window, over, together), errors = run(args, lines)
+        bed, hotend = heated.get('Bed'), heated.get('Hotend')
+        ready[name] = simulated - setup_s
+        # Without the budget the simulator has no limit to be over
+        over, together = ('-', '-') if name == 'no budget' else ('%.0f' % over, '%.0f' % together)
+        print('%-11s %8s %8s %8.1f %8.1f %8.1f %8s %10s' % (
+            name, '%.1f' % bed if bed is not None else '-', '%.1f' % hotend if hotend is not None else '-',
+            ready[name], mean, window, over, together))
+        for e in errors:
+            print('  ' + e)
+        if name == 'budget':
+            ok = bed is not None and hotend is not None and not errors and window <= args.budget and \
+                int(over) < int(together)
+            if not ok:
+                print('  the budget run failed')
+
+    saved = ready['sequential'] - ready['budget']
+    print('Heat-up with the budget: %.1f s saved, %.0f%% of the sequential start' % (
+        saved, 100.0 * saved / ready['sequential'] if ready['sequential'] else 0.0))
+    return 0 if ok else 1
+
+
+if __name__ == '__main__':
+    sys.exit(main())
@@ -0,0 +1,191 @@
+#!/usr/bin/python3
+
+# Input shaping tool for MK4duo (INPUT_SHAPING)
+#
+#   inputshaper.py impulses --type mzv --freq 40 [--damping 0.1]
+#   inputshaper.py simulate --bin mk4duo_native [--type mzv --freq 40 --damping 0.1]
+#                           [--move "G1 X40 F12000"] [--axis X] [--csv out.csv]
+#
+# impulses prints the amplitudes and delays of a shaper, the same values the
+# firmware computes, and the vibration left at frequencies around the design
+# one (100% = no shaping).
+#
+# simulate runs a test move through the native executable (built with
+# INPUT_SHAPING) once without and once with the shaper, reads the two step
+# traces and drives a damped oscillator with the motor position to show the
+# ringing of the toolhead after the move. The machine resonance is the one
+# given with --freq and --damping unless --machine-freq / --machine-damping
+# say otherwise. --csv writes the motor and toolhead positions over time.
+
+import argparse
+import math
+import os
+import subprocess
+import sys
+import tempfile
+
+from steptrace import Trace
+
+SHAPERS = {'none': 0, 'zv': 1, 'zvd': 2, 'mzv': 3, 'ei': 4}
+
+
+def impulses(shaper, freq, damping):
+    # Same as InputShaper::set_impulses()
+    if shaper == 'none' or freq <= 0:
+        return [1.0], [0.0]
+    df = math.sqrt(1.0 - damping ** 2)
+    k = math.exp(-damping * math.pi / df)
+    td = 1.0 / (freq * df)
+    if shaper == 'zv':
+        a, t = [1.0, k], [0.0, 0.5 * td]
+    elif shaper == 'zvd':
+        a, t = [1.0, 2.0 * k, k * k], [0.0, 0.5 * td, td]
+    elif shaper == 'mzv':
+        km = math.exp(-0.75 * damping * math.pi / df)
+        a1 = 1.0 - 1.0 / math.sqrt(2.0)
+        a, t = [a1, (math.sqrt(2.0) - 1.0) * km, a1 * km * km], [0.0, 0.375 * td, 0.75 * td]
+    else:
+        v_tol = 0.05
+        a1 = 0.25 * (1.0 + v_tol)
+        a, t = [a1, 0.5 * (1.0 - v_tol) * k, a1 * k * k], [0.0, 0.5 * td, td]
+    s = sum(a)
+    return [x / s for x in a], t
+
+
+def residual(a, t, freq, damping):
+    # Vibration left by the impulses on a mode, relative to a single impulse
+    w = 2.0 * math.pi * freq
+    wd = w * math.sqrt(1.0 - damping ** 2)
+    end = t[-1]
+    c = sum(ai * math.exp(-damping * w * (end - ti)) * math.cos(wd * ti) for ai, ti in zip(a, t))
+    s = sum(ai * math.exp(-damping * w * (end - ti)) * math.sin(wd * ti) for ai, ti in zip(a, t))
+    return math.sqrt(c * c + s * s)
+
+
+def cmd_impulses(args):
+    a, t = impulses(args.type, args.freq, args.damping)
+    print('%s %.1f Hz damping %.3f' % (args.type.upper(), args.freq, args.damping))
+    print('%8s %10s %10s' % ('impulse', 'amplitude', 'delay ms'))
+    for i, (ai, ti) in enumerate(zip(a, t)):
+        print('%8d %10.4f %10.3f' % (i, ai, ti * 1000.0))
+    print()
+    print('%10s %10s' % ('mode Hz', 'vibration'))
+    for r in range(5, 16):
+        f = args.freq * r / 10.0
+        print('%10.1f %9.1f%%' % (f, 100.0 * residual(a, t, f, args.damping)))
+    return 0
+
+
+def run_move(binary, shaper, args, trace):
+    gcode = 'G92 X0 Y0 Z0\nG1 X0 Y0 F1200\nM593 T%d F%g D%g\n%s\nM400\nG4 P500\n' % (
+        SHAPERS[shaper], args.freq, args.damping, args.move)
+    with tempfile.TemporaryDirectory() as tmp:
+        path = os.path.join(tmp, 'move.gcode')
+        with open(path, 'w') as f:
+            f.write(gcode)
+        subprocess.run([os.path.abspath(binary), '-q', '-e', os.path.join(tmp, 'eeprom.bin'), '-t', trace, path],
+                       check=True, stdout=subprocess.DEVNULL, stderr=subprocess.DEVNULL)
+    return Trace(trace)
+
+
+def motor_samples(trace, axis, dt, start, end, steps_per_mm):
+    # Motor position in mm every dt seconds
+    times = [x / trace.rate for x in trace.times[axis]]
+    signs = trace.signs[axis]
+    out = []
+    pos, i = 0.0, 0
+    t = start
+    while t <= end:
+        while i < len(times) and times[i] <= t:
+            pos += signs[i] / steps_per_mm
+            i += 1
+        out.append(pos)
+        t += dt
+    return out
+
+
+def oscillate(u, dt, freq, damping):
+    # Toolhead on a spring driven by the motor: x'' = w^2 (u - x) - 2 z w x'
+    w = 2.0 * math.pi * freq
+    x, v = u[0], 0.0
+    out = []
+    for ui in u:
+        v += (w * w * (ui - x) - 2.0 * damping * w * v) * dt
+        x += v * dt
+        out.append(x)
+    return out
+
+
+def cmd_simulate(args):
+    axis = 'XY'.index(args.axis)
+    mfreq = args.machine_freq or args.freq
+    mdamp = args.damping if args.machine_damping is None else args.machine_damping
+    with tempfile.TemporaryDirectory() as tmp:
+        plain = run_move(args.bin, 'none', args, os.path.join(tmp, 'plain.trc'))
+        shaped = run_move(args.bin, args.type, args, os.path.join(tmp, 'shaped.trc'))
+
+    if not plain.times[axis]:
+        print('No %s steps in the test move' % args.axis)
+        return 1
+
+    dt = 1e-5
+    start = min(plain.times[axis][0], shaped.times[axis][0]) / plain.rate - 0.005
+    stop_plain = plain.times[axis][-1] / plain.rate
+    stop_shaped = shaped.times[axis][-1] / shaped.rate
+    end = max(stop_plain, stop_shaped) + 0.3
+
+    series = []
+    for trace in (plain, shaped):
+        u = motor_samples(trace, axis, dt, start, end, args.steps_per_mm)
+        series.append((u, oscillate(u, dt, mfreq, mdamp)))
+
+    a, t = impulses(args.type, args.freq, args.damping)
+    print('Shaper %s %.1f Hz damping %.3f, delays %s ms' % (
+        args.type.upper(), args.freq, args.damping, ' '.join('%.2f' % (x * 1000.0) for x in t)))
+    print('Machine %.1f Hz damping %.3f, %s axis, move "%s"' % (mfreq, mdamp, args.axis, args.move))
+    print('%-8s %8s %10s %12s %14s' % ('', 'steps', 'move ms', 'last step ms', 'ringing mm'))
+    for name, trace, stop, (u, x) in (('plain', plain, stop_plain, series[0]), ('shaped', shaped, stop_shaped, series[1])):
+        first = int((stop - start) / dt)
+        ring = max(abs(xi - u[-1]) for xi in x[first:])
+        print('%-8s %8d %10.2f %12.2f %14.4f' % (
+            name, len(trace.times[axis]), (stop - trace.times[axis][0] / trace.rate) * 1000.0,
+            (stop - start) * 1000.0, ring))
+
+    if args.csv:
+        with open(args.csv, 'w') as f:
+            f.write('time_ms,motor_plain,toolhead_plain,motor_shaped,toolhead_shaped\n')
+            for i in range(0, len(series[0][0]), 10):
+                f.write('%.3f,%.4f,%.4f,%.4f,%.4f\n' % (
+                    i * dt * 1000.0, series[0][0][i], series[0][1][i], series[1][0][i], series[1][1][i]))
+    return 0
+
+
+def main():
+    parser = argparse.ArgumentParser(description='MK4duo input shaping tool')
+    sub = parser.add_subparsers(dest='cmd', required=True)
+
+    p = sub.add_parser('impulses', help='print the impulses of a shaper')
+    p.add_argument('--type', choices=list(SHAPERS), default='mzv')
+    p.add_argument('--freq', type=float, required=True)
+    p.add_argument('--damping', type=float, default=0.1)
+
+    p = sub.add_parser('simulate', help='ringing of a test move without and with the shaper')
+    p.add_argument('--bin', required=True, help='native executable built with INPUT_SHAPING')
+    p.add_argument('--type', choices=list(SHAPERS), default='mzv')
+    p.add_argument('--freq', type=float, default=40.0)
+    p.add_argument('--damping', type=float, default=0.1)
+    p.add_argument('--machine-freq', type=float, default=0.0)
+    p.add_argument('--machine-damping', type=float)
+    p.add_argument('--move', default='G1 X40 F12000')
+    p.add_argument('--axis', choices=['X', 'Y'], default='X')
+    p.add_argument('--steps-per-mm', type=float, default=80.0)
+    p.add_argument('--csv')
+
+    args = parser.parse_args()
+    if args.cmd == 'impulses':
+        return cmd_impulses(args)
+    return cmd_simulate(args)
+
+
+if __name__ == '__main__':
+    sys.exit(main())
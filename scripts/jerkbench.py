@@ -0,0 +1,93 @@
+#!/usr/bin/python3
+
+# Jerk control benchmark for the MK4duo host native build (src/platform/HAL_NATIVE)
+#
+# Runs the same moves through native executables built with
+# STEPPER_ISR_PROFILER and one of BEZIER_JERK_CONTROL / S_CURVE_JERK_CONTROL
+# (or none), and reports for each one the block phase cycles of the stepper
+# ISR (where the speed curve is evaluated) per step event and the peak step
+# rate reached.
+#
+#   jerkbench.py --bin trapezoid=mk_plain --bin bezier=mk_bz --bin scurve=mk_sc
+#                [--steps-per-mm 80] [--feedrate 30000] [--accel 3000] [--gcode moves.gcode]
+#
+# The default moves are long back and forth X moves at the given feedrate,
+# so the step rate limit of each ISR is reached. Cycles are host cycles, good
+# to compare the builds with each other, not the cycles of a real board.
+
+import argparse
+import os
+import re
+import subprocess
+import sys
+import tempfile
+
+from steptrace import Trace
+
+WINDOW = 64     # Steps averaged for the peak step rate
+
+
+def default_moves(args):
+    lines = ['G1 X%d F%d' % (200 if i % 2 == 0 else 0, args.feedrate) for i in range(args.moves)]
+    # Short zig-zag moves, mostly acceleration and deceleration
+    lines += ['G1 X%d Y%d F%d' % (10 + 2 * i, 10 + (i % 2) * 2, args.feedrate) for i in range(args.moves * 20)]
+    return '\n'.join(lines)
+
+
+def run(binary, moves, args, tmp):
+    gcode = 'M92 X%g Y%g\nM201 X%d Y%d\nM203 X%d Y%d\nM204 P%d T%d\nG92 X0 Y0 Z0\nM400\nM1002 R\n%s\nM400\nM1002\n' % (
+        args.steps_per_mm, args.steps_per_mm, args.accel, args.accel,
+        args.feedrate // 60, args.feedrate // 60, args.accel, args.accel, moves)
+    path = os.path.join(tmp, 'moves.gcode')
+    trace = os.path.join(tmp, 'moves.trc')
+    with open(path, 'w') as f:
+        f.write(gcode)
+    out = subprocess.run([os.path.abspath(binary), '-e', os.path.join(tmp, 'eeprom.bin'), '-t', trace, path],
+                         check=True, stdout=subprocess.PIPE, stderr=subprocess.DEVNULL).stdout.decode(errors='replace')
+    block = re.findall(r'Block count:(\d+) min:(\d+) avg:(\d+) max:(\d+)', out)
+    if not block:
+        raise RuntimeError(binary + ': no M1002 report, build it with STEPPER_ISR_PROFILER')
+    return [int(x) for x in block[-1]], Trace(trace)
+
+
+def peak_rate(trace):
+    best = 0.0
+    for times in trace.times:
+        for i in range(WINDOW, len(times)):
+            span = times[i] - times[i - WINDOW]
+            if span > 0:
+                best = max(best, WINDOW * trace.rate / float(span))
+    return best
+
+
+def main():
+    parser = argparse.ArgumentParser(description='MK4duo jerk control benchmark')
+    parser.add_argument('--bin', action='append', required=True, help='name=executable, repeat for each build')
+    parser.add_argument('--gcode', help='moves to run instead of the default ones')
+    parser.add_argument('--steps-per-mm', type=float, default=80.0)
+    parser.add_argument('--feedrate', type=int, default=30000)
+    parser.add_argument('--accel', type=int, default=3000)
+    parser.add_argument('--moves', type=int, default=6)
+    args = parser.parse_args()
+
+    if args.gcode:
+        with open(args.gcode) as f:
+            moves = f.read()
+    else:
+        moves = default_moves(args)
+
+    print('%-10s %10s %10s %10s %10s %12s %14s' % (
+        'build', 'steps', 'ISR calls', 'avg cyc', 'max cyc', 'cyc/step', 'peak steps/s'))
+    for item in args.bin:
+        name, _, binary = item.rpartition('=')
+        name = name or os.path.basename(binary)
+        with tempfile.TemporaryDirectory() as tmp:
+            (count, _, avg, high), trace = run(binary, moves, args, tmp)
+        steps = sum(len(t) for t in trace.times)
+        print('%-10s %10d %10d %10d %10d %12.1f %14.0f' % (
+            name, steps, count, avg, high, float(avg * count) / max(steps, 1), peak_rate(trace)))
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
@@ -0,0 +1,98 @@
+#!/usr/bin/python3
+
+# Segment merge benchmark for the MK4duo host native build (src/platform/HAL_NATIVE)
+#
+# Runs the same curved perimeters, cut in tiny segments the way slicers do,
+# through a native executable without and one with PLANNER_SEGMENT_MERGE, and
+# reports the move time, the blocks queued (M1003) and how far the steps went
+# from the ideal curve.
+#
+#   mergebench.py --plain mk_plain --merge mk_merge [--radius 20] [--segment 0.2]
+#                 [--feedrate 6000] [--laps 2] [--steps-per-mm 80]
+#
+# The perimeters are circles around X100 Y100, with extrusion. The path error
+# is the largest distance of the XY steps from the circle, it includes the
+# step resolution and the chords of the segments themselves.
+
+import argparse
+import math
+import os
+import re
+import subprocess
+import sys
+import tempfile
+
+from steptrace import Trace
+
+CENTER = (100.0, 100.0)
+
+
+def perimeters(args):
+    count = int(2 * math.pi * args.radius / args.segment)
+    lines = ['G92 X0 Y0 Z0 E0', 'M302 P1', 'M92 X%g Y%g' % (args.steps_per_mm, args.steps_per_mm),
+             'G1 X%.3f Y%.3f F6000' % (CENTER[0] + args.radius, CENTER[1]), 'M400', 'M1003 R']
+    e = 0.0
+    for i in range(1, count * args.laps + 1):
+        a = 2 * math.pi * i / count
+        e += args.segment * 0.033
+        lines.append('G1 X%.3f Y%.3f E%.4f F%d' % (
+            CENTER[0] + args.radius * math.cos(a), CENTER[1] + args.radius * math.sin(a), e, args.feedrate))
+    lines += ['M400', 'M1003']
+    return '\n'.join(lines) + '\n'
+
+
+def path_error(trace, args):
+    # Largest distance of the XY steps from the circle, once on it
+    events = sorted([(t, 0, s) for t, s in zip(trace.times[0], trace.signs[0])] +
+                    [(t, 1, s) for t, s in zip(trace.times[1], trace.signs[1])])
+    pos = [0, 0]
+    start = round((CENTER[0] + args.radius) * args.steps_per_mm)
+    on_circle = False
+    worst = 0.0
+    for _, axis, sign in events:
+        pos[axis] += sign
+        if not on_circle:
+            on_circle = pos[0] == start and pos[1] == round(CENTER[1] * args.steps_per_mm)
+            continue
+        r = math.hypot(pos[0] / args.steps_per_mm - CENTER[0], pos[1] / args.steps_per_mm - CENTER[1])
+        worst = max(worst, abs(r - args.radius))
+    return worst
+
+
+def run(binary, gcode, args, tmp, name):
+    path = os.path.join(tmp, name + '.gcode')
+    trace = os.path.join(tmp, name + '.trc')
+    with open(path, 'w') as f:
+        f.write(gcode)
+    out = subprocess.run([os.path.abspath(binary), '-e', os.path.join(tmp, name + '.bin'), '-t', trace, path],
+                         check=True, stdout=subprocess.PIPE, stderr=subprocess.DEVNULL).stdout.decode(errors='replace')
+    stats = re.findall(r'Segments:(\d+) joined:(\d+) blocks:(\d+) max joined:(\d+)', out)
+    t = Trace(trace)
+    return t, (stats[-1] if stats else None)
+
+
+def main():
+    parser = argparse.ArgumentParser(description='MK4duo segment merge benchmark')
+    parser.add_argument('--plain', required=True, help='native executable without PLANNER_SEGMENT_MERGE')
+    parser.add_argument('--merge', required=True, help='native executable built with PLANNER_SEGMENT_MERGE')
+    parser.add_argument('--radius', type=float, default=20.0)
+    parser.add_argument('--segment', type=float, default=0.2, help='segment length in mm')
+    parser.add_argument('--feedrate', type=int, default=6000)
+    parser.add_argument('--laps', type=int, default=2)
+    parser.add_argument('--steps-per-mm', type=float, default=80.0)
+    args = parser.parse_args()
+
+    gcode = perimeters(args)
+    print('Circle r=%g mm, %g mm segments, F%d, %d laps' % (args.radius, args.segment, args.feedrate, args.laps))
+    print('%-6s %10s %10s %10s %12s %14s' % ('build', 'segments', 'blocks', 'max join', 'move time s', 'path error mm'))
+    with tempfile.TemporaryDirectory() as tmp:
+        for name, binary in (('plain', args.plain), ('merge', args.merge)):
+            trace, stats = run(binary, gcode, args, tmp, name)
+            segments, _, blocks, most = stats if stats else ('-', '-', '-', '-')
+            print('%-6s %10s %10s %10s %12.3f %14.4f' % (
+                name, segments, blocks, most, trace.end / trace.rate, path_error(trace, args)))
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
@@ -0,0 +1,115 @@
+#!/usr/bin/python3
+
+# Fixed point planner check for the MK4duo host native build (src/platform/HAL_NATIVE)
+#
+# Runs the same moves through a native executable with the float planner and
+# one built with PLANNER_FIXED_POINT, both with STEPPER_ISR_PROFILER, checks
+# that the two step traces are equivalent and reports the cycles spent in the
+# planner recalculate (M1002 "Planner") of each one.
+#
+#   plannerbench.py --float mk_float --fixed mk_fixed [--gcode moves.gcode]
+#                   [--tolerance 0.2] [--seed 1] [--moves 400]
+#
+# The default moves are short arc segments, zig-zags and random moves at
+# random feedrates, the lookahead heavy kind. Equivalent means the same steps
+# with the same directions on every axis and a move time that differs by less
+# than --tolerance percent, the step times may move a little as the fixed
+# point speeds are rounded. Cycles are host cycles: a host has a FPU, the gain
+# of the fixed point kernels is on the AVR, where the float math is software.
+#
+# Exit code is 0 when the traces are equivalent, 1 otherwise.
+
+import argparse
+import math
+import os
+import random
+import re
+import subprocess
+import sys
+import tempfile
+
+from steptrace import Trace, AXIS_NAMES
+
+
+def default_moves(args):
+    rng = random.Random(args.seed)
+    lines = []
+    # Arc segments
+    for i in range(args.moves):
+        a = i * 0.04
+        lines.append('G1 X%.3f Y%.3f F%d' % (100 + 40 * math.cos(a), 100 + 40 * math.sin(a), rng.choice((3000, 6000, 9000))))
+    # Zig-zags
+    for i in range(args.moves):
+        lines.append('G1 X%.3f Y%.3f F%d' % (60 + 0.5 * i % 80, 60 + (i % 2) * 1.5, 6000))
+    # Random moves, with some extrusion
+    for i in range(args.moves):
+        lines.append('G1 X%.3f Y%.3f E%.4f F%d' % (
+            rng.uniform(20, 180), rng.uniform(20, 180), i * 0.05, rng.randrange(600, 12000)))
+    return '\n'.join(lines)
+
+
+def run(binary, moves, tmp, name):
+    gcode = 'G92 X0 Y0 Z0 E0\nM302 P1\nM400\nM1002 R\n%s\nM400\nM1002\n' % moves
+    path = os.path.join(tmp, name + '.gcode')
+    trace = os.path.join(tmp, name + '.trc')
+    with open(path, 'w') as f:
+        f.write(gcode)
+    out = subprocess.run([os.path.abspath(binary), '-e', os.path.join(tmp, name + '.bin'), '-t', trace, path],
+                         check=True, stdout=subprocess.PIPE, stderr=subprocess.DEVNULL).stdout.decode(errors='replace')
+    planner = re.findall(r'Planner count:(\d+) min:(\d+) avg:(\d+) max:(\d+)', out)
+    if not planner:
+        raise RuntimeError(binary + ': no M1002 planner report, build it with STEPPER_ISR_PROFILER')
+    return [int(x) for x in planner[-1]], Trace(trace)
+
+
+def equivalent(a, b, tolerance):
+    ok = True
+    us = 1e6 / a.rate
+    print('%-4s %10s %10s %8s %12s' % ('Axis', 'Steps A', 'Steps B', 'Dir err', 'Max dev'))
+    for axis, name in enumerate(AXIS_NAMES[:len(a.times)]):
+        ta, tb = a.times[axis], b.times[axis]
+        if not ta and not tb:
+            continue
+        dir_err = sum(1 for sa, sb in zip(a.signs[axis], b.signs[axis]) if sa != sb)
+        max_dev = max((abs(x - y) for x, y in zip(ta, tb)), default=0)
+        print('%-4s %10d %10d %8d %9.1f us' % (name, len(ta), len(tb), dir_err, max_dev * us))
+        if len(ta) != len(tb) or dir_err:
+            ok = False
+    diff = 100.0 * (b.end - a.end) / max(a.end, 1)
+    print('Move time: %.6f s / %.6f s (%+.3f%%)' % (a.end / a.rate, b.end / b.rate, diff))
+    if abs(diff) > tolerance:
+        ok = False
+    return ok
+
+
+def main():
+    parser = argparse.ArgumentParser(description='MK4duo fixed point planner check')
+    parser.add_argument('--float', required=True, help='native executable with the float planner')
+    parser.add_argument('--fixed', required=True, help='native executable built with PLANNER_FIXED_POINT')
+    parser.add_argument('--gcode', help='moves to run instead of the default ones')
+    parser.add_argument('--tolerance', type=float, default=0.2, help='allowed move time difference in percent')
+    parser.add_argument('--seed', type=int, default=1)
+    parser.add_argument('--moves', type=int, default=400)
+    args = parser.parse_args()
+
+    if args.gcode:
+        with open(args.gcode) as f:
+            moves = f.read()
+    else:
+        moves = default_moves(args)
+
+    with tempfile.TemporaryDirectory() as tmp:
+        (count_a, _, avg_a, max_a), trace_a = run(args.float, moves, tmp, 'float')
+        (count_b, _, avg_b, max_b), trace_b = run(args.fixed, moves, tmp, 'fixed')
+
+    ok = equivalent(trace_a, trace_b, args.tolerance)
+    print('EQUIVALENT' if ok else 'DIFFERENT')
+    print()
+    print('%-6s %10s %10s %10s' % ('build', 'recalcs', 'avg cyc', 'max cyc'))
+    print('%-6s %10d %10d %10d' % ('float', count_a, avg_a, max_a))
+    print('%-6s %10d %10d %10d' % ('fixed', count_b, avg_b, max_b))
+    return 0 if ok else 1
+
+
+if __name__ == '__main__':
+    sys.exit(main())
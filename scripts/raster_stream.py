@@ -0,0 +1,243 @@
+#!/usr/bin/python3
+
+# Raster streaming tool for MK4duo laser engraving (LASER_RASTER_STREAM)
+#
+# A raster image is sent one row at a time, either as the classic base64 text
+# line "G7 $1 L<len> D<base64>" or as the binary line "M652 P<pixels> C<crc> $1"
+# followed by the raw pixel bytes. The binary form sends 3/4 of the bytes and
+# the firmware skips the base64 decoding.
+#
+#   raster_stream.py encode image.pgm --out job.gcode [--format binary|base64] [--width PIXELS]
+#   raster_stream.py send   job.gcode --port /dev/ttyACM0 [--baud 250000]
+#   raster_stream.py bench  [--bin mk4duo_native] [--port /dev/ttyACM0] [--rows 40] [--width 51]
+#
+# encode reads a binary PGM (P5) image, one byte per pixel, 0 is no power.
+# send streams a job to a printer and waits for "raster:ready" before the
+# pixels of every M652 line (needs pyserial).
+# bench encodes the same random image both ways and reports the pixels per
+# second through the native executable and / or a real printer, together with
+# the pixels per second the serial link itself allows.
+#
+# The header line must end with a single '\n': the firmware stops reading
+# lines right after it and the next byte is the first pixel.
+
+import argparse
+import base64
+import os
+import random
+import subprocess
+import sys
+import tempfile
+import time
+
+G7_MAX_RAW = 68         # LASER_MAX_RASTER_LINE, base64 characters for G7
+M652_MAX_PIXELS = 68    # LASER_MAX_RASTER_LINE, pixel bytes for M652
+SETUP = b'G28\nM649 S50 B2 R0.2 D0 F3000\nG0 X10 Y10 F6000\n'
+
+
+def crc16(data, crc=0):
+    # CRC16 CCITT (0x1021), same as crc16() in core/utility/utility.cpp
+    for b in data:
+        crc ^= b << 8
+        for _ in range(8):
+            crc = ((crc << 1) ^ 0x1021) if crc & 0x8000 else (crc << 1)
+            crc &= 0xFFFF
+    return crc
+
+
+def read_pgm(path):
+    with open(path, 'rb') as f:
+        data = f.read()
+    fields = []
+    pos = 0
+    while len(fields) < 4:
+        while data[pos:pos + 1].isspace():
+            pos += 1
+        if data[pos:pos + 1] == b'#':
+            pos = data.index(b'\n', pos)
+            continue
+        end = pos
+        while not data[end:end + 1].isspace():
+            end += 1
+        fields.append(data[pos:end])
+        pos = end
+    if fields[0] != b'P5' or int(fields[3]) > 255:
+        raise ValueError(path + ': only 8 bit binary PGM (P5) is supported')
+    width, height = int(fields[1]), int(fields[2])
+    pixels = data[pos + 1:pos + 1 + width * height]
+    # PGM is white = 255, the laser is off at 0
+    return [bytes(255 - p for p in pixels[r * width:(r + 1) * width]) for r in range(height)]
+
+
+def split_row(row, size):
+    return [row[i:i + size] for i in range(0, len(row), size)]
+
+
+def encode_rows(rows, fmt):
+    # Rows go back and forth
+    out = bytearray(SETUP)
+    for n, row in enumerate(rows):
+        direction = 1 if n % 2 == 0 else 0
+        if fmt == 'binary':
+            chunks = split_row(row, M652_MAX_PIXELS)
+        else:
+            chunks = split_row(row, G7_MAX_RAW // 4 * 3)
+        if direction == 0:
+            chunks = [c[::-1] for c in reversed(chunks)]
+        for i, chunk in enumerate(chunks):
+            # Only the first segment steps to the next row
+            key = b' $%d' % direction if i == 0 else b''
+            if fmt == 'binary':
+                out += b'M652 P%d C%d%s\n' % (len(chunk), crc16(chunk), key)
+                out += chunk
+            else:
+                text = base64.b64encode(chunk)
+                out += b'G7%s L%d D%s\n' % (key, len(text), text)
+    return bytes(out)
+
+
+def job_pixels(job):
+    # Pixels and wire bytes of the raster lines of a job
+    pixels = 0
+    pos = 0
+    while pos < len(job):
+        end = job.index(b'\n', pos)
+        line = job[pos:end]
+        pos = end + 1
+        if line.startswith(b'M652'):
+            count = int(line.split()[1][1:])
+            pixels += count
+            pos += count
+        elif line.startswith(b'G7'):
+            pixels += len(base64.b64decode(line.split(b' D')[1]))
+    return pixels
+
+
+def cmd_encode(args):
+    rows = read_pgm(args.image)
+    if args.width:
+        rows = [r[:args.width] for r in rows]
+    with open(args.out, 'wb') as f:
+        f.write(encode_rows(rows, args.format))
+    return 0
+
+
+def open_port(port, baud):
+    import serial
+    ser = serial.Serial(port, baud, timeout=10)
+    time.sleep(2)
+    ser.reset_input_buffer()
+    return ser
+
+
+def wait_for(ser, token):
+    while True:
+        line = ser.readline()
+        if not line:
+            raise TimeoutError('no answer from printer')
+        if line.startswith(token):
+            return line
+        if line.startswith(b'Error') or line.startswith(b'echo:Unknown'):
+            sys.stderr.write(line.decode(errors='replace'))
+
+
+def stream(ser, job):
+    # Ping-pong on "ok", the pixels of M652 go after "raster:ready"
+    pos = 0
+    while pos < len(job):
+        end = job.index(b'\n', pos) + 1
+        line = job[pos:end]
+        pos = end
+        ser.write(line)
+        if line.startswith(b'M652'):
+            count = int(line.split()[1][1:])
+            wait_for(ser, b'raster:ready')
+            ser.write(job[pos:pos + count])
+            pos += count
+        wait_for(ser, b'ok')
+    ser.write(b'M400\n')
+    wait_for(ser, b'ok')
+
+
+def cmd_send(args):
+    with open(args.job, 'rb') as f:
+        job = f.read()
+    ser = open_port(args.port, args.baud)
+    start = time.time()
+    stream(ser, job)
+    elapsed = time.time() - start
+    print('%d pixels in %.2f s, %.0f pixels/s' % (job_pixels(job), elapsed, job_pixels(job) / elapsed))
+    return 0
+
+
+def run_native(binary, job):
+    with tempfile.NamedTemporaryFile(suffix='.gcode', delete=False) as f:
+        f.write(job)
+        path = f.name
+    try:
+        start = time.time()
+        subprocess.run([binary, '-q', path], check=True, stdout=subprocess.DEVNULL, stderr=subprocess.DEVNULL)
+        return time.time() - start
+    finally:
+        os.unlink(path)
+
+
+def cmd_bench(args):
+    rng = random.Random(args.seed)
+    rows = [bytes(rng.randrange(256) for _ in range(args.width)) for _ in range(args.rows)]
+    jobs = [(fmt, encode_rows(rows, fmt)) for fmt in ('base64', 'binary')]
+    pixels = args.rows * args.width
+    setup = len(SETUP)
+
+    print('%d rows of %d pixels, link %d baud' % (args.rows, args.width, args.baud))
+    print('%-7s %10s %12s %16s %16s %16s' % ('format', 'bytes', 'bytes/pixel', 'link px/s', 'native px/s', 'printer px/s'))
+    for fmt, job in jobs:
+        size = len(job) - setup
+        link = pixels / (size * 10.0 / args.baud)
+        native = '-'
+        if args.bin:
+            native = '%.0f' % (pixels / run_native(args.bin, job))
+        printer = '-'
+        if args.port:
+            ser = open_port(args.port, args.baud)
+            start = time.time()
+            stream(ser, job)
+            printer = '%.0f' % (pixels / (time.time() - start))
+            ser.close()
+        print('%-7s %10d %12.2f %16.0f %16s %16s' % (fmt, size, size / float(pixels), link, native, printer))
+    return 0
+
+
+def main():
+    parser = argparse.ArgumentParser(description='MK4duo raster streaming tool')
+    sub = parser.add_subparsers(dest='cmd')
+    sub.required = True
+
+    p = sub.add_parser('encode', help='encode a PGM image as raster lines')
+    p.add_argument('image')
+    p.add_argument('--out', required=True)
+    p.add_argument('--format', choices=['binary', 'base64'], default='binary')
+    p.add_argument('--width', type=int, default=0, help='crop rows to this many pixels')
+    p.set_defaults(func=cmd_encode)
+
+    p = sub.add_parser('send', help='stream a job to a printer')
+    p.add_argument('job')
+    p.add_argument('--port', required=True)
+    p.add_argument('--baud', type=int, default=250000)
+    p.set_defaults(func=cmd_send)
+
+    p = sub.add_parser('bench', help='compare base64 and binary raster lines')
+    p.add_argument('--bin', help='native executable built with LASER_RASTER_STREAM')
+    p.add_argument('--port', help='serial port of a printer')
+    p.add_argument('--baud', type=int, default=250000)
+    p.add_argument('--rows', type=int, default=40)
+    p.add_argument('--width', type=int, default=51)
+    p.add_argument('--seed', type=int, default=1)
+    p.set_defaults(func=cmd_bench)
+
+    args = parser.parse_args()
+    return args.func(args)
+
+
+if __name__ == '__main__':
+    sys.exit(main())
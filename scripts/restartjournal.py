@@ -0,0 +1,258 @@
+#!/usr/bin/python3
+
+# Power loss test and save latency for the MK4duo restart journal (SD_RESTART_JOURNAL, src/lib/journal.h)
+#
+# Builds a small host program with the host g++ around src/lib/journal.h and
+# a card in memory, then saves the restart data of a made up print the way
+# Restart::save_job() does, and cuts the power at a random block write:
+#
+#   journal  the write cut leaves the block in part new, in part old, erased
+#            or garbage. After the "reboot" Journal::replay() must give the
+#            state of one of the saves done before the cut, or of the one cut
+#            if its record got on the card whole, never one that was not
+#            saved. The print goes on saving from there with a second cut.
+#   file     the restart file as before, restart_job_t written whole over
+#            the last one, valid_head first and valid_foot last. A cut write
+#            leaves it invalid unless the new bytes got to the end.
+#
+#   restartjournal.py [--trials 2000] [--saves 400] [--blocks 8] [--seed 1]
+#                     [--read-ms 0.5] [--write-ms 1.5]
+#
+# The latency of a save is counted in block reads and writes, as SdFat does
+# them. The restart file is opened (the directory block read), written at 0
+# in part of its block (the block read first) with O_SYNC (the block written,
+# then the directory entry read and written). The journal is the directory
+# block read, to find the file is still there, and one block write.
+# Times are the blocks at --read-ms and --write-ms, the CPU time is left out.
+# Exit code is 0 when all replays are right.
+
+import argparse
+import os
+import subprocess
+import sys
+import tempfile
+
+HERE = os.path.dirname(os.path.abspath(__file__))
+LIB = os.path.join(HERE, '..', 'MK4duo', 'src', 'lib')
+
+HARNESS = r'''
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+// core/utility/utility.cpp
+void crc16(uint16_t *crc, const void * const data, uint16_t cnt) {
+  uint8_t *ptr = (uint8_t *)data;
+  while (cnt--) {
+    *crc = (uint16_t)(*crc ^ (uint16_t)(((uint16_t)*ptr++) << 8));
+    for (uint8_t i = 0; i < 8; i++)
+      *crc = (uint16_t)((*crc & 0x8000) ? ((uint16_t)(*crc << 1) ^ 0x1021) : (*crc << 1));
+  }
+}
+
+#include "journal.h"
+
+// restart_job_t of a DUE with 2 hotends, a bed, 2 fans and leveling
+typedef struct {
+  uint8_t   valid_head;
+  char      fileName[206];
+  uint32_t  sdpos;
+  float     axis_position_mm[4];
+  float     home_offset[3], position_shift[3];
+  uint16_t  feedrate;
+  int16_t   target_temperature[4], bed_target_temperature[4];
+  uint8_t   fan_speed[6];
+  uint8_t   active_extruder;
+  int16_t   flow_percentage[4], density_percentage[4];
+  bool      leveling;
+  float     z_fade_height;
+  uint8_t   axis_relative_modes;
+  uint32_t  print_job_counter_elapsed;
+  uint8_t   valid_foot;
+} job_t;
+
+#define FIRST   1000
+#define MAXSAVE 20000
+
+static uint32_t rng_state;
+static uint32_t rnd() { rng_state = rng_state * 1103515245 + 12345; return rng_state >> 8; }
+
+// SdSpiCard in memory, the power cut at a block write
+class Card {
+  public:
+    uint8_t blocks[256][512];
+    long writes, cut_at;
+    bool off;
+    uint8_t cut_kind;
+    bool readBlock(uint32_t b, uint8_t *dst) {
+      if (off) return false;
+      memcpy(dst, blocks[b - FIRST], 512);
+      return true;
+    }
+    bool writeBlock(uint32_t b, const uint8_t *src) {
+      if (off) return false;
+      uint8_t *dst = blocks[b - FIRST];
+      if (++writes == cut_at) {
+        const uint16_t n = rnd() % 512;
+        cut_kind = rnd() % 3;
+        memcpy(dst, src, n);
+        for (uint16_t i = n; i < 512; i++)
+          dst[i] = cut_kind == 0 ? dst[i] : cut_kind == 1 ? 0xFF : uint8_t(rnd());
+        off = true;
+        return false;
+      }
+      memcpy(dst, src, 512);
+      return true;
+    }
+};
+
+static Card card;
+static job_t states[MAXSAVE];
+static Journal<job_t, JOURNAL_BLOCKS> journal;
+
+// The print: sdpos on, position on, Z up now and then, temperatures and fan at times
+static void make_states(const int saves) {
+  job_t s;
+  memset(&s, 0, sizeof(s));
+  strcpy(s.fileName, "/prints/calibration_cube_0.2mm_PLA.gcode");
+  s.target_temperature[0] = 210; s.bed_target_temperature[0] = 60;
+  s.flow_percentage[0] = s.density_percentage[0] = 100;
+  s.axis_position_mm[2] = 0.2f;
+  for (int i = 0; i < saves; i++) {
+    if (!++s.valid_head) ++s.valid_head;
+    s.valid_foot = s.valid_head;
+    s.sdpos += 200 + rnd() % 4000;
+    s.axis_position_mm[0] = 10 + (rnd() % 20000) / 100.0f;
+    s.axis_position_mm[1] = 10 + (rnd() % 20000) / 100.0f;
+    s.axis_position_mm[3] += (rnd() % 1000) / 100.0f;
+    if (rnd() % 4 == 0) s.axis_position_mm[2] += 0.2f;
+    if (rnd() % 10 == 0) s.feedrate = 1200 + rnd() % 6000;
+    if (rnd() % 50 == 0) s.target_temperature[0] = 200 + rnd() % 30;
+    if (rnd() % 20 == 0) s.fan_speed[0] = rnd() % 256;
+    s.print_job_counter_elapsed += 1 + rnd() % 5;
+    states[i] = s;
+  }
+}
+
+// The save of the state replayed, -1 for none, -2 for one never saved
+static int which(const job_t &s, const int upto) {
+  for (int i = upto; i >= 0; i--) if (!memcmp(&states[i], &s, sizeof(s))) return i;
+  return -2;
+}
+
+static double now() {
+  timespec t;
+  clock_gettime(CLOCK_MONOTONIC, &t);
+  return t.tv_sec + t.tv_nsec * 1e-9;
+}
+
+int main(int argc, char **argv) {
+  const int trials = atoi(argv[1]), saves = atoi(argv[2]);
+  rng_state = atoi(argv[3]);
+  make_states(saves);
+
+  long bad = 0, exact = 0, lag_sum = 0, lag_max = 0, none = 0, total = 0;
+  long file_lost = 0;
+
+  for (int t = 0; t < trials; t++) {
+    // A card with the journal of an old print on it, then erased as made new
+    memset(card.blocks, 0xA5, sizeof(card.blocks));
+    card.off = false; card.writes = 0; card.cut_at = -1;
+    journal.reset(FIRST);
+    journal.erase(card);
+
+    // Two cuts: one in the print, one after the resume
+    int done = -1;
+    for (int round = 0; round < 2; round++) {
+      card.off = false;
+      card.writes = 0;
+      card.cut_at = 1 + rnd() % (saves / 2);
+      if (round) journal.open(card, FIRST);
+      int i = done + 1;
+      for (; i < saves && !card.off; i++) if (journal.append(card, states[i])) done = i;
+      // The write cut may have got the record of its save on the card whole
+      const int tried = card.off ? i - 1 : done;
+      // Reboot
+      card.off = false;
+      card.cut_at = -1;
+      Journal<job_t, JOURNAL_BLOCKS> * const boot = new Journal<job_t, JOURNAL_BLOCKS>();
+      job_t got;
+      boot->reset(FIRST);
+      const int w = boot->replay(card, got) ? which(got, tried) : -1;
+      delete boot;
+      total++;
+      if (w == -2 || (w == -1 && done >= 0)) bad++;
+      else if (w == -1) none++;
+      else {
+        if (w >= done) exact++;
+        else {
+          lag_sum += done - w;
+          if (done - w > lag_max) lag_max = done - w;
+        }
+        done = w;   // The print goes on from the state replayed
+      }
+      // The restart file: cut in the write of the save after the last one done
+      const uint16_t n = rnd() % 512;
+      if (n < sizeof(job_t)) file_lost++;
+    }
+  }
+
+  // CPU time and size of a save
+  card.off = false; card.cut_at = -1; card.writes = 0;
+  journal.reset(FIRST);
+  journal.erase(card);
+  card.writes = 0;
+  const double t0 = now();
+  for (int i = 0; i < saves; i++) journal.append(card, states[i]);
+  const double cpu = (now() - t0) / saves;
+  printf("%ld %ld %ld %ld %ld %ld %ld %.9f %ld %u\n", total, bad, exact, lag_sum, lag_max, none, file_lost, cpu,
+         card.writes, (unsigned)sizeof(job_t));
+  return bad ? 1 : 0;
+}
+'''
+
+
+def main():
+    parser = argparse.ArgumentParser(description='MK4duo restart journal power loss test')
+    parser.add_argument('--trials', type=int, default=2000)
+    parser.add_argument('--saves', type=int, default=400)
+    parser.add_argument('--blocks', type=int, default=8, help='SD_RESTART_JOURNAL_BLOCKS')
+    parser.add_argument('--seed', type=int, default=1)
+    parser.add_argument('--read-ms', type=float, default=0.5, help='time of a block read')
+    parser.add_argument('--write-ms', type=float, default=1.5, help='time of a block write')
+    args = parser.parse_args()
+
+    with tempfile.TemporaryDirectory() as tmp:
+        src = os.path.join(tmp, 'journal_harness.cpp')
+        exe = os.path.join(tmp, 'journal_harness')
+        with open(src, 'w') as f:
+            f.write(HARNESS)
+        subprocess.run(['g++', '-O2', '-std=gnu++11', '-DJOURNAL_BLOCKS=%d' % args.blocks, '-I', LIB, '-o', exe, src],
+                       check=True)
+        run = subprocess.run([exe, str(args.trials), str(args.saves), str(args.seed)],
+                             stdout=subprocess.PIPE, universal_newlines=True)
+    total, bad, exact, lag_sum, lag_max, none, file_lost, cpu, writes, size = run.stdout.split()
+    total, bad, exact, lag_sum, lag_max, none, file_lost, writes = (
+        int(x) for x in (total, bad, exact, lag_sum, lag_max, none, file_lost, writes))
+    cpu, size = float(cpu), int(size)
+    good = total - bad - none
+
+    print('Power cuts: %d, %d saves a print, %d blocks, restart_job_t of %d bytes' % (
+        total, args.saves, args.blocks, size))
+    print('  journal  %d replays right, %d never saved, %d with nothing saved yet' % (good + none, bad, none))
+    print('           last save back %.1f%%, %.2f saves lost on average, %d at most' % (
+        100.0 * exact / max(good, 1), lag_sum / max(good, 1), lag_max))
+    print('  file     %.1f%% of the cuts in a write leave no valid restart file' % (100.0 * file_lost / total))
+
+    old = 2 * args.read_ms + 2 * args.write_ms
+    new = args.read_ms + writes / args.saves * args.write_ms
+    print('Save latency: file 2 reads + 2 writes = %.2f ms, journal 1 read + %.2f writes = %.2f ms, %.1fx' % (
+        old, writes / args.saves, new, old / new))
+    print('  journal CPU on the host %.2f us a save' % (cpu * 1e6))
+    return 0 if run.returncode == 0 and not bad else 1
+
+
+if __name__ == '__main__':
+    sys.exit(main())
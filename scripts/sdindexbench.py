@@ -0,0 +1,308 @@
+#!/usr/bin/python3
+
+# SD directory index check and listing benchmark for MK4duo (SD_DIR_INDEX)
+#
+#   sdindexbench.py [--sizes 10,100,500,1000,2000] [--rows 4] [--limit 256]
+#                   [--read-ms 0.5] [--write-ms 1.0] [--changes 200] [--seed 1]
+#
+# A FAT directory is modelled as its 32 byte entries, long name parts
+# included, 16 to a block, and SdFat as its one block cache: a block is read
+# when an access is not in the block cached. For each directory size the
+# block reads of the LCD menu are counted:
+#
+#   sort   presort() when the directory is opened: bubble sort of up to
+#          --limit entries, the names read again by getfilename() for each
+#          compare (SDSORT_USES_RAM off, the DUE settings)
+#   index  presort() with SD_DIR_INDEX: the stamp of the directory checked,
+#          or the index made again, all of it or after one more file
+#   frame  a redraw of the menu at the top, get_num_Files() and one
+#          getfilename_sorted() for each of --rows rows
+#
+# Times are the blocks at --read-ms and --write-ms each, the time of the card
+# at SPI speed; the CPU time is left out.
+#
+# Before that the index is made as SDCard::index_build() does, through
+# --changes files added, removed and renamed, and its order checked against
+# the sorted names each time. Exit code is 0 when all orders are right.
+
+import argparse
+import random
+import sys
+
+ENTRY = 32
+BLOCK = 512
+PER_BLOCK = BLOCK // ENTRY
+HEADER = 16
+RECORD = 44                 # sd_index_entry_t on a 32 bit board
+FOLDER_SORTING = -1         # Folders above
+
+
+class Card:
+    # The one block cache of SdFat, block reads and writes counted
+    def __init__(self):
+        self.cached = None
+        self.reads = self.writes = 0
+
+    def touch(self, key):
+        if key != self.cached:
+            self.cached = key
+            self.reads += 1
+
+    def write(self, blocks):
+        self.writes += blocks
+        self.cached = None
+
+
+class Directory:
+    # Entries of a FAT directory: None for free, a name on the short entry
+    def __init__(self, rng):
+        self.rng = rng
+        self.slots = []             # (kind, name, is_dir): 'lfn' / 'sfn' / 'del'
+
+    def add(self, name, is_dir=False):
+        size = (len(name) + 12) // 13 + 1
+        run = 0
+        for i, s in enumerate(self.slots):
+            run = run + 1 if s[0] == 'del' else 0
+            if run == size:
+                start = i - size + 1
+                break
+        else:
+            start = len(self.slots)
+            self.slots += [('del', None, False)] * size
+        for i in range(size - 1):
+            self.slots[start + i] = ('lfn', name, is_dir)
+        self.slots[start + size - 1] = ('sfn', name, is_dir)
+
+    def remove(self, name):
+        for i, s in enumerate(self.slots):
+            if s[1] == name:
+                self.slots[i] = ('del', None, False)
+
+    def files(self):
+        # (dir_index, name, is_dir) in directory order, as openNext()
+        return [(i, s[1], s[2]) for i, s in enumerate(self.slots) if s[0] == 'sfn']
+
+    def stamp(self):
+        return hash(tuple(s for s in self.slots if s[0] != 'del'))
+
+    def blocks(self):
+        return (len(self.slots) + PER_BLOCK - 1) // PER_BLOCK
+
+    def walk(self, card, upto=None):
+        # openNext() to the upto-th file, all of them without
+        n = 0
+        for i, s in enumerate(self.slots):
+            card.touch(('dir', i // PER_BLOCK))
+            if s[0] == 'sfn':
+                if n == upto:
+                    return
+                n += 1
+
+
+def sort_class(is_dir):
+    return 1 if FOLDER_SORTING != 0 and is_dir == (FOLDER_SORTING > 0) else 0
+
+
+def casekey(name):
+    return name.lower().encode('latin-1')
+
+
+def ref_order(files):
+    return [f[1] for f in sorted(files, key=lambda f: (sort_class(f[2]), casekey(f[1])))]
+
+
+def key3(name, is_dir):
+    k = sort_class(is_dir)
+    b = casekey(name)[:3]
+    for i in range(3):
+        k = (k << 8) | (b[i] if i < len(b) else 0)
+    return k
+
+
+def index_build(directory, old, card=None):
+    # SDCard::index_build(): old is (entries, order) or None
+    files = directory.files()
+    entries = list(files)
+    old_entries, old_order = old if old else ([], [])
+    if card:
+        directory.walk(card)
+        card.write((HEADER + len(entries) * RECORD + BLOCK - 1) // BLOCK)
+    newpos = [None] * len(old_entries)
+    j = 0
+    for i, e in enumerate(entries):
+        while j < len(old_entries) and old_entries[j][0] < e[0]:
+            j += 1
+        if j < len(old_entries) and old_entries[j] == e:
+            newpos[j] = i
+    key = [key3(e[1], e[2]) for e in entries]
+    if card:
+        for i in range(len(entries)):
+            card.touch(('tmp', (HEADER + i * RECORD) // BLOCK))
+    order = []
+    kept = set()
+    for o in old_order:
+        if newpos[o] is not None:
+            order.append(newpos[o])
+            kept.add(newpos[o])
+
+    def compare(a, b):
+        if key[a] != key[b]:
+            return -1 if key[a] < key[b] else 1
+        if card:
+            card.touch(('tmp', (HEADER + a * RECORD) // BLOCK))
+            card.touch(('tmp', (HEADER + b * RECORD) // BLOCK))
+        na, nb = casekey(entries[a][1]), casekey(entries[b][1])
+        return (na > nb) - (na < nb)
+
+    for i in range(len(entries)):
+        if i in kept:
+            continue
+        lo, hi = 0, len(order)
+        while lo < hi:
+            mid = (lo + hi) // 2
+            if compare(order[mid], i) <= 0:
+                lo = mid + 1
+            else:
+                hi = mid
+        order.insert(lo, i)
+    if card:
+        card.write((len(order) * 2 + BLOCK - 1) // BLOCK + 1)
+    return entries, order
+
+
+def made_up_name(rng, n):
+    part = rng.choice(['benchy', 'Benchy', 'calicat', 'bracket', 'case_top', 'case_bottom', 'gear', 'vase',
+                       'clip', 'hook', 'xyz_cube', 'spool_holder', 'knob', '_test'])
+    return '%s_%02d_%.2fmm_%s_%dh%02dm.gcode' % (part, n % 97, rng.choice([0.1, 0.15, 0.2, 0.28]),
+                                                rng.choice(['PLA', 'PETG', 'ABS']), rng.randrange(12),
+                                                rng.randrange(60))
+
+
+def check(args):
+    rng = random.Random(args.seed)
+    d = Directory(rng)
+    names = set()
+    serial = 0
+    index = None
+    bad = 0
+    for step in range(args.changes):
+        r = rng.random()
+        if r < 0.55 or not names:
+            serial += 1
+            name = made_up_name(rng, serial)
+            if name.lower() in {n.lower() for n in names}:
+                continue
+            is_dir = rng.random() < 0.1
+            if is_dir:
+                name = name.split('.')[0]
+            d.add(name, is_dir)
+            names.add(name)
+        elif r < 0.85:
+            name = rng.choice(sorted(names))
+            d.remove(name)
+            names.discard(name)
+        else:
+            name = rng.choice(sorted(names))
+            is_dir = [f[2] for f in d.files() if f[1] == name][0]
+            d.remove(name)
+            names.discard(name)
+            new = name.replace('_', '-', 1) if '_' in name else 'a' + name
+            if new.lower() in {n.lower() for n in names}:
+                continue
+            d.add(new, is_dir)
+            names.add(new)
+        index = index_build(d, index)
+        entries, order = index
+        if [entries[o][1] for o in order] != ref_order(d.files()):
+            bad += 1
+    # From nothing, the same order
+    entries, order = index_build(d, None)
+    if [entries[o][1] for o in order] != ref_order(d.files()):
+        bad += 1
+    print('Index check: %d changes, %d files at the end, %s' % (args.changes, len(names),
+                                                                'orders right' if not bad else '%d WRONG' % bad))
+    return bad == 0
+
+
+def bench(args):
+    print('%6s %7s | %12s %12s | %12s %12s %12s | %12s %12s' % (
+        'files', 'blocks', 'sort open', 'sort frame', 'index open', 'index full', 'index +1', 'index frame', 'speedup'))
+    for size in args.sizes:
+        rng = random.Random(size)
+        d = Directory(rng)
+        for n in range(size):
+            d.add(made_up_name(rng, n))
+        files = d.files()
+        count = len(files)
+
+        # presort() without the index, SDSORT_USES_RAM off
+        card = Card()
+        d.walk(card)                                    # getnrfilenames()
+        limit = min(count, args.limit)
+        sort_order = list(range(limit))
+        names = [f[1] for f in files]
+        for i in range(limit - 1, 0, -1):
+            swapped = False
+            for j in range(i):
+                o1, o2 = sort_order[j], sort_order[j + 1]
+                d.walk(card, o1)
+                d.walk(card, o2)
+                if casekey(names[o1]) > casekey(names[o2]):
+                    sort_order[j], sort_order[j + 1] = o2, o1
+                    swapped = True
+            if not swapped:
+                break
+        sort_open = card.reads * args.read_ms
+
+        card = Card()
+        d.walk(card)                                    # get_num_Files()
+        for nr in range(min(args.rows, count)):
+            d.walk(card, sort_order[nr] if nr < limit else nr)
+        sort_frame = card.reads * args.read_ms
+
+        # presort() with the index
+        card = Card()
+        index = index_build(d, None, card)
+        index_full = card.reads * args.read_ms + card.writes * args.write_ms
+        card = Card()
+        for b in range(d.blocks()):                      # index_stamp()
+            card.touch(('dir', b))
+        card.touch(('idx', 0))
+        index_open = card.reads * args.read_ms
+        d.add(made_up_name(rng, size + 1))
+        card = Card()
+        index_build(d, index, card)
+        index_plus = card.reads * args.read_ms + card.writes * args.write_ms
+
+        card = Card()
+        table = HEADER + count * RECORD
+        for nr in range(min(args.rows, count)):
+            card.touch(('idx', (table + nr * 2) // BLOCK))
+            card.touch(('idx', (HEADER + index[1][nr] * RECORD) // BLOCK))
+        index_frame = card.reads * args.read_ms
+
+        print('%6d %7d | %10.0fms %10.1fms | %10.1fms %10.0fms %10.0fms | %10.1fms %11.0fx' % (
+            count, d.blocks(), sort_open, sort_frame, index_open, index_full, index_plus, index_frame,
+            sort_frame / max(index_frame, 1e-9)))
+
+
+def main():
+    parser = argparse.ArgumentParser(description='MK4duo SD directory index check and benchmark')
+    parser.add_argument('--sizes', default='10,100,500,1000,2000', help='files in the directory')
+    parser.add_argument('--rows', type=int, default=4, help='rows of the menu')
+    parser.add_argument('--limit', type=int, default=256, help='SDSORT_LIMIT')
+    parser.add_argument('--read-ms', type=float, default=0.5, help='time of a block read')
+    parser.add_argument('--write-ms', type=float, default=1.0, help='time of a block write')
+    parser.add_argument('--changes', type=int, default=200, help='changes to the directory for the check')
+    parser.add_argument('--seed', type=int, default=1)
+    args = parser.parse_args()
+    args.sizes = [int(s) for s in args.sizes.split(',')]
+
+    ok = check(args)
+    bench(args)
+    return 0 if ok else 1
+
+
+if __name__ == '__main__':
+    sys.exit(main())
@@ -0,0 +1,263 @@
+#!/usr/bin/python3
+
+# SD read ahead benchmark for MK4duo (SD_READ_AHEAD, src/lib/read_ahead.h)
+#
+# Builds a small host program with the host g++ around src/lib/read_ahead.h
+# and a stand-in for SdFile on a host file, then reads a G-code file the way
+# Commands::get_sdcard() does:
+#
+#   byte   SDCard::get() for each byte, curPosition() then read()
+#   ahead  SDCard::get_line(), lines out of the two read ahead buffers,
+#          the other buffer filled as from idle() each time the command
+#          buffer is full
+#
+#   sdreadbench.py [--corpus print.gcode] [--size-mb 20] [--block 512] [--rounds 3]
+#
+# The stand-in works as SdFat does: a one block cache for reads that are not
+# whole blocks, whole blocks read straight into the buffer, read() a call. The
+# file is loaded first, a block read is a copy in memory. The lines, with
+# the sdpos each one leaves for restart and M27, must be the same both ways.
+# Without --corpus a slicer like file is made up. Times are host times, the
+# card itself is left out: the gain is the cost of the byte at a time path.
+
+import argparse
+import os
+import random
+import subprocess
+import sys
+import tempfile
+
+HERE = os.path.dirname(os.path.abspath(__file__))
+LIB = os.path.join(HERE, '..', 'MK4duo', 'src', 'lib')
+
+HARNESS = r'''
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "read_ahead.h"
+
+#define MAX_CMD_SIZE  96
+#define BUFSIZE       4
+#define BLOCK         512
+
+enum e_parser_state : uint8_t { PS_NORMAL, PS_EOL, PS_QUOTED, PS_PAREN, PS_ESC };
+
+// SdFile on a host file: one block cache, whole blocks straight to the buffer.
+// The file is loaded once, a block read is a copy, read() is a call as in SdFat.
+class StandInFile {
+  public:
+    uint8_t *image;
+    uint32_t pos, size, cached;
+    uint8_t cache[BLOCK];
+    uint32_t block_reads;
+
+    void load_file(const char *path) {
+      FILE *f = fopen(path, "rb");
+      fseek(f, 0, SEEK_END); size = ftell(f); fseek(f, 0, SEEK_SET);
+      image = (uint8_t*)calloc(size + BLOCK, 1);
+      if (fread(image, 1, size, f) != size) exit(1);
+      fclose(f);
+    }
+    void open() { pos = 0; cached = 0xFFFFFFFF; block_reads = 0; }
+    bool seekSet(uint32_t p) { pos = p; return true; }
+    uint32_t curPosition() { return pos; }
+    void load(uint32_t block, uint8_t *dst) {
+      memcpy(dst, image + block * BLOCK, BLOCK);
+      block_reads++;
+    }
+    __attribute__((noinline)) int read(void *buf, size_t nbyte) {
+      uint8_t *dst = (uint8_t*)buf;
+      if (pos >= size) return 0;
+      if (nbyte > size - pos) nbyte = size - pos;
+      size_t toRead = nbyte;
+      while (toRead) {
+        const uint32_t offset = pos % BLOCK, block = pos / BLOCK;
+        size_t n;
+        if (offset == 0 && toRead >= BLOCK && block != cached) {
+          n = BLOCK;
+          load(block, dst);
+        }
+        else {
+          if (block != cached) { load(block, cache); cached = block; }
+          n = BLOCK - offset;
+          if (n > toRead) n = toRead;
+          memcpy(dst, cache + offset, n);
+        }
+        dst += n; pos += n; toRead -= n;
+      }
+      return nbyte;
+    }
+    int read() { uint8_t b; return read(&b, 1) == 1 ? b : -1; }
+};
+
+// Commands::process_stream_char() and process_line_done()
+static inline void process_stream_char(const char c, uint8_t &sis, char (&buff)[MAX_CMD_SIZE], int &ind) {
+  if (ind >= MAX_CMD_SIZE - 1) sis = PS_EOL;
+  if (sis == PS_EOL) return;
+  else if (sis == PS_PAREN) { if (c == ')') sis = PS_NORMAL; return; }
+  else if (sis >= PS_ESC) sis -= PS_ESC;
+  else if (c == '\\') { sis += PS_ESC; if (sis == PS_ESC) return; }
+  else if (sis == PS_QUOTED) { if (c == '"') sis = PS_NORMAL; }
+  else if (c == '"') sis = PS_QUOTED;
+  else if (c == ';') { sis = PS_EOL; return; }
+  else if (c == '(') { sis = PS_PAREN; return; }
+  buff[ind++] = c;
+}
+
+static inline bool process_line_done(uint8_t &sis, char (&buff)[MAX_CMD_SIZE], int &ind) {
+  sis = PS_NORMAL;
+  buff[ind] = 0;
+  if (ind) { ind = 0; return false; }
+  return true;
+}
+
+static StandInFile file;
+static uint32_t sdpos, lines, ring;
+static uint64_t digest;
+static Read_Ahead<StandInFile, SD_BUFFER> read_ahead;
+
+// enqueue() and restart.cmd_sdpos
+static void enqueue(const char *line, const uint32_t pos) {
+  for (const char *c = line; *c; c++) digest = digest * 131 + uint8_t(*c);
+  digest = digest * 131 + pos;
+  lines++;
+  ring++;
+}
+
+static void run_byte() {
+  static char buff[MAX_CMD_SIZE];
+  uint8_t sis = PS_NORMAL;
+  int count = 0;
+  bool card_eof = sdpos >= file.size;
+  while (!card_eof) {
+    if (ring == BUFSIZE) ring = 0;      // advance_queue() ran them
+    sdpos = file.curPosition();
+    const int16_t n = file.read();
+    card_eof = sdpos >= file.size;
+    const char c = (char)n;
+    const bool is_eol = c == '\n' || c == '\r';
+    if (is_eol || card_eof) {
+      if (!process_line_done(sis, buff, count)) enqueue(buff, sdpos);
+    }
+    else
+      process_stream_char(c, sis, buff, count);
+  }
+}
+
+static void run_ahead() {
+  static char buff[MAX_CMD_SIZE];
+  uint8_t sis = PS_NORMAL;
+  int count = 0;
+  for (;;) {
+    if (ring == BUFSIZE) {              // advance_queue() ran them, then idle()
+      ring = 0;
+      read_ahead.refill(file);
+    }
+    const char *p;
+    bool is_eol;
+    uint16_t n = read_ahead.line(file, p, is_eol);
+    sdpos = read_ahead.position() - (is_eol ? 1 : 0);
+    if (!n) {
+      if (!process_line_done(sis, buff, count)) enqueue(buff, sdpos);
+      break;
+    }
+    if (is_eol) n--;
+    while (n--) process_stream_char(*p++, sis, buff, count);
+    if (is_eol && !process_line_done(sis, buff, count)) enqueue(buff, sdpos);
+  }
+}
+
+static double now() {
+  timespec t;
+  clock_gettime(CLOCK_MONOTONIC, &t);
+  return t.tv_sec + t.tv_nsec * 1e-9;
+}
+
+int main(int argc, char **argv) {
+  const int rounds = atoi(argv[2]);
+  const bool ahead = !strcmp(argv[3], "ahead");
+  double best = 1e9;
+  file.load_file(argv[1]);
+  for (int r = 0; r < rounds; r++) {
+    file.open();
+    read_ahead.reset(0);
+    sdpos = lines = ring = 0;
+    digest = 0;
+    const double t = now();
+    if (ahead) run_ahead(); else run_byte();
+    const double e = now() - t;
+    if (e < best) best = e;
+  }
+  printf("%u %u %.6f %u %016llx\n", lines, file.size, best, file.block_reads, (unsigned long long)digest);
+  return 0;
+}
+'''
+
+
+def build(tmp, block):
+    src = os.path.join(tmp, 'sdread_harness.cpp')
+    exe = os.path.join(tmp, 'sdread_harness')
+    with open(src, 'w') as f:
+        f.write(HARNESS)
+    subprocess.run(['g++', '-O2', '-std=gnu++11', '-DSD_BUFFER=%d' % block, '-I', LIB, '-o', exe, src], check=True)
+    return exe
+
+
+def made_up(path, size):
+    # Slicer like lines, with comments, CR LF and a last line with no newline
+    rng = random.Random(1)
+    e = 0.0
+    written = 0
+    with open(path, 'w', newline='') as f:
+        f.write(';FLAVOR:Marlin\n;Generated with a made up slicer\nG21\nG90\nM82\nG28\n')
+        while written < size:
+            r = rng.random()
+            if r < 0.02:
+                line = ';LAYER:%d\n' % rng.randrange(1000)
+            elif r < 0.04:
+                line = 'M117 "Layer (%d)"\n' % rng.randrange(1000)
+            elif r < 0.10:
+                line = 'G0 F7800 X%.3f Y%.3f\r\n' % (rng.uniform(10, 200), rng.uniform(10, 200))
+            else:
+                e += rng.uniform(0.01, 0.3)
+                line = 'G1 X%.3f Y%.3f E%.5f ; perimeter\n' % (rng.uniform(10, 200), rng.uniform(10, 200), e)
+            f.write(line)
+            written += len(line)
+        f.write('M84')
+
+
+def main():
+    parser = argparse.ArgumentParser(description='MK4duo SD read ahead benchmark')
+    parser.add_argument('--corpus', help='G-code file to read')
+    parser.add_argument('--size-mb', type=float, default=20.0, help='size of the made up file')
+    parser.add_argument('--block', type=int, default=512, help='SD_READ_AHEAD_SIZE')
+    parser.add_argument('--rounds', type=int, default=3)
+    args = parser.parse_args()
+
+    with tempfile.TemporaryDirectory() as tmp:
+        exe = build(tmp, args.block)
+        path = args.corpus
+        if not path:
+            path = os.path.join(tmp, 'made_up.gcode')
+            made_up(path, int(args.size_mb * 1e6))
+        results = {}
+        for mode in ('byte', 'ahead'):
+            out = subprocess.run([exe, path, str(args.rounds), mode], check=True,
+                                 stdout=subprocess.PIPE, universal_newlines=True).stdout.split()
+            results[mode] = (int(out[0]), int(out[1]), float(out[2]), int(out[3]), out[4])
+
+    lines, size = results['byte'][0], results['byte'][1]
+    print('%d lines, %.1f MB from %s, buffers of %d bytes' % (lines, size / 1e6, args.corpus or 'a made up file', args.block))
+    print('%-6s %12s %10s %12s %18s' % ('path', 'lines/s', 'MB/s', 'block reads', 'lines and sdpos'))
+    for mode in ('byte', 'ahead'):
+        n, _, t, blocks, digest = results[mode]
+        print('%-6s %12.0f %10.1f %12d %18s' % (mode, n / t, size / t / 1e6, blocks, digest))
+    same = results['byte'][0] == results['ahead'][0] and results['byte'][4] == results['ahead'][4]
+    print('Speedup %.1fx, %s' % (results['byte'][2] / results['ahead'][2], 'same lines' if same else 'DIFFERENT LINES'))
+    return 0 if same else 1
+
+
+if __name__ == '__main__':
+    sys.exit(main())
@@ -0,0 +1,285 @@
+#!/usr/bin/python3
+
+# SD upload benchmark for MK4duo (SD_WRITE_BEHIND, src/lib/write_behind.h, SD_UPLOAD_RAW)
+#
+# Builds a small host program with the host g++ around src/lib/write_behind.h
+# and a stand-in for SdFile on a host buffer, then saves a G-code file the way
+# M28 does, the lines numbered and with checksums as a host sends them:
+#
+#   line    SDCard::write_command() writing each line to the file
+#   behind  SDCard::write_command() into the write behind buffers, the full
+#           block written as from idle() after the "ok" of the line
+#   raw     M28 B<bytes>, the bytes of the file in chunks of 64, no lines
+#
+#   sduploadbench.py [--corpus print.gcode] [--size-mb 5] [--baud 250000]
+#                    [--block-ms 1.5] [--rounds 3]
+#
+# The stand-in works as SdFat does: a one block cache, a block read into it
+# before a write that is not a whole block unless the block is past the end
+# of the file, the dirty block written when another one is needed, whole
+# blocks written straight from the buffer. Files must come out the same.
+#
+# The upload time is then modelled for a host that sends a line after the
+# "ok" of the one before, over --baud, each block write taking --block-ms:
+# a line waits for the writes made before its "ok", the writes made after
+# it overlap the next line on the wire. Raw bytes are on the wire back to
+# back, the writes overlap them. CPU times are host times.
+
+import argparse
+import os
+import random
+import subprocess
+import sys
+import tempfile
+
+HERE = os.path.dirname(os.path.abspath(__file__))
+LIB = os.path.join(HERE, '..', 'MK4duo', 'src', 'lib')
+
+HARNESS = r'''
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "write_behind.h"
+
+#define BLOCK 512
+
+// SdFile in memory: one block cache, whole blocks straight from the buffer
+class StandInFile {
+  public:
+    uint8_t *image, cache[BLOCK];
+    uint32_t pos, size, cached, capacity;
+    bool dirty;
+    uint32_t block_reads, block_writes;
+
+    void open(uint32_t cap) {
+      capacity = cap;
+      if (!image) image = (uint8_t*)calloc(cap + BLOCK, 1);
+      pos = size = 0; cached = 0xFFFFFFFF; dirty = false;
+      block_reads = block_writes = 0;
+    }
+    void flush() {
+      if (dirty) { memcpy(image + cached * BLOCK, cache, BLOCK); block_writes++; dirty = false; }
+    }
+    __attribute__((noinline)) int write(const void *buf, size_t nbyte) {
+      const uint8_t *src = (const uint8_t*)buf;
+      size_t toWrite = nbyte;
+      while (toWrite) {
+        const uint32_t offset = pos % BLOCK, block = pos / BLOCK;
+        size_t n;
+        if (offset == 0 && toWrite >= BLOCK) {
+          n = BLOCK;
+          if (block == cached) { cached = 0xFFFFFFFF; dirty = false; }
+          memcpy(image + block * BLOCK, src, BLOCK);
+          block_writes++;
+        }
+        else {
+          if (block != cached) {
+            flush();
+            if (!(offset == 0 && pos >= size)) { memcpy(cache, image + block * BLOCK, BLOCK); block_reads++; }
+            cached = block;
+          }
+          n = BLOCK - offset;
+          if (n > toWrite) n = toWrite;
+          memcpy(cache + offset, src, n);
+          dirty = true;
+        }
+        src += n; pos += n; toWrite -= n;
+        if (pos > size) size = pos;
+      }
+      return nbyte;
+    }
+    int write(const char *str) { return write(str, strlen(str)); }
+    void sync() { flush(); }
+};
+
+static StandInFile file;
+static Write_Behind<StandInFile, WRITE_BUFFER> write_behind;
+static char **lines;
+static uint32_t nlines;
+static uint8_t *raw;
+static uint32_t raw_size;
+static uint32_t ok_writes, idle_writes;   // Block writes before and after the "ok"
+
+// SDCard::write_command()
+static void write_command(char *buf, const bool behind) {
+  char *begin = buf, *npos, *end = buf + strlen(buf) - 1;
+  if ((npos = strchr(buf, 'N')) != NULL) {
+    begin = strchr(npos, ' ') + 1;
+    end = strchr(npos, '*') - 1;
+  }
+  end[1] = '\r'; end[2] = '\n'; end[3] = '\0';
+  if (behind) write_behind.write(file, begin, end + 3 - begin);
+  else file.write(begin);
+}
+
+static void run(const int mode) {
+  static char buf[128];
+  file.open(raw_size * 2);
+  write_behind.reset();
+  ok_writes = idle_writes = 0;
+  if (mode == 2) {
+    for (uint32_t i = 0; i < raw_size; i += 64) {
+      const uint32_t n = raw_size - i < 64 ? raw_size - i : 64;
+      write_behind.write(file, raw + i, n);
+      write_behind.flush(file);
+    }
+    write_behind.finish(file);
+    file.sync();
+    ok_writes = file.block_writes;
+    return;
+  }
+  for (uint32_t l = 0; l < nlines; l++) {
+    strcpy(buf, lines[l]);
+    uint32_t before = file.block_writes;
+    write_command(buf, mode == 1);
+    ok_writes += file.block_writes - before;
+    if (mode == 1) {
+      before = file.block_writes;
+      write_behind.flush(file);       // idle() after the "ok"
+      idle_writes += file.block_writes - before;
+    }
+  }
+  if (mode == 1) write_behind.finish(file);
+  file.sync();
+}
+
+static double now() {
+  timespec t;
+  clock_gettime(CLOCK_MONOTONIC, &t);
+  return t.tv_sec + t.tv_nsec * 1e-9;
+}
+
+int main(int argc, char **argv) {
+  FILE *f = fopen(argv[1], "rb");
+  fseek(f, 0, SEEK_END); const long size = ftell(f); fseek(f, 0, SEEK_SET);
+  char *text = (char*)malloc(size + 1);
+  if (fread(text, 1, size, f) != (size_t)size) return 1;
+  text[size] = 0;
+  fclose(f);
+  f = fopen(argv[2], "rb");
+  fseek(f, 0, SEEK_END); raw_size = ftell(f); fseek(f, 0, SEEK_SET);
+  raw = (uint8_t*)malloc(raw_size);
+  if (fread(raw, 1, raw_size, f) != raw_size) return 1;
+  fclose(f);
+
+  lines = (char**)malloc(sizeof(char*) * (size / 2 + 1));
+  for (char *p = strtok(text, "\n"); p; p = strtok(NULL, "\n")) lines[nlines++] = p;
+
+  const int rounds = atoi(argv[3]), mode = atoi(argv[4]);
+  double best = 1e9;
+  for (int r = 0; r < rounds; r++) {
+    const double t = now();
+    run(mode);
+    const double e = now() - t;
+    if (e < best) best = e;
+  }
+  uint64_t digest = 0;
+  for (uint32_t i = 0; i < file.size; i++) digest = digest * 131 + file.image[i];
+  printf("%u %u %.6f %u %u %u %u %016llx\n", nlines, file.size, best, file.block_reads, file.block_writes,
+         ok_writes, idle_writes, (unsigned long long)digest);
+  return 0;
+}
+'''
+
+MODES = ('line', 'behind', 'raw')
+
+
+def build(tmp):
+    src = os.path.join(tmp, 'sdupload_harness.cpp')
+    exe = os.path.join(tmp, 'sdupload_harness')
+    with open(src, 'w') as f:
+        f.write(HARNESS)
+    subprocess.run(['g++', '-O2', '-std=gnu++11', '-DWRITE_BUFFER=512', '-I', LIB, '-o', exe, src], check=True)
+    return exe
+
+
+def made_up(size):
+    rng = random.Random(1)
+    e = 0.0
+    lines, written = ['G21', 'G90', 'M82', 'G28'], 0
+    while written < size:
+        if rng.random() < 0.1:
+            line = 'G0 F7800 X%.3f Y%.3f' % (rng.uniform(10, 200), rng.uniform(10, 200))
+        else:
+            e += rng.uniform(0.01, 0.3)
+            line = 'G1 X%.3f Y%.3f E%.5f' % (rng.uniform(10, 200), rng.uniform(10, 200), e)
+        lines.append(line)
+        written += len(line) + 2
+    return lines
+
+
+def numbered(lines):
+    # As the host sends them, the file is the lines with CR LF
+    out = []
+    for n, line in enumerate(lines, 1):
+        body = 'N%d %s ' % (n, line)
+        cs = 0
+        for c in body:
+            cs ^= ord(c)
+        out.append('%s*%d' % (body, cs))
+    return out
+
+
+def main():
+    parser = argparse.ArgumentParser(description='MK4duo SD upload benchmark')
+    parser.add_argument('--corpus', help='G-code file to upload')
+    parser.add_argument('--size-mb', type=float, default=5.0, help='size of the made up file')
+    parser.add_argument('--baud', type=int, default=250000, help='link speed, 10000000 for a native USB port')
+    parser.add_argument('--block-ms', type=float, default=1.5, help='time of a block write')
+    parser.add_argument('--rounds', type=int, default=3)
+    args = parser.parse_args()
+
+    if args.corpus:
+        with open(args.corpus) as f:
+            lines = [l.split(';')[0].strip() for l in f]
+        lines = [l for l in lines if l]
+    else:
+        lines = made_up(int(args.size_mb * 1e6))
+
+    results = {}
+    with tempfile.TemporaryDirectory() as tmp:
+        exe = build(tmp)
+        sent = os.path.join(tmp, 'sent.txt')
+        with open(sent, 'w', newline='') as f:
+            f.write('\n'.join(numbered(lines)) + '\n')
+        file = os.path.join(tmp, 'file.gcode')
+        with open(file, 'w', newline='') as f:
+            f.write(''.join(l + ' \r\n' for l in lines))
+        for i, mode in enumerate(MODES):
+            out = subprocess.run([exe, sent, file, str(args.rounds), str(i)], check=True,
+                                 stdout=subprocess.PIPE, universal_newlines=True).stdout.split()
+            results[mode] = [int(out[0]), int(out[1]), float(out[2])] + [int(x) for x in out[3:7]] + [out[7]]
+
+    byte_s = 10.0 / args.baud
+    block_s = args.block_ms / 1000.0
+    sent_bytes = sum(len(l) + 1 for l in numbered(lines))
+    nlines = len(lines)
+
+    print('%d lines, %.1f MB saved, %d baud, %.1f ms a block write' % (
+        nlines, results['line'][1] / 1e6, args.baud, args.block_ms))
+    print('%-7s %10s %10s %10s %12s %12s %10s %18s' % (
+        'path', 'CPU MB/s', 'reads', 'writes', 'ok waits', 'upload s', 'KB/s', 'file'))
+    for mode in MODES:
+        n, size, t, reads, writes, ok_w, idle_w, digest = results[mode]
+        cpu = t / max(n, 1)
+        if mode == 'raw':
+            wire = size * byte_s
+            upload = max(wire, writes * block_s) + block_s
+        else:
+            # Each line: on the wire, then the writes before its "ok", the "ok" back
+            wire = sent_bytes * byte_s + nlines * 3 * byte_s
+            upload = wire + nlines * cpu + (ok_w + reads) * block_s
+            # Writes after the "ok" hide behind the next line on the wire
+            line_s = sent_bytes * byte_s / nlines
+            upload += idle_w * max(0.0, block_s - line_s)
+        print('%-7s %10.1f %10d %10d %12s %11.1fs %10.1f %18s' % (
+            mode, size / t / 1e6, reads, writes, '-' if mode == 'raw' else ok_w, upload, size / upload / 1e3, digest))
+    same = len({results[m][7] for m in MODES}) == 1
+    print('Files %s' % ('the same' if same else 'DIFFERENT'))
+    return 0 if same else 1
+
+
+if __name__ == '__main__':
+    sys.exit(main())
@@ -0,0 +1,150 @@
+#!/usr/bin/python3
+
+# Step trace tool for the MK4duo host native build (src/platform/HAL_NATIVE)
+#
+# The native executable records every step pulse and direction change with
+# its stepper timer tick when started with "-t file". This script compares
+# two traces, or runs a whole folder of G-code files against a baseline, so a
+# change of the planner or of the stepper ISR can be checked in seconds.
+#
+#   steptrace.py compare a.trc b.trc [--tolerance TICKS]
+#   steptrace.py record  --bin mk4duo_native --corpus gcodes/ --out baseline/
+#   steptrace.py check   --bin mk4duo_native --corpus gcodes/ --baseline baseline/ [--tolerance TICKS]
+#
+# Exit code is 0 when the traces match, 1 otherwise.
+
+import argparse
+import os
+import subprocess
+import sys
+import tempfile
+
+AXIS_NAMES = ['X', 'Y', 'Z', 'E0', 'E1', 'E2', 'E3', 'E4', 'E5']
+DIR_EVENT = 0x10
+DIR_LEVEL = 0x20
+
+
+class Trace:
+
+    def __init__(self, path):
+        with open(path, 'rb') as f:
+            data = f.read()
+        if data[0:4] != b'MKST':
+            raise ValueError(path + ': not a step trace')
+        self.version = data[4]
+        axes = data[5]
+        self.rate = int.from_bytes(data[6:10], 'little')
+        self.times = [[] for _ in range(axes)]
+        self.signs = [[] for _ in range(axes)]
+        level = [1] * axes
+        tick = 0
+        pos = 10
+        size = len(data)
+        while pos < size:
+            delta = 0
+            shift = 0
+            while True:
+                b = data[pos]
+                pos += 1
+                delta |= (b & 0x7F) << shift
+                shift += 7
+                if not b & 0x80:
+                    break
+            tick += delta
+            event = data[pos]
+            pos += 1
+            axis = event & 0x0F
+            if event & DIR_EVENT:
+                level[axis] = 1 if event & DIR_LEVEL else -1
+            else:
+                self.times[axis].append(tick)
+                self.signs[axis].append(level[axis])
+        self.end = tick
+
+
+def compare(path_a, path_b, tolerance, out=sys.stdout):
+    a = Trace(path_a)
+    b = Trace(path_b)
+    if a.rate != b.rate:
+        print('Different tick rate: %d / %d' % (a.rate, b.rate), file=out)
+        return False
+    us = 1e6 / a.rate
+    ok = True
+    print('%-4s %10s %10s %8s %12s %10s %8s' % ('Axis', 'Steps A', 'Steps B', 'Drift', 'Max dev', 'At step', 'Dir err'), file=out)
+    for axis, name in enumerate(AXIS_NAMES[:len(a.times)]):
+        ta, tb = a.times[axis], b.times[axis]
+        sa, sb = a.signs[axis], b.signs[axis]
+        if not ta and not tb:
+            continue
+        drift = sum(sb) - sum(sa)
+        max_dev, at, dir_err = 0, -1, 0
+        for i in range(min(len(ta), len(tb))):
+            dev = abs(tb[i] - ta[i])
+            if dev > max_dev:
+                max_dev, at = dev, i
+            if sa[i] != sb[i]:
+                dir_err += 1
+        print('%-4s %10d %10d %8d %9.3f us %10d %8d' % (name, len(ta), len(tb), drift, max_dev * us, at, dir_err), file=out)
+        if len(ta) != len(tb) or drift or dir_err or max_dev > tolerance:
+            ok = False
+    print('Duration: %.6f s / %.6f s' % (a.end / a.rate, b.end / b.rate), file=out)
+    print('MATCH' if ok else 'DIFFERENT', file=out)
+    return ok
+
+
+def gcode_files(corpus):
+    return sorted(f for f in os.listdir(corpus) if f.lower().endswith(('.gcode', '.g', '.gco')))
+
+
+def run_trace(binary, gcode, trace):
+    with tempfile.TemporaryDirectory() as tmp:
+        subprocess.run([os.path.abspath(binary), '-q', '-e', os.path.join(tmp, 'eeprom.bin'), '-t', trace, gcode],
+                       check=True, stdout=subprocess.DEVNULL, stderr=subprocess.DEVNULL)
+
+
+def main():
+    parser = argparse.ArgumentParser(description='MK4duo step trace tool')
+    sub = parser.add_subparsers(dest='cmd', required=True)
+
+    p = sub.add_parser('compare', help='compare two traces')
+    p.add_argument('a')
+    p.add_argument('b')
+    p.add_argument('--tolerance', type=int, default=0, help='allowed timing deviation in ticks')
+
+    p = sub.add_parser('record', help='record the baseline traces of a G-code folder')
+    p.add_argument('--bin', required=True)
+    p.add_argument('--corpus', required=True)
+    p.add_argument('--out', required=True)
+
+    p = sub.add_parser('check', help='check a G-code folder against the baseline traces')
+    p.add_argument('--bin', required=True)
+    p.add_argument('--corpus', required=True)
+    p.add_argument('--baseline', required=True)
+    p.add_argument('--tolerance', type=int, default=0, help='allowed timing deviation in ticks')
+
+    args = parser.parse_args()
+
+    if args.cmd == 'compare':
+        return 0 if compare(args.a, args.b, args.tolerance) else 1
+
+    if args.cmd == 'record':
+        os.makedirs(args.out, exist_ok=True)
+        for name in gcode_files(args.corpus):
+            run_trace(args.bin, os.path.join(args.corpus, name), os.path.join(args.out, name + '.trc'))
+            print('recorded', name)
+        return 0
+
+    failed = 0
+    with tempfile.TemporaryDirectory() as tmp:
+        for name in gcode_files(args.corpus):
+            trace = os.path.join(tmp, name + '.trc')
+            run_trace(args.bin, os.path.join(args.corpus, name), trace)
+            print('===', name)
+            if not compare(os.path.join(args.baseline, name + '.trc'), trace, args.tolerance):
+                failed += 1
+    print('%d file(s) different' % failed)
+    return 1 if failed else 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
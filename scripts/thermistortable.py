@@ -0,0 +1,203 @@
+#!/usr/bin/python3
+
+# Error and speed of the MK4duo thermistor table (THERMISTOR_TABLE, src/lib/thermistor_table.h)
+#
+# Builds a small host program with the host g++ around src/lib/thermistor_table.h
+# and a stand-in for the sensor with the calc_thermistor() of sensor.h, then
+# for each thermistor 1 to 8 (4.7k pullup) makes the table as
+# Heater::update_sensor_parameters() does and reads every ADC value both ways:
+#
+#   formula  calc_thermistor(), Steinhart-Hart with LOG, as before
+#   table    Thermistor_Table::get(), the formula for readings out of it
+#
+#   thermistortable.py [--points 64,128] [--ranges 1024,4096]
+#                      [--maxtemp 500] [--rounds 200] [--limit 1.0]
+#
+# The error is the table against the formula, largest over the whole ADC
+# range and largest and mean from 0 to 300 degC, where the printer works.
+# The readings left to the formula are the ones colder than the bottom of
+# the table or hotter than --maxtemp. Times are host ns (and TSC cycles on
+# x86) for a reading, the best of --rounds passes over all the ADC values.
+# The host has a FPU and a fast logf(), the two come out close there; on an
+# AVR, or an ARM without FPU, LOG and the divisions are soft float and the
+# table is the integer part only.
+# Exit code is 0 when the error from 0 to 300 degC is under --limit degC.
+
+import argparse
+import os
+import subprocess
+import sys
+import tempfile
+
+HERE = os.path.dirname(os.path.abspath(__file__))
+LIB = os.path.join(HERE, '..', 'MK4duo', 'src', 'lib')
+
+THERMISTORS = (
+    (1, 'EPCOS 100K', 100000.0, 4092.0),
+    (2, 'NTC3950', 100000.0, 3950.0),
+    (3, 'ATC 204GT-2', 200000.0, 4338.0),
+    (4, 'ATC 104GT-2', 100000.0, 4725.0),
+    (5, 'HW 104LAG', 100000.0, 3974.0),
+    (6, 'E3104FXT', 100000.0, 4100.0),
+    (7, 'GE AL03006', 100000.0, 3952.0),
+    (8, 'RS 198-961', 100000.0, 3960.0),
+)
+
+HARNESS = r'''
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#if defined(__x86_64__) || defined(__i386__)
+  #include <x86intrin.h>
+  #define CYCLES() __rdtsc()
+#else
+  #define CYCLES() 0
+#endif
+#include "thermistor_table.h"
+
+#define ABS_ZERO  -273.15f
+#define LOG(x)    logf(x)
+
+static int16_t AD_RANGE;
+
+// TemperatureSensor of sensor.h, the thermistor part without VREF monitor
+class Sensor {
+  public:
+    float   res_25, beta, pullup_res, shA, shB, shC;
+    int16_t adc_low_offset, adc_high_offset;
+
+    void CalcDerivedParameters() {
+      shB = 1.0 / beta;
+      const float lnR25 = LOG(res_25);
+      shA = 1.0 / (25.0 - ABS_ZERO) - shB * lnR25 - shC * lnR25 * lnR25 * lnR25;
+    }
+
+    __attribute__((noinline)) float calc_thermistor(const int16_t raw) {
+      const int32_t adc_low = 2 * adc_low_offset,
+                    adc_max = AD_RANGE + (2 * adc_high_offset);
+      const float   adc_inverse = (float)(adc_max - raw) - 0.5f;
+      if (adc_inverse <= 0.0) return ABS_ZERO;
+      const float   resistance = pullup_res * ((float)(raw - adc_low) + 0.5f) / adc_inverse;
+      const float logResistance = LOG(resistance);
+      const float recipT = shA + shB * logResistance + shC * logResistance * logResistance * logResistance;
+      return (recipT > 0.0) ? (1.0 / recipT) + (ABS_ZERO) : 2000.0;
+    }
+};
+
+static Sensor sensor;
+static Thermistor_Table<TABLE_POINTS> table;
+static volatile float sink;
+
+// Heater::update_current_temperature()
+__attribute__((noinline)) static float read_table(const int16_t raw) {
+  float t;
+  if (!table.get(raw, t)) t = sensor.calc_thermistor(raw);
+  return t;
+}
+
+static double now() {
+  timespec t;
+  clock_gettime(CLOCK_MONOTONIC, &t);
+  return t.tv_sec + t.tv_nsec * 1e-9;
+}
+
+int main(int argc, char **argv) {
+  AD_RANGE = atoi(argv[1]);
+  sensor.res_25 = atof(argv[2]);
+  sensor.beta = atof(argv[3]);
+  const float maxtemp = atof(argv[4]);
+  const int rounds = atoi(argv[5]);
+  sensor.pullup_res = 4700;
+  sensor.shC = 0;
+  sensor.adc_low_offset = sensor.adc_high_offset = 0;
+  sensor.CalcDerivedParameters();
+
+  const double b0 = now();
+  table.build(sensor, AD_RANGE, maxtemp);
+  const double build = now() - b0;
+
+  double err_all = 0, err_work = 0, sum_work = 0;
+  long n_work = 0, outside = 0;
+  for (int16_t r = 0; r < AD_RANGE; r++) {
+    const float f = sensor.calc_thermistor(r);
+    float t;
+    if (!table.get(r, t)) { outside++; continue; }
+    const double e = fabs(t - f);
+    if (e > err_all) err_all = e;
+    if (f >= 0 && f <= 300) {
+      if (e > err_work) err_work = e;
+      sum_work += e;
+      n_work++;
+    }
+  }
+
+  double best[2] = { 1e9, 1e9 };
+  uint64_t cycles[2] = { ~0ULL, ~0ULL };
+  for (int k = 0; k < rounds; k++) {
+    for (int m = 0; m < 2; m++) {
+      const double t0 = now();
+      const uint64_t c0 = CYCLES();
+      float s = 0;
+      for (int16_t r = 0; r < AD_RANGE; r++) s += m ? read_table(r) : sensor.calc_thermistor(r);
+      const uint64_t c = CYCLES() - c0;
+      const double e = now() - t0;
+      sink = s;
+      if (e < best[m]) best[m] = e;
+      if (c < cycles[m]) cycles[m] = c;
+    }
+  }
+
+  printf("%u %ld %.4f %.4f %.4f %.3f %.3f %.1f %.1f %.3f %u\n", table.size(), outside, err_all, err_work,
+         n_work ? sum_work / n_work : 0.0, best[0] * 1e9 / AD_RANGE, best[1] * 1e9 / AD_RANGE,
+         (double)cycles[0] / AD_RANGE, (double)cycles[1] / AD_RANGE, build * 1e6, (unsigned)sizeof(table));
+  return 0;
+}
+'''
+
+
+def main():
+    parser = argparse.ArgumentParser(description='MK4duo thermistor table error and speed')
+    parser.add_argument('--points', default='64,128', help='THERMISTOR_TABLE_POINTS')
+    parser.add_argument('--ranges', default='1024,4096', help='AD_RANGE, 1024 for AVR, 4096 for 12 bit ARM')
+    parser.add_argument('--maxtemp', type=float, default=500, help='THERMISTOR_TABLE_MAXTEMP')
+    parser.add_argument('--rounds', type=int, default=200)
+    parser.add_argument('--limit', type=float, default=1.0, help='largest error allowed from 0 to 300 degC')
+    args = parser.parse_args()
+    points = [int(p) for p in args.points.split(',')]
+    ranges = [int(r) for r in args.ranges.split(',')]
+
+    worst = {}
+    with tempfile.TemporaryDirectory() as tmp:
+        src = os.path.join(tmp, 'thermistor_harness.cpp')
+        with open(src, 'w') as f:
+            f.write(HARNESS)
+        for p in points:
+            exe = os.path.join(tmp, 'thermistor_harness_%d' % p)
+            subprocess.run(['g++', '-O2', '-std=gnu++11', '-DTABLE_POINTS=%d' % p, '-I', LIB, '-o', exe, src], check=True)
+            for ad in ranges:
+                print('%d points, AD_RANGE %d, maxtemp %.0f' % (p, ad, args.maxtemp))
+                print('  %-2s %-12s %5s %8s | %8s %8s %8s | %8s %8s %8s %8s %8s' % (
+                    'T', 'name', 'used', 'formula', 'max all', 'max work', 'mean', 'ns f', 'ns t', 'cyc f',
+                    'cyc t', 'build'))
+                for n, name, r25, beta in THERMISTORS:
+                    out = subprocess.run([exe, str(ad), str(r25), str(beta), str(args.maxtemp), str(args.rounds)],
+                                         check=True, stdout=subprocess.PIPE, universal_newlines=True).stdout.split()
+                    used, outside = int(out[0]), int(out[1])
+                    err_all, err_work, mean, ns_f, ns_t, cyc_f, cyc_t, build = (float(x) for x in out[2:10])
+                    size = int(out[10])
+                    print('  %-2d %-12s %5d %8d | %7.3fC %7.3fC %7.3fC | %8.1f %8.1f %8.0f %8.0f %6.0fus' % (
+                        n, name, used, outside, err_all, err_work, mean, ns_f, ns_t, cyc_f, cyc_t, build))
+                    worst[(p, ad)] = max(worst.get((p, ad), 0.0), err_work)
+                print('  %d bytes of RAM a heater' % size)
+
+    bad = [k for k, e in worst.items() if e >= args.limit]
+    for p, ad in sorted(worst):
+        print('%3d points, AD_RANGE %4d: worst error from 0 to 300C %.3fC %s' % (
+            p, ad, worst[(p, ad)], 'over' if (p, ad) in bad else 'ok'))
+    return 0 if not bad else 1
+
+
+if __name__ == '__main__':
+    sys.exit(main())